@@ -60,17 +60,20 @@ INCLUDEPATH += $$PWD/lib/GeographicLib-1.50/include
 SOURCES += \
     src/FPS.cpp \
     src/altitudeladder.cpp \
+    src/blackboxfile.cpp \
     src/blackboxmodel.cpp \
+    src/blackboxplayer.cpp \
+    src/blackboxstore.cpp \
+    src/cameramicroservice.cpp \
     src/drawingcanvas.cpp \
     src/flightpathvector.cpp \
-    src/frskytelemetry.cpp \
     src/gpiomicroservice.cpp \
     src/headingladder.cpp \
     src/horizonladder.cpp \
     src/linkmicroservice.cpp \
+    src/linkstats.cpp \
     src/localmessage.cpp \
     src/logger.cpp \
-    src/ltmtelemetry.cpp \
     src/main.cpp \
     src/managesettings.cpp \
     src/mavlinkbase.cpp \
@@ -78,7 +81,6 @@ SOURCES += \
     src/migration.cpp \
     src/missionwaypoint.cpp \
     src/missionwaypointmanager.cpp \
-    src/msptelemetry.cpp \
     src/openhd.cpp \
     src/openhdpi.cpp \
     src/openhdrc.cpp \
@@ -86,12 +88,19 @@ SOURCES += \
     src/openhdtelemetry.cpp \
     src/powermicroservice.cpp \
     src/qopenhdlink.cpp \
-    src/smartporttelemetry.cpp \
+    src/rcchannels.cpp \
     src/speedladder.cpp \
+    src/trace.cpp \
     src/statuslogmodel.cpp \
     src/statusmicroservice.cpp \
+    src/telemetryprotocols.cpp \
+    src/telemetryreactor.cpp \
+    src/telemetrysink.cpp \
+    src/timeseriesstore.cpp \
     src/util.cpp \
-    src/vectortelemetry.cpp \
+    src/wifibroadcaststatus.cpp \
+    src/videohealth.cpp \
+    src/videorecorder.cpp \
     src/QmlObjectListModel.cpp \
     src/vroverlay.cpp
 
@@ -100,13 +109,18 @@ RESOURCES += qml/qml.qrc
 HEADERS += \
     inc/FPS.h \
     inc/altitudeladder.h \
+    inc/blackboxfile.h \
     inc/blackboxmodel.h \
+    inc/blackboxplayer.h \
+    inc/blackboxstore.h \
+    inc/cameramicroservice.h \
     inc/drawingcanvas.h \
     inc/gpiomicroservice.h \
     inc/flightpathvector.h \
     inc/headingladder.h \
     inc/horizonladder.h \
     inc/linkmicroservice.h \
+    inc/linkstats.h \
     inc/logger.h \
     inc/logger_t.h \
     inc/managesettings.h \
@@ -116,27 +130,32 @@ HEADERS += \
     inc/powermicroservice.h \
     inc/sharedqueue.h \
     inc/constants.h \
-    inc/frskytelemetry.h \
     inc/localmessage.h \
     inc/localmessage_t.h \
-    inc/ltmtelemetry.h \
     inc/mavlinktelemetry.h \
     inc/migration.hpp \
-    inc/msptelemetry.h \
     inc/openhd.h \
     inc/openhdpi.h \
     inc/openhdrc.h \
     inc/openhdsettings.h \
     inc/openhdtelemetry.h \
     inc/qopenhdlink.h \
-    inc/smartporttelemetry.h \
+    inc/rcchannels.h \
     inc/speedladder.h \
+    inc/trace.h \
     inc/statuslogmodel.h \
     inc/statusmicroservice.h \
+    inc/telemetrydecoder.h \
+    inc/telemetryprotocols.h \
+    inc/telemetryreactor.h \
+    inc/telemetrysink.h \
+    inc/timeseriesstore.h \
     inc/util.h \
-    inc/vectortelemetry.h \
+    inc/videohealth.h \
+    inc/videorecorder.h \
     inc/vroverlay.h \
     inc/wifibroadcast.h \
+    inc/wifibroadcaststatus.h \
     inc/QmlObjectListModel.h
 
 DISTFILES += \
@@ -476,11 +495,19 @@ EnableADSB {
     DEFINES += ENABLE_ADSB
 
     SOURCES += \
+    src/ADSBBeastDecoder.cpp \
+    src/ADSBJsonParser.cpp \
+    src/ADSBTrafficEngine.cpp \
     src/ADSBVehicleManager.cpp \
+    src/ADSBVehicleModel.cpp \
     src/ADSBVehicle.cpp
     
     HEADERS += \
+    inc/ADSBBeastDecoder.h \
+    inc/ADSBJsonParser.h \
+    inc/ADSBTrafficEngine.h \
     inc/ADSBVehicleManager.h \
+    inc/ADSBVehicleModel.h \
     inc/ADSBVehicle.h
 
 }
@@ -557,6 +584,27 @@ EnableRC {
     message("EnableRC")
     DEFINES += ENABLE_RC
 
+    SOURCES += \
+    src/rcpacket.cpp \
+    src/rcsender.cpp \
+    src/rctransform.cpp
+
+    HEADERS += \
+    inc/rcpacket.h \
+    inc/rcsender.h \
+    inc/rctransform.h
+
+    # the air side test receiver, not shipped in release builds
+    CONFIG(debug, debug|release) {
+        DEFINES += ENABLE_RC_STUB
+
+        SOURCES += \
+        src/rcreceiverstub.cpp
+
+        HEADERS += \
+        inc/rcreceiverstub.h
+    }
+
     EnableGamepads {
         message("EnableGamepads")
         DEFINES += ENABLE_GAMEPADS
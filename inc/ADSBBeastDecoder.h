@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QHash>
+#include <QtNumeric>
+
+#include <vector>
+
+#include "ADSBVehicle.h"
+#include "ADSBJsonParser.h"
+
+/*
+ * Decodes the Beast binary output of dump1090, readsb and friends (TCP port 30005) into
+ * aircraft, as the bytes come in.
+ *
+ * Frames are 0x1a, a type, a 6 byte timestamp, a signal byte and the Mode-S message, with
+ * every 0x1a inside doubled. Only DF17/DF18 extended squitters that pass the CRC are used:
+ * identification, airborne position and airborne velocity. Positions are CPR encoded; the
+ * first one of an aircraft needs an even and an odd frame less than 10s apart, after that
+ * every single frame is decoded relative to the last known position.
+ *
+ * Nothing is allocated per frame. takeUpdates() hands out the aircraft that changed since
+ * the last call, filtered like the JSON sources.
+ */
+class ADSBBeastDecoder
+{
+public:
+    // bytes as they came from the socket, frames may span calls
+    void feed(const char *data, size_t length, qint64 now);
+
+    // aircraft with a position that changed since the last call
+    void takeUpdates(const ADSBJsonParser::Filter &filter, qint64 now, ADSBVehicle::VehicleList &vehicles);
+
+    // forget aircraft not heard from for a while
+    void expire(qint64 now);
+
+    // frames seen and frames dropped for a bad CRC, since the start
+    quint64 frames() const { return m_frames; }
+    quint64 badFrames() const { return m_bad_frames; }
+
+private:
+    struct Aircraft {
+        char callsign[8] = {};
+        int callsign_length = 0;
+
+        // ft, kt, degrees and ft/min, NaN until known
+        double altitude = qQNaN();
+        double speed = qQNaN();
+        double heading = qQNaN();
+        double vertical_rate = qQNaN();
+
+        // raw CPR of the last even and odd frame
+        int cpr_lat[2] = {};
+        int cpr_lon[2] = {};
+        qint64 cpr_time[2] = { -1, -1 };
+
+        double lat = 0.0;
+        double lon = 0.0;
+        qint64 position_time = -1;
+
+        qint64 seen = 0;
+        bool changed = false;
+    };
+
+    enum State {
+        WaitSync,
+        WaitType,
+        Data
+    };
+
+    void message(const uint8_t *message, int length, qint64 now);
+    void position(Aircraft &aircraft, uint64_t me, int type, qint64 now);
+    void velocity(Aircraft &aircraft, uint64_t me);
+    void identification(Aircraft &aircraft, uint64_t me);
+
+    Aircraft &aircraft(uint32_t icao, qint64 now);
+
+    State m_state = WaitSync;
+    bool m_escape = false;
+    int m_expected = 0;
+    int m_length = 0;
+    // timestamp, signal and the longest message
+    uint8_t m_frame[7 + 14];
+
+    QHash<uint32_t, Aircraft> m_aircraft;
+    std::vector<uint32_t> m_changed;
+
+    quint64 m_frames = 0;
+    quint64 m_bad_frames = 0;
+};
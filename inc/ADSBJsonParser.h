@@ -0,0 +1,45 @@
+#pragma once
+
+#include "ADSBVehicle.h"
+
+/*
+ * Decodes the aircraft lists of dump1090 (aircraft.json) and OpenSky (/api/states/all)
+ * in one pass over the reply, without building a QJsonDocument.
+ *
+ * Fields are read into a plain record while the parser walks the document, and an
+ * aircraft is only turned into a VehicleInfo_t, callsign QString included, once it has
+ * a position within range. Everything else is dropped before anything is allocated
+ * for it. The output list is cleared, not freed, so a poller that keeps it around
+ * reuses the same storage for every reply once the last snapshot it sent is released.
+ */
+class ADSBJsonParser
+{
+public:
+    enum Format {
+        Dump1090,
+        OpenSky
+    };
+
+    struct Filter {
+        double lat = 0.0;
+        double lon = 0.0;
+        // km
+        double max_distance = 0.0;
+        // keep aircraft without an altitude or below 5m
+        bool unknown_zero_alt = false;
+    };
+
+    struct Result {
+        // the reply was a JSON object
+        bool ok = false;
+        // aircraft in the list before filtering
+        int aircraft = 0;
+        // the "time" (OpenSky) or "now" (dump1090) of the data, in s, 0 when missing
+        qint64 time = 0;
+    };
+
+    static Result parse(Format format, const char *data, size_t length, const Filter &filter, ADSBVehicle::VehicleList &vehicles);
+
+    // great circle distance in km
+    static double distance(double lat_1, double lon_1, double lat_2, double lon_2);
+};
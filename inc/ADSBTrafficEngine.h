@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QHash>
+
+#include <vector>
+
+#include "ADSBVehicle.h"
+
+/*
+ * Everything the app knows about the traffic around the drone, kept for threat
+ * evaluation and for lookups by area.
+ *
+ * Contacts live in a table of parallel arrays (one per field, slots reused through a
+ * free list) keyed by ICAO, and are filed into a grid of kCellSize degree cells as their
+ * position comes in, so a bounding box lookup only visits the cells it overlaps.
+ *
+ * evaluate() runs one pass over the whole table against the drone's position and
+ * velocity: distance, bearing, closure rate and time and distance of the closest point
+ * of approach, in a flat plane around the drone, which is good to well past the ADS-B
+ * range. The loop only touches the arrays so the compiler can vectorise it. A contact
+ * raises an alert when its threat level goes up, and again every kAlertRepeat ms while
+ * it stays a threat, never once per update.
+ */
+class ADSBTrafficEngine
+{
+public:
+    enum Threat {
+        ThreatNone = 0,
+        ThreatAdvisory = 1,
+        ThreatWarning = 2
+    };
+
+    struct Ownship {
+        double lat = 0.0;
+        double lon = 0.0;
+        // m above MSL
+        double alt = 0.0;
+        // m/s north, east and up
+        double vn = 0.0;
+        double ve = 0.0;
+        double vu = 0.0;
+    };
+
+    struct Alert {
+        uint32_t icao;
+        int threat;
+        // m, degrees and seconds, tcpa is negative when the contact is moving away
+        double distance;
+        double bearing;
+        double tcpa;
+    };
+
+    void update(const ADSBVehicle::VehicleInfo_t &info);
+    void remove(uint32_t icao);
+    void clear();
+
+    int count() const {
+        return m_index.size();
+    }
+
+    void evaluate(const Ownship &ownship, qint64 now, std::vector<Alert> &alerts);
+
+    // slots of the contacts inside the box, in degrees
+    void query(double south, double west, double north, double east, std::vector<int> &slots) const;
+
+    // -1 when the contact isn't known
+    int slot(uint32_t icao) const {
+        return m_index.value(icao, -1);
+    }
+
+    uint32_t icao(int slot) const { return m_icao[slot]; }
+    double lat(int slot) const { return m_lat[slot]; }
+    double lon(int slot) const { return m_lon[slot]; }
+    double altitude(int slot) const { return m_alt[slot]; }
+    double distance(int slot) const { return m_distance[slot]; }
+    double bearing(int slot) const { return m_bearing[slot]; }
+    double closure(int slot) const { return m_closure[slot]; }
+    double tcpa(int slot) const { return m_tcpa[slot]; }
+    double dcpa(int slot) const { return m_dcpa[slot]; }
+    int threat(int slot) const { return m_threat[slot]; }
+
+    int highestThreat() const {
+        return m_highest_threat;
+    }
+
+private:
+    static constexpr double kCellSize = 0.05;
+
+    // debounce, per contact
+    static constexpr qint64 kAlertRepeat = 30000;
+    static constexpr qint64 kAlertHold = 15000;
+
+    static qint64 cell(double lat, double lon);
+    void unfile(int slot);
+
+    QHash<uint32_t, int> m_index;
+    std::vector<int> m_free;
+
+    std::vector<uint32_t> m_icao;
+    std::vector<uint8_t> m_used;
+    std::vector<qint64> m_cell;
+
+    // as reported
+    std::vector<double> m_lat;
+    std::vector<double> m_lon;
+    std::vector<double> m_alt;
+    std::vector<uint8_t> m_alt_known;
+    std::vector<double> m_vn;
+    std::vector<double> m_ve;
+    std::vector<double> m_vu;
+
+    // relative to the drone, from the last evaluate()
+    std::vector<double> m_distance;
+    std::vector<double> m_bearing;
+    std::vector<double> m_closure;
+    std::vector<double> m_tcpa;
+    std::vector<double> m_dcpa;
+    std::vector<int> m_threat;
+
+    // what the contact was last alerted for, and when
+    std::vector<int> m_alerted;
+    std::vector<qint64> m_alert_time;
+
+    QHash<qint64, std::vector<int>> m_cells;
+
+    int m_highest_threat = ThreatNone;
+};
@@ -12,6 +12,7 @@
 #include <QObject>
 #include <QGeoCoordinate>
 #include <QElapsedTimer>
+#include <QVector>
 
 class ADSBVehicle : public QObject
 {
@@ -27,7 +28,7 @@ public:
         VelocityAvailable =     1 << 6,
         VerticalVelAvailable =  1 << 7,
         LastContactAvailable =  1 << 8,
-        DistanceAvailable =  1 << 8
+        DistanceAvailable =     1 << 9
     };
 
     typedef struct {
@@ -44,6 +45,9 @@ public:
         double          distance;
     } VehicleInfo_t;
 
+    // everything one poll of a source returned
+    typedef QVector<VehicleInfo_t> VehicleList;
+
     ADSBVehicle(const VehicleInfo_t& vehicleInfo, QObject* parent);
 
     Q_PROPERTY(int              icaoAddress READ icaoAddress    CONSTANT)
@@ -111,4 +115,5 @@ private:
 };
 
 Q_DECLARE_METATYPE(ADSBVehicle::VehicleInfo_t)
+Q_DECLARE_METATYPE(ADSBVehicle::VehicleList)
 
@@ -1,23 +1,25 @@
 #pragma once
 
-#include "QmlObjectListModel.h"
 #include "ADSBVehicle.h"
+#include "ADSBVehicleModel.h"
+#include "ADSBJsonParser.h"
+#include "ADSBBeastDecoder.h"
+#include "ADSBTrafficEngine.h"
+
+#include <vector>
 
 #include <QThread>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QGeoCoordinate>
 
-#include <QJsonArray>
-#include <QJsonDocument>
-#include <QJsonObject>
-#include <QJsonValue>
-
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 
 #include <QGeoCoordinate>
+#include <QGeoRectangle>
 #include <QSettings>
 
 // This is a base clase for inheriting the links for 
@@ -31,7 +33,8 @@ public:
     ~ADSBapi();
 
 signals:
-    void adsbVehicleUpdate(const ADSBVehicle::VehicleInfo_t vehicleInfo);
+    // one per reply with every aircraft it kept
+    void adsbSnapshot(const ADSBVehicle::VehicleList &vehicles);
 
     void adsbClearModelRequest();
 
@@ -48,6 +51,8 @@ protected slots:
 protected:
     void init();
 
+    ADSBJsonParser::Filter filter() const;
+
     // network 
     QNetworkAccessManager * m_manager;
     QString adsb_url;
@@ -68,14 +73,32 @@ protected:
 
     qreal max_distance;
     bool unknown_zero_alt;
+
+    // filled by every reply, kept so its storage is reused
+    ADSBVehicle::VehicleList _vehicles;
 };
 
-// This class gets the info from Openskynetwork api
+/*
+ * This class gets the info from Openskynetwork api.
+ *
+ * The query box is snapped outwards to a grid of kTileSize degree tiles, so panning the map
+ * mostly asks for the same box again. Replies are kept for a while per box; a box already
+ * covered by fresh replies is answered from them, merged, without a request. A request for
+ * a box fetched before carries its ETag and Last-Modified, so an unchanged answer is a 304.
+ *
+ * Requests go out at most every _interval ms. That starts at kBaseInterval, grows while
+ * OpenSky keeps returning the same data and backs off on HTTP 429, following the retry
+ * header when there is one. adsb_opensky_url in the settings points it at another server,
+ * a local mock for testing.
+ *
+ * A box across the antimeridian is two boxes, one either side, requested one at a time and
+ * cached like any other.
+ */
 class ADSBInternet: public ADSBapi {
     Q_OBJECT
 
 public:
-    ADSBInternet() { timer_interval = 10000; }
+    ADSBInternet();
     ~ADSBInternet() {}
 
 private slots:
@@ -83,11 +106,73 @@ private slots:
     void requestData() override;
 
 private: 
+    // columns wrap, west > east is a box across the antimeridian, see _split()
+    struct Box {
+        int south = 0;
+        int west = 0;
+        int north = -1;
+        int east = -1;
+
+        bool operator==(const Box &other) const {
+            return south == other.south && west == other.west && north == other.north && east == other.east;
+        }
+        bool contains(int row, int column) const {
+            return row >= south && row <= north && column >= west && column <= east;
+        }
+        bool overlaps(const Box &other) const {
+            return south <= other.north && north >= other.south && west <= other.east && east >= other.west;
+        }
+    };
+
+    struct CacheEntry {
+        Box box;
+        QByteArray data;
+        QByteArray etag;
+        QByteArray last_modified;
+        qint64 fetched = 0;
+    };
+
+    static constexpr double kTileSize = 0.25;
+    static constexpr qint64 kBaseInterval = 10000;
+    static constexpr qint64 kMaxStaleInterval = 60000;
+    static constexpr qint64 kMaxBackoff = 300000;
+    static constexpr int kCacheSize = 6;
+
+    // tile columns from -180 to 180
+    static constexpr int kFirstColumn = static_cast<int>(-180.0 / kTileSize);
+    static constexpr int kLastColumn = static_cast<int>(180.0 / kTileSize) - 1;
+
+    Box _wantedBox() const;
+    int _split(const Box &box, Box parts[2]) const;
+    bool _covered(const Box &box, qint64 now) const;
+    bool _fromCache(const Box &box);
+    void _emit(const ADSBVehicle::VehicleList &vehicles);
+    CacheEntry *_cached(const Box &box);
+
     bool _adsb_api_openskynetwork;
     bool _show_adsb_internet; //wired to show widget setting. somewhat redundant
+
+    QElapsedTimer _clock;
+    qint64 _interval = kBaseInterval;
+    qint64 _next_request = 0;
+    bool _in_flight = false;
+    Box _requested;
+    Box _shown;
+    qint64 _shown_at = -1;
+    qint64 _data_time = 0;
+
+    // newest last
+    QList<CacheEntry> _cache;
+
+    ADSBVehicle::VehicleList _merged;
+    QHash<uint32_t, int> _merged_index;
 };
 
-// This class gets the info from SDR
+/*
+ * This class gets the info from SDR. It keeps a connection to the Beast port of the
+ * decoder on the ground station and hands out whatever changed every kBeastInterval ms.
+ * While that port can't be reached it falls back to polling aircraft.json.
+ */
 class ADSBSdr: public ADSBapi {
     Q_OBJECT
 
@@ -101,11 +186,21 @@ private slots:
     void processReply(QNetworkReply *reply) override;
     void requestData() override;
 
+    void _beastReadyRead();
+    void _beastFlush();
+
 private:
+    static constexpr quint16 kBeastPort = 30005;
+    static constexpr int kBeastInterval = 250;
+
     QString _groundAddress = "";
     bool _adsb_api_sdr;
     bool _show_adsb_sdr; //wired to show widget setting. somewhat redundant
 
+    QTcpSocket*                     _beast = nullptr;
+    QTimer*                         _beastTimer = nullptr;
+    QElapsedTimer                   _beastClock;
+    ADSBBeastDecoder                _decoder;
 };
 
 class ADSBVehicleManager : public QObject {
@@ -116,15 +211,31 @@ public:
     ~ADSBVehicleManager();
     static ADSBVehicleManager* instance();
 
-    Q_PROPERTY(QmlObjectListModel* adsbVehicles READ adsbVehicles CONSTANT)
+    Q_PROPERTY(ADSBVehicleModel* adsbVehicles READ adsbVehicles CONSTANT)
     Q_PROPERTY(QGeoCoordinate apiMapCenter READ apiMapCenter MEMBER _api_center_coord NOTIFY mapCenterChanged)
 
     // frontend indicator. 0 inactive, 1 red, 2 green
     Q_PROPERTY(uint status READ status NOTIFY statusChanged)
 
-    QmlObjectListModel* adsbVehicles(void) { return &_adsbVehicles; }
+    // highest ADSBTrafficEngine::Threat of all contacts, 0 none, 1 advisory, 2 warning
+    Q_PROPERTY(int threatLevel READ threatLevel NOTIFY trafficChanged)
+
+    ADSBVehicleModel* adsbVehicles(void) { return &_adsbVehicles; }
     QGeoCoordinate apiMapCenter(void) { return _api_center_coord; }
     uint status() { return _status; }
+    int threatLevel() { return _traffic.highestThreat(); }
+
+    /*
+     * Contacts inside the box, nearest first, as maps with icao, callsign, lat, lon,
+     * altitude, distance (m), bearing, closure (m/s), tcpa (s) and threat.
+     */
+    Q_INVOKABLE QVariantList trafficInBox(const QGeoRectangle &box);
+
+    /*
+     * What the map shows. Contacts outside it are still tracked and evaluated, but their
+     * vehicles are only updated every few seconds, or as soon as they come into view.
+     */
+    Q_INVOKABLE void setViewport(const QGeoRectangle &viewport);
 
     // called from qml when the map has moved
     Q_INVOKABLE void newMapCenter(QGeoCoordinate center_coord);
@@ -138,20 +249,45 @@ signals:
     // sent to adsbwidgetform.ui to update the status indicator
     void statusChanged(void);
 
+    // after every traffic evaluation
+    void trafficChanged(void);
+
 public slots:
+    // single contacts from MAVLink, collected and applied as a snapshot
     void adsbVehicleUpdate  (const ADSBVehicle::VehicleInfo_t vehicleInfo);
+    void adsbSnapshot       (const ADSBVehicle::VehicleList &vehicles);
     void onStarted();
     void adsbClearModel();
 
 private slots:
     void _cleanupStaleVehicles(void);
+    void _evaluateTraffic(void);
+    void _flushIncoming(void);
+    void _moveVehicles(void);
 
 private:
-    void _evaluateTraffic(double traffic_alt, int traffic_distance);
+    bool _inViewport(const QGeoCoordinate &coordinate) const;
+    void _applyUpdate(const ADSBVehicle::VehicleInfo_t &info);
+    void _flushPending(bool all);
 
-    QmlObjectListModel              _adsbVehicles;
-    QMap<uint32_t, ADSBVehicle*>    _adsbICAOMap;
+    ADSBVehicleModel                _adsbVehicles;
+    std::vector<uint32_t>           _expired;
     QTimer                          _adsbVehicleCleanupTimer;
+    ADSBTrafficEngine               _traffic;
+    QTimer                          _trafficTimer;
+    QTimer                          _motionTimer;
+    QElapsedTimer                   _traffic_clock;
+    bool                            _has_ownship = false;
+    std::vector<ADSBTrafficEngine::Alert> _alerts;
+    std::vector<int>                _query;
+
+    ADSBVehicle::VehicleList        _incoming;
+    ADSBVehicle::VehicleList        _added;
+    QTimer                          _incomingTimer;
+
+    // latest update of contacts off screen, applied in batches
+    QHash<uint32_t, ADSBVehicle::VehicleInfo_t> _pending;
+    QGeoRectangle                   _viewport;
     ADSBInternet*                   _internetLink = nullptr;
     ADSBSdr*                        _sdrLink = nullptr;
     QGeoCoordinate                  _api_center_coord;
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QGeoRectangle>
+#include <QHash>
+#include <QSet>
+
+#include <vector>
+
+#include "ADSBVehicle.h"
+
+/*
+ * The ADS-B contacts shown on the map and in the VR overlay.
+ *
+ * Contacts are kept in a table of parallel arrays, one per field, and a slot freed by an
+ * expired contact is handed to the next new one, so traffic churning in and out of range
+ * doesn't allocate or destroy anything once the table has grown to the busiest moment.
+ * Rows map to slots in the order contacts arrived. QML reads the fields through roles
+ * with the same names the ADSBVehicle properties had.
+ *
+ * update() only records which roles of a row changed; flush() then emits one dataChanged
+ * for every run of neighbouring changed rows.
+ *
+ * Every contact keeps its last kTrackLength reported positions in a ring, exposed as the
+ * track role, a list of coordinates for a MapPolyline. Between reports, extrapolate() moves the shown
+ * position of all contacts along their heading at their speed, so the markers glide instead
+ * of jumping from one poll to the next, for up to kMaxExtrapolation after the report; a
+ * contact that hasn't reported since is shown where it last did. The reported position
+ * stays what is filtered and evaluated on. */
+class ADSBVehicleModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        IcaoAddressRole = Qt::UserRole + 1,
+        CallsignRole,
+        CoordinateRole,
+        LatRole,
+        LonRole,
+        AltitudeRole,
+        VelocityRole,
+        HeadingRole,
+        AlertRole,
+        LastContactRole,
+        VerticalVelRole,
+        DistanceRole,
+        TrackRole
+    };
+
+    explicit ADSBVehicleModel(QObject *parent = nullptr);
+
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+    int count() const {
+        return static_cast<int>(m_rows.size());
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    bool contains(uint32_t icao) const {
+        return m_index.contains(icao);
+    }
+
+    // new contacts, in one insertion at the end, the last copy of a contact listed twice wins
+    void append(const ADSBVehicle::VehicleList &vehicles);
+
+    // fields of a known contact, as far as the flags say they are present
+    void update(const ADSBVehicle::VehicleInfo_t &info);
+
+    // tells the views about everything update() changed
+    void flush();
+
+    // moves the shown position of the contacts inside the box, or of all without a box, and flushes
+    void extrapolate(const QGeoRectangle &box);
+
+    // contacts without an update for kExpiration ms, their ICAO addresses go into removed
+    void removeExpired(std::vector<uint32_t> &removed);
+
+    void clear();
+
+    // by row, for walking the model
+    uint32_t icaoAddress(int row) const { return m_icao[m_rows[row]]; }
+
+    // empty or invalid when the contact isn't known
+    QString callsign(uint32_t icao) const;
+    QGeoCoordinate coordinate(uint32_t icao) const;
+
+signals:
+    void countChanged(int count);
+
+private:
+    // a contact without an update for this long is removed from the map
+    static constexpr qint64 kExpiration = 25000;
+
+    // positions kept per contact
+    static constexpr int kTrackLength = 32;
+
+    // past this a report is too old to guess where the contact went
+    static constexpr qint64 kMaxExtrapolation = 15000;
+
+    QVariantList track(int slot) const;
+
+    void releaseSlot(int slot);
+
+    QHash<uint32_t, int> m_index;
+    std::vector<int> m_free;
+
+    // new contacts of the list append() is working on, kept for its storage
+    QSet<uint32_t> m_appending;
+
+    // slot of every row
+    std::vector<int> m_rows;
+
+    std::vector<uint32_t> m_icao;
+    std::vector<QString> m_callsign;
+    // as reported, and when
+    std::vector<double> m_lat;
+    std::vector<double> m_lon;
+    std::vector<qint64> m_fix_time;
+
+    // as shown
+    std::vector<double> m_shown_lat;
+    std::vector<double> m_shown_lon;
+
+    // kTrackLength positions per slot, oldest overwritten first
+    std::vector<double> m_track_lat;
+    std::vector<double> m_track_lon;
+    std::vector<int> m_track_head;
+    std::vector<int> m_track_count;
+    std::vector<double> m_altitude;
+    std::vector<double> m_velocity;
+    std::vector<double> m_heading;
+    std::vector<int> m_alert;
+    std::vector<int> m_last_contact;
+    std::vector<double> m_vertical_vel;
+    std::vector<double> m_distance;
+    std::vector<qint64> m_updated;
+
+    // roles changed since the last flush(), as bits from IcaoAddressRole up
+    std::vector<uint32_t> m_dirty;
+    bool m_any_dirty = false;
+
+    QElapsedTimer m_clock;};
@@ -0,0 +1,188 @@
+#ifndef BLACKBOXFILE_H
+#define BLACKBOXFILE_H
+
+#include <QtCore>
+
+#include <atomic>
+#include <vector>
+
+#include "blackboxstore.h"
+#include "sharedqueue.h"
+
+/*
+ * On-disk blackbox format, one file per armed flight.
+ *
+ *   header
+ *   block*          record blocks and flight mode blocks, in the order they were written
+ *   index block     only present if the file was closed cleanly
+ *   trailer
+ *
+ * Every block starts with a BlackBoxBlockHeader and carries a CRC-32 of its payload.
+ * Record blocks hold up to kRecordsPerBlock fixed-size records, the writer cuts a
+ * block short whenever it syncs, so a crash loses at most the records since the last
+ * sync.
+ *
+ * The index lists every record block and flight mode block, so a cleanly closed file
+ * opens without touching the data. A file without a valid trailer is scanned block by
+ * block up to the first one that is truncated or fails its CRC.
+ *
+ * Everything is stored in host byte order, all the platforms we build for are little
+ * endian.
+ */
+
+struct BlackBoxFileHeader {
+    char magic[8];
+    uint16_t version;
+    uint16_t fieldCount;
+    uint32_t recordSize;
+    // ms since the epoch when the flight was armed
+    int64_t startTime;
+    uint32_t reserved[2];
+};
+
+struct BlackBoxBlockHeader {
+    uint32_t type;
+    uint32_t size;
+    uint32_t crc;
+    // record count for record blocks, the mode index for flight mode blocks
+    uint32_t count;
+    int64_t firstTime;
+};
+
+struct BlackBoxIndexEntry {
+    uint64_t offset;
+    int64_t firstTime;
+    // first row of a record block, the mode index of a flight mode block
+    uint32_t firstRow;
+    uint32_t count;
+};
+
+struct BlackBoxFileTrailer {
+    uint64_t indexOffset;
+    char magic[8];
+};
+
+
+/*
+ * Appends records to a flight file. All disk IO, including the periodic fsync, happens
+ * on the writer's own thread so a slow SD card never stalls the UI.
+ */
+class BlackBoxFileWriter
+{
+public:
+    BlackBoxFileWriter();
+    ~BlackBoxFileWriter();
+
+    bool open(const QString &fileName);
+    void close();
+
+    bool isOpen() const {
+        return m_thread != nullptr;
+    }
+
+    QString fileName() const {
+        return m_fileName;
+    }
+
+    // how often buffered records are written out and synced to disk, in ms
+    void setSyncInterval(int ms) {
+        m_syncInterval = ms;
+    }
+
+    void addFlightMode(int index, const QString &mode);
+    void append(const BlackBoxRecord &record);
+
+private:
+    struct Item {
+        enum Type {
+            Record,
+            FlightMode,
+            Sync,
+            Stop
+        } type = Record;
+
+        BlackBoxRecord record;
+        int index = 0;
+        QByteArray mode;
+    };
+
+    void writeLoop();
+    void writeRecordBlock();
+    void writeBlock(uint32_t type, uint32_t count, int64_t firstTime, const QByteArray &payload);
+    void writeIndex();
+    void sync();
+
+    QString m_fileName;
+    int m_syncInterval = 5000;
+    QElapsedTimer m_lastSync;
+
+    SharedQueue<Item> m_queue;
+    QThread *m_thread = nullptr;
+
+    // everything below is only touched by the writer thread
+    QFile m_file;
+    std::vector<BlackBoxRecord> m_pending;
+    std::vector<BlackBoxIndexEntry> m_index;
+    uint32_t m_rows = 0;
+    bool m_failed = false;
+};
+
+
+/*
+ * Read-only view of a flight file. The file is memory mapped and records are read in
+ * place, rows and times are found by binary search over the block index.
+ */
+class BlackBoxFileReader : public BlackBoxSeries
+{
+public:
+    BlackBoxFileReader() {}
+    ~BlackBoxFileReader();
+
+    bool open(const QString &fileName);
+    void close();
+
+    bool isOpen() const {
+        return m_data != nullptr;
+    }
+
+    QString fileName() const {
+        return m_file.fileName();
+    }
+
+    QStringList flightModes() const {
+        return m_flightModes;
+    }
+
+    int count() const override {
+        return m_count;
+    }
+    BlackBoxRecord at(int row) const override;
+    int64_t timeAt(int row) const override;
+    int indexForTime(int64_t time) const override;
+
+private:
+    bool readIndex();
+    void scanBlocks();
+    int blockForRow(int row) const;
+    const uchar *recordData(int block, int index) const;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    qint64 m_size = 0;
+
+    int m_fieldCount = 0;
+    uint32_t m_recordSize = 0;
+
+    /*
+     * Record blocks, either pointing straight into the index of a cleanly closed file
+     * or rebuilt by scanning one that was not.
+     */
+    const BlackBoxIndexEntry *m_blocks = nullptr;
+    int m_blockCount = 0;
+    std::vector<BlackBoxIndexEntry> m_scanned;
+
+    QStringList m_flightModes;
+    int m_count = 0;
+};
+
+#endif // BLACKBOXFILE_H
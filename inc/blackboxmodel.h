@@ -9,128 +9,8 @@
 #include <QAbstractListModel>
 #include <QGeoCoordinate>
 
-class BlackBox
-{
-public:
-    BlackBox(const QString &flight_mode,
-             const QString &time,
-             const double &lat,
-             const double &lon,
-             const double &alt,
-             const double &speed,
-             const int &heading,
-             const double &vertical,
-             const double &pitch,
-             const double &roll,
-             const double &throttle,
-             const int &control_pitch,
-             const int &control_roll,
-             const int &control_yaw,
-             const int &control_throttle,
-             const int &rssi_up,
-             const int &rssi_down,
-             const unsigned int &lost_packet_cnt_rc,
-             const unsigned int &lost_packet_cnt_telemetry_up,
-             const unsigned int &skipped_packet_cnt,
-             const unsigned int &injection_fail_cnt,
-             const double &kbitrate,
-             const double &kbitrate_measured,
-             const unsigned int &damaged_block_cnt,
-             const int &damaged_block_percent,
-             const unsigned int &lost_packet_cnt,
-             const int &lost_packet_percent,
-             const int &airpi_load,
-             const int &airpi_temp,
-             const double &air_batt_v,
-             const int &flight_mah,
-             const int &distance,
-             const double &home_course,
-             const double &homelat,
-             const double &homelon,
-             const QString &flight_time,
-             const double &flight_distance);
-
-    QString flight_mode() const;
-    QString time() const;
-    double lat() const;
-    double lon() const;
-    double alt() const;
-    double speed() const;
-    int heading() const;
-    double vertical() const;
-    double pitch() const;
-    double roll() const;
-    double throttle() const;
-    int control_pitch() const;
-    int control_roll() const;
-    int control_yaw() const;
-    int control_throttle() const;
-    int rssi_up() const;
-    int rssi_down() const;
-    unsigned int lost_packet_cnt_rc() const;
-    unsigned int lost_packet_cnt_telemetry_up() const;
-    unsigned int skipped_packet_cnt() const;
-    unsigned int injection_fail_cnt() const;
-    double kbitrate() const;
-    double kbitrate_measured() const;
-    unsigned int damaged_block_cnt() const;
-    int damaged_block_percent() const;
-    unsigned int lost_packet_cnt() const;
-    int lost_packet_percent() const;
-    int airpi_load() const;
-    int airpi_temp() const;
-    double air_batt_v() const;
-    int flight_mah() const;
-    //double total_mah() const;
-    int distance() const;
-    double home_course() const;
-    double homelat() const;
-    double homelon() const;
-    QString flight_time() const;
-    double flight_distance() const;
-
-private:
-    QString m_flight_mode;
-    QString m_time;
-    double m_lat;
-    double m_lon;
-    double m_alt;
-    double m_speed;
-    int m_heading;
-    double m_vertical;
-    double m_pitch;
-    double m_roll;
-    double m_throttle;
-    int m_control_pitch;
-    int m_control_roll;
-    int m_control_yaw;
-    int m_control_throttle;
-    int m_rssi_up;
-    int m_rssi_down;
-    unsigned int m_lost_packet_cnt_rc;
-    unsigned int m_lost_packet_cnt_telemetry_up;
-    unsigned int m_skipped_packet_cnt;
-    unsigned int m_injection_fail_cnt;
-    double m_kbitrate;
-    double m_kbitrate_measured;
-    unsigned int m_damaged_block_cnt;
-    int m_damaged_block_percent;
-    unsigned int m_lost_packet_cnt;
-    int m_lost_packet_percent;
-    int m_airpi_load;
-    int m_airpi_temp;
-    double m_air_batt_v;
-    int m_flight_mah;
-    //double total_mah;
-    int m_distance;
-    double m_home_course;
-    double m_homelat;
-    double m_homelon;
-    QString m_flight_time;
-    double m_flight_distance;
-};
-
-
+#include "blackboxfile.h"
+#include "blackboxstore.h"
 
 class BlackBoxModel : public QAbstractListModel {
     Q_OBJECT
@@ -189,22 +69,57 @@ public:
 
     QHash<int, QByteArray> roleNames() const override;
 
-    //Q_INVOKABLE void playBlackBoxObject(int index);
-    Q_INVOKABLE BlackBox getBlackBoxObject(int index) const;
+    // the flight file being reviewed, empty while showing the live recording
+    Q_PROPERTY(QString flight READ flight NOTIFY flightChanged)
+    QString flight() const {
+        return m_flight;
+    }
+
+    // recorded flights, newest first
+    Q_INVOKABLE QStringList flights() const;
+    Q_INVOKABLE bool loadFlight(const QString &flight);
+    Q_INVOKABLE void showLiveFlight();
+
+    Q_INVOKABLE int indexForTime(qint64 time) const;
+
+    // what the view currently shows, the live recording or a loaded flight
+    const BlackBoxSeries &series() const {
+        if (m_reader.isOpen()) {
+            return m_reader;
+        }
+        return m_store;
+    }
+
+    QString flightMode(const BlackBoxRecord &record) const;
+
+    // same format as the live flight timer
+    static QString formatTime(qint64 time);
 
 signals:
     //void blackBoxModelChanged(int rows);
+    void flightChanged(QString flight);
 
 public slots:
     void initBlackBoxModel();
-    void addBlackBoxObject(const BlackBox &blackbox);
+    void addBlackBoxObject(const BlackBoxRecord &record, const QString &flight_mode);
     void removeAllBlackBoxMarkers();
-    void playBlackBoxObject(int index);
+    void setArmed(bool armed);
+    void closeFlightFile();
 
 private:
-    QList<BlackBox> m_blackbox;
-    //int m_row_limit;
-    //QSettings settings;
+    static BlackBoxField fieldForRole(int role);
+    QString flightDirectory() const;
+    void removeOldFlights(const QString &dir);
+
+    BlackBoxStore m_store;
+    BlackBoxFileWriter m_writer;
+    BlackBoxFileReader m_reader;
+    QString m_flight;
+
+    // flight modes are stored as an index into this
+    QStringList m_flight_modes;
+
+    qint64 m_time_offset = 0;
 };
 
 #endif // BLACKBOXMODEL_H
@@ -0,0 +1,111 @@
+#ifndef BLACKBOXPLAYER_H
+#define BLACKBOXPLAYER_H
+
+#include <QObject>
+#include <QtQuick>
+
+#include "blackboxstore.h"
+
+class BlackBoxModel;
+
+/*
+ * Plays back whatever BlackBoxModel currently shows, by time rather than by row.
+ *
+ * Seeks only record the requested position, the state is rebuilt once per frame on
+ * the frame timer. Scrubbing the slider therefore costs one binary search and one
+ * update of the OpenHD properties per frame no matter how fast it moves.
+ *
+ * Attitude and position are interpolated between the two samples around the playback
+ * position, everything else holds the value of the earlier sample and is only pushed
+ * when the sample changes.
+ */
+class BlackBoxPlayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BlackBoxPlayer(QObject *parent = nullptr);
+
+    static BlackBoxPlayer* instance();
+
+    void setModel(BlackBoxModel *model);
+
+    // live telemetry is paused while this is set
+    Q_PROPERTY(bool active READ active NOTIFY activeChanged)
+    bool active() const {
+        return m_active;
+    }
+
+    Q_PROPERTY(bool playing READ playing NOTIFY playingChanged)
+    bool playing() const {
+        return m_playing;
+    }
+
+    Q_PROPERTY(double rate READ rate WRITE setRate NOTIFY rateChanged)
+    double rate() const {
+        return m_rate;
+    }
+    void setRate(double rate);
+
+    // ms, on the same clock as the recorded samples
+    Q_PROPERTY(qint64 position READ position NOTIFY positionChanged)
+    qint64 position() const {
+        return m_position;
+    }
+
+    Q_PROPERTY(QString positionText READ positionText NOTIFY positionChanged)
+    QString positionText() const;
+
+    Q_PROPERTY(qint64 start READ start NOTIFY rangeChanged)
+    qint64 start() const {
+        return m_start;
+    }
+
+    Q_PROPERTY(qint64 end READ end NOTIFY rangeChanged)
+    qint64 end() const {
+        return m_end;
+    }
+
+    Q_INVOKABLE void play();
+    Q_INVOKABLE void pause();
+    Q_INVOKABLE void seek(qint64 time);
+
+    // back to live telemetry
+    Q_INVOKABLE void stop();
+
+signals:
+    void activeChanged(bool active);
+    void playingChanged(bool playing);
+    void rateChanged(double rate);
+    void positionChanged(qint64 position);
+    void rangeChanged();
+
+private slots:
+    void updateRange();
+    void frame();
+
+private:
+    void setActive(bool active);
+    void apply();
+    void pushState(const BlackBoxRecord &record, bool discrete);
+
+    BlackBoxModel *m_model = nullptr;
+
+    QTimer m_frameTimer;
+    QElapsedTimer m_clock;
+
+    bool m_active = false;
+    bool m_playing = false;
+    bool m_dirty = false;
+    double m_rate = 1.0;
+
+    qint64 m_position = 0;
+    qint64 m_start = 0;
+    qint64 m_end = 0;
+
+    // the sample the discrete fields were last pushed from
+    int m_row = -1;
+    QString m_flight_time;
+};
+
+#endif // BLACKBOXPLAYER_H
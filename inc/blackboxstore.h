@@ -0,0 +1,173 @@
+#ifndef BLACKBOXSTORE_H
+#define BLACKBOXSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+
+/*
+ * The fixed blackbox schema. Every field is kept as a scaled integer, kBlackBoxScale in
+ * blackboxstore.cpp says what one unit of each is.
+ */
+enum BlackBoxField {
+    BlackBoxFlightMode,     // index into the model's flight mode table
+    BlackBoxLat,
+    BlackBoxLon,
+    BlackBoxAlt,
+    BlackBoxSpeed,
+    BlackBoxHeading,
+    BlackBoxVertical,
+    BlackBoxPitch,
+    BlackBoxRoll,
+    BlackBoxThrottle,
+    BlackBoxControlPitch,
+    BlackBoxControlRoll,
+    BlackBoxControlYaw,
+    BlackBoxControlThrottle,
+    BlackBoxRssiUp,
+    BlackBoxRssiDown,
+    BlackBoxLostPacketCntRC,
+    BlackBoxLostPacketCntTelemetryUp,
+    BlackBoxSkippedPacketCnt,
+    BlackBoxInjectionFailCnt,
+    BlackBoxKbitrate,
+    BlackBoxKbitrateMeasured,
+    BlackBoxDamagedBlockCnt,
+    BlackBoxDamagedBlockPercent,
+    BlackBoxLostPacketCnt,
+    BlackBoxLostPacketPercent,
+    BlackBoxAirpiLoad,
+    BlackBoxAirpiTemp,
+    BlackBoxAirBattV,
+    BlackBoxFlightMah,
+    BlackBoxDistance,
+    BlackBoxHomeCourse,
+    BlackBoxHomeLat,
+    BlackBoxHomeLon,
+    BlackBoxFlightDistance,
+    BlackBoxFieldCount
+};
+
+
+struct BlackBoxRecord {
+    // ms since the vehicle was armed
+    int64_t time = 0;
+    int32_t values[BlackBoxFieldCount] = {};
+
+    double get(BlackBoxField field) const;
+    void set(BlackBoxField field, double value);
+};
+
+
+/*
+ * Read access to a recorded series, implemented by the in-memory store and by flight
+ * files loaded for review.
+ */
+class BlackBoxSeries
+{
+public:
+    virtual ~BlackBoxSeries() {}
+
+    virtual int count() const = 0;
+    virtual BlackBoxRecord at(int row) const = 0;
+    virtual int64_t timeAt(int row) const = 0;
+
+    // last row with a time at or before the given one, -1 if there is none
+    virtual int indexForTime(int64_t time) const = 0;
+};
+
+
+/*
+ * Columnar, memory-bounded storage for blackbox records.
+ *
+ * Rows are collected into chunks of kRowsPerChunk. The chunk being filled keeps one
+ * plain array per field. Once it is full, each column is packed as zigzag varint deltas
+ * from the previous row into a preallocated arena block, so slowly changing counters
+ * shrink to a byte or less per sample.
+ *
+ * Reading a sealed row decodes its whole chunk into a one-chunk cache, so sequential
+ * access (playback, scrolling the model) decodes each chunk once.
+ *
+ * When the arena grows past the memory limit the oldest chunks are dropped. The caller
+ * asks overLimitRows() before appending so a model can announce the removal first.
+ */
+class BlackBoxStore : public BlackBoxSeries
+{
+public:
+    static constexpr size_t kDefaultMemoryLimit = 16 * 1024 * 1024;
+
+    explicit BlackBoxStore(size_t memoryLimit = kDefaultMemoryLimit);
+
+    void setMemoryLimit(size_t bytes) {
+        m_memoryLimit = bytes;
+    }
+
+    // rows that evict() would drop to make room for one more chunk
+    int overLimitRows() const;
+    void evict();
+
+    void append(const BlackBoxRecord &record);
+    void clear();
+
+    // row 0 is the oldest row still held
+    int count() const override {
+        return m_count;
+    }
+    BlackBoxRecord at(int row) const override;
+    int64_t timeAt(int row) const override;
+    int indexForTime(int64_t time) const override;
+
+    size_t memoryUsed() const;
+
+private:
+    static constexpr int kRowsPerChunk = 256;
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    struct Chunk {
+        int64_t firstTime = 0;
+        int64_t lastTime = 0;
+        int rows = 0;
+        // absolute index of the arena block and where the chunk starts in it
+        int block = 0;
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    struct Block {
+        std::vector<uint8_t> bytes;
+        int chunks = 0;
+    };
+
+    // plain columns, used for the chunk being filled and for the decode cache
+    struct Columns {
+        std::vector<int64_t> time;
+        std::vector<int32_t> values[BlackBoxFieldCount];
+
+        void reserve(int rows);
+        void clear();
+        BlackBoxRecord row(int index) const;
+    };
+
+    void seal();
+    const Columns &decode(int chunk) const;
+    void locate(int row, int &chunk, int &index) const;
+
+    size_t m_memoryLimit;
+
+    std::deque<Chunk> m_chunks;
+    std::deque<Block> m_blocks;
+    int m_firstBlock = 0;
+    int m_firstChunk = 0;
+
+    Columns m_open;
+
+    int m_count = 0;
+    int m_sealedRows = 0;
+
+    mutable Columns m_cache;
+    mutable int m_cacheChunk = -1;
+};
+
+#endif // BLACKBOXSTORE_H
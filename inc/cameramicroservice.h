@@ -0,0 +1,49 @@
+#ifndef CAMERAMICROSERVICE_H
+#define CAMERAMICROSERVICE_H
+
+#include <QObject>
+#include <QtQuick>
+
+#include <openhd/mavlink.h>
+#include "constants.h"
+
+#include "util.h"
+
+#include "mavlinkbase.h"
+
+class QUdpSocket;
+
+/*
+ * Not in the OpenHD dialect yet, the generated headers would lose it on the next
+ * regeneration. Goes away once the dialect XML has it, param1 is the video stream
+ * (0 main, 1 PiP).
+ */
+constexpr uint16_t kOpenHDCommandRequestKeyframe = 11202;
+
+class CameraMicroservice : public MavlinkBase {
+    Q_OBJECT
+
+public:
+    explicit CameraMicroservice(QObject *parent = nullptr, MicroserviceTarget target = MicroserviceTargetNone, MavlinkType mavlink_type = MavlinkTypeUDP);
+
+public slots:
+    void onSetup();
+    void onRequestKeyframe(int stream);
+
+private slots:
+    void onProcessMavlinkMessage(mavlink_message_t msg);
+    void onCommandFinished();
+
+private:
+    void sendKeyframeRequest();
+
+    MicroserviceTarget m_target;
+
+    // per stream, 0 is main and 1 is PiP
+    QElapsedTimer m_last_keyframe_request[2];
+
+    // bit per stream, waiting for the command in flight to be acked or given up on
+    int m_pending_keyframe_requests = 0;
+};
+
+#endif // CAMERAMICROSERVICE_H
@@ -0,0 +1,172 @@
+#ifndef LINKSTATS_H
+#define LINKSTATS_H
+
+#include <QObject>
+#include <QtQuick>
+
+#include <QAbstractListModel>
+
+#include <array>
+
+#include "wifibroadcast.h"
+
+/*
+ * Short window statistics for the wifibroadcast downlink, one row per ground adapter.
+ *
+ * The rx status the ground sends carries lifetime counters, so a percentage computed
+ * from them converges to the average of the whole session and hides bursts. Every
+ * status is turned into per interval deltas kept in fixed rings, and the loss figures
+ * are taken over the last window() ms only. RSSI is smoothed with an EWMA that also
+ * tracks its variance, and the adapter with the best smoothed signal is remembered for
+ * every status so diversity switching shows up.
+ *
+ * The history roles and properties are plain arrays, oldest first, ready for sparklines.
+ */
+class LinkStats : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    explicit LinkStats(QObject *parent = nullptr);
+
+    static LinkStats* instance();
+
+    enum LinkStatsRoles {
+        AdapterRole = Qt::UserRole + 1,
+        RssiRole,
+        RssiAverageRole,
+        RssiDeviationRole,
+        PacketRateRole,
+        LossRole,
+        BestRole,
+        RssiHistoryRole,
+        LossHistoryRole
+    };
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    QHash<int, QByteArray> roleNames() const override;
+
+    void update(const wifibroadcast_rx_status_forward_t &status);
+
+    // percent of the video packets lost/damaged over the window
+    Q_PROPERTY(double lossPercent READ lossPercent NOTIFY statsChanged)
+    double lossPercent() const {
+        return m_loss_percent;
+    }
+
+    Q_PROPERTY(double damagedPercent READ damagedPercent NOTIFY statsChanged)
+    double damagedPercent() const {
+        return m_damaged_percent;
+    }
+
+    Q_PROPERTY(int bestAdapter READ bestAdapter NOTIFY statsChanged)
+    int bestAdapter() const {
+        return m_best_adapter;
+    }
+
+    // how often the best adapter changed over the kept history
+    Q_PROPERTY(int bestAdapterSwitches READ bestAdapterSwitches NOTIFY statsChanged)
+    int bestAdapterSwitches() const {
+        return m_best_switches;
+    }
+
+    Q_PROPERTY(QVariantList bestHistory READ bestHistory NOTIFY statsChanged)
+    QVariantList bestHistory() const;
+
+    Q_PROPERTY(QVariantList lossHistory READ lossHistory NOTIFY statsChanged)
+    QVariantList lossHistory() const;
+
+    Q_PROPERTY(int window READ window WRITE setWindow NOTIFY windowChanged)
+    int window() const {
+        return m_window;
+    }
+    void setWindow(int window);
+
+signals:
+    void statsChanged();
+    void windowChanged(int window);
+
+private:
+    static constexpr int kMaxAdapters = 6;
+    static constexpr int kHistory = 64;
+
+    template <typename T>
+    struct Ring {
+        std::array<T, kHistory> items {};
+        int head = 0;
+        int count = 0;
+
+        void push(const T &item) {
+            items[head] = item;
+            head = (head + 1) % kHistory;
+            count = qMin(count + 1, kHistory);
+        }
+
+        // 0 is the oldest
+        const T &at(int i) const {
+            return items[(head - count + i + kHistory) % kHistory];
+        }
+
+        const T &newest() const {
+            return at(count - 1);
+        }
+
+        void clear() {
+            head = 0;
+            count = 0;
+        }
+    };
+
+    struct LinkSample {
+        qint64 time;
+        quint32 received;
+        quint32 lost;
+        quint32 damaged;
+        double loss;
+    };
+
+    struct AdapterSample {
+        qint64 time;
+        quint32 received;
+        int dbm;
+        double loss;
+    };
+
+    struct Adapter {
+        Ring<AdapterSample> samples;
+        quint32 last_received = 0;
+
+        int rssi = -127;
+        double rssi_average = 0.0;
+        double rssi_variance = 0.0;
+        double packet_rate = 0.0;
+        double loss = 0.0;
+    };
+
+    // counters restart with the ground side, a smaller value means a new run
+    static quint32 delta(quint32 current, quint32 last) {
+        return current >= last ? current - last : current;
+    }
+
+    QElapsedTimer m_clock;
+    bool m_started = false;
+
+    wifibroadcast_rx_status_forward_t m_last {};
+
+    Ring<LinkSample> m_samples;
+    Ring<qint8> m_best;
+
+    std::array<Adapter, kMaxAdapters> m_adapters;
+    int m_adapter_count = 0;
+
+    double m_loss_percent = 0.0;
+    double m_damaged_percent = 0.0;
+    int m_best_adapter = -1;
+    int m_best_switches = 0;
+
+    int m_window = 2000;
+};
+
+#endif // LINKSTATS_H
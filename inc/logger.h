@@ -4,27 +4,84 @@
 #include <QObject>
 #include <QtQuick>
 
+#include <atomic>
+
 #include "constants.h"
 
+/*
+ * Buffered log file writer.
+ *
+ * logData() never blocks and never touches the disk: the message is copied into a
+ * fixed slot of a bounded lock-free queue together with a monotonic timestamp. A writer
+ * thread drains the queue in batches, formats the timestamps and appends to the log
+ * file, rotating it once it gets too big. If the writer can't keep up messages are
+ * dropped and the number dropped is logged once it catches up.
+ */
 class Logger: public QObject {
     Q_OBJECT
 
 public:
     explicit Logger(QObject *parent = nullptr);
+    virtual ~Logger();
 
     static Logger* instance();
 
-    void logData(QString data, int level);
+    // same scale as the MAVLink severities and the log_level setting
+    enum Level {
+        LogEmergency,
+        LogAlert,
+        LogCritical,
+        LogError,
+        LogWarning,
+        LogNotice,
+        LogInfo,
+        LogDebug
+    };
+    Q_ENUM(Level)
+
+    // safe to call from any thread, messages above the current level are ignored
+    Q_INVOKABLE void logData(const QString &data, int level);
 
-    QFile *outFile;
+    Q_INVOKABLE void setLevel(int level) {
+        m_level = level;
+    }
 
-signals:    
+signals:
 
 private:
+    static constexpr int kQueueSize = 1024;
+    static constexpr int kMaxMessage = 240;
+
+    struct Slot {
+        std::atomic<quint32> sequence;
+        qint64 time;
+        quint8 level;
+        quint16 length;
+        char text[kMaxMessage];
+    };
+
     void init();
+    void stop();
+    void writeLoop();
+    bool drain(QByteArray &out);
+    void rotate();
+
     QString filePath;
+    QFile m_file;
+
+    std::atomic<int> m_level { LogInfo };
+
+    QElapsedTimer m_clock;
+    qint64 m_wallStart = 0;
 
+    Slot m_slots[kQueueSize];
+    std::atomic<quint32> m_enqueue { 0 };
+    quint32 m_dequeue = 0;
+    std::atomic<int> m_dropped { 0 };
 
+    std::atomic<bool> m_running { false };
+    std::atomic<bool> m_stop { false };
+    QThread *m_thread = nullptr;
 };
 
 
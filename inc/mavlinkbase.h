@@ -2,7 +2,10 @@
 #define MAVLINKBASE_H
 
 #include <QObject>
-#include <QtQuick>
+#include <QtCore>
+
+#include <atomic>
+#include <memory>
 
 
 #include <openhd/mavlink.h>
@@ -11,6 +14,7 @@
 #include "util.h"
 
 
+class QAbstractSocket;
 class QUdpSocket;
 
 typedef enum MavlinkType {
@@ -73,30 +77,6 @@ public:
     float int_param7 = 0;
 };
 
-#if defined(ENABLE_RC)
-class MavlinkRC  {
-public:
-    uint ch1 = 0;
-    uint ch2 = 0;
-    uint ch3 = 0;
-    uint ch4 = 0;
-    uint ch5 = 0;
-    uint ch6 = 0;
-    uint ch7 = 0;
-    uint ch8 = 0;
-    uint ch9 = 0;
-    uint ch10 = 0;
-    uint ch11 = 0;
-    uint ch12 = 0;
-    uint ch13 = 0;
-    uint ch14 = 0;
-    uint ch15 = 0;
-    uint ch16 = 0;
-    uint ch17 = 0;
-    uint ch18 = 0;
-
-};
-#endif
 
 
 class MavlinkBase: public QObject {
@@ -117,7 +97,6 @@ public:
     Q_INVOKABLE void fetchParameters();
 
     void sendHeartbeat();
-    void sendRC();
 
     Q_INVOKABLE void get_Mission_Items(int count);
     Q_INVOKABLE void send_Mission_Ack();
@@ -141,6 +120,22 @@ public:
 
     Q_INVOKABLE void setGroundIP(QString address);   
 
+    // an already packed frame from another thread, through a queued connection
+    Q_INVOKABLE void sendFrame(const QByteArray &frame);
+
+    MavlinkType mavlinkType() const {
+        return m_mavlink_type;
+    }
+
+    /*
+     * Where sendData() writes to over UDP, for other threads sending on their own socket:
+     * the IPv4 address << 16 | port. 0 on TCP and until the router's port has been learned
+     * from its datagrams, before that sendData() goes to our own bound port.
+     */
+    quint64 udpEndpoint() const {
+        return m_udp_endpoint.load(std::memory_order_relaxed);
+    }
+
 signals:
     void last_heartbeat_changed(qint64 last_heartbeat);
     void last_attitude_changed(qint64 last_attitude);
@@ -163,28 +158,6 @@ signals:
 public slots:
     void onStarted();    
     void request_Mission_Changed();
-#if defined(ENABLE_RC)
-    void receive_RC_Update(uint rc1,
-                           uint rc2,
-                           uint rc3,
-                           uint rc4,
-                           uint rc5,
-                           uint rc6,
-                           uint rc7,
-                           uint rc8,
-                           uint rc9,
-                           uint rc10,
-                           uint rc11,
-                           uint rc12,
-                           uint rc13,
-                           uint rc14,
-                           uint rc15,
-                           uint rc16,
-                           uint rc17,
-                           uint rc18
-                           );
-    void joystick_Present_Changed(bool joystickPresent);
-#endif
 protected slots:
     void processMavlinkUDPDatagrams();
     void processMavlinkTCPData();
@@ -197,13 +170,14 @@ protected:
     void commandStateLoop();
     bool isConnectionLost();
     void resetParamVars();
-    void processData(QByteArray data);
+    void processData(const QByteArray &data);
     void sendData(char* data, int len);
     void sendCommand(MavlinkCommand command);   
     void setDataStreamRate(MAV_DATA_STREAM streamType, uint8_t hz);
     void requestAutopilotInfo();
 
     void reconnectTCP();
+    void publishEndpoint();
 
     QVariantMap m_allParameters;
 
@@ -235,11 +209,17 @@ protected:
     quint16 groundTCPPort = 5761;
 
     std::atomic<bool> m_ground_available;
+    bool m_udp_port_learned = false;
+    std::atomic<quint64> m_udp_endpoint { 0 };
     MavlinkType m_mavlink_type;
     QAbstractSocket *mavlinkSocket = nullptr;
 
     mavlink_status_t r_mavlink_status;
 
+    // parser state, see processData()
+    mavlink_message_t m_rx_message {};
+    mavlink_status_t m_rx_status {};
+
     qint64 m_last_heartbeat = -1;
     qint64 m_last_attitude = -1;
     qint64 m_last_battery = -1;
@@ -255,8 +235,6 @@ protected:
     QTimer* timer = nullptr;
     QTimer* m_heartbeat_timer = nullptr;
 
-    QTimer* m_rc_timer = nullptr;
-
     QTimer* m_command_timer = nullptr;
     QTimer* tcpReconnectTimer = nullptr;
 
@@ -265,27 +243,6 @@ protected:
     uint64_t m_command_sent_timestamp = 0;
 
     std::shared_ptr<MavlinkCommand> m_current_command;
-
-    uint m_rc1 = 0;
-    uint m_rc2 = 0;
-    uint m_rc3 = 0;
-    uint m_rc4 = 0;
-    uint m_rc5 = 0;
-    uint m_rc6 = 0;
-    uint m_rc7 = 0;
-    uint m_rc8 = 0;
-    uint m_rc9 = 0;
-    uint m_rc10 = 0;
-    uint m_rc11 = 0;
-    uint m_rc12 = 0;
-    uint m_rc13 = 0;
-    uint m_rc14 = 0;
-    uint m_rc15 = 0;
-    uint m_rc16 = 0;
-    uint m_rc17 = 0;
-    uint m_rc18 = 0;
-
-
 };
 
 #endif
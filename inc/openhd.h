@@ -22,7 +22,7 @@ public:
     void calculate_home_distance();
     void calculate_home_course();
 
-    Q_INVOKABLE void pauseBlackBox(bool pause, int index);
+    Q_INVOKABLE void pauseBlackBox(bool pause);
     void updateBlackBoxModel();
 
     Q_INVOKABLE void set_Requested_Flight_Mode(int mode);
@@ -164,6 +164,19 @@ public:
         return m_hdg;
     }
 
+    // m/s, north east down
+    double get_vx() {
+        return m_vx;
+    }
+
+    double get_vy() {
+        return m_vy;
+    }
+
+    double get_vz() {
+        return m_vz;
+    }
+
     Q_PROPERTY(int satellites_visible MEMBER m_satellites_visible WRITE set_satellites_visible NOTIFY satellites_visible_changed)
     void set_satellites_visible(int satellites_visible);
 
@@ -371,17 +384,10 @@ public:
     void set_last_telemetry_vfr(qint64 last_telemetry_vfr);
 
 
-    Q_PROPERTY(bool main_video_running MEMBER m_main_video_running WRITE set_main_video_running NOTIFY main_video_running_changed)
-    void set_main_video_running(bool main_video_running);
-
     Q_PROPERTY(bool lte_video_running MEMBER m_lte_video_running WRITE set_lte_video_running NOTIFY lte_video_running_changed)
     void set_lte_video_running(bool lte_video_running);
 
 
-    Q_PROPERTY(bool pip_video_running MEMBER m_pip_video_running WRITE set_pip_video_running NOTIFY pip_video_running_changed)
-    void set_pip_video_running(bool pip_video_running);
-
-
     Q_PROPERTY(QList<int> ground_gpio MEMBER m_ground_gpio WRITE set_ground_gpio NOTIFY ground_gpio_changed)
     void set_ground_gpio(QList<int> ground_gpio);
 
@@ -594,9 +600,6 @@ signals:
     void last_telemetry_gps_changed(qint64 last_telemetry_gps);
     void last_telemetry_vfr_changed(qint64 last_telemetry_vfr);
 
-    void main_video_running_changed(bool main_video_running);
-    void pip_video_running_changed(bool pip_video_running);
-
     void lte_video_running_changed(bool lte_video_running);
 
     void ground_gpio_changed(QList<int> ground_gpio);
@@ -610,6 +613,9 @@ signals:
     void ground_reboot();
     void ground_shutdown();
 
+    // stream is 0 for main and 1 for PiP, emitted from the video threads
+    void request_keyframe(int stream);
+
     void ground_vin_changed(double ground_vin);
     void ground_vout_changed(double ground_vout);
     void ground_vbat_changed(double ground_vbat);
@@ -633,13 +639,12 @@ signals:
     void currentWaypointChanged (int current_waypoint);
     void totalWaypointsChanged (int total_waypoints);
 
-    void addBlackBoxObject(const BlackBox &blackbox);
+    void addBlackBoxObject(const BlackBoxRecord &record, const QString &flight_mode);
     void pauseTelemetry(bool pause);
     void requested_Flight_Mode_Changed(int mode);
     void requested_ArmDisarm_Changed(int arm_disarm);
     void FC_Reboot_Shutdown_Changed(int reboot_shutdown);
     void request_Mission_Changed();
-    void playBlackBoxObject(int index);
 
     void fontFamilyChanged(QString fontFamily);
 
@@ -784,8 +789,6 @@ public:
     qint64 m_last_telemetry_gps = -1;
     qint64 m_last_telemetry_vfr = -1;
 
-    bool m_main_video_running = false;
-    bool m_pip_video_running = false;
     bool m_lte_video_running = false;
 
     QElapsedTimer totalTime;
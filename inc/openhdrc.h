@@ -3,11 +3,13 @@
 
 #include <QObject>
 #include <QtQuick>
+
 #if defined(ENABLE_SPEECH)
 #include <QtTextToSpeech/QTextToSpeech>
 #endif
 
 #include "util.h"
+#include "rcchannels.h"
 
 #if defined(ENABLE_GAMEPADS)
 #include <QGamepad>
@@ -17,8 +19,6 @@
 #include <QJoysticks.h>
 #endif
 
-class QUdpSocket;
-
 class OpenHDRC: public QObject {
     Q_OBJECT
 
@@ -27,6 +27,18 @@ public:
 
     Q_INVOKABLE void setGroundIP(QString address);
 
+    Q_INVOKABLE void updateSetting(const QString &key, const QVariant &value);
+
+    /*
+     * 0 based. setChannel() sets the value a channel has while the stick profile doesn't
+     * map it to an input, channel() is the value sent, after the profile.
+     */
+    void setChannel(int channel, uint value);
+    uint channel(int channel) const;
+
+    // -1 to 1, axes from 0, buttons from RCInputFrame::kAxes
+    void setInput(int input, double value);
+
 
 #if defined(ENABLE_GAMEPADS)
     Q_PROPERTY(int connectedGamepad MEMBER m_selectedGamepad WRITE set_selectedGamepad NOTIFY selectedGamepadChanged)
@@ -46,97 +58,84 @@ public:
 
 
 
-    Q_PROPERTY(uint rc1 MEMBER m_rc1 WRITE set_rc1 NOTIFY rc1_changed)
-    void set_rc1(uint rc1);
+    /*
+     * Channel values, 1000-2000. All share channelsChanged, which only fires when the
+     * RC thread computed a frame that differs from the one before.
+     */
+    Q_PROPERTY(uint rc1 READ rc1 WRITE set_rc1 NOTIFY channelsChanged)
+    uint rc1() const { return channel(0); }
+    void set_rc1(uint rc1) { setChannel(0, rc1); }
 
-    Q_PROPERTY(uint rc2 MEMBER m_rc2 WRITE set_rc2 NOTIFY rc2_changed)
-    void set_rc2(uint rc2);
+    Q_PROPERTY(uint rc2 READ rc2 WRITE set_rc2 NOTIFY channelsChanged)
+    uint rc2() const { return channel(1); }
+    void set_rc2(uint rc2) { setChannel(1, rc2); }
 
-    Q_PROPERTY(uint rc3 MEMBER m_rc3 WRITE set_rc3 NOTIFY rc3_changed)
-    void set_rc3(uint rc3);
+    Q_PROPERTY(uint rc3 READ rc3 WRITE set_rc3 NOTIFY channelsChanged)
+    uint rc3() const { return channel(2); }
+    void set_rc3(uint rc3) { setChannel(2, rc3); }
 
-    Q_PROPERTY(uint rc4 MEMBER m_rc4 WRITE set_rc4 NOTIFY rc4_changed)
-    void set_rc4(uint rc4);
+    Q_PROPERTY(uint rc4 READ rc4 WRITE set_rc4 NOTIFY channelsChanged)
+    uint rc4() const { return channel(3); }
+    void set_rc4(uint rc4) { setChannel(3, rc4); }
 
-    Q_PROPERTY(uint rc5 MEMBER m_rc5 WRITE set_rc5 NOTIFY rc5_changed)
-    void set_rc5(uint rc5);
+    Q_PROPERTY(uint rc5 READ rc5 WRITE set_rc5 NOTIFY channelsChanged)
+    uint rc5() const { return channel(4); }
+    void set_rc5(uint rc5) { setChannel(4, rc5); }
 
-    Q_PROPERTY(uint rc6 MEMBER m_rc6 WRITE set_rc6 NOTIFY rc6_changed)
-    void set_rc6(uint rc6);
+    Q_PROPERTY(uint rc6 READ rc6 WRITE set_rc6 NOTIFY channelsChanged)
+    uint rc6() const { return channel(5); }
+    void set_rc6(uint rc6) { setChannel(5, rc6); }
 
-    Q_PROPERTY(uint rc7 MEMBER m_rc7 WRITE set_rc7 NOTIFY rc7_changed)
-    void set_rc7(uint rc7);
+    Q_PROPERTY(uint rc7 READ rc7 WRITE set_rc7 NOTIFY channelsChanged)
+    uint rc7() const { return channel(6); }
+    void set_rc7(uint rc7) { setChannel(6, rc7); }
 
-    Q_PROPERTY(uint rc8 MEMBER m_rc8 WRITE set_rc8 NOTIFY rc8_changed)
-    void set_rc8(uint rc8);
+    Q_PROPERTY(uint rc8 READ rc8 WRITE set_rc8 NOTIFY channelsChanged)
+    uint rc8() const { return channel(7); }
+    void set_rc8(uint rc8) { setChannel(7, rc8); }
 
-    Q_PROPERTY(uint rc9 MEMBER m_rc9 WRITE set_rc9 NOTIFY rc9_changed)
-    void set_rc9(uint rc9);
+    Q_PROPERTY(uint rc9 READ rc9 WRITE set_rc9 NOTIFY channelsChanged)
+    uint rc9() const { return channel(8); }
+    void set_rc9(uint rc9) { setChannel(8, rc9); }
 
-    Q_PROPERTY(uint rc10 MEMBER m_rc10 WRITE set_rc10 NOTIFY rc10_changed)
-    void set_rc10(uint rc10);
+    Q_PROPERTY(uint rc10 READ rc10 WRITE set_rc10 NOTIFY channelsChanged)
+    uint rc10() const { return channel(9); }
+    void set_rc10(uint rc10) { setChannel(9, rc10); }
 
-    Q_PROPERTY(uint rc11 MEMBER m_rc11 WRITE set_rc11 NOTIFY rc11_changed)
-    void set_rc11(uint rc11);
+    Q_PROPERTY(uint rc11 READ rc11 WRITE set_rc11 NOTIFY channelsChanged)
+    uint rc11() const { return channel(10); }
+    void set_rc11(uint rc11) { setChannel(10, rc11); }
 
-    Q_PROPERTY(uint rc12 MEMBER m_rc12 WRITE set_rc12 NOTIFY rc12_changed)
-    void set_rc12(uint rc12);
+    Q_PROPERTY(uint rc12 READ rc12 WRITE set_rc12 NOTIFY channelsChanged)
+    uint rc12() const { return channel(11); }
+    void set_rc12(uint rc12) { setChannel(11, rc12); }
 
-    Q_PROPERTY(uint rc13 MEMBER m_rc13 WRITE set_rc13 NOTIFY rc13_changed)
-    void set_rc13(uint rc13);
+    Q_PROPERTY(uint rc13 READ rc13 WRITE set_rc13 NOTIFY channelsChanged)
+    uint rc13() const { return channel(12); }
+    void set_rc13(uint rc13) { setChannel(12, rc13); }
 
-    Q_PROPERTY(uint rc14 MEMBER m_rc14 WRITE set_rc14 NOTIFY rc14_changed)
-    void set_rc14(uint rc14);
+    Q_PROPERTY(uint rc14 READ rc14 WRITE set_rc14 NOTIFY channelsChanged)
+    uint rc14() const { return channel(13); }
+    void set_rc14(uint rc14) { setChannel(13, rc14); }
 
-    Q_PROPERTY(uint rc15 MEMBER m_rc15 WRITE set_rc15 NOTIFY rc15_changed)
-    void set_rc15(uint rc15);
+    Q_PROPERTY(uint rc15 READ rc15 WRITE set_rc15 NOTIFY channelsChanged)
+    uint rc15() const { return channel(14); }
+    void set_rc15(uint rc15) { setChannel(14, rc15); }
 
-    Q_PROPERTY(uint rc16 MEMBER m_rc16 WRITE set_rc16 NOTIFY rc16_changed)
-    void set_rc16(uint rc16);
+    Q_PROPERTY(uint rc16 READ rc16 WRITE set_rc16 NOTIFY channelsChanged)
+    uint rc16() const { return channel(15); }
+    void set_rc16(uint rc16) { setChannel(15, rc16); }
 
-    Q_PROPERTY(uint rc17 MEMBER m_rc17 WRITE set_rc17 NOTIFY rc17_changed)
-    void set_rc17(uint rc17);
+    Q_PROPERTY(uint rc17 READ rc17 WRITE set_rc17 NOTIFY channelsChanged)
+    uint rc17() const { return channel(16); }
+    void set_rc17(uint rc17) { setChannel(16, rc17); }
+
+    Q_PROPERTY(uint rc18 READ rc18 WRITE set_rc18 NOTIFY channelsChanged)
+    uint rc18() const { return channel(17); }
+    void set_rc18(uint rc18) { setChannel(17, rc18); }
 
-    Q_PROPERTY(uint rc18 MEMBER m_rc18 WRITE set_rc18 NOTIFY rc18_changed)
-    void set_rc18(uint rc18);
 signals:
-    void channelUpdate(uint rc1,
-                       uint rc2,
-                       uint rc3,
-                       uint rc4,
-                       uint rc5,
-                       uint rc6,
-                       uint rc7,
-                       uint rc8,
-                       uint rc9,
-                       uint rc10,
-                       uint rc11,
-                       uint rc12,
-                       uint rc13,
-                       uint rc14,
-                       uint rc15,
-                       uint rc16,
-                       uint rc17,
-                       uint rc18);
-
-    void rc1_changed(uint rc1);
-    void rc2_changed(uint rc2);
-    void rc3_changed(uint rc3);
-    void rc4_changed(uint rc4);
-    void rc5_changed(uint rc5);
-    void rc6_changed(uint rc6);
-    void rc7_changed(uint rc7);
-    void rc8_changed(uint rc8);
-    void rc9_changed(uint rc9);
-    void rc10_changed(uint rc10);
-    void rc11_changed(uint rc11);
-    void rc12_changed(uint rc12);
-    void rc13_changed(uint rc13);
-    void rc14_changed(uint rc14);
-    void rc15_changed(uint rc15);
-    void rc16_changed(uint rc16);
-    void rc17_changed(uint rc17);
-    void rc18_changed(uint rc18);
+    void channelsChanged();
 
 #if defined(ENABLE_GAMEPADS)
     void selectedGamepadChanged(int selectedGamepad);
@@ -151,7 +150,6 @@ signals:
 
 
 private slots:
-    void channelTrigger();
 #if defined(ENABLE_GAMEPADS)
     void connectedGamepadsChanged();
     void nameChanged(QString name);
@@ -160,9 +158,9 @@ private slots:
 #if defined(ENABLE_JOYSTICKS)
     void connectedJoysticksChanged();
 #endif
-    void processRCDatagrams();
 
     void axisChanged (const int js, const int axis, const qreal value);
+    void buttonChanged (const int js, const int button, const bool pressed);
 
     void connectedChanged(bool value);
     void axisLeftXChanged(double value);
@@ -189,12 +187,6 @@ private slots:
     void buttonGuideChanged(bool value);
 
 private:
-    OpenHDUtil m_util;
-
-    QUdpSocket *rcSocket = nullptr;
-
-    QString groundAddress;
-
 #if defined(ENABLE_GAMEPADS)
     QList<int> m_connectedGamepads;
     int m_selectedGamepad = -1;
@@ -215,27 +207,8 @@ private:
     QTextToSpeech *m_speech;
 #endif
 
-    uint8_t  seqno = 0;
-
-    uint m_rc1 = 1500;
-    uint m_rc2 = 1500;
-    uint m_rc3 = 1500;
-    uint m_rc4 = 1500;
-    uint m_rc5 = 1500;
-    uint m_rc6 = 1500;
-    uint m_rc7 = 1500;
-    uint m_rc8 = 1500;
-    uint m_rc9 = 1500;
-    uint m_rc10 = 1500;
-    uint m_rc11 = 1500;
-    uint m_rc12 = 1500;
-    uint m_rc13 = 1500;
-    uint m_rc14 = 1500;
-    uint m_rc15 = 1500;
-    uint m_rc16 = 1500;
-    uint m_rc17 = 1500;
-    uint m_rc18 = 1500;
-
+    // what the RC thread gets, only touched on the UI thread
+    RCInputFrame m_inputs;
 };
 
 #endif //RC_H
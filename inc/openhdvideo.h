@@ -8,6 +8,8 @@
 #include <QtQml>
 
 #include "sharedqueue.h"
+#include "videohealth.h"
+#include "videorecorder.h"
 
 #include "h264_common.h"
 
@@ -67,10 +69,19 @@ public:
     OpenHDVideo(enum OpenHDStreamType stream_type = OpenHDStreamTypeMain);
     virtual ~OpenHDVideo();
 
-    qint64 lastDataReceived = 0;
     int m_video_port = 0;
     QMutex m_mutex;
 
+    Q_PROPERTY(VideoRecorder* recorder READ recorder CONSTANT)
+    VideoRecorder* recorder() const {
+        return m_recorder;
+    }
+
+    Q_PROPERTY(VideoHealth* health READ health CONSTANT)
+    VideoHealth* health() const {
+        return m_health;
+    }
+
 signals:
     void videoRunning(bool running);
     void configure();
@@ -86,11 +97,14 @@ public slots:
 protected:
     OpenHDVideoReceiver *m_receiver = nullptr;
     QThread m_receiverThread;
+    VideoRecorder *m_recorder = nullptr;
+    VideoHealth *m_health = nullptr;
     int m_socket = 0;
 
     void parseRTP(QByteArray &datagram);
     void findNAL();
     void processNAL(QByteArray &nalUnit);
+    void onStreamLoss();
     void reconfigure();
 
     virtual void start() = 0;
@@ -120,6 +134,10 @@ protected:
     QByteArray rtpBuffer;
     size_t rtpData = 0;
     bool rtpStateFrag = false;
+    int rtpSequence = -1;
+
+    // running while slices are held back after a loss, waiting for the IDR we asked for
+    QElapsedTimer keyframeWait;
 
     bool haveSPS = false;
     bool havePPS = false;
@@ -6,13 +6,66 @@
 #include <QObject>
 
 #include <QtQml>
+#include <QtQuick>
 #include <gst/gst.h>
 
+#include "videohealth.h"
+#include "videorecorder.h"
+
 enum StreamType {
     StreamTypeMain,
     StreamTypePiP
 };
 
+class OpenHDVideoStream;
+
+/*
+ * Shared by the main and PiP streams: a single pipeline, bus, GLib main context and
+ * thread. Each stream adds its own branch to the pipeline, so GL elements in both
+ * branches end up sharing one GstGLContext, and turning PiP on adds a branch rather
+ * than a second pipeline with its own loop.
+ */
+class OpenHDVideoEngine
+{
+public:
+    static OpenHDVideoEngine* instance();
+
+    GstElement* pipeline() const {
+        return m_pipeline;
+    }
+
+    void addStream(OpenHDVideoStream *stream);
+    void removeStream(OpenHDVideoStream *stream);
+
+    /*
+     * Queues func to run on the engine thread. Never runs it inline, even when the
+     * context isn't owned yet.
+     */
+    void invoke(GSourceFunc func, gpointer data);
+
+    // moves the pipeline to PLAYING once the first branch has been added
+    void play(QQuickWindow *window);
+
+private:
+    OpenHDVideoEngine();
+
+    void run();
+
+    static gboolean busCb(GstBus *bus, GstMessage *msg, gpointer data);
+    static GstBusSyncReply busSyncCb(GstBus *bus, GstMessage *msg, gpointer data);
+
+    GMainContext *m_context = nullptr;
+    GMainLoop *m_loop = nullptr;
+    GstElement *m_pipeline = nullptr;
+
+    QList<OpenHDVideoStream*> m_streams;
+    QMutex m_streams_mutex;
+
+    bool m_running = false;
+    bool m_playing = false;
+};
+
+
 class OpenHDVideoStream : public QObject
 {
     Q_OBJECT
@@ -22,7 +75,22 @@ public:
     virtual ~OpenHDVideoStream();
     void init(QQmlApplicationEngine * engine, enum StreamType stream_type);
 
-    qint64 lastDataTimeout = 0;
+    Q_PROPERTY(VideoRecorder* recorder READ recorder CONSTANT)
+    VideoRecorder* recorder() const {
+        return m_recorder;
+    }
+
+    Q_PROPERTY(VideoHealth* health READ health CONSTANT)
+    VideoHealth* health() const {
+        return m_health;
+    }
+
+    enum StreamType streamType() const {
+        return m_stream_type;
+    }
+
+    // true if element is part of this stream's source, used to route bus messages
+    bool ownsSourceElement(GstObject *element) const;
 
 signals:
     void videoRunning(bool running);
@@ -31,36 +99,73 @@ public slots:
     void startVideo();
     void stopVideo();
 
+    /*
+     * Called from QML whenever one of the video settings changes, the running pipeline
+     * is reconfigured in place on the video engine thread.
+     */
+    void updateSetting(const QString &key, const QVariant &value);
+
 private:
+    struct StreamConfig {
+        bool enable_videotest = false;
+        bool enable_software_video_decoder = false;
+        bool enable_rtp = true;
+        bool enable_lte_video = false;
+        bool video_h264 = true;
+        bool show_pip_video = false;
+        int main_video_port = 5600;
+        int pip_video_port = 5601;
+    };
+
     void _start();
     void _stop();
     QString m_elementName;
 
-    void _timer() ;
+    bool isActive(const StreamConfig &config) const;
+    int videoPort(const StreamConfig &config) const;
+    bool sameSource(const StreamConfig &a, const StreamConfig &b) const;
+    QString sourceDescription(const StreamConfig &config, int port) const;
+    QString displayDescription(QQuickItem *videoItem) const;
+
+    void _applyConfig();
+    void _swapSource();
+    void attachSource(const StreamConfig &config);
+    void detachSource();
+    void retuneSource(int port);
+    void replaceSource();
+
+    static gboolean startCb(gpointer data);
+    static gboolean stopCb(gpointer data);
+    static gboolean applyConfigCb(gpointer data);
+    static gboolean swapSourceCb(gpointer data);
+    static GstPadProbeReturn sourceIdleCb(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+    static GstPadProbeReturn rtpSequenceCb(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+    static GstPadProbeReturn receivedDataCb(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+    static GstPadProbeReturn decodedFrameCb(GstPad *pad, GstPadProbeInfo *info, gpointer data);
 
     QQmlApplicationEngine *m_engine;
-    GstElement * m_pipeline;
-    bool firstRun = true;
+    VideoRecorder *m_recorder = nullptr;
+    VideoHealth *m_health = nullptr;
 
-    bool m_enable_videotest = false;
-    bool m_enable_software_video_decoder = false;
-    bool m_enable_rtp = true;
-    bool m_enable_pip_video = false;
-    bool m_enable_lte_video = false;
+    // this stream's branches of the shared pipeline
+    GstElement * m_source = nullptr;
+    GstElement * m_display = nullptr;
 
-    bool m_video_h264 = true;
+    bool m_swap_pending = false;
 
-    enum StreamType m_stream_type;
+    // last RTP sequence number seen by the depayloader, only touched on the source's streaming thread
+    int m_rtp_sequence = -1;
 
-    int m_video_port = 0;
+    // requested by the settings, guarded by m_config_mutex
+    StreamConfig m_config;
+    QMutex m_config_mutex;
 
-    int main_default_port = 5600;
-    int pip_default_port = 5601;
-    int lte_default_port = 8000;
+    // what the pipeline is currently built for, only touched on the engine thread
+    StreamConfig m_active;
 
-    QTimer* timer = nullptr;
+    enum StreamType m_stream_type;
 
-    GMainLoop *mainLoop = nullptr;
+    int lte_default_port = 8000;
 };
 
 #endif // OpenHDVideoStream_H
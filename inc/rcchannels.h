@@ -0,0 +1,105 @@
+#ifndef RCCHANNELS_H
+#define RCCHANNELS_H
+
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+ * What the UI thread hands to the RC send thread and back.
+ *
+ * RCTripleBuffer passes a value from one writer thread to one reader thread: the writer
+ * copies into the back buffer and swaps it with the middle one, the reader swaps the
+ * middle one with its front buffer when a new value is there. Both sides are a copy and
+ * one atomic exchange, neither ever waits for the other and the reader always gets a
+ * complete value.
+ */
+
+struct RCClock {
+    // monotonic, shared by input times and the send deadlines, in ns
+    static qint64 now();
+};
+
+
+/*
+ * The sticks and switches as they are, before any RCTransformTable is applied. Inputs
+ * are -32767 to 32767: kAxes joystick or gamepad axes, then kButtons buttons, released
+ * is -32767. direct holds channel values set straight from QML, 1000-2000, for the
+ * channels that aren't mapped to an input.
+ */
+struct RCInputFrame {
+    static constexpr int kAxes = 16;
+    static constexpr int kButtons = 16;
+    static constexpr int kInputs = kAxes + kButtons;
+
+    RCInputFrame() {
+        inputs.fill(0);
+        for (int button = kAxes; button < kInputs; button++) {
+            inputs[button] = -32767;
+        }
+        direct.fill(1500);
+    }
+
+    std::array<int16_t, kInputs> inputs;
+    std::array<uint16_t, 18> direct;
+    // RCClock::now() when an input last changed
+    qint64 input_time = 0;
+};
+
+
+/*
+ * The channel values sent out, 1000-2000.
+ */
+struct RCFrame {
+    static constexpr int kChannels = 18;
+
+    RCFrame() {
+        channels.fill(1500);
+    }
+
+    std::array<uint16_t, kChannels> channels;
+    // input_time of the RCInputFrame these were computed from
+    qint64 input_time = 0;
+    // counts the frames that differed from the one before
+    uint32_t sequence = 0;
+};
+
+
+template <typename T>
+class RCTripleBuffer {
+public:
+    // writer side
+    void write(const T &value) {
+        m_buffers[m_back] = value;
+        m_back = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel) & kIndex;
+    }
+
+    // reader side, false and value left alone when nothing was written since the last read
+    bool read(T &value) {
+        if (!(m_middle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & kIndex;
+        value = m_buffers[m_front];
+        return true;
+    }
+
+private:
+    static constexpr int kIndex = 0x3;
+    static constexpr int kFresh = 0x4;
+
+    T m_buffers[3];
+
+    // index of the middle buffer, with kFresh while the reader hasn't taken it
+    std::atomic<int> m_middle { 1 };
+
+    // owned by the writer
+    int m_back = 0;
+
+    // owned by the reader
+    int m_front = 2;
+};
+
+#endif // RCCHANNELS_H
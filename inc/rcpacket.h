@@ -0,0 +1,53 @@
+#ifndef RCPACKET_H
+#define RCPACKET_H
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * The OpenHD RC packet, sent to UDP port 5565 instead of MAVLink RC_CHANNELS_OVERRIDE
+ * when rc_transport is "openhd". All little endian:
+ *
+ *   0  'R' for channels, 'E' for the echo of one
+ *   1  number of channels, 0 in an echo
+ *   2  sequence, uint16, counts every channels packet
+ *   4  send time, uint32, µs on the sender's clock, only ever compared with itself
+ *   8  channels, 11 bits each packed LSB first, padded to a byte
+ *   n  CRC-16/CCITT-FALSE over everything before it
+ *
+ * 18 channels make 35 bytes, against 50 for the MAVLink message. The receiver answers
+ * a channels packet with an echo carrying its sequence and send time, which gives the
+ * sender the round trip time without both ends sharing a clock.
+ */
+namespace RCPacket {
+
+constexpr uint16_t kPort = 5565;
+
+constexpr uint8_t kChannels = 'R';
+constexpr uint8_t kEcho = 'E';
+
+constexpr int kMaxChannels = 18;
+constexpr int kHeaderSize = 8;
+constexpr int kCrcSize = 2;
+constexpr int kMaxSize = kHeaderSize + (kMaxChannels * 11 + 7) / 8 + kCrcSize;
+
+struct Packet {
+    uint8_t type = kChannels;
+    uint8_t count = 0;
+    uint16_t sequence = 0;
+    uint32_t time = 0;
+    // 0-2047, µs
+    uint16_t channels[kMaxChannels] = {};
+};
+
+// returns the length written to buffer, at least kMaxSize long, values above 2047 are clamped
+size_t encode(const Packet &packet, uint8_t *buffer);
+
+// false for anything that isn't a whole packet with a good CRC
+bool decode(const uint8_t *buffer, size_t length, Packet &packet);
+
+uint16_t crc16(const uint8_t *data, size_t length);
+
+}
+
+#endif // RCPACKET_H
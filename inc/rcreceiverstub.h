@@ -0,0 +1,87 @@
+#ifndef RCRECEIVERSTUB_H
+#define RCRECEIVERSTUB_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVariantList>
+
+#include <array>
+
+#include "rcpacket.h"
+
+class QUdpSocket;
+class QTimer;
+
+/*
+ * The air side of the OpenHD RC transport, for testing it from the ground station.
+ *
+ * Listens for RCPacket on a port, echoes every good one back for the sender's round
+ * trip time and keeps the count of packets, bad CRCs, lost and out of order sequence
+ * numbers. After kFailsafeTimeout without a good packet it goes into failsafe the way a
+ * receiver would: throttle (channel 3) to 1000, the other channels held. The first good
+ * packet ends it, whatever its sequence number: failsafe forgets the last one, and a jump
+ * back of kReorderWindow or more is a sender that restarted, not a late packet.
+ *
+ * Point the sender at it by setting the ground address to this machine with
+ * rc_transport "openhd", then disable RC or pull the joystick to see failsafe trip.
+ * It is never started on its own, and only built into debug builds (ENABLE_RC_STUB).
+ */
+class RCReceiverStub : public QObject {
+    Q_OBJECT
+
+public:
+    explicit RCReceiverStub(QObject *parent = nullptr);
+
+    Q_INVOKABLE bool start(int port = RCPacket::kPort);
+    Q_INVOKABLE void stop();
+
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    bool running() const {
+        return m_socket != nullptr;
+    }
+
+    Q_PROPERTY(bool failsafe READ failsafe NOTIFY failsafeChanged)
+    bool failsafe() const {
+        return m_failsafe;
+    }
+
+    Q_PROPERTY(QVariantList channels READ channels NOTIFY statsChanged)
+    QVariantList channels() const;
+
+    Q_PROPERTY(int packets MEMBER m_packets NOTIFY statsChanged)
+    Q_PROPERTY(int bad MEMBER m_bad NOTIFY statsChanged)
+    Q_PROPERTY(int lost MEMBER m_lost NOTIFY statsChanged)
+    Q_PROPERTY(int outOfOrder MEMBER m_out_of_order NOTIFY statsChanged)
+
+signals:
+    void runningChanged(bool running);
+    void failsafeChanged(bool failsafe);
+    void statsChanged();
+
+private slots:
+    void processDatagrams();
+    void checkFailsafe();
+
+private:
+    static constexpr qint64 kFailsafeTimeout = 500;
+
+    void setFailsafe(bool failsafe);
+
+    QUdpSocket *m_socket = nullptr;
+    QTimer *m_timer = nullptr;
+    QElapsedTimer m_last_packet;
+
+    bool m_failsafe = true;
+    bool m_have_sequence = false;
+    uint16_t m_sequence = 0;
+
+    int m_count = 0;
+    std::array<uint16_t, RCPacket::kMaxChannels> m_channels;
+
+    int m_packets = 0;
+    int m_bad = 0;
+    int m_lost = 0;
+    int m_out_of_order = 0;
+};
+
+#endif // RCRECEIVERSTUB_H
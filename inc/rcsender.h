@@ -0,0 +1,165 @@
+#ifndef RCSENDER_H
+#define RCSENDER_H
+
+#include <QObject>
+#include <QThread>
+
+#include <atomic>
+#include <mutex>
+
+#include "rcchannels.h"
+#include "rctransform.h"
+
+class MavlinkBase;
+
+/*
+ * Sends the RC channels to the air side at a fixed rate, from its own thread, either as
+ * MAVLink RC_CHANNELS_OVERRIDE for the flight controller or as the smaller RCPacket to
+ * OpenHD's RC port, picked by the rc_transport setting. rc_rate sets the rate, up to
+ * kMaxRate.
+ *
+ * The thread runs SCHED_FIFO on Linux when it is allowed to, otherwise at the best nice
+ * value it can get, and at TimeCriticalPriority elsewhere. It sleeps until absolute
+ * deadlines, so the packet rate doesn't drift and doesn't depend on how busy the UI or
+ * telemetry event loops are. On every tick it takes the newest stick inputs given to setInputs(), and
+ * when they or the transform table changed runs them through the RCTransformTable of
+ * the current profile. Only a result that differs from the last one becomes a new frame, which is
+ * what channel() reads and channelsChanged announces. The thread never waits for
+ * anything else: settings are handed over through updateSetting() as they change rather
+ * than read from QSettings per packet.
+ *
+ * MAVLink frames go to the telemetry link given to setMavlinkLink(): over UDP written from
+ * this thread to the router endpoint the link learned, over TCP queued to the link's
+ * thread. Over UDP nothing is sent before the link knows the endpoint. RCPacket goes out
+ * on the thread's own socket as well.
+ *
+ * Two things are measured per tick, over one second windows: how late the thread woke
+ * up for its deadline (jitter), and how long it took from an input change reaching
+ * setInputs() to the packet carrying its effect being written to the socket (stick to
+ * packet latency). Both are also fed to Trace as rc.jitter and rc.latency, in µs. With
+ * the OpenHD transport the receiver echoes every packet, the echoes are picked up on
+ * the next tick and give the round trip time, rc.rtt.
+ */
+class RCSender : public QThread {
+    Q_OBJECT
+
+public:
+    explicit RCSender(QObject *parent = nullptr);
+    static RCSender* instance();
+
+    // the only writer is OpenHDRC, on the UI thread
+    void setInputs(const RCInputFrame &inputs) {
+        m_inputs.write(inputs);
+    }
+
+    // 0 based, as last computed on the RC thread
+    uint channel(int channel) const {
+        return m_output[channel].load(std::memory_order_relaxed);
+    }
+
+    // packets per second
+    Q_PROPERTY(int rate READ rate NOTIFY rateChanged)
+    int rate() const {
+        return m_rate.load(std::memory_order_relaxed);
+    }
+
+    // µs, mean and largest over the last second
+    Q_PROPERTY(int jitter READ jitter NOTIFY statsChanged)
+    int jitter() const {
+        return m_jitter.load(std::memory_order_relaxed);
+    }
+    Q_PROPERTY(int jitterMax READ jitterMax NOTIFY statsChanged)
+    int jitterMax() const {
+        return m_jitter_max.load(std::memory_order_relaxed);
+    }
+    Q_PROPERTY(int latency READ latency NOTIFY statsChanged)
+    int latency() const {
+        return m_latency.load(std::memory_order_relaxed);
+    }
+    Q_PROPERTY(int latencyMax READ latencyMax NOTIFY statsChanged)
+    int latencyMax() const {
+        return m_latency_max.load(std::memory_order_relaxed);
+    }
+
+    // µs, -1 without an echo in the last second
+    Q_PROPERTY(int rtt READ rtt NOTIFY statsChanged)
+    int rtt() const {
+        return m_rtt.load(std::memory_order_relaxed);
+    }
+    Q_PROPERTY(int rttMax READ rttMax NOTIFY statsChanged)
+    int rttMax() const {
+        return m_rtt_max.load(std::memory_order_relaxed);
+    }
+
+    // ticks dropped because the thread woke up more than a period late, since the start
+    Q_PROPERTY(int overruns READ overruns NOTIFY statsChanged)
+    int overruns() const {
+        return m_overruns.load(std::memory_order_relaxed);
+    }
+
+    // where MAVLink RC goes, set once before any is sent
+    void setMavlinkLink(MavlinkBase *link);
+
+    // enable_rc, mavlink_sysid, fc_mavlink_sysid, rc_transport, rc_rate and rc_transforms, the stick profile
+    Q_INVOKABLE void updateSetting(const QString &key, const QVariant &value);
+
+public slots:
+    void setGroundIP(QString address);
+
+    // packets only go out while there is something producing channel values
+    void setActive(bool active);
+
+signals:
+    void statsChanged();
+    void rateChanged(int rate);
+
+    // from the RC thread, only when a channel value changed
+    void channelsChanged();
+
+protected:
+    void run() override;
+
+private:
+    enum Transport {
+        TransportMavlink,
+        TransportOpenHD
+    };
+
+    // the same 20ms the MAVLink RC timer had
+    static constexpr int kDefaultRate = 50;
+    static constexpr int kMaxRate = 250;
+
+    void loadTransforms(const QString &json);
+    void linkSent(qint64 input_time);
+
+    RCTripleBuffer<RCInputFrame> m_inputs;
+    RCTripleBuffer<RCTransformTable> m_transforms;
+
+    std::array<std::atomic<uint16_t>, RCFrame::kChannels> m_output;
+
+    std::atomic<bool> m_enabled { false };
+    std::atomic<bool> m_active { false };
+    std::atomic<int> m_sysid { 255 };
+    std::atomic<int> m_target_sysid { 1 };
+    std::atomic<int> m_transport { TransportMavlink };
+    std::atomic<int> m_rate { kDefaultRate };
+    // IPv4, 0 while unknown
+    std::atomic<quint32> m_ground_address { 0 };
+    std::atomic<MavlinkBase*> m_link { nullptr };
+
+    // latency of frames the TCP link sent, µs, since the RC thread last took them
+    std::mutex m_link_mutex;
+    qint64 m_link_latency_sum = 0;
+    qint64 m_link_latency_max = 0;
+    int m_link_latency_count = 0;
+
+    std::atomic<int> m_jitter { 0 };
+    std::atomic<int> m_jitter_max { 0 };
+    std::atomic<int> m_latency { 0 };
+    std::atomic<int> m_latency_max { 0 };
+    std::atomic<int> m_rtt { -1 };
+    std::atomic<int> m_rtt_max { -1 };
+    std::atomic<int> m_overruns { 0 };
+};
+
+#endif // RCSENDER_H
@@ -0,0 +1,64 @@
+#ifndef RCTRANSFORM_H
+#define RCTRANSFORM_H
+
+#include <QString>
+
+#include <array>
+#include <cstdint>
+
+#include "rcchannels.h"
+
+/*
+ * Turns stick inputs into channel values, one table row per channel, applied in one
+ * pass on the RC thread:
+ *
+ *   input -> deadband -> curve -> reverse -> + mix input -> 1000-2000 -> + trim
+ *
+ * The deadband is cut out of the middle and the rest stretched back to full travel. The
+ * curve is a lookup table over the input magnitude, mirrored for negative inputs, filled
+ * from an expo or from points given in the profile. Everything is precomputed when the
+ * table is built, apply() is integer only and doesn't branch on anything but the flags.
+ *
+ * A profile is a JSON array with an object for each channel that differs from the
+ * default, channel n taken from axis n-1 for the first 10 channels, as set before:
+ *
+ *   [ { "channel": 1, "input": 0, "deadband": 0.02, "expo": 0.3, "trim": 10,
+ *       "reverse": true, "mix_input": 1, "mix": -0.5 } ]
+ *
+ * input and mix_input are 0-15 for axes and 16-31 for buttons, -1 for the value QML
+ * set. deadband, expo and mix are fractions of full travel, trim is in µs. "curve" can
+ * replace "expo": outputs from 0 to 1 for evenly spaced inputs from 0 to 1.
+ */
+class RCTransformTable {
+public:
+    // segments of the curve, a power of two
+    static constexpr int kCurveSegments = 32;
+
+    RCTransformTable();
+
+    // false and the defaults for the channels it couldn't read when the profile is broken
+    bool load(const QString &json, QString *error = nullptr);
+
+    void apply(const RCInputFrame &in, std::array<uint16_t, RCFrame::kChannels> &out) const;
+
+private:
+    struct Channel {
+        int8_t input = -1;
+        int8_t mix_input = -1;
+        bool reverse = false;
+        // input units
+        int32_t deadband = 0;
+        // 16.16, stretches what is left after the deadband back to full travel
+        int32_t deadband_scale = 1 << 16;
+        // per 1024 of the mix input added
+        int32_t mix = 0;
+        int32_t trim = 0;
+        std::array<int16_t, kCurveSegments + 1> curve;
+    };
+
+    static void linear(Channel &channel);
+
+    std::array<Channel, RCFrame::kChannels> m_channels;
+};
+
+#endif // RCTRANSFORM_H
@@ -4,6 +4,10 @@
 #include <QObject>
 #include <QtQuick>
 
+#include <array>
+#include <deque>
+#include <vector>
+
 #include "mavlinkbase.h"
 
 
@@ -17,6 +21,18 @@ struct StatusMessage {
 };
 
 
+/*
+ * The last kCapacity status messages, oldest first.
+ *
+ * Messages live in a fixed ring, once it is full the oldest row is removed for every
+ * new one so the list can't grow for as long as the app runs. A message repeating one
+ * of the last few from the same sender within a few seconds isn't added again, the row
+ * it repeats counts it instead, which keeps a component stuck in an error loop from
+ * flooding the list.
+ *
+ * Every entry also goes into an index per severity and per (sysid, compid), so views can
+ * ask for the rows of one severity or one sender without walking the whole log.
+ */
 class StatusLogModel : public QAbstractListModel {
     Q_OBJECT
 
@@ -34,11 +50,69 @@ public:
     //QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
     //QModelIndex parent(const QModelIndex &child) const;
 
+    // messages at emergency to error severity (0-3) currently in the log
+    Q_PROPERTY(int errorCount READ errorCount NOTIFY countsChanged)
+    int errorCount() const;
+
+    Q_INVOKABLE int severityCount(int severity) const;
+
+    // rows of every message at or above the given severity (numerically at or below), oldest first
+    Q_INVOKABLE QVariantList severityRows(int severity) const;
+
+    Q_INVOKABLE QVariantList sourceRows(int sysid, int compid) const;
+
+    Q_INVOKABLE void clear();
+
+signals:
+    void countsChanged();
+
 protected :
       QHash<int, QByteArray> roleNames() const;
 
 private:
-    QList<StatusMessage> m_messages;
+    static constexpr int kCapacity = 1000;
+    static constexpr int kSeverities = 8;
+
+    // how far back a repeat is looked for, in messages from the same sender and in ms
+    static constexpr int kRepeatDepth = 4;
+    static constexpr qint64 kRepeatWindow = 5000;
+
+    struct Entry {
+        StatusMessage message;
+        int repeat = 1;
+        qint64 received = 0;
+    };
+
+    static int sourceKey(int sysid, int compid) {
+        return (sysid & 0xff) << 8 | (compid & 0xff);
+    }
+
+    static int severityIndex(int severity) {
+        return qBound(0, severity, kSeverities - 1);
+    }
+
+    /*
+     * Entries are numbered in the order they arrive and the indexes hold those numbers,
+     * the row of an entry is its number minus the number of the oldest one.
+     */
+    const Entry &entry(quint64 seq) const {
+        return m_entries[seq % kCapacity];
+    }
+
+    int row(quint64 seq) const {
+        return static_cast<int>(seq - m_first);
+    }
+
+    QVariantList rows(const std::deque<quint64> &index) const;
+
+    std::vector<Entry> m_entries;
+    quint64 m_first = 0;
+    quint64 m_next = 0;
+
+    std::array<std::deque<quint64>, kSeverities> m_severity_index;
+    QHash<int, std::deque<quint64>> m_source_index;
+
+    QElapsedTimer m_clock;
 };
 
 #endif // STATUSLOGMODEL_H
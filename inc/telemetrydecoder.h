@@ -0,0 +1,275 @@
+#ifndef TELEMETRYDECODER_H
+#define TELEMETRYDECODER_H
+
+#include <array>
+#include <cstdint>
+
+class TelemetrySink;
+
+/*
+ * Building blocks shared by the byte stream telemetry protocols (FrSky, SmartPort, LTM,
+ * Vector, MSP).
+ *
+ * A protocol is described by a small struct deriving from TelemetryProtocol, see
+ * telemetryprotocols.h, and TelemetryFramer<Protocol> turns it into a decoder: it finds
+ * the sync bytes, undoes byte stuffing, collects the frame into a fixed buffer, verifies
+ * it and hands it to the protocol's decode(). Nothing is allocated per byte or per frame.
+ */
+
+
+/*
+ * MSB first lookup table CRC, the table is built by the compiler.
+ *
+ *   using Crc16Ccitt = CrcTable<uint16_t, 0x1021>;
+ *   crc = Crc16Ccitt::update(crc, byte);
+ */
+template <typename T, T Poly>
+struct CrcTable {
+    static constexpr int kTopShift = (sizeof(T) - 1) * 8;
+
+    static constexpr std::array<T, 256> make() {
+        std::array<T, 256> table {};
+        constexpr T top = static_cast<T>(T(1) << (sizeof(T) * 8 - 1));
+        for (int i = 0; i < 256; i++) {
+            T crc = static_cast<T>(T(i) << kTopShift);
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & top) ? static_cast<T>((crc << 1) ^ Poly) : static_cast<T>(crc << 1);
+            }
+            table[i] = crc;
+        }
+        return table;
+    }
+
+    static constexpr std::array<T, 256> table = make();
+
+    static constexpr T update(T crc, uint8_t byte) {
+        return static_cast<T>((crc << 8) ^ table[((crc >> kTopShift) ^ byte) & 0xff]);
+    }
+
+    static constexpr T compute(const uint8_t *data, int length, T init) {
+        T crc = init;
+        for (int i = 0; i < length; i++) {
+            crc = update(crc, data[i]);
+        }
+        return crc;
+    }
+};
+
+
+/*
+ * Bounds checked cursor over a received frame. Reading past the end returns zeros and
+ * clears ok(), so a short frame can never read outside its buffer.
+ */
+class TelemetryReader {
+public:
+    TelemetryReader(const uint8_t *data, int length): m_data(data), m_length(length) {}
+
+    bool ok() const {
+        return m_ok;
+    }
+
+    int remaining() const {
+        return m_length - m_pos;
+    }
+
+    void skip(int count) {
+        if (count > remaining()) {
+            m_ok = false;
+            m_pos = m_length;
+            return;
+        }
+        m_pos += count;
+    }
+
+    uint8_t u8() {
+        if (m_pos >= m_length) {
+            m_ok = false;
+            return 0;
+        }
+        return m_data[m_pos++];
+    }
+
+    int8_t i8() {
+        return static_cast<int8_t>(u8());
+    }
+
+    // little endian
+    uint16_t u16() {
+        uint16_t t = u8();
+        t |= static_cast<uint16_t>(u8()) << 8;
+        return t;
+    }
+
+    int16_t i16() {
+        return static_cast<int16_t>(u16());
+    }
+
+    uint32_t u32() {
+        uint32_t t = u16();
+        t |= static_cast<uint32_t>(u16()) << 16;
+        return t;
+    }
+
+    int32_t i32() {
+        return static_cast<int32_t>(u32());
+    }
+
+    // big endian
+    uint16_t u16be() {
+        uint16_t t = static_cast<uint16_t>(u8()) << 8;
+        t |= u8();
+        return t;
+    }
+
+    int16_t i16be() {
+        return static_cast<int16_t>(u16be());
+    }
+
+    uint32_t u32be() {
+        uint32_t t = static_cast<uint32_t>(u16be()) << 16;
+        t |= u16be();
+        return t;
+    }
+
+    int32_t i32be() {
+        return static_cast<int32_t>(u32be());
+    }
+
+private:
+    const uint8_t *m_data;
+    int m_length;
+    int m_pos = 0;
+    bool m_ok = true;
+};
+
+
+class TelemetryDecoder {
+public:
+    virtual ~TelemetryDecoder() {}
+
+    // feeds received bytes, frames may span several calls
+    virtual void parse(const uint8_t *data, int length, TelemetrySink &sink) = 0;
+
+    virtual const char *name() const = 0;
+
+    // frames decoded and frames dropped on a bad checksum, since start
+    virtual uint64_t frames() const = 0;
+    virtual uint64_t errors() const = 0;
+};
+
+
+/*
+ * Defaults for the descriptor fields a protocol doesn't need. A protocol has to provide:
+ *
+ *   static constexpr const char *kName
+ *   static constexpr std::array<uint8_t, N> kSync   bytes every frame starts with
+ *   static constexpr int kHeaderLength               bytes (sync included) needed by frameLength()
+ *   static constexpr int kMaxFrame                   largest frame, sizes the frame buffer
+ *   static int frameLength(const uint8_t *header)    whole frame length, 0 drops the frame
+ *   void decode(const uint8_t *frame, int length, TelemetrySink &sink)
+ *
+ * and may override:
+ *
+ *   kEscape, kEscapeXor    byte stuffing: kEscape followed by b stands for b ^ kEscapeXor
+ *   kResync                an unescaped first sync byte always starts a new frame, for
+ *                          protocols that stuff it out of the payload
+ *   check()                checksum over the complete frame
+ */
+struct TelemetryProtocol {
+    static constexpr int kEscape = -1;
+    static constexpr uint8_t kEscapeXor = 0;
+    static constexpr bool kResync = false;
+
+    static bool check(const uint8_t *frame, int length) {
+        (void)frame;
+        (void)length;
+        return true;
+    }
+};
+
+
+template <typename Protocol>
+class TelemetryFramer : public TelemetryDecoder {
+public:
+    static_assert(Protocol::kHeaderLength >= static_cast<int>(Protocol::kSync.size()), "the header includes the sync bytes");
+    static_assert(Protocol::kMaxFrame >= Protocol::kHeaderLength, "frame buffer smaller than the header");
+
+    void parse(const uint8_t *data, int length, TelemetrySink &sink) override {
+        constexpr auto syncLength = static_cast<int>(Protocol::kSync.size());
+
+        for (int i = 0; i < length; i++) {
+            auto c = data[i];
+            auto literal = true;
+
+            if constexpr (Protocol::kEscape >= 0) {
+                if (m_escaped) {
+                    m_escaped = false;
+                    c ^= Protocol::kEscapeXor;
+                    literal = false;
+                } else if (c == Protocol::kEscape) {
+                    m_escaped = true;
+                    continue;
+                }
+            }
+
+            if (m_length < syncLength) {
+                if (literal && c == Protocol::kSync[m_length]) {
+                    m_frame[m_length++] = c;
+                } else if (literal && c == Protocol::kSync[0]) {
+                    m_frame[0] = c;
+                    m_length = 1;
+                } else {
+                    m_length = 0;
+                }
+            } else if (Protocol::kResync && literal && c == Protocol::kSync[0]) {
+                m_frame[0] = c;
+                m_length = 1;
+            } else {
+                m_frame[m_length++] = c;
+            }
+
+            if (m_length == Protocol::kHeaderLength) {
+                m_expected = Protocol::frameLength(m_frame.data());
+                if (m_expected < Protocol::kHeaderLength || m_expected > Protocol::kMaxFrame) {
+                    m_length = 0;
+                    continue;
+                }
+            }
+
+            if (m_length >= Protocol::kHeaderLength && m_length == m_expected) {
+                if (Protocol::check(m_frame.data(), m_length)) {
+                    m_protocol.decode(m_frame.data(), m_length, sink);
+                    m_frames++;
+                } else {
+                    m_errors++;
+                }
+                m_length = 0;
+            }
+        }
+    }
+
+    const char *name() const override {
+        return Protocol::kName;
+    }
+
+    uint64_t frames() const override {
+        return m_frames;
+    }
+
+    uint64_t errors() const override {
+        return m_errors;
+    }
+
+private:
+    Protocol m_protocol;
+
+    std::array<uint8_t, Protocol::kMaxFrame> m_frame {};
+    int m_length = 0;
+    int m_expected = 0;
+    bool m_escaped = false;
+
+    uint64_t m_frames = 0;
+    uint64_t m_errors = 0;
+};
+
+#endif // TELEMETRYDECODER_H
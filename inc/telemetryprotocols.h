@@ -0,0 +1,130 @@
+#ifndef TELEMETRYPROTOCOLS_H
+#define TELEMETRYPROTOCOLS_H
+
+#include "telemetrydecoder.h"
+
+/*
+ * Frame descriptors for the non-MAVLink telemetry protocols, see TelemetryProtocol in
+ * telemetrydecoder.h for what each field means. The frame passed to decode() always
+ * starts with the sync bytes and has already passed check().
+ */
+
+
+/*
+ * FrSky D series hub: 0x5E id data_lo data_hi, with 0x5E and 0x5D in the data stuffed as
+ * 0x5D (b ^ 0x60).
+ */
+struct FrSkyHubProtocol : TelemetryProtocol {
+    static constexpr const char *kName = "FrSky";
+    static constexpr std::array<uint8_t, 1> kSync { 0x5e };
+    static constexpr int kHeaderLength = 1;
+    static constexpr int kMaxFrame = 4;
+    static constexpr int kEscape = 0x5d;
+    static constexpr uint8_t kEscapeXor = 0x60;
+    static constexpr bool kResync = true;
+
+    static int frameLength(const uint8_t *header) {
+        (void)header;
+        return 4;
+    }
+
+    void decode(const uint8_t *frame, int length, TelemetrySink &sink);
+
+    // latitude and longitude arrive in pieces, as does the speed
+    double lon = 0;
+    double lat = 0;
+    double speed = 0;
+    char ew = '0';
+    char ns = '0';
+};
+
+
+/*
+ * FrSky SmartPort: 0x10 id(2) value(4) crc, 0x7E and 0x7D stuffed as 0x7D (b ^ 0x20). The
+ * crc is 0xFF minus the folded byte sum of everything before it.
+ */
+struct SmartPortProtocol : TelemetryProtocol {
+    static constexpr const char *kName = "SmartPort";
+    static constexpr std::array<uint8_t, 1> kSync { 0x10 };
+    static constexpr int kHeaderLength = 1;
+    static constexpr int kMaxFrame = 8;
+    static constexpr int kEscape = 0x7d;
+    static constexpr uint8_t kEscapeXor = 0x20;
+
+    static int frameLength(const uint8_t *header) {
+        (void)header;
+        return 8;
+    }
+
+    static bool check(const uint8_t *frame, int length);
+
+    void decode(const uint8_t *frame, int length, TelemetrySink &sink);
+};
+
+
+/*
+ * LightTelemetry (LTM): '$' 'T' type payload crc, little endian, the crc is the xor of the
+ * payload. The payload length depends on the frame type.
+ */
+struct LTMProtocol : TelemetryProtocol {
+    static constexpr const char *kName = "LTM";
+    static constexpr std::array<uint8_t, 2> kSync { '$', 'T' };
+    static constexpr int kHeaderLength = 3;
+    static constexpr int kMaxFrame = 18;
+
+    static int frameLength(const uint8_t *header);
+
+    static bool check(const uint8_t *frame, int length);
+
+    void decode(const uint8_t *frame, int length, TelemetrySink &sink);
+};
+
+
+/*
+ * Vector Open Telemetry revision 0: one fixed 97 byte big endian frame starting with
+ * 0xB01EDEAD and ending in a little endian CRC-16/CCITT over everything before it.
+ */
+struct VectorProtocol : TelemetryProtocol {
+    static constexpr const char *kName = "Vector";
+    static constexpr std::array<uint8_t, 4> kSync { 0xb0, 0x1e, 0xde, 0xad };
+    static constexpr int kHeaderLength = 4;
+    static constexpr int kMaxFrame = 97;
+
+    static int frameLength(const uint8_t *header) {
+        (void)header;
+        return 97;
+    }
+
+    static bool check(const uint8_t *frame, int length);
+
+    void decode(const uint8_t *frame, int length, TelemetrySink &sink);
+};
+
+
+/*
+ * MultiWii Serial Protocol v1 replies: '$' 'M' '>' size command payload crc, little
+ * endian, the crc is the xor of size, command and payload.
+ */
+struct MSPProtocol : TelemetryProtocol {
+    static constexpr const char *kName = "MSP";
+    static constexpr std::array<uint8_t, 3> kSync { '$', 'M', '>' };
+    static constexpr int kHeaderLength = 5;
+    static constexpr int kMaxFrame = 5 + 255 + 1;
+
+    static int frameLength(const uint8_t *header) {
+        return kHeaderLength + header[3] + 1;
+    }
+
+    static bool check(const uint8_t *frame, int length);
+
+    void decode(const uint8_t *frame, int length, TelemetrySink &sink);
+};
+
+
+using FrSkyDecoder = TelemetryFramer<FrSkyHubProtocol>;
+using SmartPortDecoder = TelemetryFramer<SmartPortProtocol>;
+using LTMDecoder = TelemetryFramer<LTMProtocol>;
+using VectorDecoder = TelemetryFramer<VectorProtocol>;
+using MSPDecoder = TelemetryFramer<MSPProtocol>;
+
+#endif // TELEMETRYPROTOCOLS_H
@@ -0,0 +1,48 @@
+#ifndef TELEMETRYREACTOR_H
+#define TELEMETRYREACTOR_H
+
+#include <QObject>
+#include <QtQuick>
+
+#include <memory>
+#include <vector>
+
+#include "telemetrydecoder.h"
+#include "telemetrysink.h"
+
+class QUdpSocket;
+
+/*
+ * Owns the UDP sockets for the non-MAVLink telemetry protocols. Every datagram is read
+ * into one fixed buffer and handed to the decoders registered for its port, which write
+ * what they decode into the shared TelemetrySink.
+ */
+class TelemetryReactor: public QObject {
+    Q_OBJECT
+
+public:
+    explicit TelemetryReactor(QObject *parent = nullptr);
+
+    static TelemetryReactor* instance();
+
+    // takes ownership, a port can carry more than one protocol
+    void addDecoder(quint16 port, TelemetryDecoder *decoder);
+
+private:
+    struct Endpoint {
+        quint16 port;
+        QUdpSocket *socket;
+        std::vector<std::unique_ptr<TelemetryDecoder>> decoders;
+    };
+
+    void processDatagrams(Endpoint &endpoint);
+
+    static constexpr int kMaxDatagram = 4096;
+
+    std::vector<std::unique_ptr<Endpoint>> m_endpoints;
+    TelemetrySink m_sink;
+
+    uint8_t m_buffer[kMaxDatagram];
+};
+
+#endif // TELEMETRYREACTOR_H
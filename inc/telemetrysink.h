@@ -0,0 +1,63 @@
+#ifndef TELEMETRYSINK_H
+#define TELEMETRYSINK_H
+
+#include <QObject>
+#include <QtCore>
+
+#include "util.h"
+
+/*
+ * Where the decoders in telemetryprotocols.h put what they decode. Values are in the
+ * units the OpenHD properties use, values derived from others (battery percentage and
+ * gauge, home distance) are worked out here once instead of in every protocol.
+ */
+class TelemetrySink {
+public:
+    TelemetrySink();
+
+    void set_battery_voltage(double voltage);
+    void set_battery_current(double ampere);
+    void set_flight_mah(double mah);
+
+    void set_lat(double lat);
+    void set_lon(double lon);
+    void set_alt_rel(double alt_rel);
+    void set_alt_msl(double alt_msl);
+    void set_satellites_visible(int satellites);
+    void set_gps_hdop(double hdop);
+
+    // km/h
+    void set_speed(double speed);
+    void set_airspeed(double airspeed);
+
+    // degrees
+    void set_hdg(double hdg);
+    void set_pitch(double pitch);
+    void set_roll(double roll);
+
+    void set_vx(double vx);
+    void set_vy(double vy);
+    void set_vz(double vz);
+
+    // percent
+    void set_rc_rssi(int rssi);
+    void set_armed(bool armed);
+    void set_flight_mode(const QString &flight_mode);
+
+    // after a position update from protocols that don't send home distance themselves
+    void update_home();
+
+    OpenHDUtil &util() {
+        return m_util;
+    }
+
+private:
+    int battery_cells();
+
+    OpenHDUtil m_util;
+
+    int m_battery_cells = 3;
+    QElapsedTimer m_battery_cells_age;
+};
+
+#endif // TELEMETRYSINK_H
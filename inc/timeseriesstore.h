@@ -0,0 +1,98 @@
+#ifndef TIMESERIESSTORE_H
+#define TIMESERIESSTORE_H
+
+#include <QObject>
+#include <QtQuick>
+
+#include <vector>
+
+#if defined(ENABLE_CHARTS)
+#include <QtCharts/QAbstractSeries>
+QT_CHARTS_USE_NAMESPACE
+#endif
+
+/*
+ * History for the Charts panel.
+ *
+ * A few times a second the store samples a fixed set of OpenHD properties into one ring
+ * per metric (struct of arrays, all metrics share the sample times), so the charts
+ * don't keep their own copies in QML. Counters like lost packets are stored as a rate
+ * per second. When a chart refreshes it asks for a metric decimated to its width: every
+ * pixel column keeps only its minimum and maximum, so spikes survive and a chart never
+ * gets more than twice its width in points, however long the history.
+ *
+ * Metrics are named after the OpenHD property they come from, plus "vibration" for the
+ * magnitude of the three vibration axes.
+ */
+class TimeSeriesStore : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TimeSeriesStore(QObject *parent = nullptr);
+
+    static TimeSeriesStore* instance();
+
+    // seconds shown by the charts, x runs from -span to 0
+    Q_PROPERTY(int span READ span WRITE setSpan NOTIFY spanChanged)
+    int span() const {
+        return m_span;
+    }
+    void setSpan(int span);
+
+    Q_INVOKABLE QStringList metrics() const;
+
+    // smallest and largest value over the span, for axis ranges
+    Q_INVOKABLE double minimum(const QString &metric) const;
+    Q_INVOKABLE double maximum(const QString &metric) const;
+
+    /*
+     * Points (seconds before now, value) over the span, at most two per pixel column.
+     * Returns the number of points written.
+     */
+    int decimate(int metric, int width, QVector<QPointF> &points) const;
+
+#if defined(ENABLE_CHARTS)
+    // replaces the points of a LineSeries in one go
+    Q_INVOKABLE void updateSeries(QAbstractSeries *series, const QString &metric, int width);
+#endif
+
+signals:
+    void spanChanged(int span);
+
+    // once a second, when the charts should refresh
+    void updated();
+
+private slots:
+    void sample();
+
+private:
+    int metricIndex(const QString &metric) const;
+    void range(int metric, double &min, double &max) const;
+
+    // index of the i-th sample in the ring, 0 is the oldest
+    int slot(int i) const {
+        return (m_head - m_count + i + m_capacity) % m_capacity;
+    }
+
+    QTimer m_sampleTimer;
+    QElapsedTimer m_clock;
+    int m_ticks = 0;
+
+    int m_capacity;
+    int m_head = 0;
+    int m_count = 0;
+
+    std::vector<qint64> m_times;
+    // m_values[metric * m_capacity + slot]
+    std::vector<float> m_values;
+
+    // previous counter values and when they were read
+    std::vector<double> m_counters;
+    qint64 m_last_sample = -1;
+
+    std::vector<int> m_properties;
+
+    int m_span = 300;
+};
+
+#endif // TIMESERIESSTORE_H
@@ -0,0 +1,142 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <QObject>
+#include <QtCore>
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Lightweight instrumentation for the hot paths.
+ *
+ *   TRACE_SCOPE("video.processNAL");     times the rest of the enclosing block
+ *   TRACE_COUNTER("mavlink.bytes", n);   records a value
+ *
+ * While tracing is off each of these is one relaxed atomic load and a branch. While it
+ * is on, every scope adds to per call site statistics, shown live in QML, and writes an
+ * event into a ring buffer owned by the calling thread, so threads never contend. The
+ * rings can be exported as a Chrome trace (chrome://tracing or ui.perfetto.dev).
+ *
+ * Names must be string literals, only the pointer is kept.
+ */
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#if defined(QOPENHD_NO_TRACE)
+
+// for targets that don't link trace.cpp, like tests/telemetry_fuzz
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_COUNTER(name, value) do { (void)(value); } while (0)
+
+#else
+
+#define TRACE_SCOPE(name) \
+    static TraceSite TRACE_CONCAT(_trace_site_, __LINE__) { name }; \
+    TraceScope TRACE_CONCAT(_trace_scope_, __LINE__) { TRACE_CONCAT(_trace_site_, __LINE__) }
+
+#define TRACE_COUNTER(name, value) \
+    do { \
+        if (Trace::enabled()) { \
+            static TraceSite _trace_counter_site { name }; \
+            Trace::counter(_trace_counter_site, value); \
+        } \
+    } while (0)
+
+#endif
+
+
+struct TraceSite {
+    explicit TraceSite(const char *name);
+
+    const char *name;
+    std::atomic<bool> counter { false };
+
+    std::atomic<int64_t> calls { 0 };
+    std::atomic<int64_t> total { 0 };
+    std::atomic<int64_t> max { 0 };
+    std::atomic<int64_t> value { 0 };
+
+    TraceSite *next = nullptr;
+};
+
+
+class Trace : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Trace(QObject *parent = nullptr);
+
+    static Trace* instance();
+
+    static bool enabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    // monotonic ns
+    static int64_t now();
+
+    static void complete(TraceSite &site, int64_t start, int64_t end);
+    static void counter(TraceSite &site, int64_t value);
+
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    bool isEnabled() const {
+        return enabled();
+    }
+    void setEnabled(bool enabled);
+
+    /*
+     * One entry per call site, refreshed every second: name, calls (per second), avg and
+     * max (us), load (% of one core) for scopes, value for counters.
+     */
+    Q_PROPERTY(QVariantList summary READ summary NOTIFY summaryChanged)
+    QVariantList summary() const {
+        return m_summary;
+    }
+
+    // writes the per-thread rings as Chrome trace JSON, returns the file name or "" on failure
+    Q_INVOKABLE QString exportChromeTrace();
+
+signals:
+    void enabledChanged(bool enabled);
+    void summaryChanged();
+
+private slots:
+    void updateSummary();
+
+private:
+    static std::atomic<bool> s_enabled;
+
+    QTimer m_summaryTimer;
+    QElapsedTimer m_summaryClock;
+    QVariantList m_summary;
+};
+
+
+class TraceScope
+{
+public:
+    explicit TraceScope(TraceSite &site) {
+        if (Trace::enabled()) {
+            m_site = &site;
+            m_start = Trace::now();
+        }
+    }
+
+    ~TraceScope() {
+        if (m_site != nullptr) {
+            Trace::complete(*m_site, m_start, Trace::now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope &operator=(const TraceScope&) = delete;
+
+private:
+    TraceSite *m_site = nullptr;
+    int64_t m_start = 0;
+};
+
+#endif // TRACE_H
@@ -0,0 +1,104 @@
+#ifndef VIDEOHEALTH_H
+#define VIDEOHEALTH_H
+
+#include <QObject>
+#include <QtQuick>
+
+#include <atomic>
+
+/*
+ * Health of one video stream, fed by the receiver and decoder as things happen.
+ *
+ * The recording side (frameDecoded() etc) is safe to call from any thread and only
+ * touches atomics. Stall detection runs on the GUI thread off a deadline timer that is
+ * re-armed from the last frame time, so a stall is flagged a few frame intervals after
+ * the last frame rather than on the next tick of a fixed poll.
+ *
+ * Must stay on the GUI thread, QML binds to it directly.
+ */
+class VideoHealth : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VideoHealth(QObject *parent = nullptr);
+
+    // frames are arriving and the last one is recent enough
+    Q_PROPERTY(bool running READ running NOTIFY runningChanged)
+    bool running() const {
+        return m_running;
+    }
+
+    // everything below is averaged over the last stats window
+    Q_PROPERTY(double fps READ fps NOTIFY statsChanged)
+    double fps() const {
+        return m_fps;
+    }
+
+    // kbit/s of encoded video as received
+    Q_PROPERTY(int bitrate READ bitrate NOTIFY statsChanged)
+    int bitrate() const {
+        return m_bitrate;
+    }
+
+    // longest gap between two frames in the last window, in ms
+    Q_PROPERTY(int maxFrameGap READ maxFrameGap NOTIFY statsChanged)
+    int maxFrameGap() const {
+        return m_maxFrameGap;
+    }
+
+    // totals since the stream started
+    Q_PROPERTY(int decodeErrors READ decodeErrors NOTIFY statsChanged)
+    int decodeErrors() const {
+        return m_decodeErrors;
+    }
+
+    Q_PROPERTY(int lostPackets READ lostPackets NOTIFY statsChanged)
+    int lostPackets() const {
+        return m_lostPackets;
+    }
+
+    Q_PROPERTY(int stalls READ stalls NOTIFY statsChanged)
+    int stalls() const {
+        return m_stalls;
+    }
+
+    // safe to call from any thread
+    void frameDecoded();
+    void dataReceived(int bytes);
+    void decodeError();
+    void packetsLost(int count);
+
+signals:
+    void runningChanged(bool running);
+    void statsChanged();
+
+private slots:
+    void onResumed();
+    void onStallTimer();
+    void onStatsTimer();
+
+private:
+    qint64 stallThreshold() const;
+
+    QElapsedTimer m_clock;
+
+    std::atomic<bool> m_running { false };
+    std::atomic<qint64> m_lastFrame { 0 };
+    std::atomic<int> m_windowFrames { 0 };
+    std::atomic<int> m_windowBytes { 0 };
+    std::atomic<int> m_windowMaxGap { 0 };
+    std::atomic<int> m_decodeErrors { 0 };
+    std::atomic<int> m_lostPackets { 0 };
+
+    // GUI thread only
+    QTimer *m_stallTimer = nullptr;
+    QTimer *m_statsTimer = nullptr;
+    qint64 m_windowStart = 0;
+    double m_fps = 0.0;
+    int m_bitrate = 0;
+    int m_maxFrameGap = 0;
+    int m_stalls = 0;
+};
+
+#endif // VIDEOHEALTH_H
@@ -0,0 +1,126 @@
+#ifndef VIDEORECORDER_H
+#define VIDEORECORDER_H
+
+#include <QObject>
+#include <QtQuick>
+
+#include <atomic>
+
+#include "sharedqueue.h"
+
+#if defined(ENABLE_GSTREAMER)
+#include <gst/gst.h>
+#endif
+
+/*
+ * Records the received H.264 stream to a Matroska file without re-encoding.
+ *
+ * Video receivers hand over Annex-B data (single NALs or whole access units) as they
+ * get it, either as an implicitly shared QByteArray or as a referenced GstBuffer, so
+ * nothing is copied on the display path. Mapping, muxing and disk IO all happen on the
+ * recorder's own thread.
+ *
+ * The file is written as a live Matroska stream: unknown-size segment and clusters, each
+ * cluster starting on an IDR. Nothing has to be patched up when recording stops, so a
+ * crash or power loss still leaves a file that plays up to the last written frame.
+ */
+class VideoRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit VideoRecorder(const QString &name, QObject *parent = nullptr);
+    virtual ~VideoRecorder();
+
+    Q_PROPERTY(bool recording READ recording NOTIFY recordingChanged)
+    bool recording() const {
+        return m_recording;
+    }
+
+    Q_PROPERTY(QString fileName READ fileName NOTIFY fileNameChanged)
+    QString fileName() const {
+        return m_fileName;
+    }
+
+    // used in the file name, so main and PiP recordings can be told apart
+    void setName(const QString &name) {
+        m_name = name;
+    }
+
+    Q_INVOKABLE void start();
+    Q_INVOKABLE void stop();
+
+    /*
+     * Safe to call from any thread. Returns immediately, if the writer falls too far behind
+     * the data is dropped and the file resumes at the next IDR.
+     */
+    void pushData(const QByteArray &annexB);
+
+#if defined(ENABLE_GSTREAMER)
+    /*
+     * Same as pushData(), takes its own reference to the buffer and maps it on the
+     * writer thread.
+     */
+    void pushBuffer(GstBuffer *buffer);
+#endif
+
+signals:
+    void recordingChanged(bool recording);
+    void fileNameChanged(QString fileName);
+
+private:
+    struct Chunk {
+        QByteArray data;
+#if defined(ENABLE_GSTREAMER)
+        // owned by the queue, unreffed by the writer thread
+        GstBuffer *buffer = nullptr;
+#endif
+        int size = 0;
+        qint64 timestamp = 0;
+        int session = 0;
+        bool discontinuity = false;
+        bool stop = false;
+    };
+
+    void enqueue(Chunk &&chunk);
+    void release(Chunk &chunk);
+    void writeLoop();
+    void processData(const uint8_t *p, int size, qint64 timestamp);
+    void processNAL(const uint8_t *nal, int size, qint64 timestamp);
+    void writeAccessUnit();
+    void writeHeader();
+    void startCluster(qint64 timestamp);
+
+    bool parseSPS(const QByteArray &sps, int &width, int &height);
+
+    QString m_name;
+    QString m_fileName;
+
+    std::atomic<bool> m_recording { false };
+    std::atomic<bool> m_overflow { false };
+    std::atomic<int> m_queuedBytes { 0 };
+    std::atomic<int> m_session { 0 };
+
+    QElapsedTimer m_clock;
+
+    SharedQueue<Chunk> m_queue;
+    QThread *m_thread = nullptr;
+
+    // everything below is only touched by the writer thread
+    QFile m_file;
+
+    QByteArray m_sps;
+    QByteArray m_pps;
+
+    QByteArray m_accessUnit;
+    qint64 m_accessUnitTime = 0;
+    bool m_accessUnitHasSlice = false;
+    bool m_accessUnitIsKey = false;
+
+    bool m_headerWritten = false;
+    bool m_waitingForIDR = true;
+    qint64 m_timeOrigin = -1;
+    qint64 m_clusterTime = -1;
+};
+
+#endif // VIDEORECORDER_H
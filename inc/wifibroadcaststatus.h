@@ -0,0 +1,17 @@
+#ifndef WIFIBROADCASTSTATUS_H
+#define WIFIBROADCASTSTATUS_H
+
+#include <cstdint>
+
+#include "wifibroadcast.h"
+
+// wifibroadcast_rx_status_forward_t on the wire
+constexpr int kRxStatusSize = 113;
+
+/*
+ * Decodes the rx status the ground side forwards on its telemetry port. Returns false for
+ * anything that isn't exactly one status, wifi_adapter_cnt is clamped to adapter[].
+ */
+bool decodeRxStatus(const uint8_t *data, int length, wifibroadcast_rx_status_forward_t &telemetry);
+
+#endif // WIFIBROADCASTSTATUS_H
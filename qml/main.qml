@@ -136,24 +136,40 @@ ApplicationWindow {
     }
 
 
-    FrSkyTelemetry {
-        id: frskyTelemetry
-    }
-
-    //MSPTelemetry {
-    //    id: mspTelemetry
-    //}
-
-    SmartportTelemetry {
-        id: smartportTelemetry
+    /*
+     * Push video settings to the GStreamer streams as they change, so the running pipelines
+     * can be reconfigured in place instead of polling QSettings and restarting.
+     */
+    function updateVideoSetting(key, value) {
+        if (EnableMainVideo) {
+            MainStream.updateSetting(key, value);
+        }
+        if (EnablePiP) {
+            PiPStream.updateSetting(key, value);
+        }
     }
 
-    LTMTelemetry {
-        id: ltmTelemetry
+    Connections {
+        target: settings
+        enabled: EnableGStreamer
+        function onMain_video_portChanged() { updateVideoSetting("main_video_port", settings.main_video_port) }
+        function onPip_video_portChanged() { updateVideoSetting("pip_video_port", settings.pip_video_port) }
+        function onShow_pip_videoChanged() { updateVideoSetting("show_pip_video", settings.show_pip_video) }
+        function onEnable_software_video_decoderChanged() { updateVideoSetting("enable_software_video_decoder", settings.enable_software_video_decoder) }
+        function onVideo_h264Changed() { updateVideoSetting("video_h264", settings.video_h264) }
+        function onEnable_rtpChanged() { updateVideoSetting("enable_rtp", settings.enable_rtp) }
+        function onEnable_lte_videoChanged() { updateVideoSetting("enable_lte_video", settings.enable_lte_video) }
     }
 
-    VectorTelemetry {
-        id: vectorTelemetry
+    Connections {
+        target: settings
+        enabled: EnableRC
+        function onEnable_rcChanged() { openHDRC.updateSetting("enable_rc", settings.enable_rc) }
+        function onMavlink_sysidChanged() { openHDRC.updateSetting("mavlink_sysid", settings.mavlink_sysid) }
+        function onFc_mavlink_sysidChanged() { openHDRC.updateSetting("fc_mavlink_sysid", settings.fc_mavlink_sysid) }
+        function onRc_transportChanged() { openHDRC.updateSetting("rc_transport", settings.rc_transport) }
+        function onRc_rateChanged() { openHDRC.updateSetting("rc_rate", settings.rc_rate) }
+        function onRc_transformsChanged() { openHDRC.updateSetting("rc_transforms", settings.rc_transforms) }
     }
 
     BlackBoxModel {
@@ -215,7 +215,71 @@ Item {
                             anchors.rightMargin: Qt.inputMethod.visible ? 78 : 18
 
                             value: settings.log_level
-                            onValueChanged: settings.log_level = value
+                            onValueChanged: {
+                                settings.log_level = value
+                                Logger.setLevel(value)
+                            }
+                        }
+                    }
+
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+
+                        Text {
+                            text: qsTr("Enable Profiling")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        Switch {
+                            width: 32
+                            height: elementHeight
+                            anchors.rightMargin: Qt.inputMethod.visible ? 96 : 36
+                            anchors.right: parent.right
+                            anchors.verticalCenter: parent.verticalCenter
+                            checked: settings.enable_trace
+                            onCheckedChanged: {
+                                settings.enable_trace = checked
+                                Trace.enabled = checked
+                            }
+                        }
+                    }
+
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+                        visible: settings.enable_trace
+
+                        Text {
+                            text: qsTr("Export Trace")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        Button {
+                            height: elementHeight
+                            width: 128
+                            font.pixelSize: 14
+                            anchors.rightMargin: Qt.inputMethod.visible ? 78 : 18
+                            anchors.right: parent.right
+                            anchors.verticalCenter: parent.verticalCenter
+                            text: qsTr("Export")
+                            onClicked: Trace.exportChromeTrace()
                         }
                     }
 
@@ -397,6 +461,89 @@ Item {
                         }
                     }
 
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+                        visible: EnableRC
+
+                        Text {
+                            text: qsTr("RC Transport")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        ComboBox {
+                            height: elementHeight
+                            anchors.right: parent.right
+                            anchors.rightMargin: Qt.inputMethod.visible ? 96 : 36
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 320
+                            model: ListModel {
+                                id: rc_transport
+                                ListElement { text: qsTr("MAVLink RC override") ; transport: "mavlink" }
+                                ListElement { text: qsTr("OpenHD RC (UDP 5565)") ; transport: "openhd" }
+                            }
+                            textRole: "text"
+                            // @disable-check M223
+                            Component.onCompleted: {
+                                // @disable-check M223
+                                for (var i = 0; i < model.count; i++) {
+                                    // @disable-check M222
+                                    var choice = model.get(i);
+                                    // @disable-check M223
+                                    if (choice.transport == settings.rc_transport) {
+                                        currentIndex = i;
+                                    }
+                                }
+                            }
+                            onCurrentIndexChanged: {
+                                    settings.rc_transport = rc_transport.get(currentIndex).transport
+                            }
+                        }
+                    }
+
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+                        visible: EnableRC
+
+                        Text {
+                            text: qsTr("RC Packet Rate (Hz)")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        SpinBox {
+                            id: rcRateSpinBox
+                            height: elementHeight
+                            width: 210
+                            font.pixelSize: 14
+                            anchors.right: parent.right
+                            anchors.verticalCenter: parent.verticalCenter
+                            from: 10
+                            to: 250
+                            stepSize: 10
+                            anchors.rightMargin: Qt.inputMethod.visible ? 78 : 18
+
+                            value: settings.rc_rate
+                            onValueChanged: settings.rc_rate = value
+                        }
+                    }
+
                     Rectangle {
                         width: parent.width
                         height: rowHeight
@@ -1850,6 +1997,111 @@ Item {
                             }
                         }
                     }
+
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+                        visible: EnableBlackbox
+
+                        Text {
+                            text: qsTr("BlackBox Memory Limit (MB)")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        SpinBox {
+                            id: blackboxMemoryLimitSpinBox
+                            height: elementHeight
+                            width: 210
+                            font.pixelSize: 14
+                            anchors.right: parent.right
+                            anchors.verticalCenter: parent.verticalCenter
+                            from: 1
+                            to: 256
+                            stepSize: 1
+                            anchors.rightMargin: Qt.inputMethod.visible ? 78 : 18
+
+                            value: settings.blackbox_memory_limit
+                            onValueChanged: settings.blackbox_memory_limit = value
+                        }
+                    }
+
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+                        visible: EnableBlackbox
+
+                        Text {
+                            text: qsTr("BlackBox Sync Interval (s)")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        SpinBox {
+                            id: blackboxSyncIntervalSpinBox
+                            height: elementHeight
+                            width: 210
+                            font.pixelSize: 14
+                            anchors.right: parent.right
+                            anchors.verticalCenter: parent.verticalCenter
+                            from: 1
+                            to: 60
+                            stepSize: 1
+                            anchors.rightMargin: Qt.inputMethod.visible ? 78 : 18
+
+                            value: settings.blackbox_sync_interval
+                            onValueChanged: settings.blackbox_sync_interval = value
+                        }
+                    }
+
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+                        visible: EnableBlackbox
+
+                        Text {
+                            text: qsTr("BlackBox Flights Kept")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        SpinBox {
+                            id: blackboxMaxFlightsSpinBox
+                            height: elementHeight
+                            width: 210
+                            font.pixelSize: 14
+                            anchors.right: parent.right
+                            anchors.verticalCenter: parent.verticalCenter
+                            from: 1
+                            to: 1000
+                            stepSize: 1
+                            anchors.rightMargin: Qt.inputMethod.visible ? 78 : 18
+
+                            value: settings.blackbox_max_flights
+                            onValueChanged: settings.blackbox_max_flights = value
+                        }
+                    }
                     Rectangle {
                         width: parent.width
                         height: rowHeight
@@ -2213,6 +2465,40 @@ Item {
                         }
                     }
 
+                    Rectangle {
+                        width: parent.width
+                        height: rowHeight
+                        color: (Positioner.index % 2 == 0) ? "#8cbfd7f3" : "#00000000"
+                        visible: EnableMainVideo
+
+                        Text {
+                            text: qsTr("Record video")
+                            font.weight: Font.Bold
+                            font.pixelSize: 13
+                            anchors.leftMargin: 8
+                            verticalAlignment: Text.AlignVCenter
+                            anchors.verticalCenter: parent.verticalCenter
+                            width: 224
+                            height: elementHeight
+                            anchors.left: parent.left
+                        }
+
+                        Switch {
+                            width: 32
+                            height: elementHeight
+                            anchors.rightMargin: Qt.inputMethod.visible ? 96 : 36
+
+                            anchors.right: parent.right
+                            anchors.verticalCenter: parent.verticalCenter
+                            checked: EnableMainVideo && MainStream.recorder.recording
+                            onCheckedChanged: {
+                                if (EnableMainVideo) {
+                                    checked ? MainStream.recorder.start() : MainStream.recorder.stop()
+                                }
+                            }
+                        }
+                    }
+
                     Rectangle {
                         width: parent.width
                         height: rowHeight
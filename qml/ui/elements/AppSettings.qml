@@ -33,6 +33,10 @@ Settings {
     property bool enable_speech: true
     property bool enable_imperial: false
     property bool enable_rc: false
+    property string rc_transport: "mavlink"
+    property int rc_rate: 50
+    // stick profile, see RCTransformTable
+    property string rc_transforms: ""
 
     property string color_shape: "white"
     property string color_text: "white"
@@ -48,6 +52,7 @@ Settings {
     property double ground_power_opacity: 1
 
     property int log_level: 6
+    property bool enable_trace: false
 
     property bool show_downlink_rssi: true
     property double downlink_rssi_opacity: 1
@@ -309,6 +314,9 @@ Settings {
     property bool show_blackbox: false
     property double blackbox_opacity: 1
     property double blackbox_size: 1
+    property int blackbox_memory_limit: 16
+    property int blackbox_sync_interval: 5
+    property int blackbox_max_flights: 50
 
     property bool show_mission: true
     property double mission_opacity: 1
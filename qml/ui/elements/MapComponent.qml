@@ -64,11 +64,16 @@ Map {
         findMapBounds();
     }
 
+    onZoomLevelChanged: {
+        findMapBounds();
+    }
+
     function findMapBounds(){
         var center_coord = map.toCoordinate(Qt.point(map.width/2,map.height/2))
         //console.log("my center",center_coord.latitude, center_coord.longitude);
         if (EnableADSB) {
             AdsbVehicleManager.newMapCenter(center_coord);
+            AdsbVehicleManager.setViewport(map.visibleRegion.boundingGeoRectangle());
         }
     }
 
@@ -159,6 +164,31 @@ Map {
         opacity: .3
     }
 
+    // threatening contacts in view, from the traffic evaluation
+    property var adsbThreats: []
+
+    Connections {
+        target: EnableADSB ? AdsbVehicleManager : null
+        function onTrafficChanged() {
+            var traffic = AdsbVehicleManager.trafficInBox(map.visibleRegion.boundingGeoRectangle());
+            adsbThreats = traffic.filter(function(contact) { return contact.threat > 0; });
+        }
+    }
+
+    MapItemView {
+        id: threatMapView
+        model: adsbThreats
+        visible: EnableADSB
+
+        delegate: MapCircle {
+            center: QtPositioning.coordinate(modelData.lat, modelData.lon)
+            radius: 1000
+            color: modelData.threat == 2 ? "red" : "yellow"
+            opacity: .3
+            border.width: 0
+        }
+    }
+
     MapItemView {
         id: markerMapView
         model: AdsbVehicleManager.adsbVehicles
@@ -171,6 +201,14 @@ Map {
             MapItemGroup {
                 id: delegateGroup
 
+                // where the contact has been
+                MapPolyline {
+                    line.width: 2
+                    line.color: settings.color_shape
+                    opacity: 0.5
+                    path: model.track
+                }
+
                 MapQuickItem {
                     id: marker
 
@@ -192,28 +230,28 @@ Map {
                         color: settings.color_shape
                         glow: settings.color_glow
 
-                        name: object.callsign
+                        name: model.callsign
 
                         drone_heading: OpenHD.hdg; //need this to adjust orientation
 
                         drone_alt: OpenHD.alt_msl;
 
-                        heading: object.heading;
+                        heading: model.heading;
 
-                        speed: object.velocity
+                        speed: model.velocity
 
-                        alt: object.altitude
+                        alt: model.altitude
 
 //                          {
 /*                          check if traffic is a threat.. this should not be done here. Left as REF
-                                if (object.altitude - OpenHD.alt_msl < 300 && model.distance < 2){
+                                if (model.altitude - OpenHD.alt_msl < 300 && model.distance < 2){
                                     //console.log("TRAFFIC WARNING");
 
                                     //image.source="/airplanemarkerwarn.png";
                                     background.border.color = "red";
                                     background.border.width = 5;
                                     background.opacity = 0.5;
-                                } else if (object.altitude - OpenHD.alt_msl < 500 && model.distance < 5){
+                                } else if (model.altitude - OpenHD.alt_msl < 500 && model.distance < 5){
                                     //console.log("TRAFFIC ALERT");
 
                                     //image.source="/airplanemarkeralert.png";
@@ -228,13 +266,13 @@ Map {
 
                             var _adsb_alt;
 
-                            _adsb_alt=object.altitude;
+                            _adsb_alt=model.altitude;
 
                             if ( _adsb_alt> 9999) {
                                 //console.log("qml: model alt or vertical undefined")
                                return "---";
                             } else {
-                                if(object.verticalVel > .2){ //climbing
+                                if(model.verticalVel > .2){ //climbing
                                     if (settings.enable_imperial === false){
                                         return Math.floor(_adsb_alt - OpenHD.alt_msl) + "m " + "\ue696"
                                     }
@@ -242,7 +280,7 @@ Map {
                                         return Math.floor((_adsb_alt - OpenHD.alt_msl) * 3.28084) + "Ft " + "\ue696"
                                     }
                                 }
-                                else if (object.verticalVel < -.2){//descending
+                                else if (model.verticalVel < -.2){//descending
                                     if (settings.enable_imperial === false){
                                         return Math.floor(_adsb_alt - OpenHD.alt_msl) + "m " + "\ue697"
                                     }
@@ -263,7 +301,7 @@ Map {
   */
                     }
                     //position everything
-                    coordinate: object.coordinate;
+                    coordinate: model.coordinate;
 
                 }
                 //Component.onCompleted: map.addMapItemGroup(this);
@@ -164,6 +164,54 @@ Item {
                 onCheckedChanged: bitrateAxis.visible = checked
             }
 
+            ColoredCheckbox {
+                padding: 0
+                Layout.row: 2
+                Layout.column: 1
+                text: qsTr("Altitude")
+                font.pixelSize: legend.fontSize
+                boxColor: altitudeAxis.color
+                checked: altitudeAxis.visible
+                unknownState: false
+                onCheckedChanged: altitudeAxis.visible = checked
+            }
+
+            ColoredCheckbox {
+                padding: 0
+                Layout.row: 2
+                Layout.column: 2
+                text: qsTr("Speed")
+                font.pixelSize: legend.fontSize
+                boxColor: speedAxis.color
+                checked: speedAxis.visible
+                unknownState: false
+                onCheckedChanged: speedAxis.visible = checked
+            }
+
+            ColoredCheckbox {
+                padding: 0
+                Layout.row: 2
+                Layout.column: 3
+                text: qsTr("Battery")
+                font.pixelSize: legend.fontSize
+                boxColor: batteryAxis.color
+                checked: batteryAxis.visible
+                unknownState: false
+                onCheckedChanged: batteryAxis.visible = checked
+            }
+
+            ColoredCheckbox {
+                padding: 0
+                Layout.row: 2
+                Layout.column: 4
+                text: qsTr("Vibration")
+                font.pixelSize: legend.fontSize
+                boxColor: vibrationAxis.color
+                checked: vibrationAxis.visible
+                unknownState: false
+                onCheckedChanged: vibrationAxis.visible = checked
+            }
+
         }
     }
 
@@ -188,25 +236,42 @@ Item {
         antialiasing: true
 
 
-        property int chartData: 0
-
-
-        property int lostPacketsLast: 0
-        property int lostPacketsMax: 0
-
-        property int damagedBlocksLast: 0
-        property int damagedBlocksMax: 0
+        /*
+         * The history lives in TimeSeriesStore, every refresh replaces the points of the
+         * visible series with the metric named by their "metric" property, already
+         * decimated to the plot width. x is seconds before now.
+         */
+        function refresh() {
+            if (!visible) {
+                return;
+            }
+            var flightMax = 10;
+            for (var i = 0; i < count; i++) {
+                var s = series(i);
+                if (!s.visible) {
+                    continue;
+                }
+                TimeSeriesStore.updateSeries(s, s.metric, plotArea.width);
+                if (s.axisY === flightYAxis) {
+                    flightMax = Math.max(flightMax, TimeSeriesStore.maximum(s.metric));
+                }
+            }
+            flightYAxis.max = Math.ceil(flightMax / 10) * 10;
+        }
 
-        property int injectionFailLast: 0
-        property int injectionFailMax: 0
+        onVisibleChanged: refresh()
 
-        property int skippedPacketsLast: 0
-        property int skippedPacketsMax: 0
+        Connections {
+            target: TimeSeriesStore
+            function onUpdated() {
+                chart.refresh();
+            }
+        }
 
         ValueAxis {
             id: valueAxis
-            min: 0
-            max: 300
+            min: -TimeSeriesStore.span
+            max: 0
             labelsVisible: false
             color: "black"
             labelsFont: Qt.font({pixelSize: 12})
@@ -232,8 +297,21 @@ Item {
             labelsFont: Qt.font({pixelSize: 12})
         }
 
+        // altitude, speed, battery and vibration, rescaled to what is on screen
+        ValueAxis {
+            id: flightYAxis
+            min: 0
+            max: 10
+            tickCount: 11
+            labelFormat: "%d"
+            color: "black"
+            labelsFont: Qt.font({pixelSize: 12})
+            visible: altitudeAxis.visible || speedAxis.visible || batteryAxis.visible || vibrationAxis.visible
+        }
+
         LineSeries {
             id: airCPUAxis
+            property string metric: "cpuload_air"
             name: "Air CPU"
             axisX: valueAxis
             axisY: countYAxis
@@ -244,6 +322,7 @@ Item {
 
         LineSeries {
             id: gndCPUAxis
+            property string metric: "cpuload_gnd"
             name: "Ground CPU"
             axisX: valueAxis
             axisY: countYAxis
@@ -254,6 +333,7 @@ Item {
 
         LineSeries {
             id: gndTempAxis
+            property string metric: "temp_gnd"
             name: "Ground Temp"
             axisX: valueAxis
             axisY: countYAxis
@@ -264,6 +344,7 @@ Item {
 
         LineSeries {
             id: airTempAxis
+            property string metric: "temp_air"
             name: "Air Temp"
             axisX: valueAxis
             axisYRight: countYAxis
@@ -274,6 +355,7 @@ Item {
 
         LineSeries {
             id: lostPacketAxis
+            property string metric: "lost_packet_cnt"
             name: "Lost Packets"
             axisX: valueAxis
             axisY: countYAxis
@@ -284,6 +366,7 @@ Item {
 
         LineSeries {
             id: damagedBlockAxis
+            property string metric: "damaged_block_cnt"
             name: "Damaged Blocks"
             axisX: valueAxis
             axisY: countYAxis
@@ -294,6 +377,7 @@ Item {
 
         LineSeries {
             id: downlinkRSSIAxis
+            property string metric: "downlink_rssi"
             name: "Downlink RSSI"
             axisX: valueAxis
             axisYRight: dbYAxis
@@ -304,6 +388,7 @@ Item {
 
         LineSeries {
             id: uplinkRSSIAxis
+            property string metric: "current_signal_joystick_uplink"
             name: "Uplink RSSI"
             axisX: valueAxis
             axisYRight: dbYAxis
@@ -315,6 +400,7 @@ Item {
 
         LineSeries {
             id: injectionFailAxis
+            property string metric: "injection_fail_cnt"
             name: "Injection Fail"
             axisX: valueAxis
             axisY: countYAxis
@@ -325,6 +411,7 @@ Item {
 
         LineSeries {
             id: skippedPacketAxis
+            property string metric: "skipped_packet_cnt"
             name: "Skipped packets"
             axisX: valueAxis
             axisY: countYAxis
@@ -335,6 +422,7 @@ Item {
 
         LineSeries {
             id: bitrateAxis
+            property string metric: "kbitrate"
             name: "Bitrate"
 
             axisX: valueAxis
@@ -344,68 +432,52 @@ Item {
             useOpenGL: true
         }
 
-        Timer {
-            id: chartTimer
-            running: true
-            interval: 1000
-            repeat: true
-            onTriggered: {
-                if (chart.lostPacketsLast != 0) {
-                    var lostPacketsDifference = OpenHD.lost_packet_cnt - chart.lostPacketsLast;
-                    lostPacketAxis.append(chart.chartData, lostPacketsDifference);
-                }
-                chart.lostPacketsLast = OpenHD.lost_packet_cnt;
-
-                if (chart.damagedBlocksLast != 0) {
-                    var damagedBlocksDifference = OpenHD.damaged_block_cnt - chart.damagedBlocksLast;
-                    damagedBlockAxis.append(chart.chartData, damagedBlocksDifference);
-                }
-                chart.damagedBlocksLast = OpenHD.damaged_block_cnt;
-
-                if (chart.injectionFailLast != 0) {
-                    var injectionFailDifference = OpenHD.injection_fail_cnt - chart.injectionFailLast;
-                    injectionFailAxis.append(chart.chartData, injectionFailDifference);
-                }
-                chart.injectionFailLast = OpenHD.injection_fail_cnt;
-
-                if (chart.skippedPacketsLast != 0) {
-                    var skippedPacketDifference = OpenHD.skipped_packet_cnt - chart.skippedPacketsLast;
-                    skippedPacketAxis.append(chart.chartData, skippedPacketDifference);
-                }
-                chart.skippedPacketsLast = OpenHD.skipped_packet_cnt;
-
-                airCPUAxis.append(chart.chartData, OpenHD.cpuload_air);
-                gndCPUAxis.append(chart.chartData, OpenHD.cpuload_gnd);
-                airTempAxis.append(chart.chartData, OpenHD.temp_air);
-                gndTempAxis.append(chart.chartData, OpenHD.temp_gnd);
-                downlinkRSSIAxis.append(chart.chartData, OpenHD.downlink_rssi);
-                uplinkRSSIAxis.append(chart.chartData, OpenHD.current_signal_joystick_uplink);
-
-                bitrateAxis.append(chart.chartData, OpenHD.kbitrate / 1024);
-
-                chart.chartData++;
-
-                if (chart.chartData > 300) {
-                    valueAxis.min++;
-                    valueAxis.max++;
-
-                    lostPacketAxis.remove(1);
-                    damagedBlockAxis.remove(1);
-
-                    airCPUAxis.remove(1);
-                    gndCPUAxis.remove(1);
-                    airTempAxis.remove(1);
-                    gndTempAxis.remove(1);
+        LineSeries {
+            id: altitudeAxis
+            property string metric: "alt_rel"
+            name: "Altitude"
+            axisX: valueAxis
+            axisY: flightYAxis
+            color: "gold"
+            width: 2
+            useOpenGL: true
+            visible: false
+        }
 
-                    downlinkRSSIAxis.remove(1);
-                    uplinkRSSIAxis.remove(1);
+        LineSeries {
+            id: speedAxis
+            property string metric: "speed"
+            name: "Speed"
+            axisX: valueAxis
+            axisY: flightYAxis
+            color: "cyan"
+            width: 2
+            useOpenGL: true
+            visible: false
+        }
 
-                    injectionFailAxis.remove(1);
-                    skippedPacketAxis.remove(1);
+        LineSeries {
+            id: batteryAxis
+            property string metric: "battery_voltage"
+            name: "Battery"
+            axisX: valueAxis
+            axisY: flightYAxis
+            color: "yellowgreen"
+            width: 2
+            useOpenGL: true
+            visible: false
+        }
 
-                    bitrateAxis.remove(1);
-                }
-            }
+        LineSeries {
+            id: vibrationAxis
+            property string metric: "vibration"
+            name: "Vibration"
+            axisX: valueAxis
+            axisY: flightYAxis
+            color: "magenta"
+            width: 2
+            useOpenGL: true
+            visible: false
         }
     }
 }
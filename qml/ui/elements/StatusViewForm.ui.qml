@@ -2,13 +2,12 @@ import QtQuick 2.12
 import QtQuick.Controls 2.12
 import QtQuick.Layouts 1.12
 
-import SortFilterProxyModel 0.2
-
 Item {
     ListView {
         id: messageList
 
-        model: sortModel
+        // already in arrival order, a sorting proxy would re-sort on every message
+        model: StatusLogModel
 
         anchors.fill: parent
 
@@ -37,16 +36,6 @@ Item {
     }
 
 
-    SortFilterProxyModel {
-        id: sortModel
-        sourceModel: StatusLogModel
-        sorters: RoleSorter {
-            roleName: "timestamp";
-            sortOrder: Qt.AscendingOrder
-        }
-    }
-
-
     Component {
         id: messageDelegate
 
@@ -88,7 +77,7 @@ Item {
                 font.bold: true
             }
             Text {
-                text: message
+                text: repeat > 1 ? message + "  (x" + repeat + ")" : message
                 font.pixelSize: 12
                 anchors.left: sysidText.right
                 anchors.leftMargin: 12
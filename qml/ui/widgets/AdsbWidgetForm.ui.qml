@@ -41,6 +41,19 @@ BaseWidget {
     property bool adsbStatus: AdsbVehicleManager.status ? true : false
     property color adsbStatusColor: AdsbVehicleManager.status == 2 ? "green" : "red"
 
+    // contacts within the distance limit around the drone, nearest first
+    property var nearbyTraffic: []
+
+    Connections {
+        target: AdsbVehicleManager
+        function onTrafficChanged() {
+            var center = QtPositioning.coordinate(OpenHD.lat, OpenHD.lon);
+            var box = QtPositioning.rectangle(center.atDistanceAndAzimuth(settings.adsb_distance_limit, 315, 0.0),
+                                              center.atDistanceAndAzimuth(settings.adsb_distance_limit, 135, 0.0));
+            nearbyTraffic = AdsbVehicleManager.trafficInBox(box);
+        }
+    }
+
     widgetDetailComponent: ScrollView {
 
         contentHeight: adsbSettingsColumn.height
@@ -72,6 +85,25 @@ BaseWidget {
                     radius: 5
                 }
             }
+            Item {
+                width: parent.width
+                height: 32
+                Text {
+                    text: {
+                        if (nearbyTraffic.length === 0) {
+                            return qsTr("No traffic nearby");
+                        }
+                        var nearest = nearbyTraffic[0];
+                        return qsTr("Traffic: ") + nearbyTraffic.length + qsTr(", nearest ") + (nearest.distance / 1000).toFixed(1) + "km " + Math.round(nearest.bearing) + "\u00B0";
+                    }
+                    color: "white"
+                    height: parent.height
+                    font.bold: true
+                    font.pixelSize: detailPanelFontPixels
+                    anchors.left: parent.left
+                    verticalAlignment: Text.AlignVCenter
+                }
+            }
             Item {
                 width: parent.width
                 height: 32
@@ -328,7 +360,7 @@ BaseWidget {
 
         Text {
             id: adsb_text
-            color: settings.color_shape
+            color: AdsbVehicleManager.threatLevel == 2 ? "red" : AdsbVehicleManager.threatLevel == 1 ? "yellow" : settings.color_shape
             opacity: settings.adsb_opacity
             text: "ADS-B"
             anchors.left: parent.left
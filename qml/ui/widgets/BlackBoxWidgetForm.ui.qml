@@ -29,34 +29,9 @@ BaseWidget {
             count = BlackBoxModel.rowCount()
             blackboxmodel_count_text.text = Number(count).toLocaleString(
                         Qt.locale(), 'f', 0)
-            blackbox_play_Slider.to = count
         }
     }
 
-    property bool play_pause: true
-    property bool telemetry_pause: false
-
-    function playPause() {
-
-        //console.log("playPause from:" , blackbox_play_Slider.value);
-        OpenHD.pauseBlackBox(true, blackbox_play_Slider.value)
-
-        if (play_pause == false) {
-            playTimer.start()
-        } else {
-            playTimer.stop()
-        }
-    }
-
-    Timer {
-        id: playTimer
-        interval: 1000
-        repeat: true
-        running: false
-        triggeredOnStart: false
-        onTriggered: blackbox_play_Slider.value = blackbox_play_Slider.value + 1
-    }
-
     hasWidgetDetail: true
 
     widgetDetailComponent: ScrollView {
@@ -147,6 +122,41 @@ BaseWidget {
                     }
                 }
             }
+            Item {
+                width: parent.width
+                height: 32
+                Text {
+                    text: qsTr("Flight")
+                    color: "white"
+                    height: parent.height
+                    font.bold: true
+                    font.pixelSize: detailPanelFontPixels
+                    anchors.left: parent.left
+                    verticalAlignment: Text.AlignVCenter
+                }
+                ComboBox {
+                    id: blackbox_flight_Box
+                    height: parent.height
+                    anchors.rightMargin: 0
+                    anchors.right: parent.right
+                    width: parent.width - 96
+                    font.pixelSize: detailPanelFontPixels
+                    model: ["Live"]
+
+                    onPressedChanged: {
+                        if (pressed) {
+                            model = ["Live"].concat(BlackBoxModel.flights())
+                        }
+                    }
+                    onActivated: {
+                        if (index == 0) {
+                            BlackBoxModel.showLiveFlight()
+                        } else {
+                            BlackBoxModel.loadFlight(currentText)
+                        }
+                    }
+                }
+            }
             Item {
                 width: 230
                 height: 32
@@ -251,7 +261,7 @@ BaseWidget {
 
             Text {
                 id: playText
-                text: blackbox_play_Slider.value
+                text: BlackBoxPlayer.positionText
                 color: "white"
                 height: parent.height
                 font.bold: true
@@ -263,10 +273,8 @@ BaseWidget {
             Slider {
                 id: blackbox_play_Slider
                 orientation: Qt.Horizontal
-                from: 0
-                value: 0
-                //to: 100
-                stepSize: 1
+                from: BlackBoxPlayer.start
+                to: BlackBoxPlayer.end
                 height: parent.height
                 anchors.left: parent.left
                 anchors.leftMargin: 45
@@ -276,25 +284,20 @@ BaseWidget {
                 }
 
                 width: parent.width - 135
-                // @disable-check M223
-                onValueChanged: {
-                    //console.log("play slider=",blackbox_play_Slider.value);
-                    telemetry_pause = true
-
-                    if (play_pause == false) {
-                        playPauseBtn.text = "\uf04c"
-                    } else {
-                        playPauseBtn.text = "\uf04b"
-                    }
+                // seeks are applied once per frame by the player, however fast this moves
+                onMoved: BlackBoxPlayer.seek(value)
+            }
 
-                    OpenHD.pauseBlackBox(telemetry_pause,
-                                         blackbox_play_Slider.value)
-                }
+            Binding {
+                target: blackbox_play_Slider
+                property: "value"
+                value: BlackBoxPlayer.position
+                when: !blackbox_play_Slider.pressed
             }
 
             Button {
                 id: playPauseBtn
-                text: "\uf04c"
+                text: BlackBoxPlayer.playing ? "\uf04c" : "\uf04b"
                 font.pixelSize: 12
                 anchors.right: parent.right
                 anchors.rightMargin: 10
@@ -305,19 +308,10 @@ BaseWidget {
                 }
 
                 onClicked: {
-                    // play_pause true == looks like play, false == looks like pause
-                    if (play_pause == true) {
-                        play_pause = false
+                    if (BlackBoxPlayer.playing) {
+                        BlackBoxPlayer.pause()
                     } else {
-                        play_pause = true
-                    }
-
-                    playPause()
-
-                    if (play_pause == false) {
-                        playPauseBtn.text = "\uf04c"
-                    } else {
-                        playPauseBtn.text = "\uf04b"
+                        BlackBoxPlayer.play()
                     }
                 }
 
@@ -354,21 +348,30 @@ BaseWidget {
                 verticalAlignment: Text.AlignVCenter
             }
         }
+        ComboBox {
+            id: playRateBox
+            visible: BlackBoxPlayer.active
+            width: 72
+            height: 25
+            font.pixelSize: 12
+            anchors.left: parent.left
+            anchors.leftMargin: 10
+            anchors.bottom: parent.bottom
+            model: ["0.25x", "0.5x", "1x", "2x", "4x", "8x", "16x", "32x"]
+            currentIndex: 2
+            onActivated: BlackBoxPlayer.rate = parseFloat(currentText)
+        }
+
         Button {
             id: resumeTelemetryBtn
-            visible: telemetry_pause
+            visible: BlackBoxPlayer.active
             text: "restart telemetry"
             //height: 25
             font.pixelSize: 12
             anchors.horizontalCenter: parent.horizontalCenter
             anchors.bottom: parent.bottom
             onClicked: {
-                playTimer.stop()
-                play_pause = true
-                playPauseBtn.text = "\uf04c"
-                telemetry_pause = false
-                OpenHD.pauseBlackBox(telemetry_pause,
-                                     blackbox_play_Slider.value)
+                BlackBoxPlayer.stop()
             }
 
             contentItem: Text {
@@ -292,6 +292,84 @@ BaseWidget {
                     anchors.right: parent.right
                     verticalAlignment: Text.AlignVCenter
                 }
+            }
+
+            Item {
+                width: parent.width
+                height: 32
+                Text {
+                    text: qsTr("Lost (%1s):").arg(LinkStats.window / 1000)
+                    color: "white"
+                    font.bold: true
+                    height: parent.height
+                    font.pixelSize: detailPanelFontPixels
+                    anchors.left: parent.left
+                    verticalAlignment: Text.AlignVCenter
+                }
+                Text {
+                    text: Number(LinkStats.lossPercent).toLocaleString(Qt.locale(), 'f', 1) + "%"
+                    color: "white"
+                    font.bold: true
+                    height: parent.height
+                    font.pixelSize: detailPanelFontPixels
+                    anchors.right: parent.right
+                    verticalAlignment: Text.AlignVCenter
+                }
+            }
+
+            Repeater {
+                model: LinkStats
+
+                Item {
+                    width: 200
+                    height: 44
+
+                    Text {
+                        id: cardText
+                        text: (best ? "\u25B6 " : "") + qsTr("Card %1: %2 \u00B1%3 dBm, %4% lost")
+                                .arg(adapter)
+                                .arg(Number(rssiAverage).toLocaleString(Qt.locale(), 'f', 0))
+                                .arg(Number(rssiDeviation).toLocaleString(Qt.locale(), 'f', 1))
+                                .arg(Number(loss).toLocaleString(Qt.locale(), 'f', 0))
+                        color: "white"
+                        height: 20
+                        font.pixelSize: detailPanelFontPixels
+                        anchors.left: parent.left
+                        verticalAlignment: Text.AlignVCenter
+                    }
+
+                    // signal over the kept history, -100 dBm at the bottom, -20 dBm at the top
+                    Canvas {
+                        anchors.top: cardText.bottom
+                        anchors.left: parent.left
+                        anchors.right: parent.right
+                        height: 20
+
+                        property var history: rssiHistory
+                        onHistoryChanged: requestPaint()
+
+                        onPaint: {
+                            var ctx = getContext("2d");
+                            ctx.reset();
+                            if (history.length < 2) {
+                                return;
+                            }
+                            ctx.strokeStyle = best ? settings.color_shape : "grey";
+                            ctx.lineWidth = 1;
+                            ctx.beginPath();
+                            for (var i = 0; i < history.length; i++) {
+                                var x = i * width / (history.length - 1);
+                                var y = height - Math.max(0, Math.min(1, (history[i] + 100) / 80)) * height;
+                                if (i === 0) {
+                                    ctx.moveTo(x, y);
+                                } else {
+                                    ctx.lineTo(x, y);
+                                }
+                            }
+                            ctx.stroke();
+                        }
+                    }
+                }
             }           
         }
         Button {
@@ -393,12 +393,12 @@ BaseWidget {
                     roll: OpenHD.roll
 
                     type: "adsb"
-                    name: object.callsign
-                    lat: object.lat
-                    lon: object.lon
-                    alt: object.altitude
-                    speed: object.velocity
-                    vert: object.verticalVel
+                    name: model.callsign
+                    lat: model.lat
+                    lon: model.lon
+                    alt: model.altitude
+                    speed: model.velocity
+                    vert: model.verticalVel
 
                     vroverlaySize: settings.vroverlay_size
 
@@ -25,5 +25,5 @@ Loader {
         }
         return ""
     }
-    property bool isRunning: OpenHD.pip_video_running
+    property bool isRunning: EnablePiP && PiPStream.health.running
 }
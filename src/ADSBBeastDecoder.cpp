@@ -0,0 +1,399 @@
+#include "ADSBBeastDecoder.h"
+
+#include <QtMath>
+
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// mode-s checksum generator, x^24 + x^23 + ... + x^10 + x^3 + 1 without the top bit
+constexpr uint32_t kPolynomial = 0xfff409;
+
+// even and odd frames further apart than this aren't a pair
+constexpr qint64 kCprPairAge = 10000;
+
+// a position older than this is no reference for the next single frame
+constexpr qint64 kCprReferenceAge = 60000;
+
+// a single frame decoded further than this from the last position is taken as wrong, in km
+constexpr double kCprMaxJump = 20.0;
+
+// aircraft nobody heard from for this long are forgotten
+constexpr qint64 kAircraftAge = 60000;
+
+// Beast frame type to message length
+int messageLength(uint8_t type) {
+    switch (type) {
+        case '1': return 2;
+        case '2': return 7;
+        case '3': return 14;
+        default: return 0;
+    }
+}
+
+struct CrcTable {
+    uint32_t table[256];
+
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i << 16;
+            for (int bit = 0; bit < 8; bit++) {
+                c = (c & 0x800000) ? (c << 1) ^ kPolynomial : c << 1;
+            }
+            table[i] = c & 0xffffff;
+        }
+    }
+};
+
+// the remainder over everything but the parity, equal to the parity for a good DF17
+uint32_t crc(const uint8_t *message, int length) {
+    static const CrcTable crc_table;
+    uint32_t remainder = 0;
+    for (int i = 0; i < length - 3; i++) {
+        remainder = ((remainder << 8) ^ crc_table.table[((remainder >> 16) ^ message[i]) & 0xff]) & 0xffffff;
+    }
+    return remainder;
+}
+
+// bits first to last of the 56 bit ME field, counted from 1 like the specs do
+uint32_t bits(uint64_t me, int first, int last) {
+    return static_cast<uint32_t>((me >> (56 - last)) & ((1ull << (last - first + 1)) - 1));
+}
+
+// longitude zones at a latitude, for NZ = 15
+int numberOfZones(double lat) {
+    lat = std::fabs(lat);
+    if (lat < 1e-9) {
+        return 59;
+    }
+    if (lat > 87.0) {
+        return 1;
+    }
+    if (std::fabs(lat - 87.0) < 1e-9) {
+        return 2;
+    }
+    auto a = 1.0 - std::cos(M_PI / (2.0 * 15.0));
+    auto b = std::cos(qDegreesToRadians(lat));
+    return static_cast<int>(std::floor(2.0 * M_PI / std::acos(1.0 - a / (b * b))));
+}
+
+double modulo(double a, double b) {
+    auto r = std::fmod(a, b);
+    return r < 0.0 ? r + b : r;
+}
+
+const char kCharset[] = "?ABCDEFGHIJKLMNOPQRSTUVWXYZ????? ???????????????0123456789??????";
+
+}
+
+
+void ADSBBeastDecoder::feed(const char *data, size_t length, qint64 now)
+{
+    for (size_t i = 0; i < length; i++) {
+        auto byte = static_cast<uint8_t>(data[i]);
+
+        if (m_escape) {
+            m_escape = false;
+            if (byte != 0x1a) {
+                // a lone 0x1a starts the next frame, whatever was being read is cut short
+                m_state = WaitType;
+            }
+        } else if (byte == 0x1a) {
+            if (m_state == Data) {
+                m_escape = true;
+            } else {
+                m_state = WaitType;
+            }
+            continue;
+        }
+
+        switch (m_state) {
+            case WaitSync:
+                break;
+            case WaitType:
+                m_expected = messageLength(byte);
+                // status frames and anything unknown, wait for the next sync
+                if (m_expected == 0) {
+                    m_state = WaitSync;
+                    break;
+                }
+                m_expected += 7;
+                m_length = 0;
+                m_state = Data;
+                break;
+            case Data:
+                m_frame[m_length++] = byte;
+                if (m_length == m_expected) {
+                    m_state = WaitSync;
+                    message(m_frame + 7, m_expected - 7, now);
+                }
+                break;
+        }
+    }
+}
+
+
+void ADSBBeastDecoder::message(const uint8_t *message, int length, qint64 now)
+{
+    if (length != 14) {
+        return;
+    }
+    m_frames++;
+
+    auto df = message[0] >> 3;
+    auto ca = message[0] & 0x07;
+    // DF18 with CF 0 is an ADS-B message of a transponder-less device with an ICAO address
+    if (df != 17 && !(df == 18 && ca == 0)) {
+        return;
+    }
+
+    auto parity = static_cast<uint32_t>(message[11]) << 16 | static_cast<uint32_t>(message[12]) << 8 | message[13];
+    if (crc(message, length) != parity) {
+        m_bad_frames++;
+        return;
+    }
+
+    auto icao = static_cast<uint32_t>(message[1]) << 16 | static_cast<uint32_t>(message[2]) << 8 | message[3];
+    uint64_t me = 0;
+    for (int i = 4; i < 11; i++) {
+        me = me << 8 | message[i];
+    }
+
+    auto &a = aircraft(icao, now);
+    auto type = static_cast<int>(bits(me, 1, 5));
+    if (type >= 1 && type <= 4) {
+        identification(a, me);
+    } else if ((type >= 9 && type <= 18) || (type >= 20 && type <= 22)) {
+        position(a, me, type, now);
+    } else if (type == 19) {
+        velocity(a, me);
+    }
+}
+
+
+ADSBBeastDecoder::Aircraft &ADSBBeastDecoder::aircraft(uint32_t icao, qint64 now)
+{
+    auto it = m_aircraft.find(icao);
+    if (it == m_aircraft.end()) {
+        it = m_aircraft.insert(icao, Aircraft());
+    }
+    it->seen = now;
+    if (!it->changed) {
+        it->changed = true;
+        m_changed.push_back(icao);
+    }
+    return *it;
+}
+
+
+void ADSBBeastDecoder::identification(Aircraft &aircraft, uint64_t me)
+{
+    int length = 0;
+    for (int i = 0; i < 8; i++) {
+        auto c = kCharset[bits(me, 9 + i * 6, 14 + i * 6)];
+        aircraft.callsign[i] = c;
+        if (c != ' ' && c != '?') {
+            length = i + 1;
+        }
+    }
+    aircraft.callsign_length = length;
+}
+
+
+void ADSBBeastDecoder::velocity(Aircraft &aircraft, uint64_t me)
+{
+    auto subtype = bits(me, 6, 8);
+
+    if (subtype == 1 || subtype == 2) {
+        auto ew = static_cast<int>(bits(me, 15, 24));
+        auto ns = static_cast<int>(bits(me, 26, 35));
+        // 0 is no information, supersonic counts in 4 kt steps
+        if (ew != 0 && ns != 0) {
+            auto scale = subtype == 2 ? 4.0 : 1.0;
+            auto vew = (ew - 1) * scale * (bits(me, 14, 14) ? -1.0 : 1.0);
+            auto vns = (ns - 1) * scale * (bits(me, 25, 25) ? -1.0 : 1.0);
+            aircraft.speed = std::sqrt(vew * vew + vns * vns);
+            aircraft.heading = modulo(qRadiansToDegrees(std::atan2(vew, vns)), 360.0);
+        }
+    } else if (subtype == 3 || subtype == 4) {
+        // airspeed and magnetic heading, close enough for a map
+        if (bits(me, 14, 14)) {
+            aircraft.heading = bits(me, 15, 24) * 360.0 / 1024.0;
+        }
+        auto airspeed = static_cast<int>(bits(me, 26, 35));
+        if (airspeed != 0) {
+            aircraft.speed = (airspeed - 1) * (subtype == 4 ? 4.0 : 1.0);
+        }
+    } else {
+        return;
+    }
+
+    auto rate = static_cast<int>(bits(me, 38, 46));
+    if (rate != 0) {
+        aircraft.vertical_rate = (rate - 1) * 64.0 * (bits(me, 37, 37) ? -1.0 : 1.0);
+    }
+}
+
+
+void ADSBBeastDecoder::position(Aircraft &aircraft, uint64_t me, int type, qint64 now)
+{
+    auto raw = bits(me, 9, 20);
+    if (type >= 20) {
+        // GNSS height, in m
+        aircraft.altitude = raw * 3.28084;
+    } else if (raw & 0x10) {
+        // 25 ft steps with the Q bit taken out, Gillham coded altitudes are left unknown
+        auto n = ((raw & 0xfe0) >> 1) | (raw & 0x0f);
+        aircraft.altitude = n * 25.0 - 1000.0;
+    }
+
+    auto odd = static_cast<int>(bits(me, 22, 22));
+    aircraft.cpr_lat[odd] = static_cast<int>(bits(me, 23, 39));
+    aircraft.cpr_lon[odd] = static_cast<int>(bits(me, 40, 56));
+    aircraft.cpr_time[odd] = now;
+
+    const double scale = 131072.0;
+    auto lat_even = aircraft.cpr_lat[0] / scale;
+    auto lon_even = aircraft.cpr_lon[0] / scale;
+    auto lat_odd = aircraft.cpr_lat[1] / scale;
+    auto lon_odd = aircraft.cpr_lon[1] / scale;
+
+    // relative to the last position, one frame is enough
+    if (aircraft.position_time >= 0 && now - aircraft.position_time < kCprReferenceAge) {
+        auto d_lat = 360.0 / (odd ? 59.0 : 60.0);
+        auto lat_cpr = odd ? lat_odd : lat_even;
+        auto lon_cpr = odd ? lon_odd : lon_even;
+
+        auto j = std::floor(aircraft.lat / d_lat) + std::floor(modulo(aircraft.lat, d_lat) / d_lat - lat_cpr + 0.5);
+        auto lat = d_lat * (j + lat_cpr);
+
+        auto zones = numberOfZones(lat) - odd;
+        auto d_lon = zones > 0 ? 360.0 / zones : 360.0;
+        auto m = std::floor(aircraft.lon / d_lon) + std::floor(modulo(aircraft.lon, d_lon) / d_lon - lon_cpr + 0.5);
+        auto lon = d_lon * (m + lon_cpr);
+
+        if (ADSBJsonParser::distance(aircraft.lat, aircraft.lon, lat, lon) < kCprMaxJump) {
+            aircraft.lat = lat;
+            aircraft.lon = lon;
+            aircraft.position_time = now;
+            return;
+        }
+        // start over from a pair
+        aircraft.position_time = -1;
+    }
+
+    if (aircraft.cpr_time[0] < 0 || aircraft.cpr_time[1] < 0 || std::abs(aircraft.cpr_time[0] - aircraft.cpr_time[1]) > kCprPairAge) {
+        return;
+    }
+
+    auto j = std::floor(59.0 * lat_even - 60.0 * lat_odd + 0.5);
+    auto rlat_even = 360.0 / 60.0 * (modulo(j, 60.0) + lat_even);
+    auto rlat_odd = 360.0 / 59.0 * (modulo(j, 59.0) + lat_odd);
+    if (rlat_even >= 270.0) {
+        rlat_even -= 360.0;
+    }
+    if (rlat_odd >= 270.0) {
+        rlat_odd -= 360.0;
+    }
+
+    // both frames have to be in the same longitude zone band
+    auto zones = numberOfZones(rlat_even);
+    if (zones != numberOfZones(rlat_odd)) {
+        return;
+    }
+
+    auto lat = odd ? rlat_odd : rlat_even;
+    auto ni = qMax(zones - odd, 1);
+    auto m = std::floor(lon_even * (zones - 1) - lon_odd * zones + 0.5);
+    auto lon = 360.0 / ni * (modulo(m, ni) + (odd ? lon_odd : lon_even));
+    if (lon >= 180.0) {
+        lon -= 360.0;
+    }
+
+    aircraft.lat = lat;
+    aircraft.lon = lon;
+    aircraft.position_time = now;
+}
+
+
+void ADSBBeastDecoder::takeUpdates(const ADSBJsonParser::Filter &filter, qint64 now, ADSBVehicle::VehicleList &vehicles)
+{
+    vehicles.clear();
+
+    for (auto icao : m_changed) {
+        auto it = m_aircraft.find(icao);
+        if (it == m_aircraft.end()) {
+            continue;
+        }
+        auto &a = *it;
+        a.changed = false;
+
+        if (a.position_time < 0) {
+            continue;
+        }
+
+        auto distance = ADSBJsonParser::distance(filter.lat, filter.lon, a.lat, a.lon);
+        if (distance > filter.max_distance) {
+            continue;
+        }
+
+        double altitude;
+        if (qIsNaN(a.altitude)) {
+            if (!filter.unknown_zero_alt) {
+                continue;
+            }
+            altitude = 99999.9;
+        } else {
+            // feet to meters
+            altitude = a.altitude * 0.3048;
+            if (altitude < 5 && !filter.unknown_zero_alt) {
+                continue;
+            }
+        }
+
+        vehicles.append(ADSBVehicle::VehicleInfo_t());
+        auto &info = vehicles.last();
+        info.icaoAddress = icao;
+        info.alert = 0;
+        info.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::DistanceAvailable | ADSBVehicle::AltitudeAvailable
+                            | ADSBVehicle::LastContactAvailable;
+        info.location = QGeoCoordinate(a.lat, a.lon);
+        info.distance = distance;
+        info.altitude = altitude;
+        info.lastContact = static_cast<int>((now - a.position_time) / 1000);
+
+        if (a.callsign_length > 0) {
+            info.callsign = QString::fromLatin1(a.callsign, a.callsign_length);
+            info.availableFlags |= ADSBVehicle::CallsignAvailable;
+        }
+        if (!qIsNaN(a.speed)) {
+            // knots to km/h
+            info.velocity = a.speed * 1.852;
+            info.availableFlags |= ADSBVehicle::VelocityAvailable;
+        }
+        if (!qIsNaN(a.heading)) {
+            info.heading = a.heading;
+            info.availableFlags |= ADSBVehicle::HeadingAvailable;
+        }
+        if (!qIsNaN(a.vertical_rate)) {
+            // feet/min to m/s
+            info.verticalVel = a.vertical_rate * 0.00508;
+            info.availableFlags |= ADSBVehicle::VerticalVelAvailable;
+        }
+    }
+    m_changed.clear();
+}
+
+
+void ADSBBeastDecoder::expire(qint64 now)
+{
+    for (auto it = m_aircraft.begin(); it != m_aircraft.end();) {
+        // changed ones are still listed, they go once they were handed out
+        if (!it->changed && now - it->seen > kAircraftAge) {
+            it = m_aircraft.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
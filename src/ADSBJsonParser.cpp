@@ -0,0 +1,449 @@
+#include "ADSBJsonParser.h"
+
+#include <QtMath>
+
+#include <cmath>
+#include <cstring>
+
+#include <nlohmann/json.hpp>
+
+namespace {
+
+enum class Field {
+    None,
+    Hex,
+    Callsign,
+    Lat,
+    Lon,
+    Altitude,
+    Speed,
+    Track,
+    LastContact,
+    VerticalRate
+};
+
+/*
+ * Index of every field in an OpenSky state vector. LastContact is time_position, the
+ * Unix time of the position rather than its age, parse() turns it into one.
+ */
+Field openSkyField(int index) {
+    switch (index) {
+        case 0: return Field::Hex;
+        case 1: return Field::Callsign;
+        case 3: return Field::LastContact;
+        case 5: return Field::Lon;
+        case 6: return Field::Lat;
+        case 7: return Field::Altitude;
+        case 9: return Field::Speed;
+        case 10: return Field::Track;
+        case 11: return Field::VerticalRate;
+        default: return Field::None;
+    }
+}
+
+/*
+ * dump1090-mutability names, and the ones dump1090-fa and readsb replaced them with.
+ * Both carry feet, knots and feet per minute.
+ */
+Field dump1090Field(const std::string &key) {
+    static const struct {
+        const char *key;
+        Field field;
+    } fields[] = {
+        { "hex", Field::Hex },
+        { "flight", Field::Callsign },
+        { "lat", Field::Lat },
+        { "lon", Field::Lon },
+        { "altitude", Field::Altitude },
+        { "alt_baro", Field::Altitude },
+        { "speed", Field::Speed },
+        { "gs", Field::Speed },
+        { "track", Field::Track },
+        { "seen_pos", Field::LastContact },
+        { "vert_rate", Field::VerticalRate },
+        { "baro_rate", Field::VerticalRate }
+    };
+    for (auto &f : fields) {
+        if (key == f.key) {
+            return f.field;
+        }
+    }
+    return Field::None;
+}
+
+
+// one aircraft as it is read, nothing in here allocates
+struct Record {
+    uint32_t icao = 0;
+    bool icao_ok = false;
+
+    char callsign[16] = {};
+    int callsign_length = 0;
+
+    // NaN until the field shows up with a number
+    double lat = qQNaN();
+    double lon = qQNaN();
+    double altitude = qQNaN();
+    double speed = qQNaN();
+    double track = qQNaN();
+    double last_contact = qQNaN();
+    double vertical_rate = qQNaN();
+};
+
+
+bool parseHex(const std::string &hex, uint32_t &value) {
+    if (hex.empty() || hex.size() > 8) {
+        return false;
+    }
+    value = 0;
+    for (auto c : hex) {
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            // dump1090 marks non ICAO addresses with a leading ~
+            return false;
+        }
+        value = value << 4 | digit;
+    }
+    return true;
+}
+
+
+class Handler {
+public:
+    using json = nlohmann::json;
+
+    Handler(ADSBJsonParser::Format format, const ADSBJsonParser::Filter &filter, ADSBVehicle::VehicleList &vehicles)
+        : m_format(format)
+        , m_filter(filter)
+        , m_vehicles(vehicles)
+        , m_list_key(format == ADSBJsonParser::OpenSky ? "states" : "aircraft")
+        , m_time_key(format == ADSBJsonParser::OpenSky ? "time" : "now") {}
+
+    bool ok() const {
+        return m_root_object;
+    }
+
+    int aircraft() const {
+        return m_aircraft;
+    }
+
+    qint64 time() const {
+        return m_time;
+    }
+
+    bool null() {
+        skip();
+        return true;
+    }
+
+    bool boolean(bool) {
+        skip();
+        return true;
+    }
+
+    bool number_integer(json::number_integer_t value) {
+        rootNumber(static_cast<double>(value));
+        number(static_cast<double>(value));
+        return true;
+    }
+
+    bool number_unsigned(json::number_unsigned_t value) {
+        rootNumber(static_cast<double>(value));
+        number(static_cast<double>(value));
+        return true;
+    }
+
+    bool number_float(json::number_float_t value, const json::string_t &) {
+        rootNumber(value);
+        number(value);
+        return true;
+    }
+
+    bool string(json::string_t &value) {
+        if (!inRecordLevel()) {
+            return true;
+        }
+        switch (field()) {
+            case Field::Hex:
+                m_record.icao_ok = parseHex(value, m_record.icao);
+                break;
+            case Field::Callsign: {
+                auto length = qMin<int>(static_cast<int>(value.size()), sizeof(m_record.callsign));
+                // both pad the callsign with spaces
+                while (length > 0 && value[length - 1] == ' ') {
+                    length--;
+                }
+                std::memcpy(m_record.callsign, value.data(), length);
+                m_record.callsign_length = length;
+                break;
+            }
+            case Field::Altitude:
+                // readsb reports "ground" instead of a barometric altitude
+                if (value == "ground") {
+                    m_record.altitude = 0.0;
+                }
+                break;
+            default:
+                break;
+        }
+        next();
+        return true;
+    }
+
+    bool binary(json::binary_t &) {
+        skip();
+        return true;
+    }
+
+    bool start_object(std::size_t) {
+        skip();
+        m_depth++;
+        if (m_depth == 1) {
+            m_root_object = true;
+        } else if (m_format == ADSBJsonParser::Dump1090 && m_list_depth > 0 && m_depth == m_list_depth + 1) {
+            startRecord();
+        }
+        return true;
+    }
+
+    bool key(json::string_t &key) {
+        if (m_depth == 1) {
+            m_list_next = key == m_list_key;
+            m_time_next = key == m_time_key;
+        } else if (m_format == ADSBJsonParser::Dump1090 && inRecordLevel()) {
+            m_key_field = dump1090Field(key);
+        }
+        return true;
+    }
+
+    bool end_object() {
+        if (m_format == ADSBJsonParser::Dump1090 && inRecordLevel()) {
+            endRecord();
+        }
+        m_depth--;
+        return true;
+    }
+
+    bool start_array(std::size_t) {
+        skip();
+        m_depth++;
+        if (m_depth == 2 && m_list_next) {
+            m_list_depth = m_depth;
+            m_list_next = false;
+        } else if (m_format == ADSBJsonParser::OpenSky && m_list_depth > 0 && m_depth == m_list_depth + 1) {
+            startRecord();
+        }
+        return true;
+    }
+
+    bool end_array() {
+        if (m_format == ADSBJsonParser::OpenSky && inRecordLevel()) {
+            endRecord();
+        } else if (m_depth == m_list_depth) {
+            m_list_depth = 0;
+        }
+        m_depth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) {
+        m_root_object = false;
+        return false;
+    }
+
+private:
+    // inside a record and not in something nested in it
+    bool inRecordLevel() const {
+        return m_in_record && m_depth == m_list_depth + 1;
+    }
+
+    Field field() const {
+        return m_format == ADSBJsonParser::OpenSky ? openSkyField(m_index) : m_key_field;
+    }
+
+    // every value at record level moves an OpenSky state vector to its next column
+    void next() {
+        m_index++;
+        m_key_field = Field::None;
+    }
+
+    // a value nothing is read from, nested arrays and objects included, still takes its column
+    void skip() {
+        if (inRecordLevel()) {
+            next();
+        }
+    }
+
+    // the time of the data sits next to the list
+    void rootNumber(double value) {
+        if (m_depth == 1 && m_time_next) {
+            m_time = static_cast<qint64>(value);
+            m_time_next = false;
+        }
+    }
+
+    void number(double value) {
+        if (!inRecordLevel()) {
+            return;
+        }
+        switch (field()) {
+            case Field::Lat: m_record.lat = value; break;
+            case Field::Lon: m_record.lon = value; break;
+            case Field::Altitude: m_record.altitude = value; break;
+            case Field::Speed: m_record.speed = value; break;
+            case Field::Track: m_record.track = value; break;
+            case Field::LastContact: m_record.last_contact = value; break;
+            case Field::VerticalRate: m_record.vertical_rate = value; break;
+            default: break;
+        }
+        next();
+    }
+
+    void startRecord() {
+        m_record = Record();
+        m_in_record = true;
+        m_index = 0;
+        m_key_field = Field::None;
+    }
+
+    void endRecord() {
+        m_in_record = false;
+        m_aircraft++;
+
+        auto &r = m_record;
+        if (!r.icao_ok || qIsNaN(r.lat) || qIsNaN(r.lon)) {
+            return;
+        }
+
+        auto distance = ADSBJsonParser::distance(m_filter.lat, m_filter.lon, r.lat, r.lon);
+        if (distance > m_filter.max_distance) {
+            return;
+        }
+
+        auto opensky = m_format == ADSBJsonParser::OpenSky;
+
+        double altitude;
+        if (qIsNaN(r.altitude)) {
+            if (!m_filter.unknown_zero_alt) {
+                return;
+            }
+            altitude = 99999.9;
+        } else {
+            // feet to meters
+            altitude = opensky ? r.altitude : static_cast<int>(r.altitude) * 0.3048;
+            if (altitude < 5 && !m_filter.unknown_zero_alt) {
+                return;
+            }
+        }
+
+        // only now that the aircraft is kept does it cost an allocation
+        m_vehicles.append(ADSBVehicle::VehicleInfo_t());
+        auto &info = m_vehicles.last();
+        info.icaoAddress = r.icao;
+        info.alert = 0;
+        info.availableFlags = ADSBVehicle::LocationAvailable | ADSBVehicle::DistanceAvailable | ADSBVehicle::AltitudeAvailable
+                            | ADSBVehicle::VelocityAvailable | ADSBVehicle::HeadingAvailable | ADSBVehicle::LastContactAvailable
+                            | ADSBVehicle::VerticalVelAvailable;
+
+        info.location = QGeoCoordinate(r.lat, r.lon);
+        info.distance = distance;
+        info.altitude = altitude;
+
+        if (r.callsign_length > 0) {
+            info.callsign = QString::fromLatin1(r.callsign, r.callsign_length);
+            info.availableFlags |= ADSBVehicle::CallsignAvailable;
+        } else {
+            info.callsign = QStringLiteral("N/A");
+            // OpenSky always said it had one
+            if (opensky) {
+                info.availableFlags |= ADSBVehicle::CallsignAvailable;
+            }
+        }
+
+        if (qIsNaN(r.speed)) {
+            info.velocity = 99999.9;
+        } else {
+            // m/s or knots to km/h
+            info.velocity = opensky ? r.speed * 3.6 : std::round(r.speed * 1.852);
+        }
+
+        info.heading = qIsNaN(r.track) ? 0.0 : r.track;
+        info.lastContact = qIsNaN(r.last_contact) ? 0 : static_cast<int>(r.last_contact);
+
+        if (qIsNaN(r.vertical_rate)) {
+            info.verticalVel = 0.0;
+        } else {
+            // feet/min to m/s
+            info.verticalVel = opensky ? r.vertical_rate : std::round(r.vertical_rate * 0.00508);
+        }
+    }
+
+    ADSBJsonParser::Format m_format;
+    const ADSBJsonParser::Filter &m_filter;
+    ADSBVehicle::VehicleList &m_vehicles;
+    const char *m_list_key;
+    const char *m_time_key;
+
+    int m_depth = 0;
+    bool m_root_object = false;
+
+    // the list key was just read, the array after it is the list
+    bool m_list_next = false;
+    int m_list_depth = 0;
+
+    bool m_in_record = false;
+    Record m_record;
+    int m_index = 0;
+    Field m_key_field = Field::None;
+
+    int m_aircraft = 0;
+
+    bool m_time_next = false;
+    qint64 m_time = 0;
+};
+
+}
+
+
+ADSBJsonParser::Result ADSBJsonParser::parse(Format format, const char *data, size_t length, const Filter &filter, ADSBVehicle::VehicleList &vehicles)
+{
+    vehicles.clear();
+
+    Handler handler(format, filter, vehicles);
+    auto parsed = nlohmann::json::sax_parse(data, data + length, &handler);
+
+    Result result;
+    result.ok = parsed && handler.ok();
+    result.aircraft = handler.aircraft();
+    result.time = handler.time();
+
+    // the reply's time can come after the states, so only now are they ages like dump1090's seen_pos
+    if (format == OpenSky) {
+        for (auto &info : vehicles) {
+            if (info.lastContact > 0) {
+                info.lastContact = result.time > 0 ? static_cast<int>(qMax<qint64>(0, result.time - info.lastContact)) : 0;
+            }
+        }
+    }
+    return result;
+}
+
+
+double ADSBJsonParser::distance(double lat_1, double lon_1, double lat_2, double lon_2)
+{
+    double latDistance = qDegreesToRadians(lat_1 - lat_2);
+    double lngDistance = qDegreesToRadians(lon_1 - lon_2);
+
+    double a = qSin(latDistance / 2) * qSin(latDistance / 2)
+            + qCos(qDegreesToRadians(lat_1)) * qCos(qDegreesToRadians(lat_2))
+            * qSin(lngDistance / 2) * qSin(lngDistance / 2);
+
+    double c = 2 * qAtan2(qSqrt(a), qSqrt(1 - a));
+    return 6371 * c;
+}
@@ -0,0 +1,286 @@
+#include "ADSBTrafficEngine.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+constexpr double kEarthRadius = 6371000.0;
+
+// the parsers use this for an unknown altitude
+constexpr double kUnknownAltitude = 99999.0;
+
+// box lookups covering more cells than this walk the table instead
+constexpr int kMaxQueryCells = 4096;
+
+/*
+ * Threat thresholds, in m and s. A contact is a threat when it is close now, or when it
+ * will pass close within the look ahead. Contacts without an altitude can't be separated
+ * vertically and never go past an advisory.
+ */
+constexpr double kWarningVertical = 300.0;
+constexpr double kWarningDistance = 2000.0;
+constexpr double kWarningCpa = 1000.0;
+constexpr double kWarningLookAhead = 60.0;
+
+constexpr double kAdvisoryVertical = 500.0;
+constexpr double kAdvisoryDistance = 5000.0;
+constexpr double kAdvisoryCpa = 2000.0;
+constexpr double kAdvisoryLookAhead = 120.0;
+
+
+qint64 ADSBTrafficEngine::cell(double lat, double lon)
+{
+    auto row = static_cast<qint64>(std::floor(lat / kCellSize));
+    auto column = static_cast<qint64>(std::floor(lon / kCellSize));
+    return static_cast<qint64>(static_cast<quint64>(row) << 32 | (static_cast<quint64>(column) & 0xffffffff));
+}
+
+
+void ADSBTrafficEngine::unfile(int slot)
+{
+    auto it = m_cells.find(m_cell[slot]);
+    if (it == m_cells.end()) {
+        return;
+    }
+    auto &slots = *it;
+    auto found = std::find(slots.begin(), slots.end(), slot);
+    if (found != slots.end()) {
+        *found = slots.back();
+        slots.pop_back();
+    }
+    if (slots.empty()) {
+        m_cells.erase(it);
+    }
+}
+
+
+void ADSBTrafficEngine::update(const ADSBVehicle::VehicleInfo_t &info)
+{
+    if (!(info.availableFlags & ADSBVehicle::LocationAvailable)) {
+        return;
+    }
+
+    auto slot = m_index.value(info.icaoAddress, -1);
+    auto fresh = slot < 0;
+    if (fresh) {
+        if (!m_free.empty()) {
+            slot = m_free.back();
+            m_free.pop_back();
+        } else {
+            slot = static_cast<int>(m_icao.size());
+            m_icao.push_back(0);
+            m_used.push_back(0);
+            m_cell.push_back(0);
+            m_lat.push_back(0.0);
+            m_lon.push_back(0.0);
+            m_alt.push_back(0.0);
+            m_alt_known.push_back(0);
+            m_vn.push_back(0.0);
+            m_ve.push_back(0.0);
+            m_vu.push_back(0.0);
+            m_distance.push_back(0.0);
+            m_bearing.push_back(0.0);
+            m_closure.push_back(0.0);
+            m_tcpa.push_back(0.0);
+            m_dcpa.push_back(0.0);
+            m_threat.push_back(ThreatNone);
+            m_alerted.push_back(ThreatNone);
+            m_alert_time.push_back(0);
+        }
+        m_index.insert(info.icaoAddress, slot);
+        m_icao[slot] = info.icaoAddress;
+        m_used[slot] = 1;
+        m_alt_known[slot] = 0;
+        m_vn[slot] = 0.0;
+        m_ve[slot] = 0.0;
+        m_vu[slot] = 0.0;
+        m_threat[slot] = ThreatNone;
+        m_alerted[slot] = ThreatNone;
+        m_alert_time[slot] = 0;
+    }
+
+    auto lat = info.location.latitude();
+    auto lon = info.location.longitude();
+    auto c = cell(lat, lon);
+    if (fresh || c != m_cell[slot]) {
+        if (!fresh) {
+            unfile(slot);
+        }
+        m_cell[slot] = c;
+        m_cells[c].push_back(slot);
+    }
+    m_lat[slot] = lat;
+    m_lon[slot] = lon;
+
+    if (info.availableFlags & ADSBVehicle::AltitudeAvailable) {
+        m_alt[slot] = info.altitude;
+        m_alt_known[slot] = info.altitude < kUnknownAltitude;
+    }
+
+    // velocity comes in km/h, and as 99999.9 when unknown
+    if ((info.availableFlags & ADSBVehicle::VelocityAvailable) && info.velocity < kUnknownAltitude) {
+        auto speed = info.velocity / 3.6;
+        auto heading = (info.availableFlags & ADSBVehicle::HeadingAvailable) ? qDegreesToRadians(info.heading) : 0.0;
+        m_vn[slot] = speed * std::cos(heading);
+        m_ve[slot] = speed * std::sin(heading);
+    }
+    if (info.availableFlags & ADSBVehicle::VerticalVelAvailable) {
+        m_vu[slot] = info.verticalVel;
+    }
+}
+
+
+void ADSBTrafficEngine::remove(uint32_t icao)
+{
+    auto it = m_index.find(icao);
+    if (it == m_index.end()) {
+        return;
+    }
+    auto slot = *it;
+    m_index.erase(it);
+    unfile(slot);
+    m_used[slot] = 0;
+    m_threat[slot] = ThreatNone;
+    m_free.push_back(slot);
+}
+
+
+void ADSBTrafficEngine::clear()
+{
+    m_index.clear();
+    m_cells.clear();
+    m_free.clear();
+    for (int slot = static_cast<int>(m_used.size()) - 1; slot >= 0; slot--) {
+        m_used[slot] = 0;
+        m_threat[slot] = ThreatNone;
+        m_free.push_back(slot);
+    }
+    m_highest_threat = ThreatNone;
+}
+
+
+void ADSBTrafficEngine::evaluate(const Ownship &ownship, qint64 now, std::vector<Alert> &alerts)
+{
+    alerts.clear();
+
+    auto count = static_cast<int>(m_icao.size());
+    auto lat0 = qDegreesToRadians(ownship.lat);
+    auto lon0 = qDegreesToRadians(ownship.lon);
+    auto east_scale = kEarthRadius * std::cos(lat0);
+
+    for (int i = 0; i < count; i++) {
+        // position and velocity of the contact relative to the drone
+        auto n = (qDegreesToRadians(m_lat[i]) - lat0) * kEarthRadius;
+        auto e = (qDegreesToRadians(m_lon[i]) - lon0) * east_scale;
+        auto vn = m_vn[i] - ownship.vn;
+        auto ve = m_ve[i] - ownship.ve;
+
+        auto distance = std::sqrt(n * n + e * e);
+        auto bearing = qRadiansToDegrees(std::atan2(e, n));
+        m_distance[i] = distance;
+        m_bearing[i] = bearing < 0.0 ? bearing + 360.0 : bearing;
+
+        auto along = n * vn + e * ve;
+        m_closure[i] = distance > 1.0 ? -along / distance : 0.0;
+
+        auto speed2 = vn * vn + ve * ve;
+        auto tcpa = speed2 > 0.01 ? -along / speed2 : 0.0;
+        m_tcpa[i] = tcpa;
+        auto t = tcpa > 0.0 ? tcpa : 0.0;
+        auto cn = n + vn * t;
+        auto ce = e + ve * t;
+        m_dcpa[i] = std::sqrt(cn * cn + ce * ce);
+    }
+
+    m_highest_threat = ThreatNone;
+    for (int i = 0; i < count; i++) {
+        if (!m_used[i]) {
+            continue;
+        }
+
+        auto known = m_alt_known[i] != 0;
+        auto dz = m_alt[i] - ownship.alt;
+        auto dz_cpa = dz + (m_vu[i] - ownship.vu) * qMax(m_tcpa[i], 0.0);
+
+        auto within = [&](double vertical, double distance, double cpa, double look_ahead) {
+            // both now and at the closest point, and not crossing levels in between
+            auto separated = known && std::fabs(dz) >= vertical && std::fabs(dz_cpa) >= vertical && dz * dz_cpa > 0.0;
+            if (separated) {
+                return false;
+            }
+            if (m_distance[i] < distance) {
+                return true;
+            }
+            return m_tcpa[i] > 0.0 && m_tcpa[i] < look_ahead && m_dcpa[i] < cpa;
+        };
+
+        int threat = ThreatNone;
+        if (known && within(kWarningVertical, kWarningDistance, kWarningCpa, kWarningLookAhead)) {
+            threat = ThreatWarning;
+        } else if (within(kAdvisoryVertical, kAdvisoryDistance, kAdvisoryCpa, kAdvisoryLookAhead)) {
+            threat = ThreatAdvisory;
+        }
+        m_threat[i] = threat;
+        m_highest_threat = qMax(m_highest_threat, threat);
+
+        auto since = now - m_alert_time[i];
+        if (threat > m_alerted[i] || (threat != ThreatNone && threat == m_alerted[i] && since > kAlertRepeat)) {
+            m_alerted[i] = threat;
+            m_alert_time[i] = now;
+            alerts.push_back({ m_icao[i], threat, m_distance[i], m_bearing[i], m_tcpa[i] });
+        } else if (threat < m_alerted[i] && since > kAlertHold) {
+            // only once it stayed lower for a while, so a contact on the edge doesn't alert every pass
+            m_alerted[i] = threat;
+        }
+    }
+}
+
+
+void ADSBTrafficEngine::query(double south, double west, double north, double east, std::vector<int> &slots) const
+{
+    // across the antimeridian, as the boxes either side of it
+    if (west > east) {
+        std::vector<int> east_side;
+        query(south, west, north, 180.0, slots);
+        query(south, -180.0, north, east, east_side);
+        slots.insert(slots.end(), east_side.begin(), east_side.end());
+        return;
+    }
+
+    slots.clear();
+
+    auto inside = [&](int slot) {
+        return m_lat[slot] >= south && m_lat[slot] <= north && m_lon[slot] >= west && m_lon[slot] <= east;
+    };
+
+    auto first_row = static_cast<qint64>(std::floor(south / kCellSize));
+    auto last_row = static_cast<qint64>(std::floor(north / kCellSize));
+    auto first_column = static_cast<qint64>(std::floor(west / kCellSize));
+    auto last_column = static_cast<qint64>(std::floor(east / kCellSize));
+    auto cells = (last_row - first_row + 1) * (last_column - first_column + 1);
+
+    // bigger than the table is worth indexing
+    if (cells > kMaxQueryCells || cells > m_cells.size()) {
+        for (auto slot : m_index) {
+            if (inside(slot)) {
+                slots.push_back(slot);
+            }
+        }
+        return;
+    }
+
+    for (auto row = first_row; row <= last_row; row++) {
+        for (auto column = first_column; column <= last_column; column++) {
+            auto it = m_cells.constFind(static_cast<qint64>(static_cast<quint64>(row) << 32 | (static_cast<quint64>(column) & 0xffffffff)));
+            if (it == m_cells.constEnd()) {
+                continue;
+            }
+            for (auto slot : *it) {
+                if (inside(slot)) {
+                    slots.push_back(slot);
+                }
+            }
+        }
+    }
+}
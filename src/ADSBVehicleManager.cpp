@@ -12,9 +12,13 @@
 #include "logger.h"
 #include "openhd.h"
 #include "mavlinktelemetry.h"
+#include "trace.h"
 
 #include <QDebug>
 
+#include <algorithm>
+#include <cmath>
+
 static ADSBVehicleManager* _instance = nullptr;
 
 ADSBVehicleManager* ADSBVehicleManager::instance() 
@@ -48,13 +52,26 @@ void ADSBVehicleManager::onStarted()
     _adsbVehicleCleanupTimer.setSingleShot(false);
     _adsbVehicleCleanupTimer.start(4500);
 
+    connect(&_trafficTimer, &QTimer::timeout, this, &ADSBVehicleManager::_evaluateTraffic);
+    _traffic_clock.start();
+    _trafficTimer.start(1000);
+
+    // one timer moves every marker on screen between reports
+    connect(&_motionTimer, &QTimer::timeout, this, &ADSBVehicleManager::_moveVehicles);
+    _motionTimer.start(50);
+
+    // MAVLink sends one contact per message, whatever arrives within 100ms is applied together
+    connect(&_incomingTimer, &QTimer::timeout, this, &ADSBVehicleManager::_flushIncoming);
+    _incomingTimer.setSingleShot(true);
+    _incomingTimer.setInterval(100);
+
     _internetLink = new ADSBInternet();
-    connect(_internetLink, &ADSBInternet::adsbVehicleUpdate, this, &ADSBVehicleManager::adsbVehicleUpdate, Qt::QueuedConnection);
+    connect(_internetLink, &ADSBInternet::adsbSnapshot, this, &ADSBVehicleManager::adsbSnapshot, Qt::QueuedConnection);
     connect(this, &ADSBVehicleManager::mapCenterChanged, _internetLink, &ADSBInternet::mapBoundsChanged, Qt::QueuedConnection);
     connect(_internetLink, &ADSBInternet::adsbClearModelRequest, this, &ADSBVehicleManager::adsbClearModel, Qt::QueuedConnection);
     
     _sdrLink = new ADSBSdr();
-    connect(_sdrLink, &ADSBSdr::adsbVehicleUpdate, this, &ADSBVehicleManager::adsbVehicleUpdate, Qt::QueuedConnection);
+    connect(_sdrLink, &ADSBSdr::adsbSnapshot, this, &ADSBVehicleManager::adsbSnapshot, Qt::QueuedConnection);
     connect(this, &ADSBVehicleManager::mapCenterChanged, _sdrLink, &ADSBSdr::mapBoundsChanged, Qt::QueuedConnection);
     connect(_sdrLink, &ADSBSdr::adsbClearModelRequest, this, &ADSBVehicleManager::adsbClearModel, Qt::QueuedConnection);
 }
@@ -67,16 +84,17 @@ void ADSBVehicleManager::newMapCenter(QGeoCoordinate center_coord) {
 
 void ADSBVehicleManager::_cleanupStaleVehicles()
 {
+    // contacts off screen get their coalesced update before they are judged
+    _flushPending(true);
+
     // Remove all expired ADSB vehicles
-    for (int i=_adsbVehicles.count()-1; i>=0; i--) {
-        ADSBVehicle* adsbVehicle = _adsbVehicles.value<ADSBVehicle*>(i);
-        if (adsbVehicle->expired()) {
-            // qDebug() << "Expired" << QStringLiteral("%1").arg(adsbVehicle->icaoAddress(), 0, 16);
-            _adsbVehicles.removeAt(i);
-            _adsbICAOMap.remove(adsbVehicle->icaoAddress());
-            adsbVehicle->deleteLater();
-        }
+    _adsbVehicles.removeExpired(_expired);
+    for (auto icao : _expired) {
+        // qDebug() << "Expired" << QStringLiteral("%1").arg(icao, 0, 16);
+        _traffic.remove(icao);
+        _pending.remove(icao);
     }
+
     // if more than 20 seconds with with no updates, set frontend indicator red
     // if more than 60 seconds with no updates deactivate frontend indicator
     if (_last_update_timer.elapsed() > 60000) {
@@ -92,54 +110,198 @@ void ADSBVehicleManager::_cleanupStaleVehicles()
 //currently not used.. was for testing but could have future purpose to turn off display
 void ADSBVehicleManager::adsbClearModel(){
     //qDebug() << "_adsbVehicles.clearAndDeleteContents";
-    _adsbVehicles.clearAndDeleteContents();
+    _adsbVehicles.clear();
+    _traffic.clear();
+    _pending.clear();
+    _incoming.clear();
 }
 
 void ADSBVehicleManager::adsbVehicleUpdate(const ADSBVehicle::VehicleInfo_t vehicleInfo)
 {
-    uint32_t icaoAddress = vehicleInfo.icaoAddress;
+    _incoming.append(vehicleInfo);
+    if (!_incomingTimer.isActive()) {
+        _incomingTimer.start();
+    }
+}
+
+void ADSBVehicleManager::_flushIncoming()
+{
+    adsbSnapshot(_incoming);
+    _incoming.clear();
+}
+
+void ADSBVehicleManager::adsbSnapshot(const ADSBVehicle::VehicleList &vehicles)
+{
+    TRACE_SCOPE("adsb.adsbSnapshot");
 
-    //no point in continuing because no location. This is somewhat redundant with parser
-    //possible situation where we start to not get location.. and gets stale then removed
-    if (vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable) {
+    _added.clear();
 
-        //decide if its new or needs update
-        if (_adsbICAOMap.contains(icaoAddress)) {
-            _adsbICAOMap[icaoAddress]->update(vehicleInfo);
+    for (const auto &vehicleInfo : vehicles) {
+        //no point in continuing because no location. This is somewhat redundant with parser
+        //possible situation where we start to not get location.. and gets stale then removed
+        if (!(vehicleInfo.availableFlags & ADSBVehicle::LocationAvailable)) {
+            continue;
         }
-        else {
 
-            ADSBVehicle* adsbVehicle = new ADSBVehicle(vehicleInfo, this);
-            _adsbICAOMap[icaoAddress] = adsbVehicle;
-            _adsbVehicles.append(adsbVehicle);
+        uint32_t icaoAddress = vehicleInfo.icaoAddress;
+        _traffic.update(vehicleInfo);
+
+        //decide if its new or needs update
+        if (!_adsbVehicles.contains(icaoAddress)) {
+            _added.append(vehicleInfo);
+        } else if (_inViewport(vehicleInfo.location) || _inViewport(_adsbVehicles.coordinate(icaoAddress))) {
+            _pending.remove(icaoAddress);
+            _applyUpdate(vehicleInfo);
+        } else {
+            // only the latest update matters, earlier ones are simply replaced
+            _pending.insert(icaoAddress, vehicleInfo);
         }
+    }
 
-        // Show warnings if adsb reported traffic is too close
-        _evaluateTraffic(vehicleInfo.altitude, vehicleInfo.distance);
+    // every new contact of the snapshot goes into the model in one insertion
+    _adsbVehicles.append(_added);
+    _adsbVehicles.flush();
 
+    if (!vehicles.isEmpty()) {
         _last_update_timer.restart();
-        _status = 2;
-        emit statusChanged();
+        if (_status != 2) {
+            _status = 2;
+            emit statusChanged();
+        }
     }
 }
 
-void ADSBVehicleManager::_evaluateTraffic(double traffic_alt, int traffic_distance) 
+void ADSBVehicleManager::_applyUpdate(const ADSBVehicle::VehicleInfo_t &info)
 {
-    /*
-     * Centralise traffic threat detection here. Once threat is detected it should be
-     * labled and then sent over to the adsb widget
-     *
-     *  need to calculate azimuth and bearing of any threats so that it can be shared
-     *  and depicted in the adsb widget
-     */
-    int drone_alt = OpenHD::instance()->get_msl_alt();
+    if (_has_ownship && (info.availableFlags & ADSBVehicle::DistanceAvailable)) {
+        // the parsers measure from the map center, the traffic evaluation from the drone
+        auto copy = info;
+        copy.availableFlags &= ~ADSBVehicle::DistanceAvailable;
+        _adsbVehicles.update(copy);
+    } else {
+        _adsbVehicles.update(info);
+    }
+}
 
-    if (traffic_alt - drone_alt < 300 && traffic_distance < 2) {
-        LocalMessage::instance()->showMessage("Aircraft Traffic", 3);
+bool ADSBVehicleManager::_inViewport(const QGeoCoordinate &coordinate) const
+{
+    // until the map says what it shows, everything counts as visible
+    return !_viewport.isValid() || _viewport.contains(coordinate);
+}
 
-    } else if (traffic_alt - drone_alt < 500 && traffic_distance < 5) {
-        LocalMessage::instance()->showMessage("Aircraft Traffic", 4);
+void ADSBVehicleManager::_flushPending(bool all)
+{
+    for (auto it = _pending.begin(); it != _pending.end();) {
+        if (!_adsbVehicles.contains(it.key())) {
+            it = _pending.erase(it);
+            continue;
+        }
+        if (all || _inViewport(it.value().location)) {
+            _applyUpdate(it.value());
+            it = _pending.erase(it);
+        } else {
+            ++it;
+        }
     }
+    _adsbVehicles.flush();
+}
+
+void ADSBVehicleManager::_moveVehicles()
+{
+    if (_adsbVehicles.count() == 0) {
+        return;
+    }
+    TRACE_SCOPE("adsb.moveVehicles");
+    _adsbVehicles.extrapolate(_viewport);
+}
+
+void ADSBVehicleManager::setViewport(const QGeoRectangle &viewport)
+{
+    _viewport = viewport;
+    // whatever just came into view shouldn't wait for the next batch
+    _flushPending(false);
+}
+
+void ADSBVehicleManager::_evaluateTraffic()
+{
+    TRACE_SCOPE("adsb.evaluateTraffic");
+
+    auto openhd = OpenHD::instance();
+
+    // without a position for the drone there is nothing to measure against
+    _has_ownship = openhd->get_lat() != 0.0 || openhd->get_lon() != 0.0;
+    if (!_has_ownship) {
+        return;
+    }
+
+    ADSBTrafficEngine::Ownship ownship;
+    ownship.lat = openhd->get_lat();
+    ownship.lon = openhd->get_lon();
+    ownship.alt = openhd->get_msl_alt();
+    ownship.vn = openhd->get_vx();
+    ownship.ve = openhd->get_vy();
+    ownship.vu = -openhd->get_vz();
+
+    _traffic.evaluate(ownship, _traffic_clock.elapsed(), _alerts);
+
+    // the vehicles show the threat and the distance from the drone, in km like the parsers
+    for (int row = 0; row < _adsbVehicles.count(); row++) {
+        auto icao = _adsbVehicles.icaoAddress(row);
+        auto slot = _traffic.slot(icao);
+        if (slot < 0) {
+            continue;
+        }
+        ADSBVehicle::VehicleInfo_t info {};
+        info.icaoAddress = icao;
+        info.alert = _traffic.threat(slot);
+        info.distance = _traffic.distance(slot) / 1000.0;
+        info.availableFlags = ADSBVehicle::AlertAvailable | ADSBVehicle::DistanceAvailable;
+        _adsbVehicles.update(info);
+    }
+    _adsbVehicles.flush();
+
+    for (auto &alert : _alerts) {
+        auto callsign = _adsbVehicles.callsign(alert.icao);
+        if (callsign.isEmpty()) {
+            callsign = QString::number(alert.icao, 16);
+        }
+        auto message = QString("Aircraft Traffic %1 %2km %3%4").arg(callsign).arg(alert.distance / 1000.0, 0, 'f', 1).arg(qRound(alert.bearing)).arg(QChar(0x00B0));
+        LocalMessage::instance()->showMessage(message, alert.threat == ADSBTrafficEngine::ThreatWarning ? 3 : 4);
+    }
+
+    emit trafficChanged();
+}
+
+QVariantList ADSBVehicleManager::trafficInBox(const QGeoRectangle &box)
+{
+    QVariantList traffic;
+    if (!box.isValid()) {
+        return traffic;
+    }
+
+    _traffic.query(box.bottomLeft().latitude(), box.bottomLeft().longitude(), box.topRight().latitude(), box.topRight().longitude(), _query);
+    std::sort(_query.begin(), _query.end(), [this](int a, int b) {
+        return _traffic.distance(a) < _traffic.distance(b);
+    });
+
+    traffic.reserve(static_cast<int>(_query.size()));
+    for (auto slot : _query) {
+        auto icao = _traffic.icao(slot);
+
+        QVariantMap contact;
+        contact["icao"] = icao;
+        contact["callsign"] = _adsbVehicles.callsign(icao);
+        contact["lat"] = _traffic.lat(slot);
+        contact["lon"] = _traffic.lon(slot);
+        contact["altitude"] = _traffic.altitude(slot);
+        contact["distance"] = _traffic.distance(slot);
+        contact["bearing"] = _traffic.bearing(slot);
+        contact["closure"] = _traffic.closure(slot);
+        contact["tcpa"] = _traffic.tcpa(slot);
+        contact["threat"] = _traffic.threat(slot);
+        traffic.append(contact);
+    }
+    return traffic;
 }
 
 ADSBapi::ADSBapi()
@@ -195,6 +357,105 @@ void ADSBapi::mapBoundsChanged(QGeoCoordinate center_coord) {
     lowerr_lon= QString::number(qgeo_lower_right.longitude());
 }
 
+ADSBJsonParser::Filter ADSBapi::filter() const {
+    ADSBJsonParser::Filter filter;
+    filter.lat = _api_center_coord.latitude();
+    filter.lon = _api_center_coord.longitude();
+    filter.max_distance = max_distance;
+    filter.unknown_zero_alt = unknown_zero_alt;
+    return filter;
+}
+
+ADSBInternet::ADSBInternet()
+{
+    // a tick, requests go out when they are due
+    timer_interval = 1000;
+}
+
+ADSBInternet::Box ADSBInternet::_wantedBox() const {
+    Box box;
+    box.south = static_cast<int>(std::floor(lowerr_lat.toDouble() / kTileSize));
+    box.north = static_cast<int>(std::floor(upperl_lat.toDouble() / kTileSize));
+    // 180 itself is the east edge of the last column
+    box.west = qMin(static_cast<int>(std::floor(upperl_lon.toDouble() / kTileSize)), kLastColumn);
+    box.east = qMin(static_cast<int>(std::floor(lowerr_lon.toDouble() / kTileSize)), kLastColumn);
+    return box;
+}
+
+int ADSBInternet::_split(const Box &box, Box parts[2]) const {
+    parts[0] = box;
+    if (box.west <= box.east) {
+        return 1;
+    }
+    parts[1] = box;
+    parts[0].east = kLastColumn;
+    parts[1].west = kFirstColumn;
+    return 2;
+}
+
+bool ADSBInternet::_covered(const Box &box, qint64 now) const {
+    // every tile has to be in a reply that is still fresh
+    for (int row = box.south; row <= box.north; row++) {
+        for (int column = box.west; column <= box.east; column++) {
+            auto covered = std::any_of(_cache.cbegin(), _cache.cend(), [&](const CacheEntry &entry) {
+                return now - entry.fetched < _interval && entry.box.contains(row, column);
+            });
+            if (!covered) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+ADSBInternet::CacheEntry *ADSBInternet::_cached(const Box &box) {
+    for (auto &entry : _cache) {
+        if (entry.box == box) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool ADSBInternet::_fromCache(const Box &box) {
+    auto now = _clock.elapsed();
+
+    Box parts[2];
+    auto count = _split(box, parts);
+    for (int i = 0; i < count; i++) {
+        if (!_covered(parts[i], now)) {
+            return false;
+        }
+    }
+
+    // oldest first, so a newer reply wins for an aircraft in both
+    _merged.clear();
+    _merged_index.clear();
+    for (const auto &entry : _cache) {
+        auto overlaps = entry.box.overlaps(parts[0]) || (count == 2 && entry.box.overlaps(parts[1]));
+        if (now - entry.fetched >= _interval || !overlaps) {
+            continue;
+        }
+        ADSBJsonParser::parse(ADSBJsonParser::OpenSky, entry.data.constData(), entry.data.size(), filter(), _vehicles);
+        for (const auto &info : _vehicles) {
+            auto index = _merged_index.value(info.icaoAddress, -1);
+            if (index < 0) {
+                _merged_index.insert(info.icaoAddress, _merged.size());
+                _merged.append(info);
+            } else {
+                _merged[index] = info;
+            }
+        }
+    }
+    _emit(_merged);
+    return true;
+}
+
+void ADSBInternet::_emit(const ADSBVehicle::VehicleList &vehicles) {
+    // this is received on the adsbSnapshot slot
+    emit adsbSnapshot(vehicles);
+}
+
 void ADSBInternet::requestData(void) {
     _adsb_api_openskynetwork = _settings.value("adsb_api_openskynetwork").toBool();
     _show_adsb_internet = _settings.value("show_adsb").toBool();
@@ -204,183 +465,151 @@ void ADSBInternet::requestData(void) {
         return;
     }
 
-    adsb_url= "https://opensky-network.org/api/states/all?lamin="+lowerr_lat+"&lomin="+upperl_lon+"&lamax="+upperl_lat+"&lomax="+lowerr_lon;
+    max_distance=(_settings.value("adsb_distance_limit").toInt())/1000.0;
+    unknown_zero_alt=_settings.value("adsb_show_unknown_or_zero_alt").toBool();
+
+    if (!_clock.isValid()) {
+        _clock.start();
+    }
+    auto now = _clock.elapsed();
+    auto box = _wantedBox();
+
+    // the map moved onto tiles fetched a moment ago
+    if (!(box == _shown) && _fromCache(box)) {
+        _shown = box;
+        return;
+    }
+
+    if (_in_flight || now < _next_request) {
+        return;
+    }
+
+    // across the antimeridian, the side that isn't covered yet
+    Box parts[2];
+    if (_split(box, parts) == 2 && _covered(parts[0], now)) {
+        box = parts[1];
+    } else {
+        box = parts[0];
+    }
+
+    auto url = _settings.value("adsb_opensky_url", "https://opensky-network.org/api/states/all").toString();
+    adsb_url = url + "?lamin=" + QString::number(box.south * kTileSize) + "&lomin=" + QString::number(box.west * kTileSize)
+             + "&lamax=" + QString::number((box.north + 1) * kTileSize) + "&lomax=" + QString::number((box.east + 1) * kTileSize);
 
     QNetworkRequest request;
     QUrl api_request = adsb_url;
     request.setUrl(api_request);
     request.setRawHeader("User-Agent", "MyOwnBrowser 1.0");
 
+    // same box as before, the server may answer 304 without a body
+    auto cached = _cached(box);
+    if (cached != nullptr) {
+        if (!cached->etag.isEmpty()) {
+            request.setRawHeader("If-None-Match", cached->etag);
+        }
+        if (!cached->last_modified.isEmpty()) {
+            request.setRawHeader("If-Modified-Since", cached->last_modified);
+        }
+    }
+
     // qDebug() << "url=" << api_request;
+    // the manager lives as long as the thread and keeps the connection to the server open
     m_manager->get(request);
+    _in_flight = true;
+    _requested = box;
 }
 
 void ADSBInternet::processReply(QNetworkReply *reply) {
+    _in_flight = false;
 
     if (!_adsb_api_openskynetwork || !_show_adsb_internet) {
-        return;
-    }
-
-    max_distance=(_settings.value("adsb_distance_limit").toInt())/1000;
-    unknown_zero_alt=_settings.value("adsb_show_unknown_or_zero_alt").toBool();
-
-    //qDebug() << "MAX adsb distance=" << max_distance;
-
-    if (reply->error()) {
-        qDebug() << "ADSB OpenSky request error!";
-        qDebug() << reply->errorString();
-        LocalMessage::instance()->showMessage("ADSB OpenSky Reply Error", 4);
         reply->deleteLater();
         return;
     }
 
-    QJsonParseError errorPtr;
-    QByteArray data = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data, &errorPtr);
+    auto now = _clock.elapsed();
+    auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
 
-    if (doc.isNull()) {
-        qDebug() << "ADSB Opensky network response: Parse failed";
-        LocalMessage::instance()->showMessage("ADSB OpenSky Parse Error", 4);
+    if (status == 429) {
+        // out of credits, wait as long as it says or twice as long as last time
+        auto retry = reply->rawHeader("X-Rate-Limit-Retry-After-Seconds").toLongLong() * 1000;
+        _interval = qMin(qMax(_interval * 2, retry), kMaxBackoff);
+        _next_request = now + _interval;
+        qDebug() << "ADSB OpenSky rate limited, next request in" << _interval / 1000 << "s";
+        LocalMessage::instance()->showMessage("ADSB OpenSky Rate Limited", 4);
         reply->deleteLater();
         return;
     }
 
-    if(!doc.isObject()){
-        qDebug()<<"JSON is not an object.";
+    if (status == 304) {
         reply->deleteLater();
+        auto cached = _cached(_requested);
+        if (cached == nullptr) {
+            _next_request = now;
+            return;
+        }
+        cached->fetched = now;
+        // nothing new, ask less often
+        _interval = qMin(_interval * 3 / 2, kMaxStaleInterval);
+        _next_request = now + _interval;
+        _shown = _requested;
+        ADSBJsonParser::parse(ADSBJsonParser::OpenSky, cached->data.constData(), cached->data.size(), filter(), _vehicles);
+        _emit(_vehicles);
         return;
     }
 
-    QJsonObject jsonObject = doc.object();
+    _next_request = now + _interval;
 
-    if(jsonObject.isEmpty()){
-        qDebug()<<"ADSB Openskynetwork response: JSON object is empty.";
-        LocalMessage::instance()->showMessage("ADSB OpenSky empty object", 4);
+    //qDebug() << "MAX adsb distance=" << max_distance;
+
+    if (reply->error()) {
+        qDebug() << "ADSB OpenSky request error!";
+        qDebug() << reply->errorString();
+        LocalMessage::instance()->showMessage("ADSB OpenSky Reply Error", 4);
         reply->deleteLater();
         return;
     }
 
-    QJsonValue value = jsonObject.value("states");
-    QJsonArray array = value.toArray();
-
-    foreach (const QJsonValue & v, array){
-
-        ADSBVehicle::VehicleInfo_t adsbInfo;
-        bool icaoOk;
-
-        QJsonArray innerarray = v.toArray();
-        QString icaoAux = innerarray[0].toString();
-        adsbInfo.icaoAddress = icaoAux.toUInt(&icaoOk, 16);
-        
-        // Skip this element if icao number is not ok
-        if (!icaoOk) {
-            continue;
-        }
-
-        // location comes in lat lon format, but we need it as QGeoCoordinate
-        if(innerarray[6].isNull() || innerarray[5].isNull()){ //skip if no lat lon
-            continue;
-        }
-        double lat = innerarray[6].toDouble();
-        double lon = innerarray[5].toDouble();
-        QGeoCoordinate location(lat, lon);
-        adsbInfo.location = location;
-        adsbInfo.availableFlags |= ADSBVehicle::LocationAvailable;
-
-        //evaluate distance for INTERNET adsb traffic... this is redundant with sdr
-        double lat_1 = _api_center_coord.latitude();
-        double lon_1 = _api_center_coord.longitude();
-
-        double latDistance = qDegreesToRadians(lat_1 - lat);
-        double lngDistance = qDegreesToRadians(lon_1 - lon);
+    TRACE_SCOPE("adsb.parseOpenSky");
 
-        double a = qSin(latDistance / 2) * qSin(latDistance / 2)
-                + qCos(qDegreesToRadians(lat_1)) * qCos(qDegreesToRadians(lat))
-                * qSin(lngDistance / 2) * qSin(lngDistance / 2);
-
-        double c = 2 * qAtan2(qSqrt(a), qSqrt(1 - a));
-        double distance = 6371 * c;
-
-        adsbInfo.distance = distance;
-        //qDebug() << "adsb internet distance=" << distance;
-        adsbInfo.availableFlags |= ADSBVehicle::DistanceAvailable;
-
-        // If aircraft beyond max distance than skip this one
-        if(distance>max_distance){
-            //qDebug() << "Beyond max SKIPPING";
-            continue;
-        }
+    QByteArray data = reply->readAll();
+    auto etag = reply->rawHeader("ETag");
+    auto last_modified = reply->rawHeader("Last-Modified");
+    reply->deleteLater();
 
-        // rest of fields
+    auto result = ADSBJsonParser::parse(ADSBJsonParser::OpenSky, data.constData(), data.size(), filter(), _vehicles);
 
-        // callsign
-        adsbInfo.callsign = innerarray[1].toString();
-        if (adsbInfo.callsign.length() == 0) {
-            adsbInfo.callsign = "N/A";
-        }
-        adsbInfo.availableFlags |= ADSBVehicle::CallsignAvailable;
-
-        //altitude
-        if(innerarray[7].isDouble()){
-            adsbInfo.altitude = innerarray[7].toDouble();
-            //per setting eliminate all unknown alt
-            if (adsbInfo.altitude<5 && unknown_zero_alt==false){
-                //skip this traffic
-                continue;
-            }
-        }
-        else {
-            //per setting eliminate all unknown alt
-            if (unknown_zero_alt==false){
-                //skip this traffic
-                continue;
-            }
-            else {
-                adsbInfo.altitude=99999.9;
-            }
-        }
-        adsbInfo.availableFlags |= ADSBVehicle::AltitudeAvailable;
-
-        //velocity
-        if(innerarray[9].isDouble()){
-            adsbInfo.velocity = innerarray[9].toDouble() * 3.6; // m/s to km/h
-        }
-        else {            
-            adsbInfo.velocity=99999.9;
-        }
-        adsbInfo.availableFlags |= ADSBVehicle::VelocityAvailable;
-
-        //heading
-        if(innerarray[10].isDouble()){
-            adsbInfo.heading = innerarray[10].toDouble();
-        }
-        else {            
-            adsbInfo.heading=0.0;
-        }
-        adsbInfo.availableFlags |= ADSBVehicle::HeadingAvailable;
+    if (!result.ok) {
+        qDebug() << "ADSB Opensky network response: Parse failed";
+        LocalMessage::instance()->showMessage("ADSB OpenSky Parse Error", 4);
+        return;
+    }
 
-        //last contact
-        if(innerarray[4].isNull()){
-            adsbInfo.lastContact=0;
-        }
-        else {
-            adsbInfo.lastContact = innerarray[4].toInt();
-        }
-        adsbInfo.availableFlags |= ADSBVehicle::LastContactAvailable;
+    // OpenSky only moves its time on when it has new states
+    if (result.time != 0 && result.time == _data_time) {
+        _interval = qMin(_interval * 3 / 2, kMaxStaleInterval);
+    } else {
+        _interval = kBaseInterval;
+    }
+    _data_time = result.time;
+    _next_request = now + _interval;
 
-        //vertical velocity
-        if(innerarray[11].isDouble()){
-            adsbInfo.verticalVel = innerarray[11].toDouble();
-        }
-        else {
-            adsbInfo.verticalVel=0.0;
+    auto cached = _cached(_requested);
+    if (cached == nullptr) {
+        if (_cache.size() >= kCacheSize) {
+            _cache.removeFirst();
         }
-        adsbInfo.availableFlags |= ADSBVehicle::VerticalVelAvailable;
-
-        // this is received on adsbvehicleupdate slot
-        emit adsbVehicleUpdate(adsbInfo);
+        _cache.append(CacheEntry());
+        cached = &_cache.last();
+        cached->box = _requested;
     }
-    reply->deleteLater();
+    cached->data = data;
+    cached->etag = etag;
+    cached->last_modified = last_modified;
+    cached->fetched = now;
+    _shown = _requested;
+
+    _emit(_vehicles);
 }
 
 ADSBSdr::ADSBSdr()
@@ -395,15 +624,45 @@ ADSBSdr::ADSBSdr()
 }
 
 void ADSBSdr::requestData(void) {
-    Logger::instance()->logData("request data", 1);
+    Logger::instance()->logData("request data", Logger::LogDebug);
     _adsb_api_sdr = _settings.value("adsb_api_sdr").toBool();
     _show_adsb_sdr = _settings.value("show_adsb").toBool();
 
+    max_distance=(_settings.value("adsb_distance_limit").toInt())/1000.0;
+    unknown_zero_alt=_settings.value("adsb_show_unknown_or_zero_alt").toBool();
+
     // If sdr is disabled by settings don't make the request and return
     if (!_adsb_api_sdr || !_show_adsb_sdr) {
+        if (_beast != nullptr) {
+            _beast->abort();
+            _beastTimer->stop();
+        }
+        return;
+    }
+
+    if (_groundAddress.isEmpty()) {
         return;
     }
 
+    // created here so they live in this thread
+    if (_beast == nullptr) {
+        _beast = new QTcpSocket(this);
+        connect(_beast, &QTcpSocket::readyRead, this, &ADSBSdr::_beastReadyRead);
+        _beastTimer = new QTimer(this);
+        _beastTimer->setInterval(kBeastInterval);
+        connect(_beastTimer, &QTimer::timeout, this, &ADSBSdr::_beastFlush);
+        connect(_beast, &QTcpSocket::connected, _beastTimer, [this]() { _beastTimer->start(); });
+        connect(_beast, &QTcpSocket::disconnected, _beastTimer, &QTimer::stop);
+        _beastClock.start();
+    }
+
+    if (_beast->state() == QAbstractSocket::ConnectedState) {
+        return;
+    }
+    if (_beast->state() == QAbstractSocket::UnconnectedState) {
+        _beast->connectToHost(_groundAddress, kBeastPort);
+    }
+
     adsb_url=  "http://"+_groundAddress+":8080/data/aircraft.json";
 
     QNetworkRequest request;
@@ -415,15 +674,32 @@ void ADSBSdr::requestData(void) {
     m_manager->get(request);
 }
 
+void ADSBSdr::_beastReadyRead() {
+    TRACE_SCOPE("adsb.decodeBeast");
+
+    auto data = _beast->readAll();
+    _decoder.feed(data.constData(), static_cast<size_t>(data.size()), _beastClock.elapsed());
+}
+
+void ADSBSdr::_beastFlush() {
+    auto now = _beastClock.elapsed();
+    _decoder.expire(now);
+    _decoder.takeUpdates(filter(), now, _vehicles);
+
+    if (!_vehicles.isEmpty()) {
+        // this is received on the adsbSnapshot slot
+        emit adsbSnapshot(_vehicles);
+    }
+}
+
 void ADSBSdr::processReply(QNetworkReply *reply) {
-    Logger::instance()->logData("process reply", 1);
-    if (!_adsb_api_sdr || !_show_adsb_sdr) {
+    Logger::instance()->logData("process reply", Logger::LogDebug);
+    // the Beast feed came up while this was in flight, it is newer anyway
+    if (!_adsb_api_sdr || !_show_adsb_sdr || (_beast != nullptr && _beast->state() == QAbstractSocket::ConnectedState)) {
+        reply->deleteLater();
         return;
     }
 
-    max_distance=(_settings.value("adsb_distance_limit").toInt())/1000;
-    unknown_zero_alt=_settings.value("adsb_show_unknown_or_zero_alt").toBool();
-
     //qDebug() << "MAX adsb distance=" << max_distance;
 
     if (reply->error()) {
@@ -434,168 +710,25 @@ void ADSBSdr::processReply(QNetworkReply *reply) {
         return;
     }
 
-    QJsonParseError errorPtr;
+    TRACE_SCOPE("adsb.parseSdr");
+
     QByteArray data = reply->readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(data, &errorPtr);
+    reply->deleteLater();
 
-    if (doc.isNull()) {
+    auto result = ADSBJsonParser::parse(ADSBJsonParser::Dump1090, data.constData(), data.size(), filter(), _vehicles);
+
+    if (!result.ok) {
         qDebug() << "ADSB SDR response: Parse failed";
         LocalMessage::instance()->showMessage("ADSB SDR Parse Error", 4);
-        reply->deleteLater();
-        return;
-    }
-
-    if(!doc.isObject()){
-        qDebug()<<"JSON is not an object.";
-        LocalMessage::instance()->showMessage("ADSB SDR Json not an object", 4);
-        reply->deleteLater();
         return;
     }
 
-    QJsonObject jsonObject = doc.object();
-
-    if(jsonObject.isEmpty()){
-        qDebug()<<"ADSB Openskynetwork response: JSON object is empty.";
-        LocalMessage::instance()->showMessage("ADSB SDR Json empty", 4);
-        reply->deleteLater();
-        return;
-    }
-
-    QJsonArray array = jsonObject["aircraft"].toArray();
-
-    if(array.isEmpty()){
+    if (result.aircraft == 0) {
         qDebug()<<"JSON array is empty.";
         LocalMessage::instance()->showMessage("ADSB SDR Json array empty", 4);
-        reply->deleteLater();
         return;
     }
 
-    foreach (const QJsonValue & val, array){
-        Logger::instance()->logData("For Each Loop... /n", 1);
-        ADSBVehicle::VehicleInfo_t adsbInfo;
-        bool icaoOk;
-
-        // TODO
-        // According to dump1090-mutability, this value can start 
-        // by "~" in case it isn't a valid ICAO. How this will 
-        // behave then?
-        QString icaoAux = val.toObject().value("hex").toString();
-        Logger::instance()->logData("icaoAux:"+icaoAux, 1);
-        adsbInfo.icaoAddress = icaoAux.toUInt(&icaoOk, 16);
-        
-        // Only continue if icao number is ok
-        if (icaoOk) {
-            Logger::instance()->logData("icao ok!", 1);
-
-            // location comes in lat lon format, but we need it as QGeoCoordinate
-
-            if(val.toObject().value("lat").isNull() || val.toObject().value("lon").isNull()){ //skip if no lat lon
-                continue;
-            }
-
-            double lat = val.toObject().value("lat").toDouble();
-            double lon = val.toObject().value("lon").toDouble();
-
-            QGeoCoordinate location(lat, lon);
-            adsbInfo.location = location;
-            adsbInfo.availableFlags |= ADSBVehicle::LocationAvailable;
-
-            //evaluate distance for SDR adsb traffic... this is redundant with internet
-            double lat_1 = _api_center_coord.latitude();
-            double lon_1 = _api_center_coord.longitude();
-
-            double latDistance = qDegreesToRadians(lat_1 - lat);
-            double lngDistance = qDegreesToRadians(lon_1 - lon);
-
-            double a = qSin(latDistance / 2) * qSin(latDistance / 2)
-                    + qCos(qDegreesToRadians(lat_1)) * qCos(qDegreesToRadians(lat))
-                    * qSin(lngDistance / 2) * qSin(lngDistance / 2);
-
-            double c = 2 * qAtan2(qSqrt(a), qSqrt(1 - a));
-            double distance = 6371 * c;
-
-            adsbInfo.distance = distance;
-            adsbInfo.availableFlags |= ADSBVehicle::DistanceAvailable;
-
-            // If aircraft beyond max distance than skip this one
-            if(distance>max_distance){
-                //qDebug() << "Beyond max SKIPPING";
-                continue;
-            }
-
-            // callsign
-            adsbInfo.callsign = val.toObject().value("flight").toString();
-
-            if (adsbInfo.callsign.length() == 0) {
-                adsbInfo.callsign = "N/A";
-            } else {
-                adsbInfo.availableFlags |= ADSBVehicle::CallsignAvailable;
-            }
-
-            //altitude
-            if(val.toObject().value("altitude").isNull()){
-                //per setting eliminate unknown alt traffic
-                if (unknown_zero_alt==false){
-                    //skip this traffic
-                    continue;
-                } else {
-                    adsbInfo.altitude=99999.9;
-                }
-            }
-            else {
-                adsbInfo.altitude = val.toObject().value("altitude").toInt() * 0.3048;//feet to meters
-                //per setting eliminate all unknown alt
-                if (adsbInfo.altitude<5 && unknown_zero_alt==false){
-                    //skip this traffic
-                    continue;
-                }
-            }
-            adsbInfo.availableFlags |= ADSBVehicle::AltitudeAvailable;
-
-            //velocity
-            if(val.toObject().value("speed").isNull()){
-                adsbInfo.velocity=99999.9;
-            }
-            else {
-                adsbInfo.velocity = round(val.toObject().value("speed").toDouble() * 1.852); // knots to km/h
-            }
-            adsbInfo.availableFlags |= ADSBVehicle::VelocityAvailable;
-
-            //heading
-            if(val.toObject().value("track").isNull()){
-                adsbInfo.heading=0.0;
-            }
-            else {
-                adsbInfo.heading = val.toObject().value("track").toDouble();
-            }
-            adsbInfo.availableFlags |= ADSBVehicle::HeadingAvailable;
-
-            //last contact
-            if(val.toObject().value("seen_pos").isNull()){
-                adsbInfo.lastContact=0;
-            }
-            else {
-                adsbInfo.lastContact = val.toObject().value("seen_pos").toInt();
-            }
-            adsbInfo.availableFlags |= ADSBVehicle::LastContactAvailable;
-
-            //vertical velocity
-            if(val.toObject().value("vert_rate").isNull()){
-                adsbInfo.verticalVel=0.0;
-            }
-            else {
-                adsbInfo.verticalVel = round(val.toObject().value("vert_rate").toDouble() * 0.00508); //feet/min to m/s
-            }
-            adsbInfo.availableFlags |= ADSBVehicle::VerticalVelAvailable;
-
-
-            // this is received on adsbvehicleupdate slot
-            emit adsbVehicleUpdate(adsbInfo);
-        }
-        else {
-            Logger::instance()->logData("icao REJECTED! /n", 1);
-            qDebug()<<"ICAO number NOT OK!";
-        }
-    }
-    reply->deleteLater();
+    // this is received on the adsbSnapshot slot
+    emit adsbSnapshot(_vehicles);
 }
@@ -0,0 +1,409 @@
+#include "ADSBVehicleModel.h"
+
+#include <QtMath>
+
+#include <cmath>
+
+namespace {
+
+// same comparison ADSBVehicle uses, two NaNs are equal
+bool changed(double a, double b) {
+    if (qIsNaN(a) || qIsNaN(b)) {
+        return qIsNaN(a) != qIsNaN(b);
+    }
+    return !qFuzzyCompare(a, b);
+}
+
+uint32_t bit(int role) {
+    return 1u << (role - ADSBVehicleModel::IcaoAddressRole);
+}
+
+}
+
+
+ADSBVehicleModel::ADSBVehicleModel(QObject *parent) : QAbstractListModel(parent)
+{
+    m_clock.start();
+}
+
+
+int ADSBVehicleModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return count();
+}
+
+
+QVariant ADSBVehicleModel::data(const QModelIndex &index, int role) const
+{
+    if (index.row() < 0 || index.row() >= count()) {
+        return QVariant();
+    }
+    auto slot = m_rows[index.row()];
+
+    switch (role) {
+        case IcaoAddressRole: return static_cast<int>(m_icao[slot]);
+        case CallsignRole: return m_callsign[slot];
+        case CoordinateRole: return QVariant::fromValue(QGeoCoordinate(m_shown_lat[slot], m_shown_lon[slot]));
+        case LatRole: return m_shown_lat[slot];
+        case LonRole: return m_shown_lon[slot];
+        case AltitudeRole: return m_altitude[slot];
+        case VelocityRole: return m_velocity[slot];
+        case HeadingRole: return m_heading[slot];
+        case AlertRole: return m_alert[slot];
+        case LastContactRole: return m_last_contact[slot];
+        case VerticalVelRole: return m_vertical_vel[slot];
+        case DistanceRole: return m_distance[slot];
+        case TrackRole: return track(slot);
+        default: return QVariant();
+    }
+}
+
+
+QHash<int, QByteArray> ADSBVehicleModel::roleNames() const
+{
+    static const QHash<int, QByteArray> roles {
+        { IcaoAddressRole, "icaoAddress" },
+        { CallsignRole, "callsign" },
+        { CoordinateRole, "coordinate" },
+        { LatRole, "lat" },
+        { LonRole, "lon" },
+        { AltitudeRole, "altitude" },
+        { VelocityRole, "velocity" },
+        { HeadingRole, "heading" },
+        { AlertRole, "alert" },
+        { LastContactRole, "lastContact" },
+        { VerticalVelRole, "verticalVel" },
+        { DistanceRole, "distance" },
+        { TrackRole, "track" }
+    };
+    return roles;
+}
+
+
+void ADSBVehicleModel::append(const ADSBVehicle::VehicleList &vehicles)
+{
+    // a contact can be in the list more than once, it is still one row
+    m_appending.clear();
+    for (const auto &info : vehicles) {
+        if (!m_index.contains(info.icaoAddress)) {
+            m_appending.insert(info.icaoAddress);
+        }
+    }
+    auto added = m_appending.size();
+    if (added == 0) {
+        return;
+    }
+
+    auto first = count();
+    beginInsertRows(QModelIndex(), first, first + added - 1);
+
+    for (const auto &info : vehicles) {
+        if (m_index.contains(info.icaoAddress)) {
+            // a later copy of a contact added just now, applied like the first one
+            if (m_appending.contains(info.icaoAddress)) {
+                update(info);
+                m_dirty[m_index.value(info.icaoAddress)] = 0;
+            }
+            continue;
+        }
+
+        int slot;
+        if (!m_free.empty()) {
+            slot = m_free.back();
+            m_free.pop_back();
+        } else {
+            slot = static_cast<int>(m_icao.size());
+            m_icao.push_back(0);
+            m_callsign.emplace_back();
+            m_lat.push_back(0.0);
+            m_lon.push_back(0.0);
+            m_fix_time.push_back(0);
+            m_shown_lat.push_back(0.0);
+            m_shown_lon.push_back(0.0);
+            m_track_lat.resize(m_track_lat.size() + kTrackLength);
+            m_track_lon.resize(m_track_lon.size() + kTrackLength);
+            m_track_head.push_back(0);
+            m_track_count.push_back(0);
+            m_altitude.push_back(0.0);
+            m_velocity.push_back(0.0);
+            m_heading.push_back(0.0);
+            m_alert.push_back(0);
+            m_last_contact.push_back(0);
+            m_vertical_vel.push_back(0.0);
+            m_distance.push_back(0.0);
+            m_updated.push_back(0);
+            m_dirty.push_back(0);
+        }
+
+        // what a new ADSBVehicle started with
+        m_icao[slot] = info.icaoAddress;
+        m_callsign[slot].clear();
+        m_lat[slot] = qQNaN();
+        m_lon[slot] = qQNaN();
+        m_track_head[slot] = 0;
+        m_track_count[slot] = 0;
+        m_altitude[slot] = qQNaN();
+        m_velocity[slot] = 0.0;
+        m_heading[slot] = qQNaN();
+        m_alert[slot] = 0;
+        m_last_contact[slot] = 0;
+        m_vertical_vel[slot] = 0.0;
+        m_distance[slot] = 0.0;
+
+        m_index.insert(info.icaoAddress, slot);
+        m_rows.push_back(slot);
+
+        update(info);
+        // the insertion already tells the views everything
+        m_dirty[slot] = 0;
+    }
+
+    endInsertRows();
+    emit countChanged(count());
+}
+
+
+void ADSBVehicleModel::update(const ADSBVehicle::VehicleInfo_t &info)
+{
+    auto slot = m_index.value(info.icaoAddress, -1);
+    if (slot < 0) {
+        return;
+    }
+
+    auto flags = info.availableFlags;
+    uint32_t dirty = 0;
+
+    if ((flags & ADSBVehicle::CallsignAvailable) && info.callsign != m_callsign[slot]) {
+        m_callsign[slot] = info.callsign;
+        dirty |= bit(CallsignRole);
+    }
+    if (flags & ADSBVehicle::LocationAvailable) {
+        auto lat = info.location.latitude();
+        auto lon = info.location.longitude();
+        if (lat != m_lat[slot] || lon != m_lon[slot]) {
+            m_lat[slot] = lat;
+            m_lon[slot] = lon;
+            // the report may already be a few seconds old
+            auto age = (flags & ADSBVehicle::LastContactAvailable) ? info.lastContact * 1000ll : 0ll;
+            m_fix_time[slot] = m_clock.elapsed() - age;
+            m_shown_lat[slot] = lat;
+            m_shown_lon[slot] = lon;
+
+            auto head = m_track_head[slot];
+            m_track_lat[slot * kTrackLength + head] = lat;
+            m_track_lon[slot * kTrackLength + head] = lon;
+            m_track_head[slot] = (head + 1) % kTrackLength;
+            m_track_count[slot] = qMin(m_track_count[slot] + 1, kTrackLength);
+
+            dirty |= bit(CoordinateRole) | bit(LatRole) | bit(LonRole) | bit(TrackRole);
+        }
+    }
+    if ((flags & ADSBVehicle::AltitudeAvailable) && changed(info.altitude, m_altitude[slot])) {
+        m_altitude[slot] = info.altitude;
+        dirty |= bit(AltitudeRole);
+    }
+    if ((flags & ADSBVehicle::HeadingAvailable) && changed(info.heading, m_heading[slot])) {
+        m_heading[slot] = info.heading;
+        dirty |= bit(HeadingRole);
+    }
+    if ((flags & ADSBVehicle::AlertAvailable) && info.alert != m_alert[slot]) {
+        m_alert[slot] = info.alert;
+        dirty |= bit(AlertRole);
+    }
+    if ((flags & ADSBVehicle::VelocityAvailable) && info.velocity != m_velocity[slot]) {
+        m_velocity[slot] = info.velocity;
+        dirty |= bit(VelocityRole);
+    }
+    if ((flags & ADSBVehicle::VerticalVelAvailable) && info.verticalVel != m_vertical_vel[slot]) {
+        m_vertical_vel[slot] = info.verticalVel;
+        dirty |= bit(VerticalVelRole);
+    }
+    if ((flags & ADSBVehicle::LastContactAvailable) && info.lastContact != m_last_contact[slot]) {
+        m_last_contact[slot] = info.lastContact;
+        dirty |= bit(LastContactRole);
+    }
+    if ((flags & ADSBVehicle::DistanceAvailable) && info.distance != m_distance[slot]) {
+        m_distance[slot] = info.distance;
+        dirty |= bit(DistanceRole);
+    }
+
+    // alert and distance come from the traffic evaluation, that doesn't keep a contact alive
+    if (flags & ~(ADSBVehicle::AlertAvailable | ADSBVehicle::DistanceAvailable)) {
+        m_updated[slot] = m_clock.elapsed();
+    }
+
+    if (dirty != 0) {
+        m_dirty[slot] |= dirty;
+        m_any_dirty = true;
+    }
+}
+
+
+void ADSBVehicleModel::flush()
+{
+    if (!m_any_dirty) {
+        return;
+    }
+    m_any_dirty = false;
+
+    auto rows = count();
+    for (int row = 0; row < rows; row++) {
+        if (m_dirty[m_rows[row]] == 0) {
+            continue;
+        }
+
+        uint32_t dirty = 0;
+        auto last = row;
+        while (last < rows && m_dirty[m_rows[last]] != 0) {
+            dirty |= m_dirty[m_rows[last]];
+            m_dirty[m_rows[last]] = 0;
+            last++;
+        }
+
+        QVector<int> roles;
+        for (int role = IcaoAddressRole; role <= TrackRole; role++) {
+            if (dirty & bit(role)) {
+                roles.append(role);
+            }
+        }
+        emit dataChanged(index(row), index(last - 1), roles);
+        row = last;
+    }
+}
+
+
+void ADSBVehicleModel::extrapolate(const QGeoRectangle &box)
+{
+    auto now = m_clock.elapsed();
+    auto all = !box.isValid();
+    auto south = box.bottomLeft().latitude();
+    auto north = box.topRight().latitude();
+    auto west = box.bottomLeft().longitude();
+    auto east = box.topRight().longitude();
+
+    for (auto slot : m_rows) {
+        auto lat = m_lat[slot];
+        auto lon = m_lon[slot];
+        if (!all && (lat < south || lat > north || lon < west || lon > east)) {
+            continue;
+        }
+
+        // 99999.9 is an unknown speed
+        auto speed = m_velocity[slot];
+        auto age = now - m_fix_time[slot];
+        if (speed <= 0.0 || speed > 99999.0 || qIsNaN(m_heading[slot]) || age <= 0) {
+            continue;
+        }
+
+        // too old to guess, back to where it was last reported rather than where it never was
+        if (age > kMaxExtrapolation) {
+            if (m_shown_lat[slot] != lat || m_shown_lon[slot] != lon) {
+                m_shown_lat[slot] = lat;
+                m_shown_lon[slot] = lon;
+                m_dirty[slot] |= bit(CoordinateRole) | bit(LatRole) | bit(LonRole);
+                m_any_dirty = true;
+            }
+            continue;
+        }
+
+        // metres along the heading, in a flat plane around the report
+        auto distance = speed / 3.6 * age / 1000.0;
+        auto heading = qDegreesToRadians(m_heading[slot]);
+        auto d_lat = qRadiansToDegrees(distance * std::cos(heading) / 6371000.0);
+        auto d_lon = qRadiansToDegrees(distance * std::sin(heading) / (6371000.0 * std::cos(qDegreesToRadians(lat))));
+
+        m_shown_lat[slot] = lat + d_lat;
+        m_shown_lon[slot] = lon + d_lon;
+        m_dirty[slot] |= bit(CoordinateRole) | bit(LatRole) | bit(LonRole);
+        m_any_dirty = true;
+    }
+
+    flush();
+}
+
+
+void ADSBVehicleModel::removeExpired(std::vector<uint32_t> &removed)
+{
+    removed.clear();
+
+    auto now = m_clock.elapsed();
+    auto expired = [&](int row) {
+        return now - m_updated[m_rows[row]] > kExpiration;
+    };
+
+    // from the back, so the rows of a run don't move while it is being found
+    for (int row = count() - 1; row >= 0; row--) {
+        if (!expired(row)) {
+            continue;
+        }
+        auto first = row;
+        while (first > 0 && expired(first - 1)) {
+            first--;
+        }
+
+        beginRemoveRows(QModelIndex(), first, row);
+        for (int r = first; r <= row; r++) {
+            removed.push_back(m_icao[m_rows[r]]);
+            releaseSlot(m_rows[r]);
+        }
+        m_rows.erase(m_rows.begin() + first, m_rows.begin() + row + 1);
+        endRemoveRows();
+
+        row = first;
+    }
+
+    if (!removed.empty()) {
+        emit countChanged(count());
+    }
+}
+
+
+void ADSBVehicleModel::clear()
+{
+    beginResetModel();
+    for (auto slot : m_rows) {
+        releaseSlot(slot);
+    }
+    m_rows.clear();
+    m_any_dirty = false;
+    endResetModel();
+    emit countChanged(count());
+}
+
+
+QString ADSBVehicleModel::callsign(uint32_t icao) const
+{
+    auto slot = m_index.value(icao, -1);
+    return slot < 0 ? QString() : m_callsign[slot];
+}
+
+
+QGeoCoordinate ADSBVehicleModel::coordinate(uint32_t icao) const
+{
+    auto slot = m_index.value(icao, -1);
+    return slot < 0 ? QGeoCoordinate() : QGeoCoordinate(m_lat[slot], m_lon[slot]);
+}
+
+
+
+QVariantList ADSBVehicleModel::track(int slot) const
+{
+    QVariantList path;
+    auto count = m_track_count[slot];
+    path.reserve(count);
+    // oldest first
+    for (int i = count; i > 0; i--) {
+        auto index = slot * kTrackLength + (m_track_head[slot] - i + kTrackLength) % kTrackLength;
+        path.append(QVariant::fromValue(QGeoCoordinate(m_track_lat[index], m_track_lon[index])));
+    }
+    return path;
+}
+
+
+void ADSBVehicleModel::releaseSlot(int slot)
+{
+    m_index.remove(m_icao[slot]);
+    m_dirty[slot] = 0;
+    m_free.push_back(slot);
+}
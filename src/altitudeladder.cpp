@@ -5,6 +5,7 @@
 #include "openhd.h"
 
 #include "altitudeladder.h"
+#include "trace.h"
 
 
 AltitudeLadder::AltitudeLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
@@ -13,6 +14,7 @@ AltitudeLadder::AltitudeLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
 }
 
 void AltitudeLadder::paint(QPainter* painter) {
+    TRACE_SCOPE("paint.AltitudeLadder");
     painter->save();
 
     QFont font("sans-serif", 10, QFont::Bold, false);
@@ -0,0 +1,534 @@
+#include "blackboxfile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char kFileMagic[8] = { 'Q', 'O', 'H', 'D', 'B', 'B', 'X', '1' };
+static const char kTrailerMagic[8] = { 'Q', 'O', 'H', 'D', 'B', 'E', 'N', 'D' };
+
+constexpr uint16_t kFileVersion = 1;
+
+constexpr uint32_t kRecordBlock = 0x4b524242;   // "BBRK"
+constexpr uint32_t kModeBlock = 0x444d4242;     // "BBMD"
+constexpr uint32_t kIndexBlock = 0x58494242;    // "BBIX"
+
+constexpr int kRecordsPerBlock = 64;
+
+// anything above this in a flight mode block is corruption, not a real flight mode
+constexpr int kMaxFlightModes = 256;
+
+// time plus every field, without the struct padding
+constexpr uint32_t kRecordSize = sizeof(int64_t) + BlackBoxFieldCount * sizeof(int32_t);
+
+
+/*
+ * Block payloads are padded to 8 bytes so every block header, and the index entries
+ * read straight out of the mapping, stay aligned.
+ */
+static qint64 padded(qint64 size) {
+    return (size + 7) & ~qint64(7);
+}
+
+
+static uint32_t crc32(const uchar *data, qint64 size) {
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        initialized = true;
+    }
+
+    uint32_t crc = 0xFFFFFFFF;
+    for (qint64 i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+
+BlackBoxFileWriter::BlackBoxFileWriter() {
+    // the table is built on first use, do that before there is more than one thread
+    crc32(nullptr, 0);
+}
+
+
+BlackBoxFileWriter::~BlackBoxFileWriter() {
+    close();
+}
+
+
+bool BlackBoxFileWriter::open(const QString &fileName) {
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "BlackBoxFileWriter: could not open" << fileName;
+        return false;
+    }
+
+    BlackBoxFileHeader header = {};
+    memcpy(header.magic, kFileMagic, sizeof(header.magic));
+    header.version = kFileVersion;
+    header.fieldCount = BlackBoxFieldCount;
+    header.recordSize = kRecordSize;
+    header.startTime = QDateTime::currentMSecsSinceEpoch();
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_fileName = fileName;
+    m_pending.clear();
+    m_index.clear();
+    m_rows = 0;
+    m_failed = false;
+    m_lastSync.start();
+
+    m_thread = QThread::create([this] { writeLoop(); });
+    m_thread->setObjectName("BlackBoxFileWriter");
+    m_thread->start(QThread::LowPriority);
+
+    qDebug() << "BlackBoxFileWriter: recording to" << fileName;
+    return true;
+}
+
+
+void BlackBoxFileWriter::close() {
+    if (m_thread == nullptr) {
+        return;
+    }
+
+    Item item;
+    item.type = Item::Stop;
+    m_queue.push_back(std::move(item));
+
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    m_file.close();
+
+    qDebug() << "BlackBoxFileWriter: closed" << m_fileName;
+}
+
+
+void BlackBoxFileWriter::addFlightMode(int index, const QString &mode) {
+    if (m_thread == nullptr) {
+        return;
+    }
+
+    Item item;
+    item.type = Item::FlightMode;
+    item.index = index;
+    item.mode = mode.toUtf8();
+    m_queue.push_back(std::move(item));
+}
+
+
+void BlackBoxFileWriter::append(const BlackBoxRecord &record) {
+    if (m_thread == nullptr) {
+        return;
+    }
+
+    Item item;
+    item.record = record;
+    m_queue.push_back(std::move(item));
+
+    if (m_lastSync.elapsed() >= m_syncInterval) {
+        Item sync;
+        sync.type = Item::Sync;
+        m_queue.push_back(std::move(sync));
+        m_lastSync.restart();
+    }
+}
+
+
+void BlackBoxFileWriter::writeLoop() {
+    for (;;) {
+        Item item = m_queue.front();
+        m_queue.pop_front();
+
+        switch (item.type) {
+            case Item::Record: {
+                m_pending.push_back(item.record);
+                if (m_pending.size() >= static_cast<size_t>(kRecordsPerBlock)) {
+                    writeRecordBlock();
+                }
+                break;
+            }
+            case Item::FlightMode: {
+                writeBlock(kModeBlock, static_cast<uint32_t>(item.index), 0, item.mode);
+                break;
+            }
+            case Item::Sync: {
+                writeRecordBlock();
+                sync();
+                break;
+            }
+            case Item::Stop: {
+                writeRecordBlock();
+                writeIndex();
+                sync();
+                return;
+            }
+        }
+    }
+}
+
+
+void BlackBoxFileWriter::writeRecordBlock() {
+    if (m_pending.empty()) {
+        return;
+    }
+
+    QByteArray payload;
+    payload.reserve(static_cast<int>(m_pending.size() * kRecordSize));
+    for (auto &record : m_pending) {
+        payload.append(reinterpret_cast<const char*>(&record.time), sizeof(record.time));
+        payload.append(reinterpret_cast<const char*>(record.values), sizeof(record.values));
+    }
+
+    auto count = static_cast<uint32_t>(m_pending.size());
+    writeBlock(kRecordBlock, count, m_pending.front().time, payload);
+    m_rows += count;
+
+    m_pending.clear();
+}
+
+
+void BlackBoxFileWriter::writeBlock(uint32_t type, uint32_t count, int64_t firstTime, const QByteArray &payload) {
+    if (m_failed) {
+        return;
+    }
+
+    BlackBoxBlockHeader header = {};
+    header.type = type;
+    header.size = static_cast<uint32_t>(payload.size());
+    header.crc = crc32(reinterpret_cast<const uchar*>(payload.constData()), payload.size());
+    header.count = count;
+    header.firstTime = firstTime;
+
+    auto offset = m_file.pos();
+
+    QByteArray block(reinterpret_cast<const char*>(&header), sizeof(header));
+    block.append(payload);
+    block.append(static_cast<int>(padded(payload.size()) - payload.size()), '\0');
+
+    if (m_file.write(block) != block.size()) {
+        qDebug() << "BlackBoxFileWriter: write failed, recording stopped" << m_file.errorString();
+        m_failed = true;
+        return;
+    }
+
+    if (type == kRecordBlock) {
+        m_index.push_back({ static_cast<uint64_t>(offset), firstTime, m_rows, count });
+    } else if (type == kModeBlock) {
+        m_index.push_back({ static_cast<uint64_t>(offset), 0, count, 0 });
+    }
+}
+
+
+/*
+ * Record blocks first, then flight mode blocks. The header count says how many of the
+ * entries are record blocks.
+ */
+void BlackBoxFileWriter::writeIndex() {
+    std::stable_partition(m_index.begin(), m_index.end(), [](const BlackBoxIndexEntry &entry) {
+        return entry.count > 0;
+    });
+    auto records = std::count_if(m_index.begin(), m_index.end(), [](const BlackBoxIndexEntry &entry) {
+        return entry.count > 0;
+    });
+
+    auto offset = m_file.pos();
+
+    QByteArray payload(reinterpret_cast<const char*>(m_index.data()),
+                       static_cast<int>(m_index.size() * sizeof(BlackBoxIndexEntry)));
+    writeBlock(kIndexBlock, static_cast<uint32_t>(records), 0, payload);
+
+    if (m_failed) {
+        return;
+    }
+
+    BlackBoxFileTrailer trailer = {};
+    trailer.indexOffset = static_cast<uint64_t>(offset);
+    memcpy(trailer.magic, kTrailerMagic, sizeof(trailer.magic));
+    m_file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+}
+
+
+void BlackBoxFileWriter::sync() {
+    m_file.flush();
+#if defined(Q_OS_WIN)
+    _commit(m_file.handle());
+#else
+    fsync(m_file.handle());
+#endif
+}
+
+
+BlackBoxFileReader::~BlackBoxFileReader() {
+    close();
+}
+
+
+bool BlackBoxFileReader::open(const QString &fileName) {
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qDebug() << "BlackBoxFileReader: could not open" << fileName;
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size < static_cast<qint64>(sizeof(BlackBoxFileHeader))) {
+        qDebug() << "BlackBoxFileReader: file too short" << fileName;
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, m_size);
+    if (m_data == nullptr) {
+        qDebug() << "BlackBoxFileReader: could not map" << fileName;
+        m_file.close();
+        return false;
+    }
+
+    BlackBoxFileHeader header;
+    memcpy(&header, m_data, sizeof(header));
+    if (memcmp(header.magic, kFileMagic, sizeof(header.magic)) != 0 ||
+        header.version != kFileVersion ||
+        header.recordSize != sizeof(int64_t) + header.fieldCount * sizeof(int32_t)) {
+        qDebug() << "BlackBoxFileReader: not a blackbox file" << fileName;
+        close();
+        return false;
+    }
+    m_fieldCount = std::min<int>(header.fieldCount, BlackBoxFieldCount);
+    m_recordSize = header.recordSize;
+
+    if (!readIndex()) {
+        qDebug() << "BlackBoxFileReader: no index, recovering" << fileName;
+        scanBlocks();
+    }
+
+    if (m_blockCount > 0) {
+        auto &last = m_blocks[m_blockCount - 1];
+        m_count = static_cast<int>(last.firstRow + last.count);
+    }
+
+    return true;
+}
+
+
+void BlackBoxFileReader::close() {
+    if (m_data != nullptr) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+        m_data = nullptr;
+    }
+    m_file.close();
+
+    m_size = 0;
+    m_blocks = nullptr;
+    m_blockCount = 0;
+    m_scanned.clear();
+    m_flightModes.clear();
+    m_count = 0;
+}
+
+
+bool BlackBoxFileReader::readIndex() {
+    if (m_size < static_cast<qint64>(sizeof(BlackBoxFileHeader) + sizeof(BlackBoxFileTrailer))) {
+        return false;
+    }
+
+    BlackBoxFileTrailer trailer;
+    memcpy(&trailer, m_data + m_size - sizeof(trailer), sizeof(trailer));
+    if (memcmp(trailer.magic, kTrailerMagic, sizeof(trailer.magic)) != 0) {
+        return false;
+    }
+
+    auto offset = static_cast<qint64>(trailer.indexOffset);
+    if (offset < static_cast<qint64>(sizeof(BlackBoxFileHeader)) || offset % 8 != 0 ||
+        offset + static_cast<qint64>(sizeof(BlackBoxBlockHeader)) > m_size) {
+        return false;
+    }
+
+    BlackBoxBlockHeader header;
+    memcpy(&header, m_data + offset, sizeof(header));
+    auto payload = m_data + offset + sizeof(header);
+    if (header.type != kIndexBlock ||
+        offset + static_cast<qint64>(sizeof(header)) + header.size > m_size ||
+        header.size % sizeof(BlackBoxIndexEntry) != 0 ||
+        crc32(payload, header.size) != header.crc) {
+        return false;
+    }
+
+    auto entries = reinterpret_cast<const BlackBoxIndexEntry*>(payload);
+    auto total = static_cast<int>(header.size / sizeof(BlackBoxIndexEntry));
+    if (header.count > static_cast<uint32_t>(total)) {
+        return false;
+    }
+
+    // the index is trusted from here on, so make sure it can't point outside the file
+    uint32_t rows = 0;
+    for (uint32_t i = 0; i < header.count; i++) {
+        auto &entry = entries[i];
+        if (entry.firstRow != rows ||
+            entry.offset + sizeof(BlackBoxBlockHeader) + static_cast<uint64_t>(entry.count) * m_recordSize > static_cast<uint64_t>(m_size)) {
+            return false;
+        }
+        rows += entry.count;
+    }
+
+    m_blocks = entries;
+    m_blockCount = static_cast<int>(header.count);
+
+    for (int i = m_blockCount; i < total; i++) {
+        BlackBoxBlockHeader mode;
+        auto modeOffset = static_cast<qint64>(entries[i].offset);
+        if (modeOffset + static_cast<qint64>(sizeof(mode)) > m_size) {
+            continue;
+        }
+        memcpy(&mode, m_data + modeOffset, sizeof(mode));
+        if (mode.type != kModeBlock || modeOffset + static_cast<qint64>(sizeof(mode)) + mode.size > m_size) {
+            continue;
+        }
+        auto index = static_cast<int>(mode.count);
+        if (index >= kMaxFlightModes) {
+            continue;
+        }
+        while (m_flightModes.count() <= index) {
+            m_flightModes.append(QString());
+        }
+        m_flightModes[index] = QString::fromUtf8(reinterpret_cast<const char*>(m_data + modeOffset + sizeof(mode)),
+                                                 static_cast<int>(mode.size));
+    }
+
+    return true;
+}
+
+
+/*
+ * Walks the blocks of a file that was not closed cleanly, keeping everything up to the
+ * first block that is cut off or does not match its CRC.
+ */
+void BlackBoxFileReader::scanBlocks() {
+    qint64 offset = sizeof(BlackBoxFileHeader);
+    uint32_t rows = 0;
+
+    while (offset + static_cast<qint64>(sizeof(BlackBoxBlockHeader)) <= m_size) {
+        BlackBoxBlockHeader header;
+        memcpy(&header, m_data + offset, sizeof(header));
+        auto payload = m_data + offset + sizeof(header);
+
+        if (offset + static_cast<qint64>(sizeof(header)) + header.size > m_size ||
+            crc32(payload, header.size) != header.crc) {
+            break;
+        }
+
+        if (header.type == kRecordBlock) {
+            if (header.count == 0 || header.size != static_cast<uint64_t>(header.count) * m_recordSize) {
+                break;
+            }
+            m_scanned.push_back({ static_cast<uint64_t>(offset), header.firstTime, rows, header.count });
+            rows += header.count;
+        } else if (header.type == kModeBlock) {
+            auto index = static_cast<int>(header.count);
+            if (index >= kMaxFlightModes) {
+                break;
+            }
+            while (m_flightModes.count() <= index) {
+                m_flightModes.append(QString());
+            }
+            m_flightModes[index] = QString::fromUtf8(reinterpret_cast<const char*>(payload),
+                                                     static_cast<int>(header.size));
+        } else {
+            // the index block, or something we don't know
+            break;
+        }
+
+        offset += sizeof(header) + padded(header.size);
+    }
+
+    m_blocks = m_scanned.data();
+    m_blockCount = static_cast<int>(m_scanned.size());
+}
+
+
+int BlackBoxFileReader::blockForRow(int row) const {
+    auto end = m_blocks + m_blockCount;
+    auto it = std::upper_bound(m_blocks, end, static_cast<uint32_t>(row), [](uint32_t r, const BlackBoxIndexEntry &entry) {
+        return r < entry.firstRow;
+    });
+    return static_cast<int>(it - m_blocks) - 1;
+}
+
+
+const uchar *BlackBoxFileReader::recordData(int block, int index) const {
+    return m_data + m_blocks[block].offset + sizeof(BlackBoxBlockHeader) + static_cast<qint64>(index) * m_recordSize;
+}
+
+
+BlackBoxRecord BlackBoxFileReader::at(int row) const {
+    BlackBoxRecord record;
+    if (row < 0 || row >= m_count) {
+        return record;
+    }
+
+    auto block = blockForRow(row);
+    auto p = recordData(block, row - static_cast<int>(m_blocks[block].firstRow));
+    memcpy(&record.time, p, sizeof(record.time));
+    memcpy(record.values, p + sizeof(record.time), m_fieldCount * sizeof(int32_t));
+    return record;
+}
+
+
+int64_t BlackBoxFileReader::timeAt(int row) const {
+    if (row < 0 || row >= m_count) {
+        return 0;
+    }
+
+    auto block = blockForRow(row);
+    int64_t time;
+    memcpy(&time, recordData(block, row - static_cast<int>(m_blocks[block].firstRow)), sizeof(time));
+    return time;
+}
+
+
+int BlackBoxFileReader::indexForTime(int64_t time) const {
+    if (m_count == 0 || time < m_blocks[0].firstTime) {
+        return -1;
+    }
+
+    auto end = m_blocks + m_blockCount;
+    auto it = std::upper_bound(m_blocks, end, time, [](int64_t t, const BlackBoxIndexEntry &entry) {
+        return t < entry.firstTime;
+    });
+    auto block = static_cast<int>(it - m_blocks) - 1;
+
+    // first record in the block that is later than the time
+    int low = 0;
+    int high = static_cast<int>(m_blocks[block].count);
+    while (low < high) {
+        int mid = (low + high) / 2;
+        int64_t t;
+        memcpy(&t, recordData(block, mid), sizeof(t));
+        if (t <= time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return static_cast<int>(m_blocks[block].firstRow) + low - 1;
+}
@@ -9,195 +9,6 @@
 
 #include "openhd.h"
 
-BlackBox::BlackBox(const QString &flight_mode,
-                   const QString &time,
-                   const double &lat,
-                   const double &lon,
-                   const double &alt,
-                   const double &speed,
-                   const int &heading,
-                   const double &vertical,
-                   const double &pitch,
-                   const double &roll,
-                   const double &throttle,
-                   const int &control_pitch,
-                   const int &control_roll,
-                   const int &control_yaw,
-                   const int &control_throttle,
-                   const int &rssi_up,
-                   const int &rssi_down,
-                   const unsigned int &lost_packet_cnt_rc,
-                   const unsigned int &lost_packet_cnt_telemetry_up,
-                   const unsigned int &skipped_packet_cnt,
-                   const unsigned int &injection_fail_cnt,
-                   const double &kbitrate,
-                   const double &kbitrate_measured,
-                   const unsigned int &damaged_block_cnt,
-                   const int &damaged_block_percent,
-                   const unsigned int &lost_packet_cnt,
-                   const int &lost_packet_percent,
-                   const int &airpi_load,
-                   const int &airpi_temp,
-                   const double &air_batt_v,
-                   const int &flight_mah,
-                   const int &distance,
-                   const double &home_course,
-                   const double &homelat,
-                   const double &homelon,
-                   const QString &flight_time,
-                   const double &flight_distance)
-                    : m_flight_mode(flight_mode),
-                    m_time(time),
-                    m_lat(lat),
-                    m_lon(lon),
-                    m_alt(alt),
-                    m_speed(speed),
-                    m_heading(heading),
-                    m_vertical(vertical),
-                    m_pitch(pitch),
-                    m_roll(roll),
-                    m_throttle(throttle),
-                    m_control_pitch(control_pitch),
-                    m_control_roll(control_roll),
-                    m_control_yaw(control_yaw),
-                    m_control_throttle(control_throttle),
-                    m_rssi_up(rssi_up),
-                    m_rssi_down(rssi_down),
-                    m_lost_packet_cnt_rc(lost_packet_cnt_rc),
-                    m_lost_packet_cnt_telemetry_up(lost_packet_cnt_telemetry_up),
-                    m_skipped_packet_cnt(skipped_packet_cnt),
-                    m_injection_fail_cnt(injection_fail_cnt),
-                    m_kbitrate(kbitrate),
-                    m_kbitrate_measured(kbitrate_measured),
-                    m_damaged_block_cnt(damaged_block_cnt),
-                    m_damaged_block_percent(damaged_block_percent),
-                    m_lost_packet_cnt(lost_packet_cnt),
-                    m_lost_packet_percent(lost_packet_percent),
-                    m_airpi_load(airpi_load),
-                    m_airpi_temp(airpi_temp),
-                    m_air_batt_v(air_batt_v),
-                    m_flight_mah(flight_mah),
-                    m_distance(distance),
-                    m_home_course(home_course),
-                    m_homelat(homelat),
-                    m_homelon(homelon),
-                    m_flight_time(flight_time),
-                    m_flight_distance(flight_distance)
-{
-}
-
-QString BlackBox::flight_mode() const{
-    return m_flight_mode;
-}
-QString BlackBox::time() const{
-    return m_time;
-}
-double BlackBox::lat() const{
-    return m_lat;
-}
-double BlackBox::lon() const{
-    return m_lon;
-}
-double BlackBox::alt() const{
-    return m_alt;
-}
-double BlackBox::speed() const{
-    return m_speed;
-}
-int BlackBox::heading() const{
-    return m_heading;
-}
-double BlackBox::vertical() const{
-    return m_vertical;
-}
-double BlackBox::pitch() const{
-    return m_pitch;
-}
-double BlackBox::roll() const{
-    return m_roll;
-}
-double BlackBox::throttle() const{
-    return m_throttle;
-}
-int BlackBox::control_pitch() const{
-    return m_control_pitch;
-}
-int BlackBox::control_roll() const{
-    return m_control_roll;
-}
-int BlackBox::control_yaw() const{
-    return m_control_yaw;
-}
-int BlackBox::control_throttle() const{
-    return m_control_throttle;
-}
-int BlackBox::rssi_up() const{
-    return m_rssi_up;
-}
-int BlackBox::rssi_down() const{
-    return m_rssi_down;
-}
-unsigned int BlackBox::lost_packet_cnt_rc() const{
-    return m_lost_packet_cnt_rc;
-}
-unsigned int BlackBox::lost_packet_cnt_telemetry_up() const{
-    return m_lost_packet_cnt_telemetry_up;
-}
-unsigned int BlackBox::skipped_packet_cnt() const{
-    return m_skipped_packet_cnt;
-}
-unsigned int BlackBox::injection_fail_cnt() const{
-    return m_injection_fail_cnt;
-}
-double BlackBox::kbitrate() const{
-    return m_kbitrate;
-}
-double BlackBox::kbitrate_measured() const{
-    return m_kbitrate_measured;
-}
-unsigned int BlackBox::damaged_block_cnt() const{
-    return m_damaged_block_cnt;
-}
-int BlackBox::damaged_block_percent() const{
-    return m_damaged_block_percent;
-}
-unsigned int BlackBox::lost_packet_cnt() const{
-    return m_lost_packet_cnt;
-}
-int BlackBox::lost_packet_percent() const{
-    return m_lost_packet_percent;
-}
-int BlackBox::airpi_load() const{
-    return m_airpi_load;
-}
-int BlackBox::airpi_temp() const{
-    return m_airpi_temp;
-}
-double BlackBox::air_batt_v() const{
-    return m_air_batt_v;
-}
-int BlackBox::flight_mah() const{
-    return m_flight_mah;
-}
-int BlackBox::distance() const{
-    return m_distance;
-}
-double BlackBox::home_course() const{
-    return m_home_course;
-}
-double BlackBox::homelat() const{
-    return m_homelat;
-}
-double BlackBox::homelon() const{
-    return m_homelon;
-}
-QString BlackBox::flight_time() const{
-    return m_flight_time;
-}
-double BlackBox::flight_distance() const{
-    return m_flight_distance;
-}
-
 static BlackBoxModel* _instance = nullptr;
 
 BlackBoxModel* BlackBoxModel::instance() {
@@ -213,34 +24,193 @@ BlackBoxModel::BlackBoxModel(QObject *parent): QAbstractListModel(parent){
 
 void BlackBoxModel::initBlackBoxModel() {
     qDebug() << "BlackBoxModel::initBlackBoxModel()";
+
+    QSettings settings;
+    auto limit = settings.value("blackbox_memory_limit", 16).toInt();
+    if (limit < 1) {
+        limit = 1;
+    }
+    m_store.setMemoryLimit(static_cast<size_t>(limit) * 1024 * 1024);
+
+    auto sync_interval = settings.value("blackbox_sync_interval", 5).toInt();
+    m_writer.setSyncInterval(qMax(sync_interval, 1) * 1000);
+
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &BlackBoxModel::closeFlightFile);
 }
 
-void BlackBoxModel::addBlackBoxObject(const BlackBox &blackbox){
-        //qDebug() << "BlackBoxModel::addBlackBoxMarker()";
+QString BlackBoxModel::flightDirectory() const {
+    auto dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (dir.isEmpty()) {
+        dir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    }
+    return dir + "/blackbox";
+}
 
-        beginInsertRows(QModelIndex(), rowCount(), rowCount());
+/*
+ * Every armed flight goes to its own file, so it survives a crash or restart and can be
+ * loaded again later.
+ */
+void BlackBoxModel::setArmed(bool armed) {
+    if (!armed) {
+        closeFlightFile();
+        return;
+    }
+    if (m_writer.isOpen()) {
+        return;
+    }
 
-        m_blackbox.insert(rowCount(), blackbox);
+    auto dir = flightDirectory();
+    QDir().mkpath(dir);
 
-        endInsertRows();
+    removeOldFlights(dir);
 
-       emit dataChanged(this->index(rowCount()),this->index(rowCount()));
+    /*
+     * A bounced arm can land in the same millisecond as the flight that just closed,
+     * opening that name again would truncate it.
+     */
+    auto timeStr = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz");
+    auto fileName = QString("%1/QOpenHD-%2.bbx").arg(dir).arg(timeStr);
+    for (int n = 1; QFile::exists(fileName); n++) {
+        fileName = QString("%1/QOpenHD-%2-%3.bbx").arg(dir).arg(timeStr).arg(n);
+    }
+    if (!m_writer.open(fileName)) {
+        return;
+    }
 
-        //qDebug() << "BlackBoxModel rowcount=" << rowCount();
+    for (int i = 0; i < m_flight_modes.count(); i++) {
+        m_writer.addFlightMode(i, m_flight_modes[i]);
+    }
+}
+
+/*
+ * Keeps the flight directory to blackbox_max_flights files, including the one about to
+ * be opened, oldest first. The flight being reviewed is left alone.
+ */
+void BlackBoxModel::removeOldFlights(const QString &dir) {
+    QSettings settings;
+    auto max_flights = qMax(settings.value("blackbox_max_flights", 50).toInt(), 1);
+
+    auto files = QDir(dir).entryInfoList({ "*.bbx" }, QDir::Files, QDir::Time | QDir::Reversed);
+    for (int i = 0; i < files.count() - (max_flights - 1); i++) {
+        if (files[i].completeBaseName() == m_flight) {
+            continue;
+        }
+        qDebug() << "BlackBoxModel: removing old flight" << files[i].fileName();
+        QFile::remove(files[i].absoluteFilePath());
+    }
+}
+
+void BlackBoxModel::closeFlightFile() {
+    m_writer.close();
+}
+
+QStringList BlackBoxModel::flights() const {
+    QDir dir(flightDirectory());
+    auto files = dir.entryList({ "*.bbx" }, QDir::Files, QDir::Name | QDir::Reversed);
+    for (auto &file : files) {
+        file.chop(4);
+    }
+    return files;
+}
+
+/*
+ * The file is memory mapped and only its index is read, so even a long flight is
+ * available immediately.
+ */
+bool BlackBoxModel::loadFlight(const QString &flight) {
+    auto fileName = QString("%1/%2.bbx").arg(flightDirectory()).arg(flight);
+
+    beginResetModel();
+    auto ok = m_reader.open(fileName);
+    m_flight = ok ? flight : QString();
+    endResetModel();
+
+    emit flightChanged(m_flight);
+    emit dataChanged(this->index(0),this->index(rowCount()));
+    return ok;
+}
+
+void BlackBoxModel::showLiveFlight() {
+    if (!m_reader.isOpen()) {
+        return;
+    }
+
+    beginResetModel();
+    m_reader.close();
+    m_flight.clear();
+    endResetModel();
+
+    emit flightChanged(m_flight);
+    emit dataChanged(this->index(0),this->index(rowCount()));
+}
+
+int BlackBoxModel::indexForTime(qint64 time) const {
+    return series().indexForTime(time);
+}
 
-        //blackBoxModelChanged(rowCount());
+void BlackBoxModel::addBlackBoxObject(const BlackBoxRecord &record, const QString &flight_mode){
+        //qDebug() << "BlackBoxModel::addBlackBoxMarker()";
+
+        BlackBoxRecord row = record;
+
+        auto mode = m_flight_modes.indexOf(flight_mode);
+        if (mode == -1) {
+            mode = m_flight_modes.count();
+            m_flight_modes.append(flight_mode);
+            m_writer.addFlightMode(mode, flight_mode);
+        }
+        row.values[BlackBoxFlightMode] = mode;
+
+        /*
+         * The flight timer restarts on every arm, but seeking needs times that never go
+         * backwards, so later flights continue where the previous one stopped.
+         */
+        if (m_store.count() > 0) {
+            auto last = m_store.timeAt(m_store.count() - 1);
+            if (row.time + m_time_offset <= last) {
+                m_time_offset = last + 1000 - row.time;
+            }
+        }
+        row.time += m_time_offset;
+
+        m_writer.append(row);
+
+        // while a previous flight is shown the live recording carries on out of view
+        if (m_reader.isOpen()) {
+            m_store.evict();
+            m_store.append(row);
+            return;
+        }
+
+        /*
+         * Once the memory limit is reached the oldest chunk of rows goes, announce that
+         * before the store actually drops them.
+         */
+        auto evicted = m_store.overLimitRows();
+        if (evicted > 0) {
+            beginRemoveRows(QModelIndex(), 0, evicted - 1);
+            m_store.evict();
+            endRemoveRows();
+        }
+
+        beginInsertRows(QModelIndex(), rowCount(), rowCount());
 
-        //playBlackBoxObject(rowCount()-1);
-        //qDebug() << "BlackBoxModel test flight mode=" << mblackbox.alt();
+        m_store.append(row);
 
+        endInsertRows();
+
+       emit dataChanged(this->index(rowCount()),this->index(rowCount()));
 }
 
 
 
 void BlackBoxModel::removeAllBlackBoxMarkers(){
     //remove all rows before adding new
+    if (m_reader.isOpen()) {
+        showLiveFlight();
+    }
     beginResetModel();
-    m_blackbox.clear();
+    m_store.clear();
     endResetModel();
     emit dataChanged(this->index(0),this->index(rowCount()));
 }
@@ -248,93 +218,84 @@ void BlackBoxModel::removeAllBlackBoxMarkers(){
 int BlackBoxModel::rowCount(const QModelIndex &parent) const{
     if (parent.isValid())
         return 0;
-    return m_blackbox.count();
+    return series().count();
+}
+
+QString BlackBoxModel::formatTime(qint64 time) {
+    QTime t(0, 0, 0, 0);
+    t = t.addMSecs(static_cast<int>(time));
+    if (time >= 3600 * 1000) {
+        return t.toString("hh:mm:ss");
+    }
+    return t.toString("mm:ss");
 }
 
 QVariant BlackBoxModel::data(const QModelIndex &index, int role) const{
-    if (index.row() < 0 || index.row() >= m_blackbox.count())
+    if (index.row() < 0 || index.row() >= rowCount())
         return QVariant();
 
-    const BlackBox &blackbox = m_blackbox[index.row()];
-
-    if(role == Flight_Mode)
-        return blackbox.flight_mode();
-    else if (role == Time)
-        return blackbox.time();
-    else if (role == Lat)
-        return blackbox.lat();
-    else if (role == Lon)
-        return blackbox.lon();
-    else if (role == Alt)
-        return blackbox.alt();
-    else if (role == Speed)
-        return blackbox.speed();
-    else if (role == Heading)
-        return blackbox.heading();
-    else if (role == Vertical)
-        return blackbox.vertical();
-    else if (role == Pitch)
-        return blackbox.pitch();
-    else if (role == Roll)
-        return blackbox.roll();
-    else if (role == Throttle)
-        return blackbox.throttle();
-    else if (role == Control_pitch)
-        return blackbox.control_pitch();
-    else if (role == Control_roll)
-        return blackbox.control_roll();
-    else if (role == Control_yaw)
-        return blackbox.control_yaw();
-    else if (role == Control_throttle)
-        return blackbox.control_throttle();
-    else if (role == Rssi_Up)
-        return blackbox.rssi_up();
-    else if (role == Rssi_Down)
-        return blackbox.rssi_down();
-    else if (role == Lost_packet_cnt_rc)
-        return blackbox.lost_packet_cnt_rc();
-    else if (role == Lost_packet_cnt_telemetry_up)
-        return blackbox.lost_packet_cnt_telemetry_up();
-    else if (role == Skipped_packet_cnt)
-        return blackbox.skipped_packet_cnt();
-    else if (role == Injection_fail_cnt)
-        return blackbox.injection_fail_cnt();
-    else if (role == Kbitrate)
-        return blackbox.kbitrate();
-    else if (role == Kbitrate_measured)
-        return blackbox.kbitrate_measured();
-    else if (role == Damaged_block_cnt)
-        return blackbox.damaged_block_cnt();
-    else if (role == Damaged_block_percent)
-        return blackbox.damaged_block_percent();
-    else if (role == Lost_packet_cnt)
-        return blackbox.lost_packet_cnt();
-    else if (role == Lost_packet_percent)
-        return blackbox.lost_packet_percent();
-    else if (role == Airpi_Load)
-        return blackbox.airpi_load();
-    else if (role == Airpi_Temp)
-        return blackbox.airpi_temp();
-    else if (role == Air_Batt_V)
-        return blackbox.air_batt_v();
-    else if (role == Flight_mah)
-        return blackbox.flight_mah();
-    else if (role == Distance)
-        return blackbox.distance();
-    else if (role == Home_course)
-        return blackbox.home_course();
-    else if (role == Homelat)
-        return blackbox.homelat();
-    else if (role == Homelon)
-        return blackbox.homelon();
-    else if (role == Flight_time)
-        return blackbox.flight_time();
-    else if (role == Flight_distance)
-        return blackbox.flight_distance();
+    const BlackBoxRecord blackbox = series().at(index.row());
+
+    switch (role) {
+        case Flight_Mode:
+            return flightMode(blackbox);
+        case Time:
+        case Flight_time:
+            return formatTime(blackbox.time);
+        case Heading:
+        case Control_pitch:
+        case Control_roll:
+        case Control_yaw:
+        case Control_throttle:
+        case Rssi_Up:
+        case Rssi_Down:
+        case Damaged_block_percent:
+        case Lost_packet_percent:
+        case Airpi_Load:
+        case Airpi_Temp:
+        case Flight_mah:
+        case Distance:
+            return static_cast<int>(blackbox.get(fieldForRole(role)));
+        case Lost_packet_cnt_rc:
+        case Lost_packet_cnt_telemetry_up:
+        case Skipped_packet_cnt:
+        case Injection_fail_cnt:
+        case Damaged_block_cnt:
+        case Lost_packet_cnt:
+            return static_cast<unsigned int>(blackbox.values[fieldForRole(role)]);
+        default:
+            break;
+    }
+
+    if (role > Flight_Mode && role <= Flight_distance) {
+        return blackbox.get(fieldForRole(role));
+    }
 
     return QVariant();
 }
 
+QString BlackBoxModel::flightMode(const BlackBoxRecord &record) const {
+    if (m_reader.isOpen()) {
+        return m_reader.flightModes().value(record.values[BlackBoxFlightMode]);
+    }
+    return m_flight_modes.value(record.values[BlackBoxFlightMode]);
+}
+
+/*
+ * The roles follow the field order, except for the two time roles which are both
+ * formatted from the record time.
+ */
+BlackBoxField BlackBoxModel::fieldForRole(int role) {
+    auto field = role - Flight_Mode;
+    if (role > Time) {
+        field--;
+    }
+    if (role > Flight_time) {
+        field--;
+    }
+    return static_cast<BlackBoxField>(field);
+}
+
 QHash<int, QByteArray> BlackBoxModel::roleNames() const{
     QHash<int, QByteArray> roles;
     roles[Flight_Mode] = "flight_mode";
@@ -377,54 +338,3 @@ QHash<int, QByteArray> BlackBoxModel::roleNames() const{
 
     return roles;
 }
-
-BlackBox BlackBoxModel::getBlackBoxObject(int index)const {
-    return m_blackbox.at(index);
-}
-
-void BlackBoxModel::playBlackBoxObject(int index){
-    //qDebug() << "playBlackBoxMarker: " << index;
-    if (index>=rowCount()){
-        index=rowCount()-1;
-    }
-    auto blackbox= getBlackBoxObject(index);
-
-    OpenHD::instance()->set_flight_mode(blackbox.flight_mode());
-    OpenHD::instance()->set_lat(blackbox.lat());
-    OpenHD::instance()->set_lon(blackbox.lon());
-    OpenHD::instance()->set_alt_rel(blackbox.alt());
-    OpenHD::instance()->set_speed(blackbox.speed());
-    OpenHD::instance()->set_hdg(blackbox.heading());
-    OpenHD::instance()->set_vsi(blackbox.vertical());
-    OpenHD::instance()->set_pitch(blackbox.pitch());
-    OpenHD::instance()->set_roll(blackbox.roll());
-    OpenHD::instance()->set_throttle(blackbox.throttle());
-    OpenHD::instance()->set_control_pitch(blackbox.control_pitch());
-    OpenHD::instance()->set_control_roll(blackbox.control_roll());
-    OpenHD::instance()->set_control_yaw(blackbox.control_yaw());
-    OpenHD::instance()->set_control_throttle(blackbox.control_throttle());
-    OpenHD::instance()->set_downlink_rssi(blackbox.rssi_down());
-    OpenHD::instance()->set_current_signal_joystick_uplink(blackbox.rssi_up());
-    OpenHD::instance()->set_lost_packet_cnt_rc(blackbox.lost_packet_cnt_rc());
-    OpenHD::instance()->set_lost_packet_cnt_telemetry_up(blackbox.lost_packet_cnt_telemetry_up());
-    OpenHD::instance()->set_skipped_packet_cnt(blackbox.skipped_packet_cnt());
-    OpenHD::instance()->set_injection_fail_cnt(blackbox.injection_fail_cnt());
-    OpenHD::instance()->set_kbitrate(blackbox.kbitrate());
-    OpenHD::instance()->set_kbitrate_measured(blackbox.kbitrate_measured());
-    OpenHD::instance()->set_damaged_block_cnt(blackbox.damaged_block_cnt());
-    OpenHD::instance()->set_damaged_block_percent(blackbox.damaged_block_percent());
-    OpenHD::instance()->set_lost_packet_cnt(blackbox.lost_packet_cnt());
-    OpenHD::instance()->set_lost_packet_percent(blackbox.lost_packet_percent());
-    OpenHD::instance()->set_cpuload_air(blackbox.airpi_load());
-    OpenHD::instance()->set_temp_air(blackbox.airpi_temp());
-    OpenHD::instance()->set_battery_voltage(blackbox.air_batt_v());
-    OpenHD::instance()->set_flight_mah(blackbox.flight_mah());
-    //maybe blackbox.distance should be blackbox.home_distance
-    OpenHD::instance()->set_home_distance(blackbox.distance());
-    OpenHD::instance()->set_home_course(blackbox.home_course());
-    OpenHD::instance()->set_homelat(blackbox.homelat());
-    OpenHD::instance()->set_homelon(blackbox.homelon());
-    OpenHD::instance()->set_flight_time(blackbox.flight_time());
-    OpenHD::instance()->set_flight_distance(blackbox.flight_distance());
-
-}
@@ -0,0 +1,281 @@
+#include "blackboxplayer.h"
+
+#include "blackboxmodel.h"
+#include "openhd.h"
+
+#include <cmath>
+
+constexpr double kMinRate = 0.25;
+constexpr double kMaxRate = 32.0;
+
+// ~60fps, both for playback and for applying seeks while scrubbing
+constexpr int kFrameInterval = 16;
+
+/*
+ * Samples further apart than this are not interpolated, the recording was paused or a
+ * new flight started in between.
+ */
+constexpr qint64 kMaxInterpolationGap = 5000;
+
+
+static double lerp(double a, double b, double t) {
+    return a + (b - a) * t;
+}
+
+
+// shortest way around, so 350 -> 10 goes through 0 instead of back through 180
+static double lerpAngle(double a, double b, double t) {
+    auto diff = std::fmod(b - a + 540.0, 360.0) - 180.0;
+    return std::fmod(a + diff * t + 360.0, 360.0);
+}
+
+
+static BlackBoxPlayer* _instance = nullptr;
+
+BlackBoxPlayer* BlackBoxPlayer::instance() {
+    if (_instance == nullptr) {
+        _instance = new BlackBoxPlayer();
+    }
+    return _instance;
+}
+
+
+BlackBoxPlayer::BlackBoxPlayer(QObject *parent): QObject(parent) {
+    qDebug() << "BlackBoxPlayer::BlackBoxPlayer()";
+
+    m_frameTimer.setInterval(kFrameInterval);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &BlackBoxPlayer::frame);
+}
+
+
+void BlackBoxPlayer::setModel(BlackBoxModel *model) {
+    m_model = model;
+
+    connect(model, &QAbstractItemModel::rowsInserted, this, &BlackBoxPlayer::updateRange);
+    connect(model, &QAbstractItemModel::rowsRemoved, this, &BlackBoxPlayer::updateRange);
+    connect(model, &QAbstractItemModel::modelReset, this, &BlackBoxPlayer::updateRange);
+    updateRange();
+}
+
+
+void BlackBoxPlayer::updateRange() {
+    auto &series = m_model->series();
+
+    qint64 start = 0;
+    qint64 end = 0;
+    if (series.count() > 0) {
+        start = series.timeAt(0);
+        end = series.timeAt(series.count() - 1);
+    }
+
+    if (start == m_start && end == m_end) {
+        return;
+    }
+
+    // a different flight was loaded, or the oldest samples were evicted
+    auto reset = start != m_start;
+
+    m_start = start;
+    m_end = end;
+    emit rangeChanged();
+
+    if (reset && m_active) {
+        m_row = -1;
+        seek(qBound(m_start, m_position, m_end));
+    }
+}
+
+
+void BlackBoxPlayer::setRate(double rate) {
+    rate = qBound(kMinRate, rate, kMaxRate);
+    if (rate == m_rate) {
+        return;
+    }
+    m_rate = rate;
+    emit rateChanged(m_rate);
+}
+
+
+QString BlackBoxPlayer::positionText() const {
+    return BlackBoxModel::formatTime(m_position);
+}
+
+
+void BlackBoxPlayer::setActive(bool active) {
+    if (active == m_active) {
+        return;
+    }
+    m_active = active;
+    m_row = -1;
+
+    OpenHD::instance()->pauseBlackBox(active);
+    emit activeChanged(m_active);
+}
+
+
+void BlackBoxPlayer::play() {
+    if (m_model->rowCount() == 0) {
+        return;
+    }
+
+    setActive(true);
+
+    // starting at the end means starting over
+    if (m_position >= m_end) {
+        seek(m_start);
+    }
+
+    m_playing = true;
+    m_clock.start();
+    m_frameTimer.start();
+    emit playingChanged(true);
+}
+
+
+void BlackBoxPlayer::pause() {
+    if (!m_playing) {
+        return;
+    }
+    m_playing = false;
+    emit playingChanged(false);
+}
+
+
+void BlackBoxPlayer::seek(qint64 time) {
+    if (m_model->rowCount() == 0) {
+        return;
+    }
+
+    setActive(true);
+
+    m_position = qBound(m_start, time, m_end);
+    m_dirty = true;
+    emit positionChanged(m_position);
+
+    if (!m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
+}
+
+
+void BlackBoxPlayer::stop() {
+    pause();
+    m_frameTimer.stop();
+    m_dirty = false;
+    setActive(false);
+}
+
+
+void BlackBoxPlayer::frame() {
+    if (m_playing) {
+        auto elapsed = m_clock.restart();
+        m_position += static_cast<qint64>(elapsed * m_rate);
+        if (m_position >= m_end) {
+            m_position = m_end;
+            pause();
+        }
+        m_dirty = true;
+        emit positionChanged(m_position);
+    }
+
+    if (m_dirty) {
+        m_dirty = false;
+        apply();
+    }
+
+    // nothing left to do until the next seek or play
+    if (!m_playing) {
+        m_frameTimer.stop();
+    }
+}
+
+
+void BlackBoxPlayer::apply() {
+    auto &series = m_model->series();
+
+    auto row = series.indexForTime(m_position);
+    if (row < 0) {
+        row = 0;
+    }
+    if (row >= series.count()) {
+        return;
+    }
+
+    auto record = series.at(row);
+    auto discrete = row != m_row;
+    m_row = row;
+
+    if (row + 1 < series.count()) {
+        auto next = series.at(row + 1);
+        auto span = next.time - record.time;
+
+        if (span > 0 && span <= kMaxInterpolationGap) {
+            auto t = static_cast<double>(m_position - record.time) / span;
+
+            for (auto field : { BlackBoxLat, BlackBoxLon, BlackBoxAlt, BlackBoxSpeed, BlackBoxVertical,
+                                BlackBoxPitch, BlackBoxRoll, BlackBoxDistance, BlackBoxFlightDistance }) {
+                record.set(field, lerp(record.get(field), next.get(field), t));
+            }
+            record.set(BlackBoxHeading, lerpAngle(record.get(BlackBoxHeading), next.get(BlackBoxHeading), t));
+        }
+    }
+
+    pushState(record, discrete);
+
+    auto flight_time = BlackBoxModel::formatTime(m_position);
+    if (flight_time != m_flight_time) {
+        m_flight_time = flight_time;
+        OpenHD::instance()->set_flight_time(flight_time);
+    }
+}
+
+
+/*
+ * Goes through the same OpenHD setters live telemetry uses, so every widget shows the
+ * recording exactly as it would the live link.
+ */
+void BlackBoxPlayer::pushState(const BlackBoxRecord &record, bool discrete) {
+    auto openhd = OpenHD::instance();
+
+    openhd->set_lat(record.get(BlackBoxLat));
+    openhd->set_lon(record.get(BlackBoxLon));
+    openhd->set_alt_rel(record.get(BlackBoxAlt));
+    openhd->set_speed(record.get(BlackBoxSpeed));
+    openhd->set_hdg(static_cast<int>(std::lround(record.get(BlackBoxHeading))) % 360);
+    openhd->set_vsi(record.get(BlackBoxVertical));
+    openhd->set_pitch(record.get(BlackBoxPitch));
+    openhd->set_roll(record.get(BlackBoxRoll));
+    openhd->set_home_distance(record.get(BlackBoxDistance));
+    openhd->set_flight_distance(record.get(BlackBoxFlightDistance));
+
+    if (!discrete) {
+        return;
+    }
+
+    openhd->set_flight_mode(m_model->flightMode(record));
+    openhd->set_throttle(record.get(BlackBoxThrottle));
+    openhd->set_control_pitch(record.get(BlackBoxControlPitch));
+    openhd->set_control_roll(record.get(BlackBoxControlRoll));
+    openhd->set_control_yaw(record.get(BlackBoxControlYaw));
+    openhd->set_control_throttle(record.get(BlackBoxControlThrottle));
+    openhd->set_downlink_rssi(record.get(BlackBoxRssiDown));
+    openhd->set_current_signal_joystick_uplink(record.get(BlackBoxRssiUp));
+    openhd->set_lost_packet_cnt_rc(static_cast<unsigned int>(record.values[BlackBoxLostPacketCntRC]));
+    openhd->set_lost_packet_cnt_telemetry_up(static_cast<unsigned int>(record.values[BlackBoxLostPacketCntTelemetryUp]));
+    openhd->set_skipped_packet_cnt(static_cast<unsigned int>(record.values[BlackBoxSkippedPacketCnt]));
+    openhd->set_injection_fail_cnt(static_cast<unsigned int>(record.values[BlackBoxInjectionFailCnt]));
+    openhd->set_kbitrate(record.get(BlackBoxKbitrate));
+    openhd->set_kbitrate_measured(record.get(BlackBoxKbitrateMeasured));
+    openhd->set_damaged_block_cnt(static_cast<unsigned int>(record.values[BlackBoxDamagedBlockCnt]));
+    openhd->set_damaged_block_percent(record.get(BlackBoxDamagedBlockPercent));
+    openhd->set_lost_packet_cnt(static_cast<unsigned int>(record.values[BlackBoxLostPacketCnt]));
+    openhd->set_lost_packet_percent(record.get(BlackBoxLostPacketPercent));
+    openhd->set_cpuload_air(record.get(BlackBoxAirpiLoad));
+    openhd->set_temp_air(record.get(BlackBoxAirpiTemp));
+    openhd->set_battery_voltage(record.get(BlackBoxAirBattV));
+    openhd->set_flight_mah(record.get(BlackBoxFlightMah));
+    openhd->set_home_course(record.get(BlackBoxHomeCourse));
+    openhd->set_homelat(record.get(BlackBoxHomeLat));
+    openhd->set_homelon(record.get(BlackBoxHomeLon));
+}
@@ -0,0 +1,345 @@
+#include "blackboxstore.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+/*
+ * What one stored unit of each field means, the resolution is well below what any of
+ * the telemetry sources actually deliver.
+ */
+static const double kBlackBoxScale[BlackBoxFieldCount] = {
+    1,          // flight mode index
+    1e7,        // lat, 1e-7 degrees (~1 cm)
+    1e7,        // lon
+    100,        // alt, cm
+    100,        // speed
+    1,          // heading, degrees
+    100,        // vertical speed
+    100,        // pitch, 0.01 degrees
+    100,        // roll
+    1,          // throttle, percent
+    1,          // control pitch
+    1,          // control roll
+    1,          // control yaw
+    1,          // control throttle
+    1,          // rssi up
+    1,          // rssi down
+    1,          // lost packet cnt rc
+    1,          // lost packet cnt telemetry up
+    1,          // skipped packet cnt
+    1,          // injection fail cnt
+    100,        // kbitrate
+    100,        // kbitrate measured
+    1,          // damaged block cnt
+    1,          // damaged block percent
+    1,          // lost packet cnt
+    1,          // lost packet percent
+    1,          // air load
+    1,          // air temp
+    100,        // air battery, cV
+    1,          // flight mah
+    1,          // home distance, m
+    1,          // home course, degrees
+    1e7,        // home lat
+    1e7,        // home lon
+    10,         // flight distance, dm
+};
+
+
+double BlackBoxRecord::get(BlackBoxField field) const {
+    return values[field] / kBlackBoxScale[field];
+}
+
+
+void BlackBoxRecord::set(BlackBoxField field, double value) {
+    /*
+     * The packet counters are unsigned and may pass INT32_MAX, they go through uint32 so
+     * they wrap instead of saturating. Everything else is clamped.
+     */
+    double scaled = std::round(value * kBlackBoxScale[field]);
+    if (scaled >= 0 && scaled <= 4294967295.0) {
+        values[field] = static_cast<int32_t>(static_cast<uint32_t>(scaled));
+    } else {
+        values[field] = static_cast<int32_t>(std::max(-2147483648.0, std::min(2147483647.0, scaled)));
+    }
+}
+
+
+static void putVarint(std::vector<uint8_t> &out, int64_t value) {
+    uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    while (zigzag >= 0x80) {
+        out.push_back(static_cast<uint8_t>(zigzag | 0x80));
+        zigzag >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(zigzag));
+}
+
+
+static int64_t getVarint(const uint8_t *&p) {
+    uint64_t zigzag = 0;
+    int shift = 0;
+    while (*p & 0x80) {
+        zigzag |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+        shift += 7;
+    }
+    zigzag |= static_cast<uint64_t>(*p++) << shift;
+    return static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+}
+
+
+void BlackBoxStore::Columns::reserve(int rows) {
+    time.reserve(rows);
+    for (auto &column : values) {
+        column.reserve(rows);
+    }
+}
+
+
+void BlackBoxStore::Columns::clear() {
+    time.clear();
+    for (auto &column : values) {
+        column.clear();
+    }
+}
+
+
+BlackBoxRecord BlackBoxStore::Columns::row(int index) const {
+    BlackBoxRecord record;
+    record.time = time[index];
+    for (int field = 0; field < BlackBoxFieldCount; field++) {
+        record.values[field] = values[field][index];
+    }
+    return record;
+}
+
+
+BlackBoxStore::BlackBoxStore(size_t memoryLimit): m_memoryLimit(memoryLimit) {
+    m_open.reserve(kRowsPerChunk);
+    m_cache.reserve(kRowsPerChunk);
+}
+
+
+int BlackBoxStore::overLimitRows() const {
+    if (m_open.time.size() < static_cast<size_t>(kRowsPerChunk)) {
+        return 0;
+    }
+
+    /*
+     * The next append seals a chunk, which may need a new block. Memory only comes back
+     * a whole block at a time, so drop every chunk in the oldest blocks until it fits,
+     * always keeping the block currently being filled.
+     */
+    size_t blocks = m_blocks.size() + 1;
+    int lastBlock = m_firstBlock + static_cast<int>(m_blocks.size()) - 1;
+    int rows = 0;
+    size_t chunk = 0;
+
+    for (int block = m_firstBlock; block < lastBlock && blocks * kBlockSize > m_memoryLimit; block++) {
+        while (chunk < m_chunks.size() && m_chunks[chunk].block == block) {
+            rows += m_chunks[chunk].rows;
+            chunk++;
+        }
+        blocks--;
+    }
+
+    return rows;
+}
+
+
+void BlackBoxStore::evict() {
+    auto rows = overLimitRows();
+
+    while (rows > 0 && !m_chunks.empty()) {
+        auto &chunk = m_chunks.front();
+        rows -= chunk.rows;
+        m_count -= chunk.rows;
+        m_sealedRows -= chunk.rows;
+        m_blocks[chunk.block - m_firstBlock].chunks--;
+        m_chunks.pop_front();
+        m_firstChunk++;
+
+        while (m_blocks.size() > 1 && m_blocks.front().chunks == 0) {
+            m_blocks.pop_front();
+            m_firstBlock++;
+        }
+    }
+
+    m_cacheChunk = -1;
+}
+
+
+void BlackBoxStore::append(const BlackBoxRecord &record) {
+    if (m_open.time.size() >= static_cast<size_t>(kRowsPerChunk)) {
+        seal();
+    }
+
+    m_open.time.push_back(record.time);
+    for (int field = 0; field < BlackBoxFieldCount; field++) {
+        m_open.values[field].push_back(record.values[field]);
+    }
+    m_count++;
+}
+
+
+/*
+ * Packs the chunk being filled into the arena: the time column, then each field column,
+ * every value as a delta from the row before it.
+ */
+void BlackBoxStore::seal() {
+    std::vector<uint8_t> packed;
+    packed.reserve(m_open.time.size() * (BlackBoxFieldCount + 2));
+
+    int64_t previous = 0;
+    for (auto time : m_open.time) {
+        putVarint(packed, time - previous);
+        previous = time;
+    }
+    for (auto &column : m_open.values) {
+        previous = 0;
+        for (auto value : column) {
+            putVarint(packed, static_cast<int64_t>(value) - previous);
+            previous = value;
+        }
+    }
+
+    if (m_blocks.empty() || m_blocks.back().bytes.size() + packed.size() > m_blocks.back().bytes.capacity()) {
+        Block block;
+        block.bytes.reserve(std::max(kBlockSize, packed.size()));
+        m_blocks.push_back(std::move(block));
+    }
+    auto &block = m_blocks.back();
+
+    Chunk chunk;
+    chunk.firstTime = m_open.time.front();
+    chunk.lastTime = m_open.time.back();
+    chunk.rows = static_cast<int>(m_open.time.size());
+    chunk.block = m_firstBlock + static_cast<int>(m_blocks.size()) - 1;
+    chunk.offset = block.bytes.size();
+    chunk.size = packed.size();
+
+    block.bytes.insert(block.bytes.end(), packed.begin(), packed.end());
+    block.chunks++;
+
+    m_chunks.push_back(chunk);
+    m_sealedRows += chunk.rows;
+
+    m_open.clear();
+}
+
+
+void BlackBoxStore::clear() {
+    m_chunks.clear();
+    m_blocks.clear();
+    m_firstChunk = 0;
+    m_firstBlock = 0;
+    m_open.clear();
+    m_count = 0;
+    m_sealedRows = 0;
+    m_cacheChunk = -1;
+}
+
+
+const BlackBoxStore::Columns &BlackBoxStore::decode(int chunk) const {
+    if (m_cacheChunk == m_firstChunk + chunk) {
+        return m_cache;
+    }
+
+    auto &c = m_chunks[chunk];
+    auto &block = m_blocks[c.block - m_firstBlock];
+    const uint8_t *p = block.bytes.data() + c.offset;
+
+    m_cache.clear();
+
+    int64_t previous = 0;
+    for (int i = 0; i < c.rows; i++) {
+        previous += getVarint(p);
+        m_cache.time.push_back(previous);
+    }
+    for (auto &column : m_cache.values) {
+        previous = 0;
+        for (int i = 0; i < c.rows; i++) {
+            previous += getVarint(p);
+            column.push_back(static_cast<int32_t>(previous));
+        }
+    }
+
+    m_cacheChunk = m_firstChunk + chunk;
+    return m_cache;
+}
+
+
+void BlackBoxStore::locate(int row, int &chunk, int &index) const {
+    // chunks are only sealed once full, so this is plain arithmetic
+    chunk = row / kRowsPerChunk;
+    index = row % kRowsPerChunk;
+}
+
+
+BlackBoxRecord BlackBoxStore::at(int row) const {
+    if (row < 0 || row >= m_count) {
+        return BlackBoxRecord();
+    }
+    if (row >= m_sealedRows) {
+        return m_open.row(row - m_sealedRows);
+    }
+
+    int chunk, index;
+    locate(row, chunk, index);
+    return decode(chunk).row(index);
+}
+
+
+int64_t BlackBoxStore::timeAt(int row) const {
+    if (row < 0 || row >= m_count) {
+        return 0;
+    }
+    if (row >= m_sealedRows) {
+        return m_open.time[row - m_sealedRows];
+    }
+
+    int chunk, index;
+    locate(row, chunk, index);
+
+    // the ends of a chunk are known without decoding it
+    if (index == 0) {
+        return m_chunks[chunk].firstTime;
+    }
+    if (index == m_chunks[chunk].rows - 1) {
+        return m_chunks[chunk].lastTime;
+    }
+    return decode(chunk).time[index];
+}
+
+
+/*
+ * Binary search over the chunk time ranges first, so only the one chunk that can hold
+ * the answer is decoded.
+ */
+int BlackBoxStore::indexForTime(int64_t time) const {
+    if (m_count == 0 || time < timeAt(0)) {
+        return -1;
+    }
+
+    if (!m_open.time.empty() && time >= m_open.time.front()) {
+        auto it = std::upper_bound(m_open.time.begin(), m_open.time.end(), time);
+        return m_sealedRows + static_cast<int>(it - m_open.time.begin()) - 1;
+    }
+
+    auto chunk = std::upper_bound(m_chunks.begin(), m_chunks.end(), time, [](int64_t t, const Chunk &c) {
+        return t < c.firstTime;
+    });
+    int index = static_cast<int>(chunk - m_chunks.begin()) - 1;
+
+    auto &times = decode(index).time;
+    auto it = std::upper_bound(times.begin(), times.end(), time);
+    return index * kRowsPerChunk + static_cast<int>(it - times.begin()) - 1;
+}
+
+
+size_t BlackBoxStore::memoryUsed() const {
+    size_t used = m_blocks.size() * kBlockSize;
+    used += m_chunks.size() * sizeof(Chunk);
+    used += 2 * kRowsPerChunk * (sizeof(int64_t) + BlackBoxFieldCount * sizeof(int32_t));
+    return used;
+}
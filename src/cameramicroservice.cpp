@@ -0,0 +1,127 @@
+#include "cameramicroservice.h"
+
+#include <QtNetwork>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <openhd/mavlink.h>
+
+#include "util.h"
+#include "constants.h"
+
+#include "openhd.h"
+
+
+/*
+ * A lost keyframe request costs a GOP, a duplicate one costs an extra IDR on an already
+ * struggling link. The base class already retries until acked, so anything more often
+ * than this is just another loss burst from the same outage.
+ */
+static const qint64 kKeyframeRequestInterval = 250;
+
+
+CameraMicroservice::CameraMicroservice(QObject *parent, MicroserviceTarget target, MavlinkType mavlink_type): MavlinkBase(parent, mavlink_type), m_target(target) {
+    qDebug() << "CameraMicroservice::CameraMicroservice()";
+
+    targetCompID = MAV_COMP_ID_CAMERA;
+    localPort = 14551;
+
+    #if defined(__rasp_pi__)|| defined(__jetson__)
+    groundAddress = "127.0.0.1";
+    #endif
+
+    switch (m_target) {
+        case MicroserviceTargetNone:
+        targetSysID = 0;
+        break;
+        case MicroserviceTargetAir:
+        targetSysID = 253;
+        connect(OpenHD::instance(), &OpenHD::request_keyframe, this, &CameraMicroservice::onRequestKeyframe);
+        break;
+        case MicroserviceTargetGround:
+        targetSysID = 254;
+        break;
+    }
+
+    connect(this, &CameraMicroservice::setup, this, &CameraMicroservice::onSetup);
+}
+
+
+void CameraMicroservice::onSetup() {
+    qDebug() << "CameraMicroservice::onSetup()";
+
+    connect(this, &CameraMicroservice::processMavlinkMessage, this, &CameraMicroservice::onProcessMavlinkMessage);
+    // queued, the state machine only goes back to ready after emitting these
+    connect(this, &CameraMicroservice::commandDone, this, &CameraMicroservice::onCommandFinished, Qt::QueuedConnection);
+    connect(this, &CameraMicroservice::commandFailed, this, &CameraMicroservice::onCommandFinished, Qt::QueuedConnection);
+}
+
+
+/*
+ * Emitted by the video receivers whenever they lose part of the stream. Requests for
+ * the same stream are collapsed here so the receivers don't have to coordinate.
+ *
+ * sendCommand() replaces whatever is in flight, so with main and PiP both losing data
+ * one request would cancel the other's retries. They queue up here instead and go out
+ * one after the other.
+ */
+void CameraMicroservice::onRequestKeyframe(int stream) {
+    if (stream < 0 || stream > 1) {
+        return;
+    }
+
+    auto &last = m_last_keyframe_request[stream];
+    if (last.isValid() && last.elapsed() < kKeyframeRequestInterval) {
+        return;
+    }
+    last.start();
+
+    m_pending_keyframe_requests |= 1 << stream;
+    if (m_command_state == MavlinkCommandStateReady) {
+        sendKeyframeRequest();
+    }
+}
+
+
+void CameraMicroservice::onCommandFinished() {
+    if (m_pending_keyframe_requests != 0 && m_command_state == MavlinkCommandStateReady) {
+        sendKeyframeRequest();
+    }
+}
+
+
+void CameraMicroservice::sendKeyframeRequest() {
+    int stream = (m_pending_keyframe_requests & 1) ? 0 : 1;
+    m_pending_keyframe_requests &= ~(1 << stream);
+
+    MavlinkCommand command(MavlinkCommandTypeLong);
+    command.command_id = kOpenHDCommandRequestKeyframe;
+    command.long_param1 = static_cast<float>(stream);
+    sendCommand(command);
+}
+
+
+void CameraMicroservice::onProcessMavlinkMessage(mavlink_message_t msg) {
+    switch (msg.msgid) {
+        case MAVLINK_MSG_ID_HEARTBEAT: {
+            mavlink_heartbeat_t heartbeat;
+            mavlink_msg_heartbeat_decode(&msg, &heartbeat);
+            break;
+        }
+        case MAVLINK_MSG_ID_SYSTEM_TIME:{
+            mavlink_system_time_t sys_time;
+            mavlink_msg_system_time_decode(&msg, &sys_time);
+            uint32_t boot_time = sys_time.time_boot_ms;
+
+            if (boot_time != m_last_boot) {
+                m_last_boot = boot_time;
+            }
+
+            break;
+        }
+        default: {
+            printf("CameraMicroservice received unmatched message with ID %d, sequence: %d from component %d of system %d\n", msg.msgid, msg.seq, msg.compid, msg.sysid);
+            break;
+        }
+    }
+}
@@ -5,6 +5,7 @@
 #include "openhd.h"
 
 #include "headingladder.h"
+#include "trace.h"
 
 
 HeadingLadder::HeadingLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
@@ -13,6 +14,7 @@ HeadingLadder::HeadingLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
 }
 
 void HeadingLadder::paint(QPainter* painter) {
+    TRACE_SCOPE("paint.HeadingLadder");
     painter->save();
 
     // ticks up/down position
@@ -5,6 +5,7 @@
 #include "openhd.h"
 
 #include "horizonladder.h"
+#include "trace.h"
 
 
 HorizonLadder::HorizonLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
@@ -15,6 +16,7 @@ HorizonLadder::HorizonLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
 }
 
 void HorizonLadder::paint(QPainter* painter) {
+    TRACE_SCOPE("paint.HorizonLadder");
     painter->save();
 
     painter->setRenderHint(QPainter::Antialiasing);
@@ -0,0 +1,239 @@
+#include "linkstats.h"
+
+#include <cmath>
+
+// weight of a new RSSI reading in the moving average and variance
+constexpr double kRssiAlpha = 0.2;
+
+constexpr int kMinWindow = 200;
+constexpr int kMaxWindow = 30000;
+
+
+static LinkStats* _instance = nullptr;
+
+LinkStats* LinkStats::instance() {
+    if (_instance == nullptr) {
+        _instance = new LinkStats();
+    }
+    return _instance;
+}
+
+
+LinkStats::LinkStats(QObject *parent): QAbstractListModel(parent) {
+    qDebug() << "LinkStats::LinkStats()";
+
+    m_clock.start();
+}
+
+
+int LinkStats::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_adapter_count;
+}
+
+
+QVariant LinkStats::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_adapter_count) {
+        return QVariant();
+    }
+
+    auto &adapter = m_adapters[index.row()];
+
+    switch (role) {
+        case AdapterRole:
+            return index.row();
+        case RssiRole:
+            return adapter.rssi;
+        case RssiAverageRole:
+            return adapter.rssi_average;
+        case RssiDeviationRole:
+            return std::sqrt(adapter.rssi_variance);
+        case PacketRateRole:
+            return adapter.packet_rate;
+        case LossRole:
+            return adapter.loss;
+        case BestRole:
+            return index.row() == m_best_adapter;
+        case RssiHistoryRole: {
+            QVariantList history;
+            history.reserve(adapter.samples.count);
+            for (int i = 0; i < adapter.samples.count; i++) {
+                history.append(adapter.samples.at(i).dbm);
+            }
+            return history;
+        }
+        case LossHistoryRole: {
+            QVariantList history;
+            history.reserve(adapter.samples.count);
+            for (int i = 0; i < adapter.samples.count; i++) {
+                history.append(adapter.samples.at(i).loss);
+            }
+            return history;
+        }
+        default:
+            return QVariant();
+    }
+}
+
+
+QHash<int, QByteArray> LinkStats::roleNames() const {
+    static QHash<int, QByteArray> roles {
+        { AdapterRole, "adapter" },
+        { RssiRole, "rssi" },
+        { RssiAverageRole, "rssiAverage" },
+        { RssiDeviationRole, "rssiDeviation" },
+        { PacketRateRole, "packetRate" },
+        { LossRole, "loss" },
+        { BestRole, "best" },
+        { RssiHistoryRole, "rssiHistory" },
+        { LossHistoryRole, "lossHistory" }
+    };
+    return roles;
+}
+
+
+void LinkStats::setWindow(int window) {
+    window = qBound(kMinWindow, window, kMaxWindow);
+    if (window == m_window) {
+        return;
+    }
+    m_window = window;
+    emit windowChanged(m_window);
+}
+
+
+QVariantList LinkStats::bestHistory() const {
+    QVariantList history;
+    history.reserve(m_best.count);
+    for (int i = 0; i < m_best.count; i++) {
+        history.append(static_cast<int>(m_best.at(i)));
+    }
+    return history;
+}
+
+
+QVariantList LinkStats::lossHistory() const {
+    QVariantList history;
+    history.reserve(m_samples.count);
+    for (int i = 0; i < m_samples.count; i++) {
+        history.append(m_samples.at(i).loss);
+    }
+    return history;
+}
+
+
+void LinkStats::update(const wifibroadcast_rx_status_forward_t &status) {
+    auto now = m_clock.elapsed();
+    auto adapter_count = qMin<int>(status.wifi_adapter_cnt, kMaxAdapters);
+
+    /*
+     * The first status only sets the baseline, deltas against zero would count the
+     * whole session so far as one interval.
+     */
+    if (!m_started) {
+        m_started = true;
+        m_last = status;
+        for (int i = 0; i < adapter_count; i++) {
+            m_adapters[i].last_received = status.adapter[i].received_packet_cnt;
+        }
+    }
+
+    LinkSample sample;
+    sample.time = now;
+    sample.received = delta(status.received_packet_cnt, m_last.received_packet_cnt);
+    sample.lost = delta(status.lost_packet_cnt, m_last.lost_packet_cnt);
+    sample.damaged = delta(status.damaged_block_cnt, m_last.damaged_block_cnt);
+    // lost packets never show up in received, so they are added back to get what was sent
+    auto sent = sample.received + sample.lost;
+    sample.loss = sent > 0 ? 100.0 * sample.lost / sent : 0.0;
+    m_samples.push(sample);
+    m_last = status;
+
+    // everything inside the window
+    auto window_start = now - m_window;
+    quint64 received = 0;
+    quint64 lost = 0;
+    quint64 damaged = 0;
+    for (int i = m_samples.count - 1; i >= 0; i--) {
+        auto &s = m_samples.at(i);
+        if (s.time < window_start) {
+            break;
+        }
+        received += s.received;
+        lost += s.lost;
+        damaged += s.damaged;
+    }
+    auto window_sent = received + lost;
+    m_loss_percent = window_sent > 0 ? 100.0 * lost / window_sent : 0.0;
+    m_damaged_percent = received > 0 ? 100.0 * damaged / received : 0.0;
+
+    if (adapter_count > m_adapter_count) {
+        beginInsertRows(QModelIndex(), m_adapter_count, adapter_count - 1);
+        for (int i = m_adapter_count; i < adapter_count; i++) {
+            m_adapters[i] = Adapter();
+            m_adapters[i].last_received = status.adapter[i].received_packet_cnt;
+            m_adapters[i].rssi_average = status.adapter[i].current_signal_dbm;
+        }
+        m_adapter_count = adapter_count;
+        endInsertRows();
+    } else if (adapter_count < m_adapter_count) {
+        beginRemoveRows(QModelIndex(), adapter_count, m_adapter_count - 1);
+        m_adapter_count = adapter_count;
+        endRemoveRows();
+    }
+
+    auto best = -1;
+    for (int i = 0; i < adapter_count; i++) {
+        auto &adapter = m_adapters[i];
+        auto &rx = status.adapter[i];
+
+        AdapterSample adapter_sample;
+        adapter_sample.time = now;
+        adapter_sample.received = delta(rx.received_packet_cnt, adapter.last_received);
+        adapter_sample.dbm = rx.current_signal_dbm;
+        // what this adapter missed of everything the link carried in the interval
+        adapter_sample.loss = sent > 0 ? qBound(0.0, 100.0 - 100.0 * adapter_sample.received / sent, 100.0) : 0.0;
+        adapter.samples.push(adapter_sample);
+        adapter.last_received = rx.received_packet_cnt;
+
+        adapter.rssi = rx.current_signal_dbm;
+        auto diff = adapter.rssi - adapter.rssi_average;
+        adapter.rssi_average += kRssiAlpha * diff;
+        adapter.rssi_variance = (1.0 - kRssiAlpha) * (adapter.rssi_variance + kRssiAlpha * diff * diff);
+
+        // each delta covers the time since the sample before it
+        quint64 adapter_received = 0;
+        qint64 start = now;
+        for (int s = adapter.samples.count - 1; s >= 0; s--) {
+            auto &item = adapter.samples.at(s);
+            start = item.time;
+            if (item.time < window_start) {
+                break;
+            }
+            adapter_received += item.received;
+        }
+        auto span = now - start;
+        adapter.packet_rate = span > 0 ? adapter_received * 1000.0 / span : 0.0;
+        adapter.loss = window_sent > 0 ? qBound(0.0, 100.0 - 100.0 * adapter_received / window_sent, 100.0) : 0.0;
+
+        if (best < 0 || adapter.rssi_average > m_adapters[best].rssi_average) {
+            best = i;
+        }
+    }
+
+    m_best.push(static_cast<qint8>(best));
+    m_best_adapter = best;
+    m_best_switches = 0;
+    for (int i = 1; i < m_best.count; i++) {
+        if (m_best.at(i) != m_best.at(i - 1)) {
+            m_best_switches++;
+        }
+    }
+
+    if (adapter_count > 0) {
+        emit dataChanged(index(0), index(adapter_count - 1));
+    }
+    emit statsChanged();
+}
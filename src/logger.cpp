@@ -1,33 +1,38 @@
 #include "logger.h"
 
-
-#if defined(__rasp_pi__)
-#include <stdio.h>
-#include <unistd.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#endif
-
-#include <QThread>
-#include <QtConcurrent>
-#include <QFutureWatcher>
-#include <QFuture>
 #include "localmessage.h"
 #include "constants.h"
 
 #include "logger_t.h"
 
+#include <cstring>
+
 /* this class needs work... right now just trying to solve pi crash issue
  * -the class is a bit hard to control with the build directive (enable_log)
  * -all of the platforms paths need to be determined.. the only accurate one
  * is for the rpi.
  */
 
+// the file is rotated once it grows past this, keeping kLogFiles old ones
+constexpr qint64 kMaxLogSize = 1024 * 1024;
+constexpr int kLogFiles = 3;
+
+// how long the writer sleeps when the queue is empty
+constexpr int kWriterInterval = 100;
+
+static const char *kLevelNames[] = {
+    "EMERG", "ALERT", "CRIT", "ERROR", "WARN", "NOTICE", "INFO", "DEBUG"
+};
 
-static Logger* _instance = new Logger();
+
+static Logger* _instance = nullptr;
 
 
 Logger::Logger(QObject *parent): QObject(parent) {
+    for (quint32 i = 0; i < kQueueSize; i++) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
     #if defined(ENABLE_LOG)
     qDebug() << "Logger::Logger()";
     init();
@@ -35,7 +40,15 @@ Logger::Logger(QObject *parent): QObject(parent) {
 }
 
 
+Logger::~Logger() {
+    stop();
+}
+
+
 Logger* Logger::instance() {
+    if (_instance == nullptr) {
+        _instance = new Logger();
+    }
     return _instance;
 }
 
@@ -66,39 +79,169 @@ filePath="%userprofiles%\AppData\Local\QOpenHD_Log.log"; //untested
 #endif
 
 
-outFile = new QFile(filePath);
+m_file.setFileName(filePath);
 
-outFile->open(QIODevice::WriteOnly | QIODevice::Append);
+m_file.open(QIODevice::WriteOnly | QIODevice::Append);
 
-if(!outFile->isOpen()){
+if(!m_file.isOpen()){
     qDebug() << "Log File NOT open";
     LocalMessage::instance()->showMessage("Could Not Open Log File!", 4);
+    return;
 }
 
+QSettings settings;
+m_level = settings.value("log_level", LogInfo).toInt();
+
+m_clock.start();
+m_wallStart = QDateTime::currentMSecsSinceEpoch();
+
+m_thread = QThread::create([this] { writeLoop(); });
+m_thread->setObjectName("Logger");
+m_thread->start(QThread::LowPriority);
+m_running = true;
+
+if (qApp != nullptr) {
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &Logger::stop);
 }
 
-void Logger::logData(QString data, int level) {
+}
 
-#if defined(ENABLE_LOG)
 
-    if(outFile->isOpen()){
+void Logger::stop() {
+    if (m_thread == nullptr) {
+        return;
+    }
+    m_running = false;
+    m_stop = true;
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+    m_file.close();
+}
 
-        QDateTime dateTime(QDateTime::currentDateTime());
 
-        QString timeStr(dateTime.toString("dd-MM-yyyy HH:mm:ss:zzz"));
+/*
+ * Bounded multi-producer queue after Dmitry Vyukov: a producer claims a position with
+ * a CAS on the enqueue counter, fills the slot and publishes it through the slot's
+ * sequence number. The single consumer hands the slot back the same way.
+ */
+void Logger::logData(const QString &data, int level) {
+    if (!m_running || level > m_level) {
+        return;
+    }
+
+    auto time = m_clock.nsecsElapsed();
+
+    Slot *slot;
+    auto pos = m_enqueue.load(std::memory_order_relaxed);
+    for (;;) {
+        slot = &m_slots[pos % kQueueSize];
+        auto sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<qint32>(sequence - pos);
+        if (diff == 0) {
+            if (m_enqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // full, the writer is behind
+            m_dropped++;
+            return;
+        } else {
+            pos = m_enqueue.load(std::memory_order_relaxed);
+        }
+    }
+
+    auto text = data.toUtf8();
+    auto length = qMin(text.size(), kMaxMessage);
+    memcpy(slot->text, text.constData(), length);
+    slot->length = static_cast<quint16>(length);
+    slot->level = static_cast<quint8>(qBound(0, level, static_cast<int>(LogDebug)));
+    slot->time = time;
 
-        QTextStream outStream(outFile);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+}
 
-        outStream << timeStr << " Data: " << data ;
 
-        //outFile.close(); // is never called
+bool Logger::drain(QByteArray &out) {
+    auto drained = false;
+
+    for (;;) {
+        auto &slot = m_slots[m_dequeue % kQueueSize];
+        if (slot.sequence.load(std::memory_order_acquire) != m_dequeue + 1) {
+            break;
+        }
+
+        // timestamps are only turned into wall clock time here, off the caller's thread
+        auto time = QDateTime::fromMSecsSinceEpoch(m_wallStart + slot.time / 1000000);
+        out.append(time.toString("yyyy-MM-dd HH:mm:ss.zzz").toLatin1());
+        out.append(' ');
+        out.append(kLevelNames[slot.level]);
+        out.append(' ');
+        out.append(slot.text, slot.length);
+        out.append('\n');
+
+        slot.sequence.store(m_dequeue + kQueueSize, std::memory_order_release);
+        m_dequeue++;
+        drained = true;
     }
-#endif
+
+    auto dropped = m_dropped.exchange(0);
+    if (dropped > 0) {
+        out.append(QString("%1 messages dropped\n").arg(dropped).toLatin1());
+    }
+
+    return drained;
 }
 
+
+void Logger::writeLoop() {
+    QByteArray out;
+
+    for (;;) {
+        auto stopping = m_stop.load();
+
+        out.clear();
+        drain(out);
+
+        if (!out.isEmpty()) {
+            m_file.write(out);
+            m_file.flush();
+
+            if (m_file.size() > kMaxLogSize) {
+                rotate();
+            }
+        }
+
+        if (stopping) {
+            return;
+        }
+        if (out.isEmpty()) {
+            QThread::msleep(kWriterInterval);
+        }
+    }
+}
+
+
+/*
+ * QOpenHD_Log.txt -> QOpenHD_Log.txt.1 -> ... -> QOpenHD_Log.txt.<kLogFiles>, the
+ * oldest one is dropped.
+ */
+void Logger::rotate() {
+    m_file.close();
+
+    QFile::remove(QString("%1.%2").arg(filePath).arg(kLogFiles));
+    for (int i = kLogFiles - 1; i >= 1; i--) {
+        QFile::rename(QString("%1.%2").arg(filePath).arg(i), QString("%1.%2").arg(filePath).arg(i + 1));
+    }
+    QFile::rename(filePath, QString("%1.1").arg(filePath));
+
+    m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+
 QObject *loggerSingletonProvider(QQmlEngine *engine, QJSEngine *scriptEngine) {
     Q_UNUSED(engine)
     Q_UNUSED(scriptEngine)
 
-    return _instance;
+    return Logger::instance();
 }
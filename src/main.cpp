@@ -27,15 +27,16 @@ const QVector<QString> permissions({"android.permission.INTERNET",
 //#if defined(ENABLE_LOG)
 #include "logger.h"
 //#endif
+#include "trace.h"
 
-#include "frskytelemetry.h"
-#include "msptelemetry.h"
-#include "ltmtelemetry.h"
-#include "vectortelemetry.h"
-#include "smartporttelemetry.h"
+#include "telemetryreactor.h"
 
 #include "qopenhdlink.h"
 
+#include "linkstats.h"
+
+#include "timeseriesstore.h"
+
 #include "powermicroservice.h"
 
 #include "gpiomicroservice.h"
@@ -44,6 +45,8 @@ const QVector<QString> permissions({"android.permission.INTERNET",
 
 #include "statusmicroservice.h"
 
+#include "cameramicroservice.h"
+
 #include "statuslogmodel.h"
 
 #if defined(ENABLE_ADSB)
@@ -56,9 +59,13 @@ const QVector<QString> permissions({"android.permission.INTERNET",
 
 #include "QmlObjectListModel.h"
 
+#include "videohealth.h"
+#include "videorecorder.h"
+
 #if defined(ENABLE_BLACKBOX)
 #include "blackboxmodel.h"
 #endif
+#include "blackboxplayer.h"
 
 #include "speedladder.h"
 #include "altitudeladder.h"
@@ -72,6 +79,11 @@ const QVector<QString> permissions({"android.permission.INTERNET",
 
 #if defined(ENABLE_RC)
 #include "QJoysticks.h"
+#include "rcsender.h"
+#endif
+
+#if defined(ENABLE_RC_STUB)
+#include "rcreceiverstub.h"
 #endif
 
 #if defined(__ios__)
@@ -237,12 +249,6 @@ int main(int argc, char *argv[]) {
 
 
 
-    qmlRegisterType<FrSkyTelemetry>("OpenHD", 1, 0, "FrSkyTelemetry");
-    qmlRegisterType<MSPTelemetry>("OpenHD", 1, 0, "MSPTelemetry");
-    qmlRegisterType<LTMTelemetry>("OpenHD", 1, 0, "LTMTelemetry");
-    qmlRegisterType<VectorTelemetry>("OpenHD", 1, 0, "VectorTelemetry");
-    qmlRegisterType<SmartportTelemetry>("OpenHD", 1, 0, "SmartportTelemetry");
-
     qmlRegisterType<OpenHDRC>("OpenHD", 1, 0, "OpenHDRC");
 
     qmlRegisterSingletonType<OpenHDPi>("OpenHD", 1, 0, "OpenHDPi", openHDPiSingletonProvider);
@@ -258,6 +264,9 @@ int main(int argc, char *argv[]) {
 
     qmlRegisterUncreatableType<QmlObjectListModel>("OpenHD", 1, 0, "QmlObjectListModel", "Reference only");
 
+    qmlRegisterUncreatableType<VideoRecorder>("OpenHD", 1, 0, "VideoRecorder", "Reference only");
+    qmlRegisterUncreatableType<VideoHealth>("OpenHD", 1, 0, "VideoHealth", "Reference only");
+
     qmlRegisterType<BlackBoxModel>("OpenHD", 1, 0, "BlackBoxModel");
 
     qmlRegisterType<SpeedLadder>("OpenHD", 1, 0, "SpeedLadder");
@@ -401,6 +410,9 @@ OpenHDAppleVideo *pipVideo = new OpenHDAppleVideo(OpenHDStreamTypePiP);
     mavlinkThread->start();
 
 
+    auto linkStats = LinkStats::instance();
+    engine.rootContext()->setContextProperty("LinkStats", linkStats);
+
     auto openhdTelemetry = OpenHDTelemetry::instance();
     engine.rootContext()->setContextProperty("OpenHDTelemetry", openhdTelemetry);
     //QThread *telemetryThread = new QThread();
@@ -410,6 +422,9 @@ OpenHDAppleVideo *pipVideo = new OpenHDAppleVideo(OpenHDStreamTypePiP);
     //telemetryThread->start();
     openhdTelemetry->onStarted();
 
+    // FrSky, SmartPort, LTM and Vector
+    TelemetryReactor::instance();
+
     auto airGPIOMicroservice = new GPIOMicroservice(nullptr, MicroserviceTargetAir, MavlinkTypeTCP);
     engine.rootContext()->setContextProperty("AirGPIOMicroservice", airGPIOMicroservice);
     //QThread *airGPIOThread = new QThread();
@@ -456,10 +471,18 @@ OpenHDAppleVideo *pipVideo = new OpenHDAppleVideo(OpenHDStreamTypePiP);
     QObject::connect(openHDSettings, &OpenHDSettings::groundStationIPUpdated, airLinkMicroservice, &GPIOMicroservice::setGroundIP, Qt::QueuedConnection);
     airLinkMicroservice->onStarted();
 
+    auto airCameraMicroservice = new CameraMicroservice(nullptr, MicroserviceTargetAir, MavlinkTypeTCP);
+    engine.rootContext()->setContextProperty("AirCameraMicroservice", airCameraMicroservice);
+    QObject::connect(openHDSettings, &OpenHDSettings::groundStationIPUpdated, airCameraMicroservice, &CameraMicroservice::setGroundIP, Qt::QueuedConnection);
+    airCameraMicroservice->onStarted();
+
 
     auto statusLogModel = StatusLogModel::instance();
     engine.rootContext()->setContextProperty("StatusLogModel", statusLogModel);
 
+    auto trace = Trace::instance();
+    engine.rootContext()->setContextProperty("Trace", trace);
+
     #if defined(ENABLE_EXAMPLE_WIDGET)
     engine.rootContext()->setContextProperty("EnableExampleWidget", QVariant(true));
     #else
@@ -469,6 +492,10 @@ OpenHDAppleVideo *pipVideo = new OpenHDAppleVideo(OpenHDStreamTypePiP);
     auto blackBoxModel = BlackBoxModel::instance();
     engine.rootContext()->setContextProperty("BlackBoxModel", blackBoxModel);
 
+    auto blackBoxPlayer = BlackBoxPlayer::instance();
+    blackBoxPlayer->setModel(blackBoxModel);
+    engine.rootContext()->setContextProperty("BlackBoxPlayer", blackBoxPlayer);
+
     #if defined(ENABLE_BLACKBOX)
     engine.rootContext()->setContextProperty("EnableBlackbox", QVariant(true));
     blackBoxModel->initBlackBoxModel();
@@ -534,6 +561,9 @@ OpenHDAppleVideo *pipVideo = new OpenHDAppleVideo(OpenHDStreamTypePiP);
 
 #if defined(ENABLE_CHARTS)
     engine.rootContext()->setContextProperty("EnableCharts", QVariant(true));
+    // only sampled when there is a chart to show it
+    auto timeSeriesStore = TimeSeriesStore::instance();
+    engine.rootContext()->setContextProperty("TimeSeriesStore", timeSeriesStore);
 #else
     engine.rootContext()->setContextProperty("EnableCharts", QVariant(false));
 #endif
@@ -543,6 +573,12 @@ OpenHDAppleVideo *pipVideo = new OpenHDAppleVideo(OpenHDStreamTypePiP);
     //QJoysticks* jinstance = QJoysticks::getInstance();
     auto QJoysticks = QJoysticks::getInstance();
     engine.rootContext()->setContextProperty("QJoysticks", QJoysticks);
+    engine.rootContext()->setContextProperty("RCSender", RCSender::instance());
+    RCSender::instance()->setMavlinkLink(mavlinkTelemetry);
+#if defined(ENABLE_RC_STUB)
+    // debug builds only, and it only listens once start() is called
+    engine.rootContext()->setContextProperty("RCReceiverStub", new RCReceiverStub());
+#endif
 #else
     engine.rootContext()->setContextProperty("EnableRC", QVariant(false));
 #endif
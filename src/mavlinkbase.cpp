@@ -1,4 +1,5 @@
 #include "mavlinkbase.h"
+#include "trace.h"
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
@@ -13,7 +14,6 @@
 #include <QFuture>
 
 #include <openhd/mavlink.h>
-#include "openhdrc.h"
 
 #include "util.h"
 #include "constants.h"
@@ -65,11 +65,6 @@ void MavlinkBase::onStarted() {
     connect(m_heartbeat_timer, &QTimer::timeout, this, &MavlinkBase::sendHeartbeat);
     m_heartbeat_timer->start(5000);
 
-    #if defined(ENABLE_RC)
-    m_rc_timer = new QTimer(this);        
-    connect(m_rc_timer, &QTimer::timeout, this, &MavlinkBase::sendRC);
-    #endif
-
 
     emit setup();
 }
@@ -102,6 +97,7 @@ void MavlinkBase::setGroundIP(QString address) {
     }
 
     groundAddress = address;
+    publishEndpoint();
 
     if (reconnect) {
         switch (m_mavlink_type) {
@@ -119,6 +115,15 @@ void MavlinkBase::setGroundIP(QString address) {
 }
 
 
+void MavlinkBase::publishEndpoint() {
+    if (m_mavlink_type != MavlinkTypeUDP || !m_udp_port_learned) {
+        return;
+    }
+    auto address = QHostAddress(groundAddress).toIPv4Address();
+    m_udp_endpoint = address == 0 ? 0 : static_cast<quint64>(address) << 16 | groundUDPPort;
+}
+
+
 void MavlinkBase::set_loading(bool loading) {
     m_loading = loading;
     emit loadingChanged(m_loading);
@@ -146,6 +151,11 @@ void MavlinkBase::sendData(char* data, int len) {
     }
 }
 
+void MavlinkBase::sendFrame(const QByteArray &frame) {
+    sendData(const_cast<char*>(frame.constData()), frame.size());
+}
+
+
 QVariantMap MavlinkBase::getAllParameters() {
     qDebug() << "MavlinkBase::getAllParameters()";
     return m_allParameters;
@@ -180,69 +190,6 @@ void MavlinkBase::sendHeartbeat() {
     sendData((char*)buffer, len);
 }
 
-#if defined(ENABLE_RC)
-void MavlinkBase::joystick_Present_Changed(bool joystickPresent) {
-    qDebug() << "MavlinkBase::joystick_Present_Changed:"<< joystickPresent;
-    if (joystickPresent == true){
-        qDebug() << "MavlinkBase::joystick_Present_Changed: starting timer for RC msgs";
-        m_rc_timer->start(20);
-    }
-    else{
-        qDebug() << "MavlinkBase::joystick_Present_Changed: stopping timer for RC msgs";
-        m_rc_timer->stop();
-    }
-
-}
-
-void MavlinkBase::receive_RC_Update(uint rc1,uint rc2,uint rc3,uint rc4,uint rc5,uint rc6,uint rc7,uint rc8,
-                                    uint rc9,uint rc10,uint rc11,uint rc12,uint rc13,uint rc14,uint rc15,uint rc16,uint rc17,uint rc18) {
-
-    qDebug() << "MavlinkBase::receive_RC_Update="<< rc1;
-    m_rc1 = rc1;
-    m_rc2 = rc2;
-    m_rc3 = rc3;
-    m_rc4 = rc4;
-    m_rc5 = rc5;
-    m_rc6 = rc6;
-    m_rc7 = rc7;
-    m_rc8 = rc8;
-    m_rc9 = rc9;
-    m_rc10 = rc10;
-    m_rc11 = rc11;
-    m_rc12 = rc12;
-    m_rc13 = rc13;
-    m_rc14 = rc14;
-    m_rc15 = rc15;
-    m_rc16 = rc16;
-    m_rc17 = rc17;
-    m_rc18 = rc18;
-
-}
-
-void MavlinkBase::sendRC () {
-    QSettings settings;
-    bool enable_rc = settings.value("enable_rc", m_util.default_mavlink_sysid()).toBool();
-
-    if (enable_rc == true){
-        int mavlink_sysid = settings.value("mavlink_sysid", m_util.default_mavlink_sysid()).toInt();
-
-        mavlink_message_t msg;
-
-        //TODO mavlink sysid is hard coded at 255... in app its default is 225
-        mavlink_msg_rc_channels_override_pack(255, MAV_COMP_ID_MISSIONPLANNER, &msg, targetSysID, targetCompID, m_rc1, m_rc2, m_rc3, m_rc4, m_rc5, m_rc6, m_rc7, m_rc8, m_rc9, m_rc10, m_rc11, m_rc12, m_rc13, m_rc14, m_rc15, m_rc16, m_rc17, m_rc18);
-
-        uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
-        int len = mavlink_msg_to_send_buffer(buffer, &msg);
-
-        sendData((char*)buffer, len);
-    }
-    else {
-        return;
-    }
-
-}
-#endif
-
 void MavlinkBase::requestAutopilotInfo() {
     qDebug() << "MavlinkBase::request_Autopilot_Info";
     QSettings settings;
@@ -418,31 +365,57 @@ void MavlinkBase::processMavlinkUDPDatagrams() {
         QHostAddress _groundAddress;
         quint16 groundPort;
          ((QUdpSocket*)mavlinkSocket)->readDatagram(datagram.data(), datagram.size(), &_groundAddress, &groundPort);
-        groundUDPPort = groundPort;
+        if (!m_udp_port_learned || groundPort != groundUDPPort) {
+            groundUDPPort = groundPort;
+            m_udp_port_learned = true;
+            publishEndpoint();
+        }
         processData(datagram);
     }
 }
 
 
-void MavlinkBase::processData(QByteArray data) {
-    typedef QByteArray::Iterator Iterator;
-    mavlink_message_t msg;
+void MavlinkBase::processData(const QByteArray &data) {
+    TRACE_SCOPE("mavlink.processData");
+    TRACE_COUNTER("mavlink.bytes", data.size());
 
-    for (Iterator i = data.begin(); i != data.end(); i++) {
-        char c = *i;
+    mavlink_message_t msg;
 
-        uint8_t res = mavlink_parse_char(MAVLINK_COMM_0, (uint8_t)c, &msg, &r_mavlink_status);
+    // const iterators, begin() would detach and copy the datagram the caller still holds
+    for (auto i = data.constBegin(); i != data.constEnd(); i++) {
+        uint8_t c = static_cast<uint8_t>(*i);
+
+        /*
+         * mavlink_parse_char() keeps its state per channel, and every MavlinkBase used to
+         * share MAVLINK_COMM_0 across sockets and threads, so partial frames from one
+         * connection corrupted another's. Each instance has its own buffer instead.
+         */
+        uint8_t res = mavlink_frame_char_buffer(&m_rx_message, &m_rx_status, c, &msg, &r_mavlink_status);
+
+        if (res == MAVLINK_FRAMING_BAD_CRC || res == MAVLINK_FRAMING_BAD_SIGNATURE) {
+            // same recovery mavlink_parse_char() does
+            m_rx_status.parse_error++;
+            m_rx_status.msg_received = MAVLINK_FRAMING_INCOMPLETE;
+            m_rx_status.parse_state = MAVLINK_PARSE_STATE_IDLE;
+            if (c == MAVLINK_STX) {
+                m_rx_status.parse_state = MAVLINK_PARSE_STATE_GOT_STX;
+                m_rx_message.len = 0;
+                mavlink_start_checksum(&m_rx_message);
+            }
+            continue;
+        }
 
-        if (res) {
+        if (res == MAVLINK_FRAMING_OK) {
             /*
-             * Not the target we're talking to, so reject it
+             * Not the target we're talking to, so reject it. The rest of the datagram can
+             * still hold messages we want.
              */
             if (m_restrict_sysid && (msg.sysid != targetSysID)) {
-                return;
+                continue;
             }
 
             if (m_restrict_compid && (msg.compid != targetCompID)) {
-                return;
+                continue;
             }
 
             // process ack messages in the base class, subclasses will receive a signal
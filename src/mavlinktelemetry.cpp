@@ -1,4 +1,5 @@
 #include "mavlinktelemetry.h"
+#include "trace.h"
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
@@ -64,11 +65,6 @@ void MavlinkTelemetry::onSetup() {
     connect(timer, &QTimer::timeout, this, &MavlinkTelemetry::requestSysIdSettings);
     resetParamVars();
     timer->start(200);
-
-    #if defined(ENABLE_RC)
-    auto mavlink = MavlinkTelemetry::instance();
-    connect(this, &MavlinkTelemetry::update_RC_MavlinkBase, mavlink, &MavlinkBase::receive_RC_Update);
-    #endif
 }
 
 void MavlinkTelemetry::requestSysIdSettings() {
@@ -117,91 +113,8 @@ void MavlinkTelemetry::FC_Reboot_Shutdown_Changed(int reboot_shutdown) {
     //command.long_param2 = m_arm_disarm;
     sendCommand(command);
 }
-#if defined(ENABLE_RC)
-/*RC updates passing thru mavlink telemetry is really not required. But it does serve to agregate
-  all of the rc inputs in one place and then send all of them in one go to mavlinkbase where they
-  are actually sent
- */
-
-void MavlinkTelemetry::rc1_changed(uint rc1) {
-    m_rc1=rc1;
-    qDebug() << "MavlinkTelemetry::rc1_changed="<< m_rc1;
-    emit update_RC_MavlinkBase (m_rc1, m_rc2, m_rc3, m_rc4, m_rc5, m_rc6, m_rc7, m_rc8, m_rc9, m_rc10, m_rc11, m_rc12, m_rc13, m_rc14, m_rc15, m_rc16, m_rc17, m_rc18);
-}
-void MavlinkTelemetry::rc2_changed(uint rc2) {
-    m_rc2=rc2;
-    qDebug() << "MavlinkTelemetry::rc2_changed="<< m_rc2;
-    emit update_RC_MavlinkBase (m_rc1, m_rc2, m_rc3, m_rc4, m_rc5, m_rc6, m_rc7, m_rc8, m_rc9, m_rc10, m_rc11, m_rc12, m_rc13, m_rc14, m_rc15, m_rc16, m_rc17, m_rc18);
-}
-void MavlinkTelemetry::rc3_changed(uint rc3) {
-    m_rc3=rc3;
-    qDebug() << "MavlinkTelemetry::rc3_changed="<< m_rc3;
-    emit update_RC_MavlinkBase (m_rc1, m_rc2, m_rc3, m_rc4, m_rc5, m_rc6, m_rc7, m_rc8, m_rc9, m_rc10, m_rc11, m_rc12, m_rc13, m_rc14, m_rc15, m_rc16, m_rc17, m_rc18);
-}
-void MavlinkTelemetry::rc4_changed(uint rc4) {
-    m_rc4=rc4;
-    qDebug() << "MavlinkTelemetry::rc4_changed="<< m_rc4;
-    emit update_RC_MavlinkBase (m_rc1, m_rc2, m_rc3, m_rc4, m_rc5, m_rc6, m_rc7, m_rc8, m_rc9, m_rc10, m_rc11, m_rc12, m_rc13, m_rc14, m_rc15, m_rc16, m_rc17, m_rc18);
-}
-void MavlinkTelemetry::rc5_changed(uint rc5) {
-    m_rc5=rc5;
-    qDebug() << "MavlinkTelemetry::rc5_changed="<< m_rc5;
-}
-void MavlinkTelemetry::rc6_changed(uint rc6) {
-    m_rc6=rc6;
-    qDebug() << "MavlinkTelemetry::rc6_changed="<< m_rc6;
-}
-void MavlinkTelemetry::rc7_changed(uint rc7) {
-    m_rc7=rc7;
-    qDebug() << "MavlinkTelemetry::rc7_changed="<< m_rc7;
-}
-void MavlinkTelemetry::rc8_changed(uint rc8) {
-    m_rc8=rc8;
-    qDebug() << "MavlinkTelemetry::rc8_changed="<< m_rc8;
-}
-void MavlinkTelemetry::rc9_changed(uint rc9) {
-    m_rc9=rc9;
-    qDebug() << "MavlinkTelemetry::rc9_changed="<< m_rc9;
-}
-void MavlinkTelemetry::rc10_changed(uint rc10) {
-    m_rc10=rc10;
-    qDebug() << "MavlinkTelemetry::rc10_changed="<< m_rc10;
-}
-void MavlinkTelemetry::rc11_changed(uint rc11) {
-    m_rc11=rc11;
-    qDebug() << "MavlinkTelemetry::rc11_changed="<< m_rc11;
-}
-void MavlinkTelemetry::rc12_changed(uint rc12) {
-    m_rc12=rc12;
-    qDebug() << "MavlinkTelemetry::rc12_changed="<< m_rc12;
-}
-void MavlinkTelemetry::rc13_changed(uint rc13) {
-    m_rc13=rc13;
-    qDebug() << "MavlinkTelemetry::rc13_changed="<< m_rc13;
-}
-void MavlinkTelemetry::rc14_changed(uint rc14) {
-    m_rc14=rc14;
-    qDebug() << "MavlinkTelemetry::rc14_changed="<< m_rc14;
-}
-void MavlinkTelemetry::rc15_changed(uint rc15) {
-    m_rc15=rc15;
-    qDebug() << "MavlinkTelemetry::rc15_changed="<< m_rc15;
-}
-void MavlinkTelemetry::rc16_changed(uint rc16) {
-    m_rc16=rc16;
-    qDebug() << "MavlinkTelemetry::rc16_changed="<< m_rc16;
-}
-void MavlinkTelemetry::rc17_changed(uint rc17) {
-    m_rc17=rc17;
-    qDebug() << "MavlinkTelemetry::rc17_changed="<< m_rc17;
-}
-void MavlinkTelemetry::rc18_changed(uint rc18) {
-    m_rc18=rc18;
-    qDebug() << "MavlinkTelemetry::rc18_changed="<< m_rc18;
-}
-#endif
-
 void MavlinkTelemetry::onProcessMavlinkMessage(mavlink_message_t msg) {
+    TRACE_SCOPE("mavlink.onProcessMavlinkMessage");
 
     if(pause_telemetry==true){
         return;
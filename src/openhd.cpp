@@ -35,7 +35,7 @@ OpenHD::OpenHD(QObject *parent): QObject(parent) {
     #if defined(ENABLE_BLACKBOX)
     auto blackBoxModel = BlackBoxModel::instance();
     connect(this, &OpenHD::addBlackBoxObject, blackBoxModel, &BlackBoxModel::addBlackBoxObject);
-    connect(this, &OpenHD::playBlackBoxObject, blackBoxModel, &BlackBoxModel::playBlackBoxObject);
+    connect(this, &OpenHD::armed_changed, blackBoxModel, &BlackBoxModel::setArmed);
     #endif
 
     timer = new QTimer(this);
@@ -262,23 +262,52 @@ void OpenHD::request_Mission(){
     emit request_Mission_Changed();
 }
 
-void OpenHD::pauseBlackBox(bool pause, int index){
+void OpenHD::pauseBlackBox(bool pause){
     //qDebug() << "OpenHD::pauseBlackBox";
     m_pause_blackbox=pause;
     emit pauseTelemetry(pause);
-    emit playBlackBoxObject(index);
 }
 
 void OpenHD::updateBlackBoxModel() {
     if (m_pause_blackbox==false && m_armed == true){
         //qDebug() << "updateBlackBoxModel() ";
-        emit addBlackBoxObject(BlackBox(m_flight_mode,m_flight_time,m_lat,m_lon,m_alt_msl,m_speed,
-                                        m_hdg,m_vsi,m_pitch,m_roll,m_throttle, m_control_pitch,m_control_roll,m_control_yaw,
-                                        m_control_throttle,m_current_signal_joystick_uplink,m_downlink_rssi,m_lost_packet_cnt_rc,
-                                        m_lost_packet_cnt_telemetry_up,m_skipped_packet_cnt,m_injection_fail_cnt,m_kbitrate,
-                                        m_kbitrate_measured,m_damaged_block_cnt,m_damaged_block_percent,m_lost_packet_cnt,
-                                        m_lost_packet_percent,m_cpuload_air,m_temp_air,m_battery_voltage,m_flight_mah,
-                                        m_home_distance,m_home_course,m_homelat,m_homelon,m_flight_time,m_flight_distance));
+        BlackBoxRecord record;
+        record.time = flightTimeStart.elapsed();
+        record.set(BlackBoxLat, m_lat);
+        record.set(BlackBoxLon, m_lon);
+        record.set(BlackBoxAlt, m_alt_msl);
+        record.set(BlackBoxSpeed, m_speed);
+        record.set(BlackBoxHeading, m_hdg);
+        record.set(BlackBoxVertical, m_vsi);
+        record.set(BlackBoxPitch, m_pitch);
+        record.set(BlackBoxRoll, m_roll);
+        record.set(BlackBoxThrottle, m_throttle);
+        record.set(BlackBoxControlPitch, m_control_pitch);
+        record.set(BlackBoxControlRoll, m_control_roll);
+        record.set(BlackBoxControlYaw, m_control_yaw);
+        record.set(BlackBoxControlThrottle, m_control_throttle);
+        record.set(BlackBoxRssiUp, m_current_signal_joystick_uplink);
+        record.set(BlackBoxRssiDown, m_downlink_rssi);
+        record.set(BlackBoxLostPacketCntRC, m_lost_packet_cnt_rc);
+        record.set(BlackBoxLostPacketCntTelemetryUp, m_lost_packet_cnt_telemetry_up);
+        record.set(BlackBoxSkippedPacketCnt, m_skipped_packet_cnt);
+        record.set(BlackBoxInjectionFailCnt, m_injection_fail_cnt);
+        record.set(BlackBoxKbitrate, m_kbitrate);
+        record.set(BlackBoxKbitrateMeasured, m_kbitrate_measured);
+        record.set(BlackBoxDamagedBlockCnt, m_damaged_block_cnt);
+        record.set(BlackBoxDamagedBlockPercent, m_damaged_block_percent);
+        record.set(BlackBoxLostPacketCnt, m_lost_packet_cnt);
+        record.set(BlackBoxLostPacketPercent, m_lost_packet_percent);
+        record.set(BlackBoxAirpiLoad, m_cpuload_air);
+        record.set(BlackBoxAirpiTemp, m_temp_air);
+        record.set(BlackBoxAirBattV, m_battery_voltage);
+        record.set(BlackBoxFlightMah, m_flight_mah);
+        record.set(BlackBoxDistance, m_home_distance);
+        record.set(BlackBoxHomeCourse, m_home_course);
+        record.set(BlackBoxHomeLat, m_homelat);
+        record.set(BlackBoxHomeLon, m_homelon);
+        record.set(BlackBoxFlightDistance, m_flight_distance);
+        emit addBlackBoxObject(record, m_flight_mode);
     }
 }
 
@@ -795,16 +824,6 @@ void OpenHD::set_last_telemetry_vfr(qint64 last_telemetry_vfr) {
     emit last_telemetry_vfr_changed(m_last_telemetry_vfr);
 }
 
-void OpenHD::set_main_video_running(bool main_video_running) {
-    m_main_video_running = main_video_running;
-    emit main_video_running_changed(m_main_video_running);
-}
-
-void OpenHD::set_pip_video_running(bool pip_video_running) {
-    m_pip_video_running = pip_video_running;
-    emit pip_video_running_changed(m_pip_video_running);
-}
-
 void OpenHD::set_lte_video_running(bool lte_video_running) {
     m_lte_video_running = lte_video_running;
     emit lte_video_running_changed(m_lte_video_running);
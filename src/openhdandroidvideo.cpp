@@ -229,6 +229,9 @@ void OpenHDAndroidVideo::renderLoop() {
             //const int64_t ts = (int64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
             //AMediaCodec_releaseOutputBufferAtTime(codec, status, ts);
             AMediaCodec_releaseOutputBuffer(codec, (size_t)status, info.size != 0);
+            if (info.size != 0) {
+                m_health->frameDecoded();
+            }
         } else if (status == AMEDIACODEC_INFO_OUTPUT_BUFFERS_CHANGED) {
             //qDebug("output buffers changed");
         } else if (status == AMEDIACODEC_INFO_OUTPUT_FORMAT_CHANGED) {
@@ -35,8 +35,10 @@ void decompressionOutputCallback(void *decompressionOutputRefCon,
 
     if (status != noErr) {
         qDebug() << "Decompressed error: " << status;
+        t->health()->decodeError();
     } else {
         t->processDecodedFrame(imageBuffer);
+        t->health()->frameDecoded();
     }
 }
 
@@ -273,6 +275,7 @@ void OpenHDAppleVideo::processFrame(QByteArray &nal, webrtc::H264::NaluType fram
 
     if (status != noErr) {
         qDebug() << "VTDecompressionSessionDecodeFrame fail: " << status;
+        m_health->decodeError();
     }
 
     if (sampleBuffer) {
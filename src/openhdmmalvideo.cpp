@@ -426,6 +426,7 @@ void OpenHDMMALVideo::renderLoop() {
                 if (m_videoOut) {
                     m_videoOut->paintFrame(buffer);
                 }
+                m_health->frameDecoded();
                 m_frames = m_frames + 1;
                 qint64 current_timestamp = QDateTime::currentMSecsSinceEpoch();
                 auto elapsed = current_timestamp - m_last_time;
@@ -1,5 +1,3 @@
-#include <QtNetwork>
-
 #include "openhdrc.h"
 #include "util.h"
 
@@ -11,23 +9,12 @@
 #include <QJoysticks.h>
 #endif
 
-#include "mavlinktelemetry.h"
-
-#define BUFLEN 21
-#define PORT 5565 // UDP port for OpenHD RC
+#if defined(ENABLE_RC)
+#include "rcsender.h"
+#endif
 
 
 OpenHDRC::OpenHDRC(QObject *parent): QObject(parent) {
-
-    #if defined(__rasp_pi__)
-    groundAddress = "127.0.0.1";
-    #endif
-
-    rcSocket = new QUdpSocket(this);
-    rcSocket->bind(QHostAddress::Any);
-
-    connect(rcSocket, &QUdpSocket::readyRead, this, &OpenHDRC::processRCDatagrams);
-
 #if defined(ENABLE_SPEECH)
     m_speech = new QTextToSpeech(this);
 #endif
@@ -51,98 +38,87 @@ OpenHDRC::OpenHDRC(QObject *parent): QObject(parent) {
 
     connect(jinstance, &QJoysticks::countChanged, this, &OpenHDRC::connectedJoysticksChanged);
     connect(jinstance, &QJoysticks::axisChanged, this, &OpenHDRC::axisChanged);
+    connect(jinstance, &QJoysticks::buttonChanged, this, &OpenHDRC::buttonChanged);
 
-    auto mavlink = MavlinkTelemetry::instance();
-    connect(this, &OpenHDRC::rc1_changed, mavlink, &MavlinkTelemetry::rc1_changed);
-    connect(this, &OpenHDRC::rc2_changed, mavlink, &MavlinkTelemetry::rc2_changed);
-    connect(this, &OpenHDRC::rc3_changed, mavlink, &MavlinkTelemetry::rc3_changed);
-    connect(this, &OpenHDRC::rc4_changed, mavlink, &MavlinkTelemetry::rc4_changed);
-    connect(this, &OpenHDRC::rc5_changed, mavlink, &MavlinkTelemetry::rc5_changed);
-    connect(this, &OpenHDRC::rc6_changed, mavlink, &MavlinkTelemetry::rc6_changed);
-    connect(this, &OpenHDRC::rc7_changed, mavlink, &MavlinkTelemetry::rc7_changed);
-    connect(this, &OpenHDRC::rc8_changed, mavlink, &MavlinkTelemetry::rc8_changed);
-    connect(this, &OpenHDRC::rc9_changed, mavlink, &MavlinkTelemetry::rc9_changed);
-    connect(this, &OpenHDRC::rc10_changed, mavlink, &MavlinkTelemetry::rc10_changed);
-    connect(this, &OpenHDRC::rc11_changed, mavlink, &MavlinkTelemetry::rc11_changed);
-    connect(this, &OpenHDRC::rc12_changed, mavlink, &MavlinkTelemetry::rc12_changed);
-    connect(this, &OpenHDRC::rc13_changed, mavlink, &MavlinkTelemetry::rc13_changed);
-    connect(this, &OpenHDRC::rc14_changed, mavlink, &MavlinkTelemetry::rc14_changed);
-    connect(this, &OpenHDRC::rc15_changed, mavlink, &MavlinkTelemetry::rc15_changed);
-    connect(this, &OpenHDRC::rc16_changed, mavlink, &MavlinkTelemetry::rc16_changed);
-    connect(this, &OpenHDRC::rc17_changed, mavlink, &MavlinkTelemetry::rc17_changed);
-    connect(this, &OpenHDRC::rc18_changed, mavlink, &MavlinkTelemetry::rc18_changed);
-
-    connect(this, &OpenHDRC::set_Joystick_Present, mavlink, &MavlinkBase::joystick_Present_Changed);
+#if defined(ENABLE_RC)
+    connect(this, &OpenHDRC::set_Joystick_Present, RCSender::instance(), &RCSender::setActive);
+#endif
 #endif
 
-    QTimer *timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &OpenHDRC::channelTrigger);
-    timer->start(15); // about 60Hz
+#if defined(ENABLE_RC)
+    connect(RCSender::instance(), &RCSender::channelsChanged, this, &OpenHDRC::channelsChanged);
+#endif
 
 }
 
 
 void OpenHDRC::setGroundIP(QString address) {
-    groundAddress = address;
+#if defined(ENABLE_RC)
+    RCSender::instance()->setGroundIP(address);
+#else
+    Q_UNUSED(address)
+#endif
 }
 
 
-void OpenHDRC::channelTrigger() {
-    emit channelUpdate(m_rc1, m_rc2, m_rc3, m_rc4, m_rc5, m_rc6, m_rc7, m_rc8, m_rc9, m_rc10
-                       ,m_rc11,m_rc12,m_rc13,m_rc14,m_rc15,m_rc16,m_rc17,m_rc18);
-/*this is Stuff Stephen wrote and interferes
+/*
+ * Called from QML as the RC settings change, so the RC thread never has to read
+ * QSettings itself.
+ */
+void OpenHDRC::updateSetting(const QString &key, const QVariant &value) {
 #if defined(ENABLE_RC)
-    QSettings settings;
-    auto enable_rc = settings.value("enable_rc", false).toBool();
-
-    if (enable_rc) {
-        QByteArray rcChannels(BUFLEN, 0);
-
-        rcChannels[0] = m_rc1 & 0xFF;
-        rcChannels[1] = (m_rc1 >> 8) & 0xFF;
-
-        rcChannels[2] = m_rc2 & 0xFF;
-        rcChannels[3] = (m_rc2 >> 8) & 0xFF;
-
-        rcChannels[4] = m_rc3 & 0xFF;
-        rcChannels[5] = (m_rc3 >> 8) & 0xFF;
-
-        rcChannels[6] = m_rc4 & 0xFF;
-        rcChannels[7] = (m_rc4 >> 8) & 0xFF;
-
-        rcChannels[8] = m_rc5 & 0xFF;
-        rcChannels[9] = (m_rc5 >> 8) & 0xFF;
-
-        rcChannels[10] = m_rc6 & 0xFF;
-        rcChannels[11] = (m_rc6 >> 8) & 0xFF;
+    RCSender::instance()->updateSetting(key, value);
+#else
+    Q_UNUSED(key)
+    Q_UNUSED(value)
+#endif
+}
 
-        rcChannels[12] = m_rc7 & 0xFF;
-        rcChannels[13] = (m_rc7 >> 8) & 0xFF;
 
-        rcChannels[14] = m_rc8 & 0xFF;
-        rcChannels[15] = (m_rc8 >> 8) & 0xFF;
+void OpenHDRC::setChannel(int channel, uint value) {
+    if (channel < 0 || channel >= static_cast<int>(m_inputs.direct.size()) || m_inputs.direct[channel] == value) {
+        return;
+    }
+    m_inputs.direct[channel] = value;
 
-        rcChannels[16] = seqno;
-        rcChannels[17] = 0;
+#if defined(ENABLE_RC)
+    m_inputs.input_time = RCClock::now();
+    RCSender::instance()->setInputs(m_inputs);
+#else
+    emit channelsChanged();
+#endif
+}
 
-        // is16
-        rcChannels[18] = 0;
 
-        // these would be the buttons, disabled for now.
-        rcChannels[19] = 1;
-        rcChannels[20] = 1;
+uint OpenHDRC::channel(int channel) const {
+#if defined(ENABLE_RC)
+    return RCSender::instance()->channel(channel);
+#else
+    return m_inputs.direct[channel];
+#endif
+}
 
-        rcSocket->writeDatagram(rcChannels, rcChannels.length(), QHostAddress(groundAddress), PORT);
 
-        seqno++;
+/*
+ * Only stores the raw value, deadbands, curves and mixing are up to the RC thread, see
+ * RCTransformTable.
+ */
+void OpenHDRC::setInput(int input, double value) {
+    if (input < 0 || input >= RCInputFrame::kInputs) {
+        return;
+    }
+    auto scaled = static_cast<int16_t>(qBound(-1.0, value, 1.0) * 32767);
+    if (m_inputs.inputs[input] == scaled) {
+        return;
     }
+    m_inputs.inputs[input] = scaled;
+
+#if defined(ENABLE_RC)
+    m_inputs.input_time = RCClock::now();
+    RCSender::instance()->setInputs(m_inputs);
 #endif
-*/
 }
 
-void OpenHDRC::processRCDatagrams() {
-    // no return data necessary from UDP socket
-}
 
 #if defined(ENABLE_GAMEPADS)
 void OpenHDRC::connectedGamepadsChanged() {
@@ -248,166 +224,20 @@ void OpenHDRC::set_selectedJoystick(int selectedJoystick) {
 }
 #endif
 
-void OpenHDRC::set_rc1(uint rc1) {
-    m_rc1 = rc1;
-    emit rc1_changed(m_rc1);
-    qDebug() << "Openhdrc::rc1=" << m_rc1;
-}
-
-void OpenHDRC::set_rc2(uint rc2) {
-    m_rc2 = rc2;
-    emit rc2_changed(m_rc2);
-    qDebug() << "Openhdrc::rc2=" << m_rc2;
-}
-
-void OpenHDRC::set_rc3(uint rc3) {
-    m_rc3 = rc3;
-    emit rc3_changed(m_rc3);
-    qDebug() << "Openhdrc::rc3=" << m_rc3;
-}
-
-void OpenHDRC::set_rc4(uint rc4) {
-    m_rc4 = rc4;
-    emit rc4_changed(m_rc4);
-    qDebug() << "Openhdrc::rc4=" << m_rc4;
-}
-
-
-void OpenHDRC::set_rc5(uint rc5) {
-    m_rc5 = rc5;
-    emit rc5_changed(m_rc5);
-    qDebug() << "Openhdrc::rc5=" << m_rc5;
-}
-
-void OpenHDRC::set_rc6(uint rc6) {
-    m_rc6 = rc6;
-    emit rc6_changed(m_rc6);
-    qDebug() << "Openhdrc::rc6=" << m_rc6;
-}
-
-void OpenHDRC::set_rc7(uint rc7) {
-    m_rc7 = rc7;
-    emit rc7_changed(m_rc7);
-    qDebug() << "Openhdrc::rc7=" << m_rc7;
-}
-
-void OpenHDRC::set_rc8(uint rc8) {
-    m_rc8 = rc8;
-    emit rc8_changed(m_rc8);
-    qDebug() << "Openhdrc::rc8=" << m_rc8;
-}
-
-void OpenHDRC::set_rc9(uint rc9) {
-    m_rc9 = rc9;
-    emit rc9_changed(m_rc9);
-    qDebug() << "Openhdrc::rc9=" << m_rc9;
-}
-
-void OpenHDRC::set_rc10(uint rc10) {
-    m_rc10 = rc10;
-    emit rc10_changed(m_rc10);
-    qDebug() << "Openhdrc::rc10=" << m_rc10;
-}
-
-void OpenHDRC::set_rc11(uint rc11) {
-    m_rc11 = rc11;
-    emit rc11_changed(m_rc11);
-    qDebug() << "Openhdrc::rc11=" << m_rc11;
-}
-
-void OpenHDRC::set_rc12(uint rc12) {
-    m_rc12 = rc12;
-    emit rc12_changed(m_rc12);
-    qDebug() << "Openhdrc::rc12=" << m_rc12;
-}
-
-void OpenHDRC::set_rc13(uint rc13) {
-    m_rc13 = rc13;
-    emit rc13_changed(m_rc13);
-    qDebug() << "Openhdrc::rc13=" << m_rc13;
-}
-
-void OpenHDRC::set_rc14(uint rc14) {
-    m_rc14 = rc14;
-    emit rc14_changed(m_rc14);
-    qDebug() << "Openhdrc::rc14=" << m_rc14;
-}
-
-void OpenHDRC::set_rc15(uint rc15) {
-    m_rc15 = rc15;
-    emit rc15_changed(m_rc15);
-    qDebug() << "Openhdrc::rc15=" << m_rc15;
-}
-
-void OpenHDRC::set_rc16(uint rc16) {
-    m_rc16 = rc16;
-    emit rc16_changed(m_rc16);
-    qDebug() << "Openhdrc::rc16=" << m_rc16;
-}
-
-void OpenHDRC::set_rc17(uint rc17) {
-    m_rc17 = rc17;
-    emit rc17_changed(m_rc17);
-    qDebug() << "Openhdrc::rc17=" << m_rc17;
-}
-
-void OpenHDRC::set_rc18(uint rc18) {
-    m_rc18 = rc18;
-    emit rc18_changed(m_rc18);
-    qDebug() << "Openhdrc::rc18=" << m_rc18;
-}
-
 void OpenHDRC::axisChanged(const int js, const int axis, const qreal value) {
     Q_UNUSED(js)
-    Q_UNUSED(axis)
-
-    //qDebug() << "OpenHDRC::axisChanged()";
-    switch (axis) {
-        case 0:
-        set_rc1(m_util.map(value, -1, 1, 1000, 2000));
-        break;
-
-        case 1:
-        set_rc2(m_util.map(value, -1, 1, 1000, 2000));
-        break;
-
-        case 2:
-        set_rc3(m_util.map(value, -1, 1, 1000, 2000));
-        break;
-
-        case 3:
-        set_rc4(m_util.map(value, -1, 1, 1000, 2000));
-        break;
 
-        case 4:
-        set_rc5(m_util.map(value, -1, 1, 1000, 2000));
-        break;
-
-        case 5:
-        set_rc6(m_util.map(value, -1, 1, 1000, 2000));
-        break;
-
-        case 6:
-        set_rc7(m_util.map(value, -1, 1, 1000, 2000));
-        break;
-
-        case 7:
-        set_rc8(m_util.map(value, -1, 1, 1000, 2000));
-        break;
-
-        case 8:
-        set_rc9(m_util.map(value, -1, 1, 1000, 2000));
-        break;
+    if (axis < RCInputFrame::kAxes) {
+        setInput(axis, value);
+    }
+}
 
-        case 9:
-        set_rc10(m_util.map(value, -1, 1, 1000, 2000));
-        break;
+void OpenHDRC::buttonChanged(const int js, const int button, const bool pressed) {
+    Q_UNUSED(js)
 
-        default:
-        break;
+    if (button < RCInputFrame::kButtons) {
+        setInput(RCInputFrame::kAxes + button, pressed ? 1.0 : -1.0);
     }
-
-    qDebug() << "Axis " << axis << ": " << value;
 }
 
 void OpenHDRC::connectedChanged(bool value) {
@@ -427,93 +257,95 @@ void OpenHDRC::connectedChanged(bool value) {
 #endif
 }
 
-/* RC channel slots arranged in channel order */
+/*
+ * Gamepad controls as inputs, the axes in the order the default stick profile has
+ * always put them on channels 1-4, the triggers next, then the buttons.
+ */
 
-void OpenHDRC::axisLeftXChanged(double value) {
-    set_rc4(m_util.map(value, -1, 1, 1000, 2000));
+void OpenHDRC::axisRightXChanged(double value) {
+    setInput(0, value);
+}
+
+void OpenHDRC::axisRightYChanged(double value) {
+    setInput(1, value);
 }
 
 void OpenHDRC::axisLeftYChanged(double value) {
-    set_rc3(m_util.map(value, -1, 1, 1000, 2000));
+    setInput(2, value);
 }
 
-void OpenHDRC::axisRightYChanged(double value) {
-    set_rc2(m_util.map(value, -1, 1, 1000, 2000));
+void OpenHDRC::axisLeftXChanged(double value) {
+    setInput(3, value);
 }
 
-void OpenHDRC::axisRightXChanged(double value) {
-    set_rc1(m_util.map(value, -1, 1, 1000, 2000));
+void OpenHDRC::buttonL2Changed(double value) {
+    setInput(4, value * 2.0 - 1.0);
+}
+
+void OpenHDRC::buttonR2Changed(double value) {
+    setInput(5, value * 2.0 - 1.0);
 }
 
 void OpenHDRC::buttonAChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 0, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonBChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 1, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonXChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 2, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonYChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 3, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonL1Changed(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 4, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonR1Changed(bool value) {
-    Q_UNUSED(value)
-}
-
-void OpenHDRC::buttonL2Changed(double value) {
-    Q_UNUSED(value)
-}
-
-void OpenHDRC::buttonR2Changed(double value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 5, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonSelectChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 6, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonStartChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 7, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonL3Changed(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 8, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonR3Changed(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 9, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonUpChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 10, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonDownChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 11, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonLeftChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 12, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonRightChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 13, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonCenterChanged(bool value) {
-    Q_UNUSED(value)
+    setInput(RCInputFrame::kAxes + 14, value ? 1.0 : -1.0);
 }
 
 void OpenHDRC::buttonGuideChanged(bool value) {
-    Q_UNUSED(value)
-
+    setInput(RCInputFrame::kAxes + 15, value ? 1.0 : -1.0);
 }
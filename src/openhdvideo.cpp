@@ -1,6 +1,7 @@
 #if defined(ENABLE_VIDEO_RENDER)
 
 #include "openhdvideo.h"
+#include "trace.h"
 
 #include "constants.h"
 
@@ -33,6 +34,13 @@
 #include <fcntl.h>
 
 
+/*
+ * How long slices are held back after asking for a keyframe. Well over a round trip, if
+ * the air side doesn't support the request we fall back to decoding through the damage.
+ */
+static const qint64 kKeyframeWaitTimeout = 1000;
+
+
 OpenHDVideoReceiver::OpenHDVideoReceiver(OpenHDVideo *video, enum OpenHDStreamType stream_type): QObject(), m_stream_type(stream_type), m_video(video) {
     qDebug() << "OpenHDVideoReceiver::OpenHDVideoReceiver()";
 }
@@ -135,12 +143,18 @@ void OpenHDVideoReceiver::onStart() {
 OpenHDVideo::OpenHDVideo(enum OpenHDStreamType stream_type): QObject(), m_stream_type(stream_type) {
     qDebug() << "OpenHDVideo::OpenHDVideo()";
 
+    m_recorder = new VideoRecorder(m_stream_type == OpenHDStreamTypeMain ? "main" : "pip", this);
+
+    // no parent, we get moved to the video thread and QML needs this on the GUI thread
+    m_health = new VideoHealth();
+
     sps = (uint8_t*)malloc(sizeof(uint8_t)*1024);
     pps = (uint8_t*)malloc(sizeof(uint8_t)*1024);
 }
 
 OpenHDVideo::~OpenHDVideo() {
     qDebug() << "~OpenHDVideo()";
+    m_health->deleteLater();
 }
 
 
@@ -163,8 +177,6 @@ void OpenHDVideo::onStarted() {
 
     m_enable_rtp = settings.value("enable_rtp", true).toBool();
 
-    lastDataReceived = QDateTime::currentMSecsSinceEpoch();
-
     timer = new QTimer(this);
     QObject::connect(timer, &QTimer::timeout, this, &OpenHDVideo::reconfigure);
     timer->start(1000);
@@ -197,8 +209,8 @@ void OpenHDVideo::onSocketChanged(int fd) {
 /*
  * Fired by m_timer.
  *
- * This is primarily a way to check for video stalls so the UI layer can take action
- * if necessary, such as hiding the PiP element when the stream has stopped.
+ * Restarts the receiver when the port or RTP setting changes. Stall detection is done
+ * by m_health as frames come out of the decoder.
  */
 void OpenHDVideo::reconfigure() {
     if (m_background) {
@@ -207,22 +219,6 @@ void OpenHDVideo::reconfigure() {
 
     QMutexLocker locker(&m_mutex);
 
-    auto currentTime = QDateTime::currentMSecsSinceEpoch();
-
-    if (currentTime - lastDataReceived < 2500) {
-        if (m_stream_type == OpenHDStreamTypeMain) {
-            OpenHD::instance()->set_main_video_running(true);
-        } else {
-            OpenHD::instance()->set_pip_video_running(true);
-        }
-    } else {
-        if (m_stream_type == OpenHDStreamTypeMain) {
-            OpenHD::instance()->set_main_video_running(false);
-        } else {
-            OpenHD::instance()->set_pip_video_running(false);
-        }
-    }
-
     QSettings settings;
 
     int port = 0;
@@ -257,6 +253,9 @@ void OpenHDVideo::reconfigure() {
         sentPPS = false;
         havePPS = false;
         sentIDR = false;
+        rtpSequence = -1;
+        rtpStateFrag = false;
+        keyframeWait.invalidate();
         isStart = true;
         isConfigured = false;
         m_receiverThread.start();
@@ -269,9 +268,6 @@ void OpenHDVideo::startVideo() {
     QMutexLocker locker(&m_mutex);
 #if defined(ENABLE_MAIN_VIDEO) || defined(ENABLE_PIP)
     firstRun = false;
-    lastDataReceived = QDateTime::currentMSecsSinceEpoch();
-    OpenHD::instance()->set_main_video_running(false);
-    OpenHD::instance()->set_pip_video_running(false);
     QFuture<void> future = QtConcurrent::run(this, &OpenHDVideo::start);
 #endif
 }
@@ -287,6 +283,8 @@ void OpenHDVideo::stopVideo() {
 
 
 void OpenHDVideo::onReceivedData(QByteArray data) {
+    m_health->dataReceived(data.size());
+
     if (m_enable_rtp || m_stream_type == OpenHDStreamTypePiP) {
         parseRTP(data);
     } else {
@@ -317,9 +315,21 @@ void OpenHDVideo::parseRTP(QByteArray &datagram) {
     uint8_t csrcCount = static_cast<uint8_t>(first_byte & 0x0f);
     uint8_t marker = static_cast<uint8_t>(second_byte >> 7);
     uint8_t payload_type = static_cast<uint8_t>(second_byte & 0x7f);
-    uint16_t sequence_number = static_cast<uint16_t>((datagram[2] << 8) | datagram[3]);
-    uint32_t timestamp = static_cast<uint32_t>((datagram[4] << 24) | (datagram[5] << 16) | (datagram[6] << 8) | datagram[7]);
-    uint32_t ssrc = static_cast<uint32_t>((datagram[8] << 24) | (datagram[9] << 16) | (datagram[10] << 8) | (datagram[11]));
+    uint16_t sequence_number = static_cast<uint16_t>((static_cast<uint8_t>(datagram[2]) << 8) | static_cast<uint8_t>(datagram[3]));
+    uint32_t timestamp = static_cast<uint32_t>((static_cast<uint8_t>(datagram[4]) << 24) | (static_cast<uint8_t>(datagram[5]) << 16) | (static_cast<uint8_t>(datagram[6]) << 8) | static_cast<uint8_t>(datagram[7]));
+    uint32_t ssrc = static_cast<uint32_t>((static_cast<uint8_t>(datagram[8]) << 24) | (static_cast<uint8_t>(datagram[9]) << 16) | (static_cast<uint8_t>(datagram[10]) << 8) | static_cast<uint8_t>(datagram[11]));
+
+    /*
+     * A gap means whatever NAL was being reassembled is incomplete, and the frames after
+     * it reference something the decoder never got.
+     */
+    if (rtpSequence != -1 && sequence_number != static_cast<uint16_t>(rtpSequence + 1)) {
+        m_health->packetsLost(static_cast<uint16_t>(sequence_number - rtpSequence - 1));
+        rtpBuffer.clear();
+        rtpStateFrag = false;
+        onStreamLoss();
+    }
+    rtpSequence = sequence_number;
 
     QByteArray csrc;
     for (int i = 0; i < csrcCount; i++) {
@@ -328,6 +338,10 @@ void OpenHDVideo::parseRTP(QByteArray &datagram) {
 
     auto payloadOffset = MINIMUM_HEADER_LENGTH + 4 * csrcCount;
 
+    if (datagram.size() <= payloadOffset) {
+        return;
+    }
+
     QByteArray payload(datagram.data() + payloadOffset, datagram.size() - payloadOffset);
 
     const int type_stap_a = 24;
@@ -354,6 +368,9 @@ void OpenHDVideo::parseRTP(QByteArray &datagram) {
             break;
         }
         case type_fu_a: {
+            if (payload.size() < 2) {
+                break;
+            }
             fu_a_header fu_a;
             fu_a.s    = static_cast<uint8_t>((payload[1] >> 7) & 0x1);
             fu_a.e    = static_cast<uint8_t>((payload[1] >> 6) & 0x1);
@@ -368,8 +385,12 @@ void OpenHDVideo::parseRTP(QByteArray &datagram) {
                 reassembled |= (fu_a.type & 0x1f);
                 rtpBuffer.append((char*)&reassembled, 1);
                 rtpBuffer.append(payload.data() + 2, payload.size() - 2);
+                rtpStateFrag = true;
+            } else if (!rtpStateFrag) {
+                // the start of this NAL was lost, drop the rest of it
             } else if (fu_a.e == 1) {
                 rtpBuffer.append(payload.data() + 2, payload.size() - 2);
+                rtpStateFrag = false;
                 submit = true;
             } else {
                 rtpBuffer.append(payload.data() + 2, payload.size() - 2);
@@ -396,6 +417,23 @@ void OpenHDVideo::parseRTP(QByteArray &datagram) {
 
 
 
+/*
+ * Called when part of the stream went missing. Rather than feeding the decoder frames
+ * that reference the lost data until the encoder's next scheduled keyframe comes along,
+ * ask the air side for one now and hold slices back until it arrives, which is a single
+ * round trip instead of a whole GOP.
+ */
+void OpenHDVideo::onStreamLoss() {
+    emit OpenHD::instance()->request_keyframe(m_stream_type == OpenHDStreamTypeMain ? 0 : 1);
+
+    // if we're already waiting for an IDR there's nothing more to hold back
+    if (sentIDR) {
+        sentIDR = false;
+        keyframeWait.start();
+    }
+}
+
+
 void OpenHDVideo::findNAL() {
     size_t sz = tempBuffer.size();
 
@@ -436,17 +474,28 @@ void OpenHDVideo::findNAL() {
  * Some hardware decoders, particularly on Android, will crash if sent an IDR
  * before the PPS/SPS, or a non-IDR before an IDR.
  *
+ * Whatever goes to the decoder is also handed to the recorder, always after
+ * processFrame() so the decoder never gets a shared QByteArray and detaches it.
+ *
  */
 void OpenHDVideo::processNAL(QByteArray &nalUnit) {
+    TRACE_SCOPE("video.processNAL");
     webrtc::H264::NaluType nalu_type = webrtc::H264::ParseNaluType(nalUnit.data()[0]);
 
     switch (nalu_type) {
         case webrtc::H264::NaluType::kSlice: {
+            if (!sentIDR && keyframeWait.isValid() && keyframeWait.hasExpired(kKeyframeWaitTimeout)) {
+                // the air side never answered, a smeared picture beats a frozen one
+                qDebug() << "No IDR after keyframe request, resuming";
+                keyframeWait.invalidate();
+                sentIDR = true;
+            }
             if (isConfigured && sentSPS && sentPPS && sentIDR) {
                 QByteArray _n;
                 _n.append(NAL_HEADER, 4);
                 _n.append(nalUnit);
                 processFrame(_n, nalu_type);
+                m_recorder->pushData(_n);
                 //nalQueue.push_back(_n);
             }
             break;
@@ -458,9 +507,11 @@ void OpenHDVideo::processNAL(QByteArray &nalUnit) {
                 _n.append(nalUnit);
 
                 processFrame(_n, nalu_type);
+                m_recorder->pushData(_n);
                 //nalQueue.push_back(_n);
 
                 sentIDR = true;
+                keyframeWait.invalidate();
             }
             break;
         }
@@ -471,7 +522,9 @@ void OpenHDVideo::processNAL(QByteArray &nalUnit) {
 
             auto _sps = webrtc::SpsParser::ParseSps((const uint8_t*)nalUnit.data() + webrtc::H264::kNaluTypeSize, nalUnit.size() - webrtc::H264::kNaluTypeSize);
 
-            if (_sps) {
+            if (!_sps) {
+                m_health->decodeError();
+            } else {
                 new_width = _sps->width;
                 new_height = _sps->height;
                 new_fps = 30;
@@ -510,6 +563,7 @@ void OpenHDVideo::processNAL(QByteArray &nalUnit) {
                     _n.append(nalUnit);
 
                     processFrame(_n, nalu_type);
+                    m_recorder->pushData(_n);
                     //nalQueue.push_back(_n);
 
                     sentSPS = true;
@@ -534,6 +588,7 @@ void OpenHDVideo::processNAL(QByteArray &nalUnit) {
                 _n.append(nalUnit);
 
                 processFrame(_n, nalu_type);
+                m_recorder->pushData(_n);
                 //nalQueue.push_back(_n);
 
                 sentPPS = true;
@@ -546,6 +601,7 @@ void OpenHDVideo::processNAL(QByteArray &nalUnit) {
             _n.append(nalUnit);
 
             processFrame(_n, nalu_type);
+            m_recorder->pushData(_n);
             break;
         }
         default: {
@@ -558,9 +614,6 @@ void OpenHDVideo::processNAL(QByteArray &nalUnit) {
         emit configure();
         isStart = false;
     }
-    if (isConfigured) {
-        lastDataReceived = QDateTime::currentMSecsSinceEpoch();
-    }
 }
 
 #endif
@@ -13,6 +13,12 @@
 
 #include "openhd.h"
 
+#if defined(__linux__) || defined(__android__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #if defined(__android__)
 #include <jni.h>
 #include <QAndroidJniEnvironment>
@@ -372,9 +378,12 @@ SetPlaying::run() {
 }
 
 
-OpenHDVideoStream::OpenHDVideoStream(int &argc, char *argv[], QObject * parent): QObject(parent), timer(new QTimer) {
+OpenHDVideoStream::OpenHDVideoStream(int &argc, char *argv[], QObject * parent): QObject(parent) {
     qDebug() << "OpenHDVideoStream::OpenHDVideoStream()";
 
+    m_recorder = new VideoRecorder("main", this);
+    m_health = new VideoHealth(this);
+
 #ifdef __macos__
     #if defined(ENABLE_MAIN_VIDEO) || defined(ENABLE_PIP)
         #ifdef RELEASE_BUILD
@@ -670,39 +679,137 @@ void OpenHDVideoStream::init(QQmlApplicationEngine* engine = nullptr, enum Strea
     }
 
     m_engine = engine;
+    m_recorder->setName(m_stream_type == StreamTypeMain ? "main" : "pip");
+
     QSettings settings;
-    m_enable_videotest = settings.value("enable_videotest", false).toBool();
-    if (m_stream_type == StreamTypeMain) {
-        m_video_port = settings.value("main_video_port", 5600).toInt();
-    } else {
-        m_video_port = settings.value("pip_video_port", 5601).toInt();
+    m_config.enable_videotest = settings.value("enable_videotest", false).toBool();
+    m_config.enable_software_video_decoder = settings.value("enable_software_video_decoder", false).toBool();
+    m_config.enable_rtp = settings.value("enable_rtp", true).toBool();
+    m_config.enable_lte_video = settings.value("enable_lte_video", false).toBool();
+    m_config.video_h264 = settings.value("video_h264", false).toBool();
+    m_config.show_pip_video = settings.value("show_pip_video", false).toBool();
+    m_config.main_video_port = settings.value("main_video_port", 5600).toInt();
+    m_config.pip_video_port = settings.value("pip_video_port", 5601).toInt();
+
+    qDebug() << "OpenHDVideoStream::init()";
+}
+
+
+static OpenHDVideoEngine* _engine = nullptr;
+
+
+OpenHDVideoEngine* OpenHDVideoEngine::instance() {
+    // created on first use, gst_init() has to have run by then
+    if (_engine == nullptr) {
+        _engine = new OpenHDVideoEngine();
     }
-    m_enable_rtp = settings.value("enable_rtp", true).toBool();
+    return _engine;
+}
 
-    m_enable_lte_video = settings.value("enable_lte_video", false).toBool();
 
-    m_video_h264 = settings.value("video_h264", false).toBool();
+OpenHDVideoEngine::OpenHDVideoEngine() {
+    qDebug() << "OpenHDVideoEngine::OpenHDVideoEngine()";
 
-    lastDataTimeout = QDateTime::currentMSecsSinceEpoch();
+    m_context = g_main_context_new();
+    m_loop = g_main_loop_new(m_context, FALSE);
+    m_pipeline = gst_pipeline_new("video");
 
-    QObject::connect(timer, &QTimer::timeout, this, &OpenHDVideoStream::_timer);
-    timer->start(1000);
+    GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(m_pipeline));
+    gst_bus_set_sync_handler(bus, &OpenHDVideoEngine::busSyncCb, this, nullptr);
 
-    qDebug() << "OpenHDVideoStream::init()";
+    GSource *source = gst_bus_create_watch(bus);
+    g_source_set_callback(source, (GSourceFunc)&OpenHDVideoEngine::busCb, this, nullptr);
+    g_source_attach(source, m_context);
+    g_source_unref(source);
+
+    gst_object_unref(bus);
 }
 
 
-static gboolean PipelineCb(GstBus *bus, GstMessage *msg, gpointer data) {
-    auto instance = static_cast<OpenHDVideoStream*>(data);
+void OpenHDVideoEngine::run() {
+    qDebug() << "OpenHDVideoEngine::run()";
+
+    g_main_context_push_thread_default(m_context);
+    g_main_loop_run(m_loop);
+    g_main_context_pop_thread_default(m_context);
+}
+
+
+void OpenHDVideoEngine::addStream(OpenHDVideoStream *stream) {
+    QMutexLocker locker(&m_streams_mutex);
+
+    if (!m_streams.contains(stream)) {
+        m_streams.append(stream);
+    }
+
+    if (!m_running) {
+        m_running = true;
+        QtConcurrent::run([this]() {
+            run();
+        });
+    }
+}
+
+
+/*
+ * Called on the engine thread once the stream has taken its branches out of the
+ * pipeline. The engine winds down with the last stream.
+ */
+void OpenHDVideoEngine::removeStream(OpenHDVideoStream *stream) {
+    QMutexLocker locker(&m_streams_mutex);
+
+    m_streams.removeAll(stream);
+
+    if (m_streams.isEmpty() && m_running) {
+        gst_element_set_state(m_pipeline, GST_STATE_NULL);
+        g_main_loop_quit(m_loop);
+        m_running = false;
+        m_playing = false;
+    }
+}
+
+
+void OpenHDVideoEngine::invoke(GSourceFunc func, gpointer data) {
+    GSource *source = g_idle_source_new();
+    g_source_set_callback(source, func, data, nullptr);
+    g_source_attach(source, m_context);
+    g_source_unref(source);
+}
+
+
+/*
+ * When the app first launches we have to wait for the QML element to be ready before the pipeline
+ * starts pushing frames to it.
+ *
+ * After that point branches are brought up to the pipeline's state as they are added.
+ */
+void OpenHDVideoEngine::play(QQuickWindow *window) {
+    if (m_playing) {
+        return;
+    }
+    m_playing = true;
+    window->scheduleRenderJob(new SetPlaying (m_pipeline), QQuickWindow::BeforeSynchronizingStage);
+}
+
+
+gboolean OpenHDVideoEngine::busCb(GstBus *bus, GstMessage *msg, gpointer data) {
+    Q_UNUSED(bus)
+
+    auto instance = static_cast<OpenHDVideoEngine*>(data);
 
     switch (GST_MESSAGE_TYPE(msg)){
     case GST_MESSAGE_EOS:{
             break;
         }
-        case GST_MESSAGE_ERROR:{
-            break;
-        }
+        case GST_MESSAGE_ERROR:
         case GST_MESSAGE_WARNING:{
+            // decoders report corrupt input this way, count it against the stream it came from
+            QMutexLocker locker(&instance->m_streams_mutex);
+            for (auto stream : instance->m_streams) {
+                if (stream->ownsSourceElement(GST_MESSAGE_SRC(msg))) {
+                    stream->health()->decodeError();
+                }
+            }
             break;
         }
         case GST_MESSAGE_INFO:{
@@ -715,10 +822,6 @@ static gboolean PipelineCb(GstBus *bus, GstMessage *msg, gpointer data) {
             break;
         }
         case GST_MESSAGE_ELEMENT:{
-            auto m = QString(gst_structure_get_name(gst_message_get_structure(msg)));
-            if (m == "GstUDPSrcTimeout") {
-                instance->lastDataTimeout = QDateTime::currentMSecsSinceEpoch();
-            }
             break;
         }
         case GST_MESSAGE_LATENCY: {
@@ -738,77 +841,262 @@ static gboolean PipelineCb(GstBus *bus, GstMessage *msg, gpointer data) {
     return TRUE;
 }
 
-void OpenHDVideoStream::_start() {
-    qDebug() << "OpenHDVideoStream::_start()";
 
-    GError *error = nullptr;
+/*
+ * Runs on whichever thread posted the message. Stream status ENTER is posted from the
+ * new streaming thread itself, which lets us drop the priority of every thread working
+ * on the PiP branch so it can never take CPU away from decoding the main stream.
+ */
+GstBusSyncReply OpenHDVideoEngine::busSyncCb(GstBus *bus, GstMessage *msg, gpointer data) {
+    Q_UNUSED(bus)
+    Q_UNUSED(data)
 
-    QSettings settings;
-    auto pipeline = new QString();    
-    QTextStream s(pipeline);
+    if (GST_MESSAGE_TYPE(msg) != GST_MESSAGE_STREAM_STATUS) {
+        return GST_BUS_PASS;
+    }
+
+    GstStreamStatusType type;
+    GstElement *owner = nullptr;
+    gst_message_parse_stream_status(msg, &type, &owner);
+
+    if (type != GST_STREAM_STATUS_TYPE_ENTER || owner == nullptr) {
+        return GST_BUS_PASS;
+    }
+
+    bool pip = false;
+    for (GstObject *object = GST_OBJECT(owner); object != nullptr; object = GST_OBJECT_PARENT(object)) {
+        if (GST_OBJECT_NAME(object) != nullptr && g_str_has_prefix(GST_OBJECT_NAME(object), "pip")) {
+            pip = true;
+            break;
+        }
+    }
 
-    if (m_enable_videotest) {
+    if (pip) {
+#if defined(__linux__) || defined(__android__)
+        setpriority(PRIO_PROCESS, syscall(SYS_gettid), 10);
+#else
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+#endif
+    }
+
+    return GST_BUS_PASS;
+}
+
+
+/*
+ * Tees the depayloaded H.264 off to the recorder. This only costs anything while a
+ * recording is running, and then only a buffer ref here on the source's streaming
+ * thread, the recorder maps and writes it on its own.
+ */
+static GstPadProbeReturn RecorderProbeCb(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    Q_UNUSED(pad)
+
+    auto recorder = static_cast<VideoRecorder*>(data);
+    if (!recorder->recording()) {
+        return GST_PAD_PROBE_OK;
+    }
+
+    recorder->pushBuffer(GST_PAD_PROBE_INFO_BUFFER(info));
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+/*
+ * Watches the RTP sequence numbers going into the depayloader. Any gap means the decoder
+ * is about to reference something it never got, so ask the air side for an IDR right away
+ * instead of waiting for the encoder's next scheduled one.
+ */
+GstPadProbeReturn OpenHDVideoStream::rtpSequenceCb(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    Q_UNUSED(pad)
+
+    auto stream = static_cast<OpenHDVideoStream*>(data);
+
+    uint8_t header[4];
+    if (gst_buffer_extract(GST_PAD_PROBE_INFO_BUFFER(info), 0, header, sizeof(header)) != sizeof(header)) {
+        return GST_PAD_PROBE_OK;
+    }
+    int sequence = (header[2] << 8) | header[3];
+
+    if (stream->m_rtp_sequence != -1 && sequence != ((stream->m_rtp_sequence + 1) & 0xffff)) {
+        stream->m_health->packetsLost((sequence - stream->m_rtp_sequence - 1) & 0xffff);
+        emit OpenHD::instance()->request_keyframe(stream->m_stream_type == StreamTypeMain ? 0 : 1);
+    }
+    stream->m_rtp_sequence = sequence;
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+GstPadProbeReturn OpenHDVideoStream::receivedDataCb(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    Q_UNUSED(pad)
+
+    auto stream = static_cast<OpenHDVideoStream*>(data);
+    stream->m_health->dataReceived(static_cast<int>(gst_buffer_get_size(GST_PAD_PROBE_INFO_BUFFER(info))));
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+/*
+ * Sits on the display branch's input, so it sees every frame that made it out of the
+ * decoder, before PiP's leaky queue gets a chance to drop any.
+ */
+GstPadProbeReturn OpenHDVideoStream::decodedFrameCb(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    Q_UNUSED(pad)
+    Q_UNUSED(info)
+
+    auto stream = static_cast<OpenHDVideoStream*>(data);
+    stream->m_health->frameDecoded();
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+bool OpenHDVideoStream::ownsSourceElement(GstObject *element) const {
+    return m_source != nullptr && gst_object_has_as_ancestor(element, GST_OBJECT(m_source));
+}
+
+
+bool OpenHDVideoStream::isActive(const StreamConfig &config) const {
+    if (m_stream_type == StreamTypePiP) {
+        return config.show_pip_video;
+    }
+    return true;
+}
+
+
+int OpenHDVideoStream::videoPort(const StreamConfig &config) const {
+    if (m_stream_type == StreamTypePiP) {
+        return config.pip_video_port;
+    }
+    if (config.enable_lte_video) {
+        return lte_default_port;
+    }
+    return config.main_video_port;
+}
+
+
+/*
+ * Whether both configs build the same source bin apart from the port, which can be
+ * changed on the running udpsrc. Mirrors the choices made in sourceDescription().
+ */
+bool OpenHDVideoStream::sameSource(const StreamConfig &a, const StreamConfig &b) const {
+    if (a.enable_videotest || b.enable_videotest) {
+        return a.enable_videotest == b.enable_videotest;
+    }
+    if (m_stream_type == StreamTypeMain && a.enable_rtp != b.enable_rtp) {
+        return false;
+    }
+    return a.video_h264 == b.video_h264 &&
+           a.enable_software_video_decoder == b.enable_software_video_decoder;
+}
+
+
+/*
+ * Builds the part of the pipeline that changes with the settings: the source, depayloader,
+ * parser and decoder. It always ends in a queue so the bin has a static src pad to ghost,
+ * decodebin3 only exposes its pads once it has seen data.
+ */
+QString OpenHDVideoStream::sourceDescription(const StreamConfig &config, int port) const {
+    QString pipeline;
+    QTextStream s(&pipeline);
+
+    if (config.enable_videotest) {
         qDebug() << "Using video test";
         s << "videotestsrc pattern=smpte !";
-        s << "video/x-raw,width=640,height=480 !";
-        s << "queue !";
-    } else {
-        qDebug() << "Listening on port" << m_video_port;
-
-        if (m_enable_rtp || m_stream_type == StreamTypePiP) {
-            if (m_video_h264 == true ){
-                qDebug() << "h264 video stream started";
-                s << QString("udpsrc port=%1 caps=\"application/x-rtp, media=(string)video, clock-rate=(int)90000, encoding-name=(string)H264\" timeout=1000000000 !").arg(m_video_port);
-                s << " rtpjitterbuffer !";
-                s << " rtph264depay !";
-            } else { //we are h265.. it has its own verbose setting but not using it here
-                qDebug() << "h265 video stream started";
-                s << QString("udpsrc port=%1 caps=\"application/x-rtp, encoding-name=(string)H265,payload=96\" timeout=1000000000 !").arg(m_video_port);
-                s << " rtph265depay !";
-                }
-         } else {
-            s << QString("udpsrc port=%1 timeout=1000000000 !").arg(m_video_port);
+        s << " video/x-raw,width=640,height=480 !";
+        s << " queue";
+        return pipeline;
+    }
+
+    qDebug() << "Listening on port" << port;
+
+    if (config.enable_rtp || m_stream_type == StreamTypePiP) {
+        if (config.video_h264 == true ){
+            qDebug() << "h264 video stream started";
+            s << QString("udpsrc name=udpsrc port=%1 caps=\"application/x-rtp, media=(string)video, clock-rate=(int)90000, encoding-name=(string)H264\" !").arg(port);
+            s << " rtpjitterbuffer !";
+            s << " rtph264depay name=depay !";
+        } else { //we are h265.. it has its own verbose setting but not using it here
+            qDebug() << "h265 video stream started";
+            s << QString("udpsrc name=udpsrc port=%1 caps=\"application/x-rtp, encoding-name=(string)H265,payload=96\" !").arg(port);
+            s << " rtph265depay !";
         }
-        s << " queue !";
+    } else {
+        s << QString("udpsrc name=udpsrc port=%1 !").arg(port);
+    }
+    s << " queue !";
 
-        if (m_enable_software_video_decoder) {
-            qDebug() << "Forcing software decoder";
+    if (config.enable_software_video_decoder) {
+        qDebug() << "Forcing software decoder";
+        s << " h264parse !";
+        s << " avdec_h264 !";
+    } else {
+        qDebug() << "Using hardware decoder, fallback to software if unavailable";
+        if (config.video_h264 == true ){
             s << " h264parse !";
-            s << " avdec_h264 !";
         } else {
-            qDebug() << "Using hardware decoder, fallback to software if unavailable";
-            if (m_video_h264 == true ){
-                s << " h264parse !";
+            s << " h265parse !";
+        }
+        #if defined(__rasp_pi__)
+            s << " omxh264dec !";
+        #else
+            if (config.video_h264 == true ){
+                s << " decodebin3 !";
             } else {
-                s << " h265parse !";
+                s << " omxh265dec !";
             }
-            #if defined(__rasp_pi__)
-                s << " omxh264dec !";
-            #else
-                if (m_video_h264 == true ){
-                        s << " decodebin3 !";
-                } else {
-                        s << " omxh265dec !";
-                }
-            #endif
-        }
+        #endif
     }
-    s << " queue !";
-    s << " glupload ! glcolorconvert !";
-    s << " qmlglsink name=qmlglsink sync=false";
-    m_pipeline = gst_parse_launch(pipeline->toUtf8(), &error);
-    qDebug() << "GSTREAMER PIPE=" << pipeline->toUtf8();
-    if (error) {
-        qDebug() << "gst_parse_launch error: " << error->message;
+    s << " queue";
+
+    return pipeline;
+}
+
+
+/*
+ * The display side of the branch. It is built once and never torn down, so the GL
+ * context and the sink stay alive across reconfiguration.
+ *
+ * PiP is scaled down on the GPU to the size it is shown at, right after upload, and its
+ * queue is leaky so a slow PiP branch drops frames instead of backing up its decoder.
+ */
+QString OpenHDVideoStream::displayDescription(QQuickItem *videoItem) const {
+    QString pipeline;
+    QTextStream s(&pipeline);
+
+    if (m_stream_type == StreamTypePiP) {
+        s << "queue leaky=downstream max-size-buffers=2 ! ";
     }
-    GstElement *qmlglsink = gst_bin_get_by_name(GST_BIN(m_pipeline), "qmlglsink");
 
+    s << "glupload ! glcolorconvert !";
 
-    GstBus *bus = gst_pipeline_get_bus (GST_PIPELINE(m_pipeline));
+    if (m_stream_type == StreamTypePiP) {
+        qreal ratio = videoItem->window() != nullptr ? videoItem->window()->devicePixelRatio() : 1.0;
+        int width = qRound(videoItem->width() * ratio) & ~1;
+        int height = qRound(videoItem->height() * ratio) & ~1;
+        if (width > 0 && height > 0) {
+            s << QString(" glcolorscale ! video/x-raw(memory:GLMemory),width=%1,height=%2 !").arg(width).arg(height);
+        }
+    }
+
+    // async=false, a branch with no source attached must not hold up the whole pipeline
+    s << " qmlglsink name=qmlglsink sync=false async=false";
+
+    return pipeline;
+}
+
+
+void OpenHDVideoStream::_start() {
+    qDebug() << "OpenHDVideoStream::_start()";
 
-    gst_bus_add_signal_watch(bus);
-    g_signal_connect(bus, "message", (GCallback)PipelineCb, this);
+    auto engine = OpenHDVideoEngine::instance();
 
+    {
+        QMutexLocker locker(&m_config_mutex);
+        m_active = m_config;
+    }
 
     QQuickItem *videoItem;
     QQuickWindow *rootObject;
@@ -826,110 +1114,282 @@ void OpenHDVideoStream::_start() {
         LocalMessage::instance()->showMessage("Could not start video stream (E2)", 2);
         return;
     }
+
+    GError *error = nullptr;
+
+    auto pipeline = displayDescription(videoItem);
+    m_display = gst_parse_bin_from_description(pipeline.toUtf8(), TRUE, &error);
+    qDebug() << "GSTREAMER PIPE=" << pipeline.toUtf8();
+    if (error) {
+        qDebug() << "gst_parse_bin_from_description error: " << error->message;
+        g_error_free(error);
+    }
+    if (m_display == nullptr) {
+        LocalMessage::instance()->showMessage("Could not start video stream (E3)", 2);
+        return;
+    }
+    gst_element_set_name(m_display, m_stream_type == StreamTypeMain ? "maindisplay" : "pipdisplay");
+
+    GstElement *qmlglsink = gst_bin_get_by_name(GST_BIN(m_display), "qmlglsink");
     g_object_set(qmlglsink, "widget", videoItem, NULL);
+    gst_object_unref(qmlglsink);
 
+    GstPad *pad = gst_element_get_static_pad(m_display, "sink");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, decodedFrameCb, this, nullptr);
+    gst_object_unref(pad);
 
-    /*
-     * When the app first launches we have to wait for the QML element to be ready before the pipeline
-     * starts pushing frames to it.
-     *
-     * After that point we can just set the pipeline to GST_STATE_PLAYING directly.
-     */
-    if (firstRun) {
-        firstRun = false;
-        rootObject->scheduleRenderJob(new SetPlaying (m_pipeline), QQuickWindow::BeforeSynchronizingStage);
-    } else {
-        gst_element_set_state (m_pipeline, GST_STATE_PLAYING);
+    gst_bin_add(GST_BIN(engine->pipeline()), m_display);
+    gst_element_sync_state_with_parent(m_display);
+
+    if (isActive(m_active)) {
+        attachSource(m_active);
     }
 
-    lastDataTimeout = QDateTime::currentMSecsSinceEpoch();
-    OpenHD::instance()->set_main_video_running(false);
-    OpenHD::instance()->set_pip_video_running(false);
+    engine->play(rootObject);
+}
+
 
-    mainLoop = g_main_loop_new(nullptr, FALSE);
-    g_main_loop_run(mainLoop);
+gboolean OpenHDVideoStream::startCb(gpointer data) {
+    auto instance = static_cast<OpenHDVideoStream*>(data);
+    instance->_start();
+    return G_SOURCE_REMOVE;
 }
 
+
 /*
- * Fired by m_timer.
- *
- * Checks every second if the enable_videotest setting has changed, if so we restart the
- * stream and let the the pipeline be reconstructed using whichever video source is now enabled.
+ * Builds a new source bin for the given config and links it in front of the display
+ * side of the pipeline, which keeps running the whole time.
  */
-void OpenHDVideoStream::_timer() {    
-    // skip everything until the video is known to have started at least once.
-    if (firstRun) {
+void OpenHDVideoStream::attachSource(const StreamConfig &config) {
+    GError *error = nullptr;
+
+    auto description = sourceDescription(config, videoPort(config));
+    qDebug() << "GSTREAMER SOURCE=" << description.toUtf8();
+
+    m_source = gst_parse_bin_from_description(description.toUtf8(), TRUE, &error);
+    if (error) {
+        qDebug() << "gst_parse_bin_from_description error: " << error->message;
+        g_error_free(error);
+    }
+    if (m_source == nullptr) {
+        LocalMessage::instance()->showMessage("Could not start video stream (E4)", 2);
         return;
     }
+    gst_element_set_name(m_source, m_stream_type == StreamTypeMain ? "mainsource" : "pipsource");
+
+    GstElement *depay = gst_bin_get_by_name(GST_BIN(m_source), "depay");
+    if (depay != nullptr) {
+        GstPad *pad = gst_element_get_static_pad(depay, "src");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, RecorderProbeCb, m_recorder, nullptr);
+        gst_object_unref(pad);
+
+        m_rtp_sequence = -1;
+        pad = gst_element_get_static_pad(depay, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, rtpSequenceCb, this, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(depay);
+    }
 
-    QSettings settings;
+    GstElement *udpsrc = gst_bin_get_by_name(GST_BIN(m_source), "udpsrc");
+    if (udpsrc != nullptr) {
+        GstPad *pad = gst_element_get_static_pad(udpsrc, "src");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, receivedDataCb, this, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(udpsrc);
+    }
+
+    gst_bin_add(GST_BIN(OpenHDVideoEngine::instance()->pipeline()), m_source);
+    gst_element_link(m_source, m_display);
+    gst_element_sync_state_with_parent(m_source);
+}
 
-    auto _enable_videotest = settings.value("enable_videotest", false).toBool();
-    auto _enable_software_video_decoder = settings.value("enable_software_video_decoder", false).toBool();
-    auto _enable_rtp = settings.value("enable_rtp", true).toBool();
 
-    auto _enable_lte_video = settings.value("enable_lte_video", false).toBool();
+void OpenHDVideoStream::detachSource() {
+    m_swap_pending = false;
 
-    auto _video_h264 = settings.value("video_h264", false).toBool();
+    if (m_source == nullptr) {
+        return;
+    }
+
+    gst_element_set_state(m_source, GST_STATE_NULL);
+    gst_element_unlink(m_source, m_display);
+    gst_bin_remove(GST_BIN(OpenHDVideoEngine::instance()->pipeline()), m_source);
+    m_source = nullptr;
+}
 
-    auto _show_pip_video = settings.value("show_pip_video", false).toBool();
 
-    auto _main_video_port = settings.value("main_video_port", main_default_port).toInt();
-    if (m_enable_lte_video) {
-        _main_video_port = 8000;
+/*
+ * Only the port changed, so udpsrc just has to rebind. The socket is opened on the
+ * NULL->READY transition, so cycle the element through NULL and let it catch up with
+ * the rest of the bin again.
+ */
+void OpenHDVideoStream::retuneSource(int port) {
+    GstElement *udpsrc = gst_bin_get_by_name(GST_BIN(m_source), "udpsrc");
+    if (udpsrc == nullptr) {
+        replaceSource();
+        return;
     }
 
-    auto _pip_video_port = settings.value("pip_video_port", pip_default_port).toInt();
+    qDebug() << "Moving stream to port" << port;
+
+    gst_element_set_state(udpsrc, GST_STATE_NULL);
+    // udpsrc drives the depayloader, so nothing is reading this until it restarts
+    m_rtp_sequence = -1;
+    g_object_set(udpsrc, "port", port, NULL);
+    gst_element_sync_state_with_parent(udpsrc);
+    gst_object_unref(udpsrc);
+}
 
 
-    if (m_stream_type == StreamTypeMain) {
-        if (_enable_videotest != m_enable_videotest || _enable_software_video_decoder != m_enable_software_video_decoder || _main_video_port != m_video_port || _enable_rtp != m_enable_rtp || _enable_lte_video != m_enable_lte_video || _video_h264 != m_video_h264) {
-            qDebug() << "Restarting main stream";
-            stopVideo();
-            m_enable_videotest = _enable_videotest;
-            m_enable_software_video_decoder = _enable_software_video_decoder;            
-            m_enable_rtp = _enable_rtp;
-            m_enable_lte_video= _enable_lte_video;
-            m_video_h264= _video_h264;
-            m_video_port = _main_video_port;
-            startVideo();
-        }
-    } else if (m_stream_type == StreamTypePiP) {
-        if (m_enable_pip_video != _show_pip_video || _enable_videotest != m_enable_videotest || _enable_software_video_decoder != m_enable_software_video_decoder || _pip_video_port != m_video_port || _enable_rtp != m_enable_rtp) {
-            qDebug() << "Restarting PiP stream";
-            stopVideo();
-            m_enable_videotest = _enable_videotest;
-            m_enable_software_video_decoder = _enable_software_video_decoder;
-            m_enable_rtp = _enable_rtp;
-
-            m_video_port = _pip_video_port;
-            m_enable_pip_video = _show_pip_video;
-            if (_show_pip_video) {
-                startVideo();
-            }
-        }
+/*
+ * Depay/parse/decoder changed. Wait for the source bin's src pad to go idle so we never
+ * cut it off in the middle of pushing a buffer, then swap the whole bin.
+ */
+void OpenHDVideoStream::replaceSource() {
+    if (m_swap_pending) {
+        return;
     }
+    m_swap_pending = true;
 
-    auto currentTime = QDateTime::currentMSecsSinceEpoch();
+    GstPad *pad = gst_element_get_static_pad(m_source, "src");
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_IDLE, &OpenHDVideoStream::sourceIdleCb, this, nullptr);
+    gst_object_unref(pad);
+}
 
-    if (currentTime - lastDataTimeout < 2500) {
-        if (m_stream_type == StreamTypeMain) {
-            OpenHD::instance()->set_main_video_running(false);
-        } else {
-            OpenHD::instance()->set_pip_video_running(false);
+
+GstPadProbeReturn OpenHDVideoStream::sourceIdleCb(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+    Q_UNUSED(pad)
+    Q_UNUSED(info)
+
+    auto instance = static_cast<OpenHDVideoStream*>(data);
+
+    /*
+     * This can run on the old source's streaming thread, which can't shut itself down, so
+     * the swap itself is deferred to the engine thread. The pad stays blocked until then
+     * because the probe is left installed.
+     */
+    OpenHDVideoEngine::instance()->invoke(&OpenHDVideoStream::swapSourceCb, instance);
+
+    return GST_PAD_PROBE_OK;
+}
+
+
+gboolean OpenHDVideoStream::swapSourceCb(gpointer data) {
+    auto instance = static_cast<OpenHDVideoStream*>(data);
+    instance->_swapSource();
+    return G_SOURCE_REMOVE;
+}
+
+
+void OpenHDVideoStream::_swapSource() {
+    if (!m_swap_pending) {
+        return;
+    }
+
+    qDebug() << "Swapping video source";
+
+    detachSource();
+
+    StreamConfig config;
+    {
+        QMutexLocker locker(&m_config_mutex);
+        config = m_config;
+    }
+
+    if (isActive(config)) {
+        attachSource(config);
+    }
+    m_active = config;
+}
+
+
+gboolean OpenHDVideoStream::applyConfigCb(gpointer data) {
+    auto instance = static_cast<OpenHDVideoStream*>(data);
+    instance->_applyConfig();
+    return G_SOURCE_REMOVE;
+}
+
+
+/*
+ * Runs on the engine thread and brings this stream's branch in line with the most
+ * recently requested config, doing the least amount of work needed for the change.
+ */
+void OpenHDVideoStream::_applyConfig() {
+    if (m_display == nullptr) {
+        return;
+    }
+
+    StreamConfig config;
+    {
+        QMutexLocker locker(&m_config_mutex);
+        config = m_config;
+    }
+
+    if (!isActive(config)) {
+        detachSource();
+        m_active = config;
+        return;
+    }
+
+    if (m_source == nullptr) {
+        attachSource(config);
+        m_active = config;
+        return;
+    }
+
+    if (m_swap_pending) {
+        // the swap will pick up the latest config when it runs
+        return;
+    }
+
+    auto port = videoPort(config);
+
+    if (sameSource(config, m_active)) {
+        if (!config.enable_videotest && port != videoPort(m_active)) {
+            retuneSource(port);
         }
-    } else {
-        if (m_stream_type == StreamTypeMain) {
-            OpenHD::instance()->set_main_video_running(true);
+        m_active = config;
+        return;
+    }
+
+    replaceSource();
+}
+
+
+void OpenHDVideoStream::updateSetting(const QString &key, const QVariant &value) {
+    {
+        QMutexLocker locker(&m_config_mutex);
+
+        if (key == "enable_videotest") {
+            m_config.enable_videotest = value.toBool();
+        } else if (key == "enable_software_video_decoder") {
+            m_config.enable_software_video_decoder = value.toBool();
+        } else if (key == "enable_rtp") {
+            m_config.enable_rtp = value.toBool();
+        } else if (key == "enable_lte_video") {
+            m_config.enable_lte_video = value.toBool();
+        } else if (key == "video_h264") {
+            m_config.video_h264 = value.toBool();
+        } else if (key == "show_pip_video") {
+            m_config.show_pip_video = value.toBool();
+        } else if (key == "main_video_port") {
+            m_config.main_video_port = value.toInt();
+        } else if (key == "pip_video_port") {
+            m_config.pip_video_port = value.toInt();
         } else {
-            OpenHD::instance()->set_pip_video_running(true);
+            return;
         }
     }
+
+    OpenHDVideoEngine::instance()->invoke(&OpenHDVideoStream::applyConfigCb, this);
 }
 
+
 void OpenHDVideoStream::startVideo() {
 #if defined(ENABLE_MAIN_VIDEO) || defined(ENABLE_PIP)
-    QFuture<void> future = QtConcurrent::run(this, &OpenHDVideoStream::_start);
+    auto engine = OpenHDVideoEngine::instance();
+    engine->addStream(this);
+    engine->invoke(&OpenHDVideoStream::startCb, this);
 #endif
 }
 
@@ -937,17 +1397,27 @@ void OpenHDVideoStream::_stop() {
 #if defined(ENABLE_MAIN_VIDEO) || defined(ENABLE_PIP)
     qDebug() << "OpenHDVideoStream::_stop()";
 
-    if (m_pipeline != nullptr) {
-        gst_element_set_state (m_pipeline, GST_STATE_NULL);
-        //gst_object_unref (m_pipeline);
-        g_main_loop_quit(mainLoop);
+    detachSource();
+
+    if (m_display != nullptr) {
+        gst_element_set_state(m_display, GST_STATE_NULL);
+        gst_bin_remove(GST_BIN(OpenHDVideoEngine::instance()->pipeline()), m_display);
+        m_display = nullptr;
     }
+
+    OpenHDVideoEngine::instance()->removeStream(this);
 #endif
 }
 
+gboolean OpenHDVideoStream::stopCb(gpointer data) {
+    auto instance = static_cast<OpenHDVideoStream*>(data);
+    instance->_stop();
+    return G_SOURCE_REMOVE;
+}
+
 void OpenHDVideoStream::stopVideo() {
 #if defined(ENABLE_MAIN_VIDEO) || defined(ENABLE_PIP)
-    QFuture<void> future = QtConcurrent::run(this, &OpenHDVideoStream::_stop);
+    OpenHDVideoEngine::instance()->invoke(&OpenHDVideoStream::stopCb, this);
 #endif
 }
 
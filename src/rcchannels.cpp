@@ -0,0 +1,8 @@
+#include "rcchannels.h"
+
+#include <chrono>
+
+
+qint64 RCClock::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,112 @@
+#include "rcpacket.h"
+
+#include <algorithm>
+
+
+namespace RCPacket {
+
+static size_t channelBytes(int count) {
+    return (count * 11 + 7) / 8;
+}
+
+
+size_t encode(const Packet &packet, uint8_t *buffer) {
+    auto count = std::min<int>(packet.count, kMaxChannels);
+    if (packet.type == kEcho) {
+        count = 0;
+    }
+
+    buffer[0] = packet.type;
+    buffer[1] = static_cast<uint8_t>(count);
+    buffer[2] = packet.sequence & 0xff;
+    buffer[3] = packet.sequence >> 8;
+    buffer[4] = packet.time & 0xff;
+    buffer[5] = (packet.time >> 8) & 0xff;
+    buffer[6] = (packet.time >> 16) & 0xff;
+    buffer[7] = packet.time >> 24;
+
+    auto out = buffer + kHeaderSize;
+    std::fill(out, out + channelBytes(count), 0);
+
+    uint32_t bits = 0;
+    int used = 0;
+    size_t written = 0;
+    for (int c = 0; c < count; c++) {
+        bits |= static_cast<uint32_t>(std::min<uint16_t>(packet.channels[c], 2047)) << used;
+        used += 11;
+        while (used >= 8) {
+            out[written++] = bits & 0xff;
+            bits >>= 8;
+            used -= 8;
+        }
+    }
+    if (used > 0) {
+        out[written++] = bits & 0xff;
+    }
+
+    auto length = kHeaderSize + written;
+    auto crc = crc16(buffer, length);
+    buffer[length] = crc & 0xff;
+    buffer[length + 1] = crc >> 8;
+
+    return length + kCrcSize;
+}
+
+
+bool decode(const uint8_t *buffer, size_t length, Packet &packet) {
+    if (length < kHeaderSize + kCrcSize) {
+        return false;
+    }
+
+    auto type = buffer[0];
+    int count = buffer[1];
+    if ((type != kChannels && type != kEcho) || count > kMaxChannels || (type == kEcho && count != 0)) {
+        return false;
+    }
+
+    auto expected = kHeaderSize + channelBytes(count);
+    if (length != expected + kCrcSize) {
+        return false;
+    }
+
+    uint16_t crc = buffer[expected] | (buffer[expected + 1] << 8);
+    if (crc != crc16(buffer, expected)) {
+        return false;
+    }
+
+    packet.type = type;
+    packet.count = static_cast<uint8_t>(count);
+    packet.sequence = buffer[2] | (buffer[3] << 8);
+    packet.time = static_cast<uint32_t>(buffer[4]) | (static_cast<uint32_t>(buffer[5]) << 8) |
+                  (static_cast<uint32_t>(buffer[6]) << 16) | (static_cast<uint32_t>(buffer[7]) << 24);
+
+    auto in = buffer + kHeaderSize;
+    uint32_t bits = 0;
+    int used = 0;
+    size_t read = 0;
+    for (int c = 0; c < count; c++) {
+        while (used < 11) {
+            bits |= static_cast<uint32_t>(in[read++]) << used;
+            used += 8;
+        }
+        packet.channels[c] = bits & 0x7ff;
+        bits >>= 11;
+        used -= 11;
+    }
+
+    return true;
+}
+
+
+uint16_t crc16(const uint8_t *data, size_t length) {
+    uint16_t crc = 0xffff;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+}
@@ -0,0 +1,141 @@
+#include "rcreceiverstub.h"
+
+#include <QtNetwork>
+#include <QTimer>
+
+// failsafe checks, and how often the counters are passed on to QML
+constexpr int kCheckInterval = 50;
+
+// AETR, channel 3
+constexpr int kThrottle = 2;
+
+// further back than this is a sender that started counting again, not a late packet
+constexpr int kReorderWindow = 64;
+
+
+RCReceiverStub::RCReceiverStub(QObject *parent): QObject(parent) {
+    qDebug() << "RCReceiverStub::RCReceiverStub()";
+    m_channels.fill(1500);
+    m_channels[kThrottle] = 1000;
+}
+
+
+bool RCReceiverStub::start(int port) {
+    stop();
+
+    auto socket = new QUdpSocket(this);
+    if (!socket->bind(QHostAddress::AnyIPv4, static_cast<quint16>(port))) {
+        qDebug() << "RCReceiverStub::start: can't bind" << port << socket->errorString();
+        delete socket;
+        return false;
+    }
+    m_socket = socket;
+    connect(m_socket, &QUdpSocket::readyRead, this, &RCReceiverStub::processDatagrams);
+
+    m_timer = new QTimer(this);
+    connect(m_timer, &QTimer::timeout, this, &RCReceiverStub::checkFailsafe);
+    m_timer->start(kCheckInterval);
+
+    m_have_sequence = false;
+    m_packets = 0;
+    m_bad = 0;
+    m_lost = 0;
+    m_out_of_order = 0;
+    m_last_packet.invalidate();
+    setFailsafe(true);
+
+    emit runningChanged(true);
+    emit statsChanged();
+    return true;
+}
+
+
+void RCReceiverStub::stop() {
+    if (!m_socket) {
+        return;
+    }
+    delete m_socket;
+    m_socket = nullptr;
+    delete m_timer;
+    m_timer = nullptr;
+
+    emit runningChanged(false);
+}
+
+
+QVariantList RCReceiverStub::channels() const {
+    QVariantList channels;
+    for (int c = 0; c < m_count; c++) {
+        channels.append(m_channels[c]);
+    }
+    return channels;
+}
+
+
+void RCReceiverStub::processDatagrams() {
+    uint8_t buffer[RCPacket::kMaxSize + 1];
+
+    while (m_socket->hasPendingDatagrams()) {
+        QHostAddress sender;
+        quint16 senderPort;
+        auto size = m_socket->readDatagram((char*)buffer, sizeof(buffer), &sender, &senderPort);
+
+        RCPacket::Packet packet;
+        if (size <= 0 || !RCPacket::decode(buffer, static_cast<size_t>(size), packet) || packet.type != RCPacket::kChannels) {
+            m_bad++;
+            continue;
+        }
+
+        // echoed even when out of order, the round trip was still made
+        RCPacket::Packet echo;
+        echo.type = RCPacket::kEcho;
+        echo.sequence = packet.sequence;
+        echo.time = packet.time;
+        auto length = RCPacket::encode(echo, buffer);
+        m_socket->writeDatagram((char*)buffer, static_cast<qint64>(length), sender, senderPort);
+
+        if (m_have_sequence) {
+            auto step = static_cast<int16_t>(packet.sequence - m_sequence);
+            if (step <= 0 && step > -kReorderWindow) {
+                m_out_of_order++;
+                continue;
+            }
+            // a restarted sender is followed from its new sequence on, nothing counted lost
+            if (step > 0) {
+                m_lost += step - 1;
+            }
+        }
+        m_have_sequence = true;
+        m_sequence = packet.sequence;
+
+        m_packets++;
+        m_count = packet.count;
+        std::copy(packet.channels, packet.channels + packet.count, m_channels.begin());
+        m_last_packet.start();
+
+        setFailsafe(false);
+    }
+}
+
+
+void RCReceiverStub::checkFailsafe() {
+    if (!m_failsafe && (!m_last_packet.isValid() || m_last_packet.elapsed() > kFailsafeTimeout)) {
+        qDebug() << "RCReceiverStub: failsafe after" << m_last_packet.elapsed() << "ms without a packet";
+        setFailsafe(true);
+    }
+    emit statsChanged();
+}
+
+
+void RCReceiverStub::setFailsafe(bool failsafe) {
+    if (failsafe) {
+        m_channels[kThrottle] = 1000;
+        // whatever comes next starts the count again, it may be a restarted sender
+        m_have_sequence = false;
+    }
+    if (m_failsafe == failsafe) {
+        return;
+    }
+    m_failsafe = failsafe;
+    emit failsafeChanged(m_failsafe);
+}
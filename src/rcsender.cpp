@@ -0,0 +1,380 @@
+#include "rcsender.h"
+
+#include <QCoreApplication>
+#include <QSettings>
+#include <QtNetwork>
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <openhd/mavlink.h>
+
+#include "mavlinkbase.h"
+#include "rcpacket.h"
+#include "trace.h"
+#include "util.h"
+
+
+static RCSender* _instance = nullptr;
+
+RCSender* RCSender::instance() {
+    if (_instance == nullptr) {
+        _instance = new RCSender();
+    }
+    return _instance;
+}
+
+
+RCSender::RCSender(QObject *parent): QThread(parent) {
+    qDebug() << "RCSender::RCSender()";
+    setObjectName("rcSender");
+
+    for (auto &channel : m_output) {
+        channel = 1500;
+    }
+
+    QSettings settings;
+    OpenHDUtil util;
+    m_enabled = settings.value("enable_rc", false).toBool();
+    m_sysid = settings.value("mavlink_sysid", util.default_mavlink_sysid()).toInt();
+    m_target_sysid = settings.value("fc_mavlink_sysid", util.default_mavlink_sysid()).toInt();
+    updateSetting("rc_transport", settings.value("rc_transport", "mavlink"));
+    updateSetting("rc_rate", settings.value("rc_rate", kDefaultRate));
+    loadTransforms(settings.value("rc_transforms", "").toString());
+
+#if defined(__rasp_pi__)
+    setGroundIP("127.0.0.1");
+#endif
+
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        requestInterruption();
+        wait();
+    });
+
+    start(QThread::TimeCriticalPriority);
+}
+
+
+void RCSender::updateSetting(const QString &key, const QVariant &value) {
+    if (key == "enable_rc") {
+        m_enabled = value.toBool();
+    } else if (key == "mavlink_sysid") {
+        m_sysid = value.toInt();
+    } else if (key == "fc_mavlink_sysid") {
+        m_target_sysid = value.toInt();
+    } else if (key == "rc_transport") {
+        m_transport = value.toString() == "openhd" ? TransportOpenHD : TransportMavlink;
+    } else if (key == "rc_rate") {
+        auto rate = qBound(1, value.toInt(), kMaxRate);
+        if (m_rate.exchange(rate) != rate) {
+            emit rateChanged(rate);
+        }
+    } else if (key == "rc_transforms") {
+        loadTransforms(value.toString());
+    }
+}
+
+
+/*
+ * Built here, on the UI thread, the RC thread only gets the finished table. A profile
+ * that can't be read still applies for the channels that could, the rest keep the
+ * defaults.
+ */
+void RCSender::loadTransforms(const QString &json) {
+    RCTransformTable table;
+    QString error;
+    if (!table.load(json, &error)) {
+        qDebug() << "RCSender::loadTransforms:" << error;
+    }
+    m_transforms.write(table);
+}
+
+
+void RCSender::setMavlinkLink(MavlinkBase *link) {
+    m_link.store(link, std::memory_order_release);
+}
+
+
+/*
+ * On the link's thread, for a frame it wrote to its TCP socket. Folded into the RC
+ * thread's numbers when its one second window ends.
+ */
+void RCSender::linkSent(qint64 input_time) {
+    auto latency = (RCClock::now() - input_time) / 1000;
+    TRACE_COUNTER("rc.latency", latency);
+
+    std::lock_guard<std::mutex> lock(m_link_mutex);
+    m_link_latency_sum += latency;
+    m_link_latency_max = std::max(m_link_latency_max, latency);
+    m_link_latency_count++;
+}
+
+
+void RCSender::setGroundIP(QString address) {
+    m_ground_address = QHostAddress(address).toIPv4Address();
+}
+
+
+void RCSender::setActive(bool active) {
+    qDebug() << "RCSender::setActive(" << active << ")";
+    m_active = active;
+}
+
+
+/*
+ * Sleeps until an absolute time on the RCClock::now() clock. Waking up late for one
+ * deadline doesn't push the next one back, unlike sleeping for the period after every
+ * packet.
+ */
+static void sleepUntil(qint64 deadline) {
+#if defined(__linux__)
+    timespec ts;
+    ts.tv_sec = deadline / 1000000000;
+    ts.tv_nsec = deadline % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::nanoseconds(deadline)));
+#endif
+}
+
+
+/*
+ * QThread::TimeCriticalPriority does nothing on Linux, under SCHED_OTHER there is only one
+ * priority. Real time scheduling needs CAP_SYS_NICE or an rtprio limit, without it the
+ * thread at least gets the best nice value it may have.
+ */
+static void raisePriority() {
+#if defined(__linux__)
+    sched_param param {};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 10;
+    auto error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (error == 0) {
+        return;
+    }
+    qWarning() << "RCSender: no SCHED_FIFO," << strerror(error) << "- trying nice -10";
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), -10) != 0) {
+        qWarning() << "RCSender: can't raise the RC thread's priority," << strerror(errno);
+    }
+#endif
+}
+
+
+void RCSender::run() {
+    constexpr qint64 second = 1000000000;
+
+    raisePriority();
+
+    // no event loop here, UDP writes and waitForReadyRead() don't need one
+    QUdpSocket socket;
+    socket.bind(QHostAddress::AnyIPv4, 0);
+
+    RCInputFrame inputs;
+    RCTransformTable transforms;
+    RCFrame frame;
+    std::array<uint16_t, RCFrame::kChannels> channels;
+
+    RCPacket::Packet packet;
+    packet.count = RCFrame::kChannels;
+
+    static_assert(MAVLINK_MAX_PACKET_LEN >= RCPacket::kMaxSize, "buffer too small for RCPacket");
+    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+
+    // only rebuilt when the address changes, a QHostAddress per packet would allocate
+    quint32 target = 0;
+    QHostAddress target_address;
+    auto writeTo = [&](quint32 address, quint16 port, qint64 length) {
+        if (address != target) {
+            target = address;
+            target_address = QHostAddress(address);
+        }
+        socket.writeDatagram((char*)buffer, length, target_address, port);
+    };
+
+    int ticks = 0;
+    qint64 jitter_sum = 0;
+    qint64 jitter_max = 0;
+    int latency_count = 0;
+    qint64 latency_sum = 0;
+    qint64 latency_max = 0;
+    int rtt_count = 0;
+    qint64 rtt_sum = 0;
+    qint64 rtt_max = 0;
+
+    // echoes are timed as they arrive, not when the next tick gets to them
+    auto takeEchoes = [&]() {
+        auto now = static_cast<uint32_t>(RCClock::now() / 1000);
+        while (socket.hasPendingDatagrams()) {
+            auto size = socket.readDatagram((char*)buffer, sizeof(buffer));
+            RCPacket::Packet echo;
+            if (size <= 0 || !RCPacket::decode(buffer, static_cast<size_t>(size), echo) || echo.type != RCPacket::kEcho) {
+                continue;
+            }
+            // wraps after 71 minutes, the difference doesn't
+            qint64 rtt = static_cast<uint32_t>(now - echo.time);
+            TRACE_COUNTER("rc.rtt", rtt);
+            rtt_sum += rtt;
+            rtt_max = std::max(rtt_max, rtt);
+            rtt_count++;
+        }
+    };
+
+    qint64 deadline = RCClock::now();
+    qint64 window = deadline;
+
+    while (!isInterruptionRequested()) {
+        auto period = second / m_rate.load(std::memory_order_relaxed);
+        auto transport = m_transport.load(std::memory_order_relaxed);
+
+        deadline += period;
+
+        if (transport == TransportOpenHD) {
+            // the last part of the wait is left to sleepUntil(), waitForReadyRead() only has ms
+            for (;;) {
+                auto ms = (deadline - RCClock::now()) / 1000000;
+                if (ms <= 0 || !socket.waitForReadyRead(static_cast<int>(ms))) {
+                    break;
+                }
+                takeEchoes();
+            }
+        }
+        sleepUntil(deadline);
+
+        auto woke = RCClock::now();
+        auto late = (woke - deadline) / 1000;
+        if (woke - deadline > period) {
+            // don't burst out the missed packets, carry on from now
+            m_overruns.fetch_add(1, std::memory_order_relaxed);
+            deadline = woke;
+        }
+
+        TRACE_COUNTER("rc.jitter", late);
+        jitter_sum += late;
+        jitter_max = std::max(jitter_max, late);
+        ticks++;
+
+        /*
+         * Both reads are a flag check unless something changed, so sticks at rest
+         * cost nothing but the packet.
+         */
+        bool new_inputs = m_inputs.read(inputs);
+        bool new_transforms = m_transforms.read(transforms);
+
+        bool fresh = false;
+        if (new_inputs || new_transforms) {
+            transforms.apply(inputs, channels);
+            if (channels != frame.channels) {
+                frame.channels = channels;
+                frame.input_time = inputs.input_time;
+                frame.sequence++;
+                fresh = true;
+
+                for (int c = 0; c < RCFrame::kChannels; c++) {
+                    m_output[c].store(channels[c], std::memory_order_relaxed);
+                }
+                emit channelsChanged();
+            }
+        }
+
+        auto address = m_ground_address.load(std::memory_order_relaxed);
+        bool sent = false;
+
+        if (m_enabled.load(std::memory_order_relaxed) && m_active.load(std::memory_order_relaxed)) {
+            const auto &c = frame.channels;
+
+            if (transport == TransportOpenHD) {
+                if (address != 0) {
+                    std::copy(c.begin(), c.end(), packet.channels);
+                    packet.time = static_cast<uint32_t>(RCClock::now() / 1000);
+                    writeTo(address, RCPacket::kPort, static_cast<qint64>(RCPacket::encode(packet, buffer)));
+                    packet.sequence++;
+                    sent = true;
+                }
+            } else {
+                mavlink_message_t msg;
+                // own channel, MAVLINK_COMM_0 sequence numbers belong to the telemetry thread
+                mavlink_msg_rc_channels_override_pack_chan(m_sysid.load(std::memory_order_relaxed), MAV_COMP_ID_MISSIONPLANNER, MAVLINK_COMM_1, &msg,
+                                                           m_target_sysid.load(std::memory_order_relaxed), MAV_COMP_ID_AUTOPILOT1,
+                                                           c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], c[8],
+                                                           c[9], c[10], c[11], c[12], c[13], c[14], c[15], c[16], c[17]);
+
+                auto len = mavlink_msg_to_send_buffer(buffer, &msg);
+
+                /*
+                 * The telemetry link knows where the router is. Over UDP its endpoint is
+                 * written to from here, so the telemetry event loop isn't in the way. A TCP
+                 * stream can only be written by its own thread, the frame is queued to it
+                 * and the latency taken there.
+                 */
+                auto link = m_link.load(std::memory_order_acquire);
+                auto endpoint = link != nullptr ? link->udpEndpoint() : 0;
+                if (endpoint != 0) {
+                    writeTo(static_cast<quint32>(endpoint >> 16), static_cast<quint16>(endpoint & 0xffff), len);
+                    sent = true;
+                } else if (link != nullptr && link->mavlinkType() == MavlinkTypeTCP) {
+                    QByteArray data((const char*)buffer, len);
+                    auto input_time = frame.input_time;
+                    QMetaObject::invokeMethod(link, [this, link, data, fresh, input_time]() {
+                        link->sendFrame(data);
+                        if (fresh) {
+                            linkSent(input_time);
+                        }
+                    }, Qt::QueuedConnection);
+                }
+            }
+
+            if (sent && fresh) {
+                auto latency = (RCClock::now() - frame.input_time) / 1000;
+                TRACE_COUNTER("rc.latency", latency);
+                latency_sum += latency;
+                latency_max = std::max(latency_max, latency);
+                latency_count++;
+            }
+        }
+
+        if (woke - window >= second) {
+            {
+                // left for the next window rather than waiting while the link adds one
+                std::unique_lock<std::mutex> lock(m_link_mutex, std::try_to_lock);
+                if (lock.owns_lock()) {
+                    latency_sum += m_link_latency_sum;
+                    latency_max = std::max(latency_max, m_link_latency_max);
+                    latency_count += m_link_latency_count;
+                    m_link_latency_sum = 0;
+                    m_link_latency_max = 0;
+                    m_link_latency_count = 0;
+                }
+            }
+
+            m_jitter = static_cast<int>(jitter_sum / ticks);
+            m_jitter_max = static_cast<int>(jitter_max);
+            m_latency = latency_count ? static_cast<int>(latency_sum / latency_count) : 0;
+            m_latency_max = static_cast<int>(latency_max);
+            m_rtt = rtt_count ? static_cast<int>(rtt_sum / rtt_count) : -1;
+            m_rtt_max = rtt_count ? static_cast<int>(rtt_max) : -1;
+            emit statsChanged();
+
+            window = woke;
+            ticks = 0;
+            jitter_sum = 0;
+            jitter_max = 0;
+            latency_count = 0;
+            latency_sum = 0;
+            latency_max = 0;
+            rtt_count = 0;
+            rtt_sum = 0;
+            rtt_max = 0;
+        }
+    }
+}
@@ -0,0 +1,158 @@
+#include "rctransform.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+
+#include <algorithm>
+#include <cstdlib>
+
+// channels mapped to axes 0-9 by default, as the joystick code always did
+constexpr int kDefaultMapped = 10;
+
+constexpr int kFullTravel = 32767;
+constexpr int kSegmentShift = 10;
+constexpr int kSegmentLength = 1 << kSegmentShift;
+
+static_assert(kSegmentLength * RCTransformTable::kCurveSegments == kFullTravel + 1, "curve must cover the input range");
+
+
+RCTransformTable::RCTransformTable() {
+    for (int c = 0; c < RCFrame::kChannels; c++) {
+        auto &channel = m_channels[c];
+        channel.input = c < kDefaultMapped ? c : -1;
+        linear(channel);
+    }
+}
+
+
+void RCTransformTable::linear(Channel &channel) {
+    for (int i = 0; i <= kCurveSegments; i++) {
+        channel.curve[i] = static_cast<int16_t>(std::min(i * kSegmentLength, kFullTravel));
+    }
+}
+
+
+bool RCTransformTable::load(const QString &json, QString *error) {
+    QString problem;
+
+    *this = RCTransformTable();
+
+    if (json.trimmed().isEmpty()) {
+        return true;
+    }
+
+    QJsonParseError parseError;
+    auto doc = QJsonDocument::fromJson(json.toUtf8(), &parseError);
+    if (!doc.isArray()) {
+        if (error) {
+            *error = parseError.error != QJsonParseError::NoError ? parseError.errorString() : "not an array";
+        }
+        return false;
+    }
+
+    for (const auto &entry : doc.array()) {
+        auto o = entry.toObject();
+
+        int c = o.value("channel").toInt(0) - 1;
+        if (c < 0 || c >= RCFrame::kChannels) {
+            problem = QString("bad channel %1").arg(o.value("channel").toInt(0));
+            continue;
+        }
+
+        auto input = o.value("input").toInt(m_channels[c].input);
+        auto mix_input = o.value("mix_input").toInt(-1);
+        if (input < -1 || input >= RCInputFrame::kInputs || mix_input < -1 || mix_input >= RCInputFrame::kInputs) {
+            problem = QString("channel %1: bad input").arg(c + 1);
+            continue;
+        }
+
+        Channel channel;
+        channel.input = static_cast<int8_t>(input);
+        channel.mix_input = static_cast<int8_t>(mix_input);
+        channel.reverse = o.value("reverse").toBool(false);
+        channel.trim = std::clamp(o.value("trim").toInt(0), -500, 500);
+        channel.mix = static_cast<int32_t>(std::clamp(o.value("mix").toDouble(0.0), -1.0, 1.0) * 1024);
+
+        auto deadband = std::clamp(o.value("deadband").toDouble(0.0), 0.0, 0.9);
+        channel.deadband = static_cast<int32_t>(deadband * kFullTravel);
+        channel.deadband_scale = static_cast<int32_t>((static_cast<int64_t>(kFullTravel) << 16) / (kFullTravel - channel.deadband));
+
+        if (o.contains("curve")) {
+            auto points = o.value("curve").toArray();
+            if (points.size() < 2) {
+                problem = QString("channel %1: a curve needs at least 2 points").arg(c + 1);
+                continue;
+            }
+            // resampled to the table, straight lines between the given points
+            auto last = points.size() - 1;
+            for (int i = 0; i <= kCurveSegments; i++) {
+                auto t = static_cast<double>(i) / kCurveSegments * last;
+                auto p = std::min(static_cast<int>(t), last - 1);
+                auto y0 = points.at(p).toDouble();
+                auto y1 = points.at(p + 1).toDouble();
+                auto y = std::clamp(y0 + (y1 - y0) * (t - p), 0.0, 1.0);
+                channel.curve[i] = static_cast<int16_t>(y * kFullTravel);
+            }
+        } else {
+            auto expo = std::clamp(o.value("expo").toDouble(0.0), 0.0, 1.0);
+            for (int i = 0; i <= kCurveSegments; i++) {
+                auto t = static_cast<double>(i) / kCurveSegments;
+                auto y = (1.0 - expo) * t + expo * t * t * t;
+                channel.curve[i] = static_cast<int16_t>(y * kFullTravel);
+            }
+        }
+
+        m_channels[c] = channel;
+    }
+
+    if (!problem.isEmpty()) {
+        if (error) {
+            *error = problem;
+        }
+        return false;
+    }
+    return true;
+}
+
+
+void RCTransformTable::apply(const RCInputFrame &in, std::array<uint16_t, RCFrame::kChannels> &out) const {
+    for (int c = 0; c < RCFrame::kChannels; c++) {
+        const auto &channel = m_channels[c];
+
+        if (channel.input < 0) {
+            out[c] = in.direct[c];
+            continue;
+        }
+
+        int32_t x = in.inputs[channel.input];
+        int32_t magnitude = std::abs(x);
+
+        if (magnitude <= channel.deadband) {
+            magnitude = 0;
+        } else {
+            magnitude = static_cast<int32_t>((static_cast<int64_t>(magnitude - channel.deadband) * channel.deadband_scale) >> 16);
+            magnitude = std::min(magnitude, kFullTravel);
+        }
+
+        auto segment = magnitude >> kSegmentShift;
+        auto fraction = magnitude & (kSegmentLength - 1);
+        int32_t y0 = channel.curve[segment];
+        int32_t y1 = channel.curve[segment + 1];
+        int32_t y = y0 + (y1 - y0) * fraction / kSegmentLength;
+
+        if ((x < 0) != channel.reverse) {
+            y = -y;
+        }
+
+        if (channel.mix_input >= 0) {
+            y += in.inputs[channel.mix_input] * channel.mix / 1024;
+        }
+
+        // rounded, the last curve segment can fall a count short of full travel
+        int32_t half = y < 0 ? -kFullTravel / 2 : kFullTravel / 2;
+        int32_t value = 1500 + (y * 500 + half) / kFullTravel + channel.trim;
+        out[c] = static_cast<uint16_t>(std::clamp(value, 1000, 2000));
+    }
+}
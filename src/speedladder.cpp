@@ -5,6 +5,7 @@
 #include "openhd.h"
 
 #include "speedladder.h"
+#include "trace.h"
 
 
 SpeedLadder::SpeedLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
@@ -13,6 +14,7 @@ SpeedLadder::SpeedLadder(QQuickItem *parent): QQuickPaintedItem(parent) {
 }
 
 void SpeedLadder::paint(QPainter* painter) {
+    TRACE_SCOPE("paint.SpeedLadder");
     painter->save();
 
     painter->setFont(m_font);
@@ -1,5 +1,7 @@
 #include "statuslogmodel.h"
 
+#include <algorithm>
+
 
 static StatusLogModel* _instance = nullptr;
 
@@ -11,27 +13,153 @@ StatusLogModel* StatusLogModel::instance() {
 }
 
 
-StatusLogModel::StatusLogModel(QObject *parent) {
+StatusLogModel::StatusLogModel(QObject *parent): QAbstractListModel(parent) {
     qDebug() << "StatusLogModel::StatusLogModel()";
+
+    m_entries.resize(kCapacity);
+    m_clock.start();
 }
 
 
 void StatusLogModel::addMessage(StatusMessage message) {
-    beginInsertRows(QModelIndex(), rowCount(), rowCount());
-    m_messages.append(message);
+    auto now = m_clock.elapsed();
+    auto &source = m_source_index[sourceKey(message.sysid, message.compid)];
+
+    // a repeat of something the sender said just now only bumps the count of that row
+    auto depth = 0;
+    for (auto it = source.rbegin(); it != source.rend() && depth < kRepeatDepth; ++it, depth++) {
+        auto &e = m_entries[*it % kCapacity];
+        if (now - e.received > kRepeatWindow) {
+            break;
+        }
+        if (e.message.severity == message.severity && e.message.message == message.message) {
+            e.repeat++;
+            e.received = now;
+            e.message.timestamp = message.timestamp;
+            auto i = index(row(*it));
+            emit dataChanged(i, i);
+            return;
+        }
+    }
+
+    if (m_next - m_first == kCapacity) {
+        auto &oldest = entry(m_first);
+        // the oldest entry is the front of both of its indexes
+        m_severity_index[severityIndex(oldest.message.severity)].pop_front();
+        auto key = sourceKey(oldest.message.sysid, oldest.message.compid);
+        auto &oldest_source = m_source_index[key];
+        oldest_source.pop_front();
+
+        beginRemoveRows(QModelIndex(), 0, 0);
+        m_first++;
+        endRemoveRows();
+
+        if (oldest_source.empty() && key != sourceKey(message.sysid, message.compid)) {
+            m_source_index.remove(key);
+        }
+    }
+
+    auto seq = m_next;
+    beginInsertRows(QModelIndex(), row(seq), row(seq));
+    auto &e = m_entries[seq % kCapacity];
+    e.message = std::move(message);
+    e.repeat = 1;
+    e.received = now;
+    m_next++;
     endInsertRows();
+
+    m_severity_index[severityIndex(e.message.severity)].push_back(seq);
+    m_source_index[sourceKey(e.message.sysid, e.message.compid)].push_back(seq);
+
+    emit countsChanged();
+}
+
+
+void StatusLogModel::clear() {
+    beginResetModel();
+    m_first = m_next;
+    for (auto &index : m_severity_index) {
+        index.clear();
+    }
+    m_source_index.clear();
+    endResetModel();
+
+    emit countsChanged();
 }
 
 
 int StatusLogModel::rowCount(const QModelIndex & parent) const {
-    Q_UNUSED(parent)
-    return m_messages.count();
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(m_next - m_first);
 }
 
 
 int StatusLogModel::columnCount(const QModelIndex &parent) const {
     Q_UNUSED(parent);
-    return 5;
+    return 6;
+}
+
+
+int StatusLogModel::errorCount() const {
+    auto count = 0;
+    for (int severity = 0; severity <= 3; severity++) {
+        count += static_cast<int>(m_severity_index[severity].size());
+    }
+    return count;
+}
+
+
+int StatusLogModel::severityCount(int severity) const {
+    if (severity < 0 || severity >= kSeverities) {
+        return 0;
+    }
+    return static_cast<int>(m_severity_index[severity].size());
+}
+
+
+QVariantList StatusLogModel::rows(const std::deque<quint64> &index) const {
+    QVariantList list;
+    list.reserve(static_cast<int>(index.size()));
+    for (auto seq : index) {
+        list.append(row(seq));
+    }
+    return list;
+}
+
+
+QVariantList StatusLogModel::severityRows(int severity) const {
+    severity = qMin(severity, kSeverities - 1);
+    if (severity < 0) {
+        return QVariantList();
+    }
+    if (severity == 0) {
+        return rows(m_severity_index[0]);
+    }
+
+    // merge the per severity indexes, they are each in arrival order already
+    std::vector<quint64> seqs;
+    for (int s = 0; s <= severity; s++) {
+        seqs.insert(seqs.end(), m_severity_index[s].begin(), m_severity_index[s].end());
+    }
+    std::sort(seqs.begin(), seqs.end());
+
+    QVariantList list;
+    list.reserve(static_cast<int>(seqs.size()));
+    for (auto seq : seqs) {
+        list.append(row(seq));
+    }
+    return list;
+}
+
+
+QVariantList StatusLogModel::sourceRows(int sysid, int compid) const {
+    auto it = m_source_index.find(sourceKey(sysid, compid));
+    if (it == m_source_index.end()) {
+        return QVariantList();
+    }
+    return rows(*it);
 }
 
 
@@ -43,6 +171,7 @@ QHash<int, QByteArray> StatusLogModel::roleNames() const {
     roles[2] = "compid";
     roles[3] = "severity";
     roles[4] = "timestamp";
+    roles[5] = "repeat";
 
     return roles;
 }
@@ -50,22 +179,24 @@ QHash<int, QByteArray> StatusLogModel::roleNames() const {
 
 QVariant StatusLogModel::data(const QModelIndex &index, int role) const {
 
-    if (index.row() < 0 || index.row() >= m_messages.size()) {
+    if (index.row() < 0 || index.row() >= rowCount()) {
         return QVariant();
     }
 
-    const StatusMessage entry = m_messages[index.row()];
+    const Entry &e = entry(m_first + index.row());
 
     if (role == 0) {
-        return QVariant::fromValue(entry.message);
+        return QVariant::fromValue(e.message.message);
     } else if (role == 1) {
-        return QVariant::fromValue(entry.sysid);
+        return QVariant::fromValue(e.message.sysid);
     } else if (role == 2) {
-        return QVariant::fromValue(entry.compid);
+        return QVariant::fromValue(e.message.compid);
     } else if (role == 3) {
-        return QVariant::fromValue(entry.severity);
+        return QVariant::fromValue(e.message.severity);
     } else if (role == 4) {
-        return QVariant::fromValue(entry.timestamp);
+        return QVariant::fromValue(e.message.timestamp);
+    } else if (role == 5) {
+        return QVariant::fromValue(e.repeat);
     }
 
     return QVariant();
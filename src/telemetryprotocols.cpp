@@ -0,0 +1,584 @@
+#include "telemetryprotocols.h"
+
+#include "telemetrysink.h"
+
+
+/* #################################################################################################################
+ * FrSky hub
+ * ################################################################################################################# */
+
+// Data Ids (bp = before decimal point; af = after decimal point)
+// Official data IDs
+#define ID_GPS_ALTITUDE_BP 0x01
+#define ID_GPS_ALTITUDE_AP 0x09
+#define ID_TEMPRATURE1 0x02
+#define ID_RPM 0x03
+#define ID_FUEL_LEVEL 0x04
+#define ID_TEMPRATURE2 0x05
+#define ID_VOLT 0x06
+#define ID_ALTITUDE_BP 0x10
+#define ID_ALTITUDE_AP 0x21
+#define ID_GPS_SPEED_BP 0x11
+#define ID_GPS_SPEED_AP 0x19
+#define ID_LONGITUDE_BP 0x12
+#define ID_LONGITUDE_AP 0x1A
+#define ID_E_W 0x22
+#define ID_LATITUDE_BP 0x13
+#define ID_LATITUDE_AP 0x1B
+#define ID_N_S 0x23
+#define ID_COURSE_BP 0x14
+#define ID_COURSE_AP 0x1C
+#define ID_DATE_MONTH 0x15
+#define ID_YEAR 0x16
+#define ID_HOUR_MINUTE 0x17
+#define ID_SECOND 0x18
+#define ID_ACC_X 0x24
+#define ID_ACC_Y 0x25
+#define ID_ACC_Z 0x26
+#define ID_VOLTAGE_AMP 0x39
+#define ID_VOLTAGE_AMP_BP 0x3A
+#define ID_VOLTAGE_AMP_AP 0x3B
+#define ID_CURRENT 0x28
+// User defined data IDs
+#define ID_GYRO_X 0x40
+#define ID_GYRO_Y 0x41
+#define ID_GYRO_Z 0x42
+#define ID_VERT_SPEED 0x30 //opentx vario
+
+
+void FrSkyHubProtocol::decode(const uint8_t *frame, int length, TelemetrySink &sink) {
+    TelemetryReader reader(frame + 1, length - 1);
+
+    auto id = reader.u8();
+    uint16_t data = reader.u16();
+
+    switch (id) {
+        case ID_VOLTAGE_AMP: {
+            // no idea what this is here for, it was commented out in the old OSD
+            //uint16_t val = (state.pkg[2] >> 8) | ((state.pkg[1] & 0xf) << 8);
+            //float battery = 3.0f * val / 500.0f;
+            // no current provided? is it in the 3rd byte of state.pkg?
+            sink.set_battery_voltage(data / 10.0f);
+            break;
+        }
+        case ID_ALTITUDE_BP: {
+            sink.set_alt_rel(data);
+            break;
+        }
+        case ID_ALTITUDE_AP: {
+            // this was commented out in the old OSD
+            //td->baro_altitude += data/100;
+            break;
+        }
+        case ID_GPS_ALTITUDE_BP: {
+            sink.set_alt_msl(data);
+            break;
+        }
+        case ID_LONGITUDE_BP: {
+            lon = data / 100;
+            lon += 1.0 * (data - lon * 100) / 60;
+            sink.set_lon((ew == 'E' ? 1 : -1) * lon);
+            break;
+        }
+        case ID_LONGITUDE_AP: {
+            lon += 1.0 * data / 60 / 10000;
+            sink.set_lon((ew == 'E' ? 1 : -1) * lon);
+            break;
+        }
+        case ID_LATITUDE_BP: {
+            lat = data / 100;
+            lat += 1.0 * (data - lat * 100) / 60;
+            sink.set_lat((ns == 'N' ? 1 : -1) * lat);
+            break;
+        }
+        case ID_LATITUDE_AP: {
+            lat += 1.0 * data / 60 / 10000;
+            sink.set_lat((ns == 'N' ? 1 : -1) * lat);
+            break;
+        }
+        case ID_COURSE_BP: {
+            sink.set_hdg(data);
+            break;
+        }
+        case ID_GPS_SPEED_BP: {
+            speed = 1.0 * data / 0.0194384449;
+            sink.set_speed(static_cast<int>(speed));
+            break;
+        }
+        case ID_GPS_SPEED_AP: {
+            speed += 1.0 * data / 1.94384449; //now we are in cm/s
+            speed = speed / 100 / 1000 * 3600; //now we are in km/h
+            sink.set_speed(static_cast<int>(speed));
+            break;
+        }
+        case ID_ACC_X: {
+            sink.set_vx(data);
+            break;
+        }
+        case ID_ACC_Y: {
+            sink.set_vy(data);
+            break;
+        }
+        case ID_ACC_Z: {
+            sink.set_vz(data);
+            break;
+        }
+        case ID_E_W: {
+            ew = static_cast<char>(data);
+            break;
+        }
+        case ID_N_S: {
+            ns = static_cast<char>(data);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+
+/* #################################################################################################################
+ * FrSky SmartPort
+ * ################################################################################################################# */
+
+//Frsky DATA ID's
+#define FR_ID_ALTITUDE 0x0100 //ALT_FIRST_ID
+#define FR_ID_VARIO 0x0110 //VARIO_FIRST_ID
+#define FR_ID_VFAS 0x0210 //VFAS_FIRST_ID
+#define FR_ID_CURRENT 0x0200 //CURR_FIRST_ID
+#define FR_ID_CELLS 0x0300 //CELLS_FIRST_ID
+#define FR_ID_CELLS_LAST 0x030F //CELLS_LAST_ID
+#define FR_ID_T1 0x0400 //T1_FIRST_ID
+#define FR_ID_T2 0x0410 //T2_FIRST_ID
+#define FR_ID_RPM 0x0500 //RPM_FIRST_ID
+#define FR_ID_FUEL 0x0600 //FUEL_FIRST_ID
+#define FR_ID_ACCX 0x0700 //ACCX_FIRST_ID
+#define FR_ID_ACCY 0x0710 //ACCY_FIRST_ID
+#define FR_ID_ACCZ 0x0720 //ACCZ_FIRST_ID
+#define FR_ID_LATLONG 0x0800 //GPS_LONG_LATI_FIRST_ID
+#define FR_ID_GPS_ALT 0x0820 //GPS_ALT_FIRST_ID
+#define FR_ID_SPEED 0x0830 //GPS_SPEED_FIRST_ID
+#define FR_ID_GPS_COURSE 0x0840 //GPS_COURS_FIRST_ID
+#define FR_ID_GPS_TIME_DATE 0x0850 //GPS_TIME_DATE_FIRST_ID
+#define FR_ID_GPS_SAT 0x0860 //GPS satellite count and fix state (own definition)
+#define FR_ID_A3_FIRST 0x0900 //A3_FIRST_ID
+#define FR_ID_A4_FIRST 0x0910 //A4_FIRST_ID
+#define FR_ID_AIR_SPEED_FIRST 0x0A00 //AIR_SPEED_FIRST_ID
+#define FR_ID_RSSI 0xF101 // used by the radio system
+#define FR_ID_ADC1 0xF102 //ADC1_ID
+#define FR_ID_ADC2 0xF103 //ADC2_ID
+#define FR_ID_RXBATT 0xF104 // used by the radio system
+#define FR_ID_SWR 0xF105 // used by the radio system
+#define FR_ID_FIRMWARE 0xF106 // used by the radio system
+
+
+bool SmartPortProtocol::check(const uint8_t *frame, int length) {
+    uint16_t crc = 0;
+
+    for (int i = 0; i < length - 1; i++) {
+        crc += frame[i];
+        crc += crc >> 8;
+        crc &= 0x00ff;
+    }
+
+    return static_cast<uint8_t>(0xff - crc) == frame[length - 1];
+}
+
+
+void SmartPortProtocol::decode(const uint8_t *frame, int length, TelemetrySink &sink) {
+    TelemetryReader reader(frame + 1, length - 1);
+
+    auto id = reader.u16();
+    auto u32 = reader.u32();
+    auto i32 = static_cast<int32_t>(u32);
+    auto u16 = static_cast<uint16_t>(u32);
+    auto i16 = static_cast<int16_t>(u32);
+
+    switch (id) {
+        case FR_ID_VFAS: {
+            sink.set_battery_voltage(u16 / 100.0);
+            break;
+        }
+        case FR_ID_LATLONG: {
+            double value = u32 & 0x3fffffff;
+            value /= 600000;
+            if (u32 & 0x40000000) {
+                value = -value;
+            }
+            if (u32 & 0x80000000) {
+                sink.set_lon(value);
+            } else {
+                sink.set_lat(value);
+            }
+            break;
+        }
+        case FR_ID_GPS_ALT: {
+            sink.set_alt_msl(i32 / 100.0);
+            break;
+        }
+        case FR_ID_SPEED: {
+            sink.set_speed(u32 / 2000.0);
+            break;
+        }
+        case FR_ID_GPS_COURSE: {
+            sink.set_hdg(u32 / 100.0);
+            break;
+        }
+        case FR_ID_T1: {
+            // iNav, CF flight modes / arm, see inav smartport.c
+            break;
+        }
+        case FR_ID_T2: {
+            // iNav, CF sat fix / home
+            //auto fix = (uint8_t)(u32 / 1000);
+            sink.set_satellites_visible(static_cast<uint8_t>(u32 % 1000));
+            break;
+        }
+        case FR_ID_GPS_SAT: {
+            // car ctrl sat fix
+            //auto fix = (uint8_t)(u16 % 10);
+            sink.set_satellites_visible(static_cast<uint8_t>(u16 / 10));
+            break;
+        }
+        case FR_ID_ALTITUDE: {
+            sink.set_alt_rel(i32 / 100.0);
+            break;
+        }
+        case FR_ID_ACCX: {
+            sink.set_vx(i16);
+            break;
+        }
+        case FR_ID_ACCY: {
+            sink.set_vy(i16);
+            break;
+        }
+        case FR_ID_ACCZ: {
+            sink.set_vz(i16);
+            break;
+        }
+        case FR_ID_CURRENT: {
+            sink.set_battery_current(u16 / 10.0);  // this is guessed
+            break;
+        }
+        case FR_ID_RSSI:
+        case FR_ID_RXBATT:
+        case FR_ID_SWR:
+        case FR_ID_ADC1:
+        case FR_ID_ADC2:
+        case FR_ID_VARIO:
+        case FR_ID_CELLS:
+        case FR_ID_CELLS_LAST:
+        case FR_ID_RPM:
+        case FR_ID_FUEL:
+        case FR_ID_GPS_TIME_DATE:
+        case FR_ID_A3_FIRST:
+        case FR_ID_A4_FIRST:
+        case FR_ID_AIR_SPEED_FIRST:
+        case FR_ID_FIRMWARE:
+        default: {
+            break;
+        }
+    }
+}
+
+
+/* #################################################################################################################
+ * LightTelemetry protocol (LTM)
+ *
+ * Ghettostation one way telemetry protocol for really low bitrates (1200/2400 bauds).
+ *
+ * Protocol details: little endian.
+ *   G Frame (GPS position) (2hz @ 1200 bauds , 5hz >= 2400 bauds): 18BYTES
+ *    0x24 0x54 0x47 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF  0xFF   0xC0
+ *     $     T    G  --------LAT-------- -------LON---------  SPD --------ALT-------- SAT/FIX  CRC
+ *   A Frame (Attitude) (5hz @ 1200bauds , 10hz >= 2400bauds): 10BYTES
+ *     0x24 0x54 0x41 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF 0xC0
+ *      $     T   A   --PITCH-- --ROLL--- -HEADING-  CRC
+ *   S Frame (Sensors) (2hz @ 1200bauds, 5hz >= 2400bauds): 11BYTES
+ *     0x24 0x54 0x53 0xFF 0xFF  0xFF 0xFF    0xFF    0xFF      0xFF       0xC0
+ *      $     T   S   VBAT(mv)  Current(ma)   RSSI  AIRSPEED  ARM/FS/FMOD   CRC
+ *   O Frame (Origin): 18 bytes, N Frame (Navigation): 10 bytes, X Frame (GPS extra): 10 bytes
+ * ################################################################################################################# */
+
+int LTMProtocol::frameLength(const uint8_t *header) {
+    switch (header[2]) {
+        case 'G': return 18;
+        case 'A': return 10;
+        case 'S': return 11;
+        case 'O': return 18;
+        case 'N': return 10;
+        case 'X': return 10;
+        default: return 0;
+    }
+}
+
+
+bool LTMProtocol::check(const uint8_t *frame, int length) {
+    uint8_t crc = 0;
+    for (int i = 3; i < length; i++) {
+        crc ^= frame[i];
+    }
+    return crc == 0;
+}
+
+
+void LTMProtocol::decode(const uint8_t *frame, int length, TelemetrySink &sink) {
+    TelemetryReader reader(frame + 3, length - 4);
+
+    switch (frame[2]) {
+        case 'G': {
+            sink.set_lat(reader.i32() / 10000000.0);
+            sink.set_lon(reader.i32() / 10000000.0);
+
+            auto uav_groundspeedms = reader.u8();
+            sink.set_speed(uav_groundspeedms * 3.6f); // convert to kmh
+
+            sink.set_alt_rel(reader.i32() / 100.0f);
+
+            auto ltm_satsfix = reader.u8();
+            sink.set_satellites_visible(ltm_satsfix >> 2);
+            //auto fix = ltm_satsfix & 0b00000011;
+            break;
+        }
+        case 'A': {
+            sink.set_pitch(reader.i16());
+            sink.set_roll(reader.i16());
+            sink.set_hdg(reader.i16()); //-180/180, the sink wraps it to 0/360
+            break;
+        }
+        case 'O': {
+            // home position, qopenhd works out home itself when the vehicle arms
+            //lat int32, lon int32, alt int32 cm, osd on uint8, home fix uint8
+            break;
+        }
+        case 'X': {
+            //HDOP 		uint16 HDOP * 100
+            //hw status 	uint8
+            //LTM_X_counter 	uint8
+            //Disarm Reason 	uint8
+            //(unused) 		1byte
+            sink.set_gps_hdop(reader.u16() / 100.0f);
+            break;
+        }
+        case 'S': {
+            //Vbat 			uint16, mV
+            //Battery Consumption 	uint16, mAh
+            //RSSI 			uchar
+            //Airspeed 			uchar, m/s
+            //Status 			uchar
+            sink.set_battery_voltage(reader.u16() / 1000.0f);
+            sink.set_flight_mah(reader.u16());
+            // no current provided
+
+            sink.set_rc_rssi(reader.u8());
+
+            auto uav_airspeedms = reader.u8();
+            sink.set_airspeed(uav_airspeedms * 3.6f); // convert to kmh
+
+            auto ltm_armfsmode = reader.u8();
+            sink.set_armed(ltm_armfsmode & 0b00000001);
+            //auto ltm_failsafe = (ltm_armfsmode >> 1) & 0b00000001;
+            sink.set_flight_mode(sink.util().ltm_mode_from_telem((ltm_armfsmode >> 2) & 0b00111111));
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+
+/* #################################################################################################################
+ * Vector Open Telemetry Revision 0
+ *
+ * 1) UART protocol is 8N1 (8 bits, no parity bit, 1 stop bit), 57600 baud, 3.3V input/outputs levels
+ * 2) all fields BIG-ENDIAN byte order
+ * 3) The VECTOR_OPEN_TELEMETRY packet is sent as frequently as every 80mS, but timing will vary considerably
+ *
+ *   uint32_t StartCode;            //  0xB01EDEAD
+ *   uint32_t TimestampMS;          // -not used- timestamp in milliseconds
+ *   int32_t BaroAltitudecm;        // -fl baro_altitude- zero referenced (from home position) barometric altitude in cm
+ *   uint16_t AirspeedKPHX10;       // -fl airspeed- KPH * 10, requires optional pitot sensor
+ *   int16_t ClimbRateMSX100;       // -fl vario - meters/second * 100
+ *   uint16_t RPM;                  // -not used- requires optional RPM sensor
+ *   int16_t PitchDegrees;          // -i16 pitch-
+ *   int16_t RollDegrees;           // -i16 roll-
+ *   int16_t YawDegrees;            // -fl heading-
+ *   int16_t AccelXCentiGrav;       // -not used-
+ *   int16_t AccelYCentiGrav;       // -not used-
+ *   int16_t AccelZCentiGrav;       // -not used-
+ *   uint16_t PackVoltageX100;      // -fl voltage-
+ *   uint16_t VideoTxVoltageX100;   // -fl vtxvoltage
+ *   uint16_t CameraVoltageX100;    // -fl camvoltage
+ *   uint16_t RxVoltageX100;        // -fl rxvoltage
+ *   uint16_t PackCurrentX10;       // -fl ampere-
+ *   int16_t TempDegreesCX10;       // -i16 temp- degrees C * 10, from optional temperature sensor
+ *   uint16_t mAHConsumed;          // -u16 mahconsumed-
+ *   uint16_t CompassDegrees;       // -u16 compassdegrees used- either magnetic compass reading (if compass enabled) or filtered GPS course over ground if not
+ *   uint8_t RSSIPercent;           // -u8 rssi-
+ *   uint8_t LQPercent;             // -u8 LQ-
+ *   int32_t LatitudeX1E7;          // -dbl latitude- (degrees * 10,000,000 )
+ *   int32_t LongitudeX1E7;         // -dbl longitude- (degrees * 10,000,000 )
+ *   uint32_t DistanceFromHomeMX10; // -fl distance- horizontal GPS distance from home point, in meters X 10 (decimeters)
+ *   uint16_t GroundspeedKPHX10;    // -fl speed- ( km/h * 10 )
+ *   uint16_t CourseDegrees;        // -u16 coursedegrees- GPS course over ground, in degrees
+ *   int32_t GPSAltitudecm;         // -fl altitude- ( GPS altitude, using WGS-84 ellipsoid, cm)
+ *   uint8_t HDOPx10;               // -fl hdop- GPS HDOP * 10
+ *   uint8_t SatsInUse;             // -u8 sats- satellites used for navigation
+ *   uint8_t PresentFlightMode;     // -u8 uav_flightmode- present flight mode, as defined in VECTOR_FLIGHT_MODES
+ *   uint8_t RFU[24];               // -not used- reserved for future use
+ *   uint16_t CRC;                  // little endian, unlike everything else
+ * ################################################################################################################# */
+
+using Crc16Ccitt = CrcTable<uint16_t, 0x1021>;
+
+constexpr uint16_t kVectorCrcInit = 0xffff;
+
+
+bool VectorProtocol::check(const uint8_t *frame, int length) {
+    auto crc = Crc16Ccitt::compute(frame, length - 2, kVectorCrcInit);
+    auto received = static_cast<uint16_t>(frame[length - 2] | (frame[length - 1] << 8));
+    return crc == received;
+}
+
+
+void VectorProtocol::decode(const uint8_t *frame, int length, TelemetrySink &sink) {
+    TelemetryReader reader(frame, length - 2);
+
+    reader.skip(4); // StartCode
+    reader.skip(4); // TimestampMS
+
+    sink.set_alt_rel(reader.i32be() / 100.0f);
+    sink.set_airspeed(reader.u16be() / 10.0f);
+
+    reader.skip(2); // ClimbRateMSX100
+    reader.skip(2); // RPM
+
+    sink.set_pitch(reader.i16be());
+    sink.set_roll(reader.i16be());
+    sink.set_hdg(reader.i16be());
+
+    sink.set_vx(reader.i16be());
+    sink.set_vy(reader.i16be());
+    sink.set_vz(reader.i16be());
+
+    auto battery_voltage = reader.u16be() / 100.0f;
+    reader.skip(2); // VideoTxVoltageX100
+    reader.skip(2); // CameraVoltageX100
+    reader.skip(2); // RxVoltageX100
+    auto ampere = reader.u16be() / 10.0f;
+    sink.set_battery_voltage(battery_voltage);
+    sink.set_battery_current(ampere);
+
+    reader.skip(2); // TempDegreesCX10
+    sink.set_flight_mah(reader.u16be());
+
+    reader.skip(2); // CompassDegrees
+    sink.set_rc_rssi(reader.u8());
+    reader.skip(1); // LQPercent
+
+    sink.set_lat(reader.i32be() / 10000000.0);
+    sink.set_lon(reader.i32be() / 10000000.0);
+
+    // qopenhd doesn't use this because we calculate home when the drone is armed based on current location
+    reader.skip(4); // DistanceFromHomeMX10
+
+    sink.set_speed(reader.u16be() / 10.0f);
+    reader.skip(2); // CourseDegrees
+    sink.set_alt_msl(reader.i32be() / 100.0f);
+
+    sink.set_gps_hdop(reader.u8());
+    sink.set_satellites_visible(reader.u8());
+
+    sink.set_flight_mode(sink.util().vot_mode_from_telemetry(reader.u8()));
+
+    sink.update_home();
+}
+
+
+/* #################################################################################################################
+ * MultiWii Serial Protocol (MSP) v1
+ *
+ * MSP is request/response, so these only show up when something on the air side polls the
+ * flight controller and forwards the replies.
+ * ################################################################################################################# */
+
+#define MSP_RAW_GPS 106
+#define MSP_ATTITUDE 108
+#define MSP_ALTITUDE 109
+#define MSP_ANALOG 110
+
+
+bool MSPProtocol::check(const uint8_t *frame, int length) {
+    uint8_t crc = 0;
+    for (int i = 3; i < length - 1; i++) {
+        crc ^= frame[i];
+    }
+    return crc == frame[length - 1];
+}
+
+
+void MSPProtocol::decode(const uint8_t *frame, int length, TelemetrySink &sink) {
+    TelemetryReader reader(frame + kHeaderLength, length - kHeaderLength - 1);
+
+    // replies from older firmware can be shorter, nothing is applied from a short one
+    switch (frame[4]) {
+        case MSP_RAW_GPS: {
+            reader.skip(1); // fix
+            auto sats = reader.u8();
+            auto lat = reader.i32() / 10000000.0;
+            auto lon = reader.i32() / 10000000.0;
+            auto alt_msl = reader.u16(); // m
+            auto speed = reader.u16() * 0.036; // cm/s to km/h
+            if (!reader.ok()) {
+                break;
+            }
+            sink.set_satellites_visible(sats);
+            sink.set_lat(lat);
+            sink.set_lon(lon);
+            sink.set_alt_msl(alt_msl);
+            sink.set_speed(speed);
+            sink.update_home();
+            break;
+        }
+        case MSP_ATTITUDE: {
+            auto roll = reader.i16() / 10.0;
+            auto pitch = reader.i16() / 10.0;
+            auto heading = reader.i16();
+            if (!reader.ok()) {
+                break;
+            }
+            sink.set_roll(roll);
+            sink.set_pitch(pitch);
+            sink.set_hdg(heading);
+            break;
+        }
+        case MSP_ALTITUDE: {
+            auto alt_rel = reader.i32() / 100.0; // cm
+            if (!reader.ok()) {
+                break;
+            }
+            sink.set_alt_rel(alt_rel);
+            break;
+        }
+        case MSP_ANALOG: {
+            auto battery_voltage = reader.u8() / 10.0;
+            auto mah = reader.u16();
+            auto rssi = reader.u16() * 100 / 1023;
+            if (!reader.ok()) {
+                break;
+            }
+            sink.set_battery_voltage(battery_voltage);
+            sink.set_flight_mah(mah);
+            sink.set_rc_rssi(rssi);
+            if (reader.remaining() >= 2) {
+                sink.set_battery_current(reader.i16() / 100.0);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#include "telemetryreactor.h"
+
+#include <QtNetwork>
+
+#include "telemetryprotocols.h"
+#include "trace.h"
+
+
+static TelemetryReactor* _instance = nullptr;
+
+TelemetryReactor* TelemetryReactor::instance() {
+    if (_instance == nullptr) {
+        _instance = new TelemetryReactor();
+    }
+    return _instance;
+}
+
+
+TelemetryReactor::TelemetryReactor(QObject *parent): QObject(parent) {
+    qDebug() << "TelemetryReactor::TelemetryReactor()";
+
+    addDecoder(5002, new FrSkyDecoder());
+    addDecoder(5010, new SmartPortDecoder());
+    addDecoder(5001, new LTMDecoder());
+    // port defined in global_functions.sh on ground
+    addDecoder(5011, new VectorDecoder());
+    // MSP shares 14550 with MAVLink and stays off until it gets a port of its own
+    //addDecoder(14550, new MSPDecoder());
+}
+
+
+void TelemetryReactor::addDecoder(quint16 port, TelemetryDecoder *decoder) {
+    for (auto &endpoint : m_endpoints) {
+        if (endpoint->port == port) {
+            endpoint->decoders.emplace_back(decoder);
+            return;
+        }
+    }
+
+    auto endpoint = new Endpoint { port, new QUdpSocket(this), {} };
+    endpoint->decoders.emplace_back(decoder);
+    m_endpoints.emplace_back(endpoint);
+
+    if (!endpoint->socket->bind(QHostAddress::Any, port)) {
+        qDebug() << "TelemetryReactor: could not bind port" << port << "for" << decoder->name();
+    }
+    connect(endpoint->socket, &QUdpSocket::readyRead, this, [this, endpoint] {
+        processDatagrams(*endpoint);
+    });
+}
+
+
+void TelemetryReactor::processDatagrams(Endpoint &endpoint) {
+    TRACE_SCOPE("telemetry.decode");
+
+    while (endpoint.socket->hasPendingDatagrams()) {
+        // anything past the buffer is cut off, no telemetry datagram comes close
+        auto length = endpoint.socket->readDatagram(reinterpret_cast<char*>(m_buffer), kMaxDatagram);
+        if (length < 0) {
+            break;
+        }
+        TRACE_COUNTER("telemetry.bytes", length);
+
+        for (auto &decoder : endpoint.decoders) {
+            decoder->parse(m_buffer, static_cast<int>(length), m_sink);
+        }
+    }
+
+    if (Trace::enabled()) {
+        uint64_t frames = 0;
+        uint64_t errors = 0;
+        for (auto &e : m_endpoints) {
+            for (auto &decoder : e->decoders) {
+                frames += decoder->frames();
+                errors += decoder->errors();
+            }
+        }
+        TRACE_COUNTER("telemetry.frames", static_cast<int64_t>(frames));
+        TRACE_COUNTER("telemetry.errors", static_cast<int64_t>(errors));
+    }
+}
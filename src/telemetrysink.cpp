@@ -0,0 +1,138 @@
+#include "telemetrysink.h"
+
+#include "openhd.h"
+
+#include <cmath>
+
+// the setting is re-read at most this often (ms) rather than once per frame
+constexpr qint64 kSettingsInterval = 1000;
+
+
+TelemetrySink::TelemetrySink() {}
+
+
+int TelemetrySink::battery_cells() {
+    if (!m_battery_cells_age.isValid() || m_battery_cells_age.elapsed() > kSettingsInterval) {
+        QSettings settings;
+        m_battery_cells = settings.value("battery_cells", QVariant(3)).toInt();
+        m_battery_cells_age.start();
+    }
+    return m_battery_cells;
+}
+
+
+void TelemetrySink::set_battery_voltage(double voltage) {
+    auto openhd = OpenHD::instance();
+    openhd->set_battery_voltage(voltage);
+
+    int battery_percent = m_util.lipo_battery_voltage_to_percent(battery_cells(), voltage);
+    openhd->set_battery_percent(battery_percent);
+    openhd->set_battery_gauge(m_util.battery_gauge_glyph_from_percentage(battery_percent));
+}
+
+
+void TelemetrySink::set_battery_current(double ampere) {
+    OpenHD::instance()->set_battery_current(ampere);
+}
+
+
+void TelemetrySink::set_flight_mah(double mah) {
+    OpenHD::instance()->set_flight_mah(mah);
+}
+
+
+void TelemetrySink::set_lat(double lat) {
+    OpenHD::instance()->set_lat(lat);
+}
+
+
+void TelemetrySink::set_lon(double lon) {
+    OpenHD::instance()->set_lon(lon);
+}
+
+
+void TelemetrySink::set_alt_rel(double alt_rel) {
+    OpenHD::instance()->set_alt_rel(alt_rel);
+}
+
+
+void TelemetrySink::set_alt_msl(double alt_msl) {
+    OpenHD::instance()->set_alt_msl(alt_msl);
+}
+
+
+void TelemetrySink::set_satellites_visible(int satellites) {
+    OpenHD::instance()->set_satellites_visible(satellites);
+}
+
+
+void TelemetrySink::set_gps_hdop(double hdop) {
+    OpenHD::instance()->set_gps_hdop(hdop);
+}
+
+
+void TelemetrySink::set_speed(double speed) {
+    OpenHD::instance()->set_speed(speed);
+}
+
+
+void TelemetrySink::set_airspeed(double airspeed) {
+    OpenHD::instance()->set_airspeed(airspeed);
+}
+
+
+void TelemetrySink::set_hdg(double hdg) {
+    // -180..180 from some protocols, the widgets want 0..359
+    auto heading = static_cast<int>(std::lround(hdg)) % 360;
+    if (heading < 0) {
+        heading += 360;
+    }
+    OpenHD::instance()->set_hdg(heading);
+}
+
+
+void TelemetrySink::set_pitch(double pitch) {
+    OpenHD::instance()->set_pitch(pitch);
+}
+
+
+void TelemetrySink::set_roll(double roll) {
+    OpenHD::instance()->set_roll(roll);
+}
+
+
+void TelemetrySink::set_vx(double vx) {
+    OpenHD::instance()->set_vx(vx);
+}
+
+
+void TelemetrySink::set_vy(double vy) {
+    OpenHD::instance()->set_vy(vy);
+}
+
+
+void TelemetrySink::set_vz(double vz) {
+    OpenHD::instance()->set_vz(vz);
+}
+
+
+void TelemetrySink::set_rc_rssi(int rssi) {
+    OpenHD::instance()->setRcRssi(rssi);
+}
+
+
+void TelemetrySink::set_armed(bool armed) {
+    OpenHD::instance()->set_armed(armed);
+}
+
+
+void TelemetrySink::set_flight_mode(const QString &flight_mode) {
+    OpenHD::instance()->set_flight_mode(flight_mode);
+}
+
+
+void TelemetrySink::update_home() {
+    auto openhd = OpenHD::instance();
+    openhd->calculate_home_distance();
+    openhd->calculate_home_course();
+}
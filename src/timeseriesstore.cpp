@@ -0,0 +1,311 @@
+#include "timeseriesstore.h"
+
+#include <cmath>
+
+#if defined(ENABLE_CHARTS)
+#include <QtCharts/QXYSeries>
+#endif
+
+#include "openhd.h"
+#include "trace.h"
+
+// 5 samples a second, 4096 of them keep a bit over 13 minutes
+constexpr int kSampleInterval = 200;
+constexpr int kCapacity = 4096;
+constexpr int kSamplesPerUpdate = 1000 / kSampleInterval;
+
+constexpr int kMinSpan = 10;
+constexpr int kMaxSpan = kCapacity * kSampleInterval / 1000;
+
+
+namespace {
+
+enum class MetricKind {
+    Value,
+    // lifetime counter, stored as a rate per second
+    Counter,
+    // magnitude of vibration_x/y/z
+    Vibration
+};
+
+struct Metric {
+    const char *name;
+    MetricKind kind;
+    // values are multiplied by this, kbitrate is shown in Mbit/s
+    double scale;
+};
+
+const Metric kMetrics[] = {
+    { "alt_rel", MetricKind::Value, 1.0 },
+    { "speed", MetricKind::Value, 1.0 },
+    { "battery_voltage", MetricKind::Value, 1.0 },
+    { "downlink_rssi", MetricKind::Value, 1.0 },
+    { "current_signal_joystick_uplink", MetricKind::Value, 1.0 },
+    { "kbitrate", MetricKind::Value, 1.0 / 1024.0 },
+    { "vibration", MetricKind::Vibration, 1.0 },
+    { "cpuload_air", MetricKind::Value, 1.0 },
+    { "cpuload_gnd", MetricKind::Value, 1.0 },
+    { "temp_air", MetricKind::Value, 1.0 },
+    { "temp_gnd", MetricKind::Value, 1.0 },
+    { "lost_packet_cnt", MetricKind::Counter, 1.0 },
+    { "damaged_block_cnt", MetricKind::Counter, 1.0 },
+    { "injection_fail_cnt", MetricKind::Counter, 1.0 },
+    { "skipped_packet_cnt", MetricKind::Counter, 1.0 }
+};
+
+constexpr int kMetricCount = sizeof(kMetrics) / sizeof(kMetrics[0]);
+
+}
+
+
+static TimeSeriesStore* _instance = nullptr;
+
+TimeSeriesStore* TimeSeriesStore::instance() {
+    if (_instance == nullptr) {
+        _instance = new TimeSeriesStore();
+    }
+    return _instance;
+}
+
+
+TimeSeriesStore::TimeSeriesStore(QObject *parent): QObject(parent), m_capacity(kCapacity) {
+    qDebug() << "TimeSeriesStore::TimeSeriesStore()";
+
+    m_times.resize(m_capacity);
+    m_values.resize(static_cast<size_t>(kMetricCount) * m_capacity);
+    m_counters.resize(kMetricCount);
+
+    /*
+     * Property indexes are looked up once, a sample is then just a read through the
+     * meta object for every metric.
+     */
+    auto meta = OpenHD::instance()->metaObject();
+    for (auto &metric : kMetrics) {
+        if (metric.kind == MetricKind::Vibration) {
+            m_properties.push_back(meta->indexOfProperty("vibration_x"));
+            m_properties.push_back(meta->indexOfProperty("vibration_y"));
+            m_properties.push_back(meta->indexOfProperty("vibration_z"));
+        } else {
+            m_properties.push_back(meta->indexOfProperty(metric.name));
+        }
+    }
+
+    m_clock.start();
+
+    connect(&m_sampleTimer, &QTimer::timeout, this, &TimeSeriesStore::sample);
+    m_sampleTimer.start(kSampleInterval);
+}
+
+
+void TimeSeriesStore::setSpan(int span) {
+    span = qBound(kMinSpan, span, kMaxSpan);
+    if (span == m_span) {
+        return;
+    }
+    m_span = span;
+    emit spanChanged(m_span);
+}
+
+
+QStringList TimeSeriesStore::metrics() const {
+    QStringList names;
+    for (auto &metric : kMetrics) {
+        names.append(metric.name);
+    }
+    return names;
+}
+
+
+int TimeSeriesStore::metricIndex(const QString &metric) const {
+    for (int i = 0; i < kMetricCount; i++) {
+        if (metric == QLatin1String(kMetrics[i].name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+void TimeSeriesStore::sample() {
+    TRACE_SCOPE("charts.sample");
+
+    auto openhd = OpenHD::instance();
+    auto meta = openhd->metaObject();
+    auto now = m_clock.elapsed();
+    auto seconds = m_last_sample >= 0 ? (now - m_last_sample) / 1000.0 : 0.0;
+
+    auto read = [&](int property) {
+        return property >= 0 ? meta->property(property).read(openhd).toDouble() : 0.0;
+    };
+
+    auto head = m_head;
+    auto property = m_properties.begin();
+    for (int i = 0; i < kMetricCount; i++) {
+        auto &metric = kMetrics[i];
+        double value = 0.0;
+
+        switch (metric.kind) {
+            case MetricKind::Value: {
+                value = read(*property++);
+                break;
+            }
+            case MetricKind::Counter: {
+                auto counter = read(*property++);
+                // counters restart with the ground side, a smaller value means a new run
+                auto delta = counter >= m_counters[i] ? counter - m_counters[i] : counter;
+                value = seconds > 0.0 ? delta / seconds : 0.0;
+                m_counters[i] = counter;
+                break;
+            }
+            case MetricKind::Vibration: {
+                auto x = read(*property++);
+                auto y = read(*property++);
+                auto z = read(*property++);
+                value = std::sqrt(x * x + y * y + z * z);
+                break;
+            }
+        }
+
+        m_values[static_cast<size_t>(i) * m_capacity + head] = static_cast<float>(value * metric.scale);
+    }
+
+    m_times[head] = now;
+    m_head = (m_head + 1) % m_capacity;
+    m_count = qMin(m_count + 1, m_capacity);
+    m_last_sample = now;
+
+    if (++m_ticks >= kSamplesPerUpdate) {
+        m_ticks = 0;
+        emit updated();
+    }
+}
+
+
+void TimeSeriesStore::range(int metric, double &min, double &max) const {
+    min = 0.0;
+    max = 0.0;
+    if (metric < 0 || m_count == 0) {
+        return;
+    }
+
+    auto start = m_clock.elapsed() - m_span * 1000;
+    auto values = &m_values[static_cast<size_t>(metric) * m_capacity];
+    auto first = true;
+    for (int i = m_count - 1; i >= 0; i--) {
+        auto s = slot(i);
+        if (m_times[s] < start) {
+            break;
+        }
+        double value = values[s];
+        if (first || value < min) {
+            min = value;
+        }
+        if (first || value > max) {
+            max = value;
+        }
+        first = false;
+    }
+}
+
+
+double TimeSeriesStore::minimum(const QString &metric) const {
+    double min, max;
+    range(metricIndex(metric), min, max);
+    return min;
+}
+
+
+double TimeSeriesStore::maximum(const QString &metric) const {
+    double min, max;
+    range(metricIndex(metric), min, max);
+    return max;
+}
+
+
+int TimeSeriesStore::decimate(int metric, int width, QVector<QPointF> &points) const {
+    points.clear();
+    if (metric < 0 || metric >= kMetricCount || m_count == 0 || width <= 0) {
+        return 0;
+    }
+
+    auto now = m_clock.elapsed();
+    auto span = m_span * 1000;
+    auto start = now - span;
+    auto values = &m_values[static_cast<size_t>(metric) * m_capacity];
+
+    // oldest sample inside the span
+    auto first = m_count;
+    while (first > 0 && m_times[slot(first - 1)] >= start) {
+        first--;
+    }
+    auto count = m_count - first;
+    if (count == 0) {
+        return 0;
+    }
+
+    points.reserve(qMin(count, width * 2));
+
+    // few enough samples, nothing to drop
+    if (count <= width * 2) {
+        for (int i = first; i < m_count; i++) {
+            auto s = slot(i);
+            points.append(QPointF((m_times[s] - now) / 1000.0, values[s]));
+        }
+        return points.size();
+    }
+
+    /*
+     * One bucket per pixel column. Each keeps its lowest and highest sample in the
+     * order they happened, so the line still goes through every spike.
+     */
+    auto i = first;
+    for (int column = 0; column < width && i < m_count; column++) {
+        auto column_end = start + static_cast<qint64>(span) * (column + 1) / width;
+
+        auto min_slot = -1;
+        auto max_slot = -1;
+        for (; i < m_count; i++) {
+            auto s = slot(i);
+            if (m_times[s] >= column_end && column < width - 1) {
+                break;
+            }
+            if (min_slot < 0 || values[s] < values[min_slot]) {
+                min_slot = s;
+            }
+            if (max_slot < 0 || values[s] > values[max_slot]) {
+                max_slot = s;
+            }
+        }
+
+        if (min_slot < 0) {
+            continue;
+        }
+
+        auto a = min_slot;
+        auto b = max_slot;
+        if (m_times[b] < m_times[a]) {
+            std::swap(a, b);
+        }
+        points.append(QPointF((m_times[a] - now) / 1000.0, values[a]));
+        if (b != a) {
+            points.append(QPointF((m_times[b] - now) / 1000.0, values[b]));
+        }
+    }
+    return points.size();
+}
+
+
+#if defined(ENABLE_CHARTS)
+void TimeSeriesStore::updateSeries(QAbstractSeries *series, const QString &metric, int width) {
+    TRACE_SCOPE("charts.update");
+
+    auto xy = qobject_cast<QXYSeries*>(series);
+    if (xy == nullptr) {
+        return;
+    }
+
+    QVector<QPointF> points;
+    decimate(metricIndex(metric), width, points);
+    xy->replace(points);
+}
+#endif
@@ -0,0 +1,286 @@
+#include "trace.h"
+
+#include "localmessage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <QStandardPaths>
+
+// events kept per thread, the export covers roughly the last few seconds of a busy thread
+constexpr int kRingSize = 16384;
+
+std::atomic<bool> Trace::s_enabled { false };
+
+static std::atomic<TraceSite*> s_sites { nullptr };
+static std::atomic<int64_t> s_origin { 0 };
+
+
+struct TraceEvent {
+    const char *name;
+    int64_t start;
+    // duration for scopes, the value for counters
+    int64_t value;
+    bool counter;
+};
+
+
+/*
+ * Rings outlive their threads so a short-lived thread still shows up in the export, a
+ * ring whose thread has finished is handed to the next new thread.
+ */
+struct TraceRing {
+    TraceEvent events[kRingSize];
+    std::atomic<uint64_t> head { 0 };
+    std::atomic<bool> owned { false };
+    int tid = 0;
+    QString name;
+};
+
+static std::mutex s_ringsMutex;
+static std::vector<TraceRing*> s_rings;
+
+
+struct TraceRingHolder {
+    TraceRing *ring = nullptr;
+
+    ~TraceRingHolder() {
+        if (ring != nullptr) {
+            ring->owned = false;
+        }
+    }
+};
+
+static thread_local TraceRingHolder t_ring;
+
+
+static TraceRing *threadRing() {
+    if (t_ring.ring != nullptr) {
+        return t_ring.ring;
+    }
+
+    std::lock_guard<std::mutex> lock(s_ringsMutex);
+
+    TraceRing *ring = nullptr;
+    for (auto r : s_rings) {
+        auto expected = false;
+        if (r->owned.compare_exchange_strong(expected, true)) {
+            ring = r;
+            ring->head = 0;
+            break;
+        }
+    }
+    if (ring == nullptr) {
+        ring = new TraceRing();
+        ring->owned = true;
+        ring->tid = static_cast<int>(s_rings.size()) + 1;
+        s_rings.push_back(ring);
+    }
+
+    auto thread = QThread::currentThread();
+    ring->name = thread->objectName().isEmpty() ? QString("thread %1").arg(ring->tid) : thread->objectName();
+
+    t_ring.ring = ring;
+    return ring;
+}
+
+
+static void record(const char *name, int64_t start, int64_t value, bool counter) {
+    auto ring = threadRing();
+    auto head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head % kRingSize] = { name, start, value, counter };
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+
+TraceSite::TraceSite(const char *name): name(name) {
+    next = s_sites.load();
+    while (!s_sites.compare_exchange_weak(next, this)) {}
+}
+
+
+static Trace* _instance = nullptr;
+
+Trace* Trace::instance() {
+    if (_instance == nullptr) {
+        _instance = new Trace();
+    }
+    return _instance;
+}
+
+
+Trace::Trace(QObject *parent): QObject(parent) {
+    qDebug() << "Trace::Trace()";
+
+    m_summaryTimer.setInterval(1000);
+    connect(&m_summaryTimer, &QTimer::timeout, this, &Trace::updateSummary);
+
+    QSettings settings;
+    setEnabled(settings.value("enable_trace", false).toBool());
+}
+
+
+int64_t Trace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+void Trace::complete(TraceSite &site, int64_t start, int64_t end) {
+    auto duration = end - start;
+
+    site.calls.fetch_add(1, std::memory_order_relaxed);
+    site.total.fetch_add(duration, std::memory_order_relaxed);
+    auto max = site.max.load(std::memory_order_relaxed);
+    while (duration > max && !site.max.compare_exchange_weak(max, duration, std::memory_order_relaxed)) {}
+
+    record(site.name, start, duration, false);
+}
+
+
+void Trace::counter(TraceSite &site, int64_t value) {
+    site.counter = true;
+    site.calls.fetch_add(1, std::memory_order_relaxed);
+    site.value.store(value, std::memory_order_relaxed);
+
+    record(site.name, now(), value, true);
+}
+
+
+void Trace::setEnabled(bool enabled) {
+    if (enabled == s_enabled) {
+        return;
+    }
+
+    if (enabled) {
+        s_origin = now();
+        for (auto site = s_sites.load(); site != nullptr; site = site->next) {
+            site->calls = 0;
+            site->total = 0;
+            site->max = 0;
+        }
+        m_summaryClock.start();
+        m_summaryTimer.start();
+    } else {
+        m_summaryTimer.stop();
+        m_summary.clear();
+        emit summaryChanged();
+    }
+
+    s_enabled = enabled;
+    emit enabledChanged(enabled);
+}
+
+
+void Trace::updateSummary() {
+    auto elapsed = qMax<qint64>(m_summaryClock.restart(), 1);
+
+    QVariantList summary;
+    for (auto site = s_sites.load(); site != nullptr; site = site->next) {
+        auto calls = site->calls.exchange(0);
+        auto total = site->total.exchange(0);
+        auto max = site->max.exchange(0);
+
+        QVariantMap entry;
+        entry["name"] = QString(site->name);
+        entry["calls"] = calls * 1000.0 / elapsed;
+        if (site->counter) {
+            entry["value"] = static_cast<double>(site->value.load());
+        } else {
+            entry["avg"] = calls > 0 ? total / 1000.0 / calls : 0.0;
+            entry["max"] = max / 1000.0;
+            entry["load"] = total / 10000.0 / elapsed;
+        }
+        summary.append(entry);
+    }
+
+    std::sort(summary.begin(), summary.end(), [](const QVariant &a, const QVariant &b) {
+        return a.toMap()["load"].toDouble() > b.toMap()["load"].toDouble();
+    });
+
+    m_summary = summary;
+    emit summaryChanged();
+}
+
+
+/*
+ * Events a thread writes while this runs may be torn, that only ever affects the few
+ * oldest entries being overwritten at that moment.
+ */
+QString Trace::exportChromeTrace() {
+    auto dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    if (dir.isEmpty()) {
+        dir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    }
+    QDir().mkpath(dir);
+
+    auto timeStr = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    auto fileName = QString("%1/QOpenHD-trace-%2.json").arg(dir).arg(timeStr);
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Trace: could not open" << fileName;
+        LocalMessage::instance()->showMessage("Could not export trace", 4);
+        return QString();
+    }
+
+    auto origin = s_origin.load();
+
+    QByteArray out;
+    out.append("{\"traceEvents\":[\n");
+    auto first = true;
+
+    auto separator = [&] {
+        if (!first) {
+            out.append(",\n");
+        }
+        first = false;
+    };
+
+    std::vector<TraceRing*> rings;
+    QStringList names;
+    {
+        std::lock_guard<std::mutex> lock(s_ringsMutex);
+        rings = s_rings;
+        for (auto ring : rings) {
+            names.append(ring->name);
+        }
+    }
+
+    for (size_t r = 0; r < rings.size(); r++) {
+        auto ring = rings[r];
+
+        separator();
+        out.append(QString("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%1,\"args\":{\"name\":\"%2\"}}")
+                   .arg(ring->tid).arg(names[static_cast<int>(r)]).toUtf8());
+
+        auto head = ring->head.load(std::memory_order_acquire);
+        auto count = std::min<uint64_t>(head, kRingSize);
+
+        for (auto i = head - count; i < head; i++) {
+            auto event = ring->events[i % kRingSize];
+            if (event.name == nullptr || event.start < origin) {
+                continue;
+            }
+
+            separator();
+            auto ts = QString::number((event.start - origin) / 1000.0, 'f', 3);
+            if (event.counter) {
+                out.append(QString("{\"ph\":\"C\",\"name\":\"%1\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"args\":{\"value\":%4}}")
+                           .arg(event.name).arg(ring->tid).arg(ts).arg(event.value).toUtf8());
+            } else {
+                out.append(QString("{\"ph\":\"X\",\"name\":\"%1\",\"pid\":1,\"tid\":%2,\"ts\":%3,\"dur\":%4}")
+                           .arg(event.name).arg(ring->tid).arg(ts).arg(QString::number(event.value / 1000.0, 'f', 3)).toUtf8());
+            }
+        }
+    }
+
+    out.append("\n]}\n");
+    file.write(out);
+    file.close();
+
+    qDebug() << "Trace: exported to" << fileName;
+    LocalMessage::instance()->showMessage("Trace saved to " + fileName, 6);
+    return fileName;
+}
@@ -0,0 +1,114 @@
+#include "videohealth.h"
+
+
+/*
+ * A stall is this many missed frame intervals. Clamped so a very high frame rate doesn't
+ * flag every hiccup in the scheduler, and a stream we haven't measured yet still gets
+ * flagged eventually.
+ */
+constexpr int kStallFrames = 3;
+constexpr qint64 kMinStallThreshold = 100;
+constexpr qint64 kMaxStallThreshold = 1000;
+
+// only used for the numbers shown to the user, stall detection doesn't wait for it
+constexpr int kStatsInterval = 1000;
+
+
+VideoHealth::VideoHealth(QObject *parent): QObject(parent) {
+    m_clock.start();
+
+    m_stallTimer = new QTimer(this);
+    m_stallTimer->setSingleShot(true);
+    m_stallTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_stallTimer, &QTimer::timeout, this, &VideoHealth::onStallTimer);
+
+    m_statsTimer = new QTimer(this);
+    connect(m_statsTimer, &QTimer::timeout, this, &VideoHealth::onStatsTimer);
+    m_statsTimer->start(kStatsInterval);
+}
+
+
+void VideoHealth::frameDecoded() {
+    auto now = m_clock.elapsed();
+    auto last = m_lastFrame.exchange(now);
+
+    m_windowFrames++;
+
+    if (last != 0) {
+        int gap = static_cast<int>(now - last);
+        int max = m_windowMaxGap;
+        while (gap > max && !m_windowMaxGap.compare_exchange_weak(max, gap)) {}
+    }
+
+    // only the first frame after a stall has to reach the GUI thread
+    if (!m_running.exchange(true)) {
+        QMetaObject::invokeMethod(this, "onResumed", Qt::QueuedConnection);
+    }
+}
+
+
+void VideoHealth::dataReceived(int bytes) {
+    m_windowBytes += bytes;
+}
+
+
+void VideoHealth::decodeError() {
+    m_decodeErrors++;
+}
+
+
+void VideoHealth::packetsLost(int count) {
+    m_lostPackets += count;
+}
+
+
+qint64 VideoHealth::stallThreshold() const {
+    if (m_fps <= 0.0) {
+        return kMaxStallThreshold;
+    }
+    auto threshold = static_cast<qint64>(kStallFrames * 1000.0 / m_fps);
+    return qBound(kMinStallThreshold, threshold, kMaxStallThreshold);
+}
+
+
+void VideoHealth::onResumed() {
+    emit runningChanged(true);
+    m_stallTimer->start(static_cast<int>(stallThreshold()));
+}
+
+
+/*
+ * Fires at the point the stream would be stalled if nothing arrived since the timer was
+ * armed. Usually something did, in which case we just move the deadline.
+ */
+void VideoHealth::onStallTimer() {
+    auto remaining = m_lastFrame + stallThreshold() - m_clock.elapsed();
+
+    if (remaining > 0) {
+        m_stallTimer->start(static_cast<int>(remaining));
+        return;
+    }
+
+    if (m_running.exchange(false)) {
+        qDebug() << "Video stalled," << m_clock.elapsed() - m_lastFrame << "ms since last frame";
+        m_stalls++;
+        emit runningChanged(false);
+    }
+}
+
+
+void VideoHealth::onStatsTimer() {
+    auto now = m_clock.elapsed();
+    auto elapsed = now - m_windowStart;
+    m_windowStart = now;
+
+    if (elapsed <= 0) {
+        return;
+    }
+
+    m_fps = m_windowFrames.exchange(0) * 1000.0 / elapsed;
+    m_bitrate = static_cast<int>(m_windowBytes.exchange(0) * 8 / elapsed);
+    m_maxFrameGap = m_windowMaxGap.exchange(0);
+
+    emit statsChanged();
+}
@@ -0,0 +1,629 @@
+#include "videorecorder.h"
+
+#include "localmessage.h"
+
+#include <QStandardPaths>
+
+/*
+ * How much data may be waiting for the writer before we start dropping, a few seconds
+ * of video at the bitrates we normally see on the link.
+ */
+constexpr int kMaxQueuedBytes = 16 * 1024 * 1024;
+
+/*
+ * SimpleBlock timecodes are a signed 16 bit offset from the cluster timecode, start a
+ * new cluster well before that runs out even if the GOP is very long.
+ */
+constexpr qint64 kMaxClusterDuration = 30000;
+
+
+/*
+ * Minimal EBML writing helpers, just enough for a live Matroska stream.
+ */
+static void writeId(QByteArray &out, uint32_t id) {
+    if (id > 0xFFFFFF) {
+        out.append(static_cast<char>(id >> 24));
+    }
+    if (id > 0xFFFF) {
+        out.append(static_cast<char>(id >> 16));
+    }
+    if (id > 0xFF) {
+        out.append(static_cast<char>(id >> 8));
+    }
+    out.append(static_cast<char>(id));
+}
+
+static void writeSize(QByteArray &out, uint64_t size) {
+    int len = 1;
+    // all ones is reserved for "unknown size"
+    while (len < 8 && size >= (1ULL << (7 * len)) - 1) {
+        len++;
+    }
+    uint64_t value = size | (1ULL << (7 * len));
+    for (int i = len - 1; i >= 0; i--) {
+        out.append(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+static void writeUnknownSize(QByteArray &out) {
+    out.append("\x01\xFF\xFF\xFF\xFF\xFF\xFF\xFF", 8);
+}
+
+static void writeUInt(QByteArray &out, uint32_t id, uint64_t value) {
+    int len = 1;
+    while (len < 8 && (value >> (8 * len)) != 0) {
+        len++;
+    }
+    writeId(out, id);
+    writeSize(out, len);
+    for (int i = len - 1; i >= 0; i--) {
+        out.append(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+static void writeBinary(QByteArray &out, uint32_t id, const QByteArray &data) {
+    writeId(out, id);
+    writeSize(out, data.size());
+    out.append(data);
+}
+
+
+/*
+ * Bit reader for the SPS, returns zeroes once it runs past the end so a truncated
+ * or garbage SPS can't read out of bounds.
+ */
+struct SPSReader {
+    const QByteArray &data;
+    int bit = 0;
+    bool overflow = false;
+
+    uint32_t readBit() {
+        if (bit >= data.size() * 8) {
+            overflow = true;
+            return 0;
+        }
+        uint32_t value = (static_cast<uint8_t>(data[bit / 8]) >> (7 - (bit % 8))) & 1;
+        bit++;
+        return value;
+    }
+
+    uint32_t readBits(int count) {
+        uint32_t value = 0;
+        for (int i = 0; i < count; i++) {
+            value = (value << 1) | readBit();
+        }
+        return value;
+    }
+
+    uint32_t readUE() {
+        int zeros = 0;
+        while (readBit() == 0 && !overflow && zeros < 32) {
+            zeros++;
+        }
+        if (zeros >= 32) {
+            overflow = true;
+            return 0;
+        }
+        return (1u << zeros) - 1 + readBits(zeros);
+    }
+
+    int32_t readSE() {
+        uint32_t value = readUE();
+        if (value & 1) {
+            return static_cast<int32_t>((value + 1) / 2);
+        }
+        return -static_cast<int32_t>(value / 2);
+    }
+};
+
+
+VideoRecorder::VideoRecorder(const QString &name, QObject *parent): QObject(parent), m_name(name) {
+    qDebug() << "VideoRecorder::VideoRecorder()";
+    m_clock.start();
+}
+
+
+VideoRecorder::~VideoRecorder() {
+    stop();
+
+    // whatever was pushed after the last stop still holds its buffer
+    while (!m_queue.empty()) {
+        release(m_queue.front());
+        m_queue.pop_front();
+    }
+}
+
+
+void VideoRecorder::start() {
+    if (m_recording) {
+        return;
+    }
+
+    auto dir = QStandardPaths::writableLocation(QStandardPaths::MoviesLocation);
+    if (dir.isEmpty()) {
+        dir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    }
+    QDir().mkpath(dir);
+
+    auto timeStr = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss");
+    m_fileName = QString("%1/QOpenHD-%2-%3.mkv").arg(dir).arg(m_name).arg(timeStr);
+
+    m_file.setFileName(m_fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "VideoRecorder: could not open" << m_fileName;
+        LocalMessage::instance()->showMessage("Could not start video recording", 4);
+        return;
+    }
+
+    m_sps.clear();
+    m_pps.clear();
+    m_accessUnit.clear();
+    m_accessUnitHasSlice = false;
+    m_accessUnitIsKey = false;
+    m_headerWritten = false;
+    m_waitingForIDR = true;
+    m_timeOrigin = -1;
+    m_clusterTime = -1;
+
+    m_session++;
+    m_overflow = false;
+
+    m_thread = QThread::create([this] { writeLoop(); });
+    m_thread->setObjectName(QString("%1VideoRecorder").arg(m_name));
+    m_thread->start(QThread::LowPriority);
+
+    m_recording = true;
+
+    qDebug() << "VideoRecorder: recording to" << m_fileName;
+    emit fileNameChanged(m_fileName);
+    emit recordingChanged(true);
+}
+
+
+void VideoRecorder::stop() {
+    if (!m_recording) {
+        return;
+    }
+    m_recording = false;
+
+    Chunk chunk;
+    chunk.stop = true;
+    m_queue.push_back(std::move(chunk));
+
+    m_thread->wait();
+    delete m_thread;
+    m_thread = nullptr;
+
+    m_file.close();
+
+    qDebug() << "VideoRecorder: stopped" << m_fileName;
+    emit recordingChanged(false);
+}
+
+
+void VideoRecorder::pushData(const QByteArray &annexB) {
+    if (!m_recording) {
+        return;
+    }
+
+    Chunk chunk;
+    chunk.data = annexB;
+    chunk.size = annexB.size();
+    enqueue(std::move(chunk));
+}
+
+
+#if defined(ENABLE_GSTREAMER)
+void VideoRecorder::pushBuffer(GstBuffer *buffer) {
+    if (!m_recording) {
+        return;
+    }
+
+    Chunk chunk;
+    chunk.buffer = buffer;
+    chunk.size = static_cast<int>(gst_buffer_get_size(buffer));
+    enqueue(std::move(chunk));
+}
+#endif
+
+
+void VideoRecorder::enqueue(Chunk &&chunk) {
+    if (m_queuedBytes + chunk.size > kMaxQueuedBytes) {
+        if (!m_overflow.exchange(true)) {
+            qDebug() << "VideoRecorder: writer is falling behind, dropping until the next IDR";
+        }
+        return;
+    }
+
+#if defined(ENABLE_GSTREAMER)
+    if (chunk.buffer != nullptr) {
+        gst_buffer_ref(chunk.buffer);
+    }
+#endif
+    chunk.timestamp = m_clock.elapsed();
+    chunk.session = m_session;
+    chunk.discontinuity = m_overflow.exchange(false);
+
+    m_queuedBytes += chunk.size;
+    m_queue.push_back(std::move(chunk));
+}
+
+
+void VideoRecorder::release(Chunk &chunk) {
+#if defined(ENABLE_GSTREAMER)
+    if (chunk.buffer != nullptr) {
+        gst_buffer_unref(chunk.buffer);
+        chunk.buffer = nullptr;
+    }
+#else
+    Q_UNUSED(chunk)
+#endif
+}
+
+
+void VideoRecorder::writeLoop() {
+    for (;;) {
+        Chunk chunk = m_queue.front();
+        m_queue.pop_front();
+
+        if (chunk.stop) {
+            break;
+        }
+
+        m_queuedBytes -= chunk.size;
+
+        // left over from a previous recording
+        if (chunk.session != m_session) {
+            release(chunk);
+            continue;
+        }
+
+        if (chunk.discontinuity) {
+            m_accessUnit.clear();
+            m_accessUnitHasSlice = false;
+            m_accessUnitIsKey = false;
+            m_waitingForIDR = true;
+        }
+
+#if defined(ENABLE_GSTREAMER)
+        if (chunk.buffer != nullptr) {
+            GstMapInfo map;
+            if (gst_buffer_map(chunk.buffer, &map, GST_MAP_READ)) {
+                processData(map.data, static_cast<int>(map.size), chunk.timestamp);
+                gst_buffer_unmap(chunk.buffer, &map);
+            }
+            release(chunk);
+            continue;
+        }
+#endif
+        processData(reinterpret_cast<const uint8_t*>(chunk.data.constData()), chunk.data.size(), chunk.timestamp);
+    }
+
+    writeAccessUnit();
+    m_file.flush();
+}
+
+
+/*
+ * Split on 3 or 4 byte start codes, the zero before a 4 byte start code is
+ * trimmed off the end of the previous NAL.
+ */
+void VideoRecorder::processData(const uint8_t *p, int size, qint64 timestamp) {
+    int nalStart = -1;
+    int i = 0;
+    while (i + 2 < size) {
+        if (p[i] == 0 && p[i + 1] == 0 && p[i + 2] == 1) {
+            if (nalStart >= 0) {
+                int end = i;
+                while (end > nalStart && p[end - 1] == 0) {
+                    end--;
+                }
+                processNAL(p + nalStart, end - nalStart, timestamp);
+            }
+            i += 3;
+            nalStart = i;
+        } else {
+            i++;
+        }
+    }
+    if (nalStart >= 0 && nalStart < size) {
+        processNAL(p + nalStart, size - nalStart, timestamp);
+    }
+}
+
+
+/*
+ * Groups NALs into access units. A new one starts at an AUD, SEI, SPS or PPS, or at
+ * a slice with first_mb_in_slice == 0, which is a single 1 bit after the NAL header.
+ */
+void VideoRecorder::processNAL(const uint8_t *nal, int size, qint64 timestamp) {
+    if (size < 1) {
+        return;
+    }
+
+    int type = nal[0] & 0x1f;
+
+    switch (type) {
+        case 7: {
+            writeAccessUnit();
+            m_sps = QByteArray(reinterpret_cast<const char*>(nal), size);
+            return;
+        }
+        case 8: {
+            writeAccessUnit();
+            m_pps = QByteArray(reinterpret_cast<const char*>(nal), size);
+            return;
+        }
+        case 9: {
+            writeAccessUnit();
+            return;
+        }
+        case 6: {
+            writeAccessUnit();
+            break;
+        }
+        case 1:
+        case 5: {
+            if (m_accessUnitHasSlice && size > 1 && (nal[1] & 0x80)) {
+                writeAccessUnit();
+            }
+            m_accessUnitHasSlice = true;
+            if (type == 5) {
+                m_accessUnitIsKey = true;
+            }
+            break;
+        }
+        default: {
+            return;
+        }
+    }
+
+    if (m_accessUnit.isEmpty()) {
+        m_accessUnitTime = timestamp;
+    }
+
+    // Matroska wants length prefixed NALs rather than start codes
+    m_accessUnit.append(static_cast<char>(size >> 24));
+    m_accessUnit.append(static_cast<char>(size >> 16));
+    m_accessUnit.append(static_cast<char>(size >> 8));
+    m_accessUnit.append(static_cast<char>(size));
+    m_accessUnit.append(reinterpret_cast<const char*>(nal), size);
+}
+
+
+void VideoRecorder::writeAccessUnit() {
+    if (!m_accessUnitHasSlice) {
+        m_accessUnit.clear();
+        return;
+    }
+
+    bool write = true;
+    if (m_waitingForIDR) {
+        if (!m_accessUnitIsKey || m_sps.isEmpty() || m_pps.isEmpty()) {
+            write = false;
+        } else {
+            m_waitingForIDR = false;
+        }
+    }
+
+    if (write) {
+        if (!m_headerWritten) {
+            writeHeader();
+        }
+
+        if (m_timeOrigin < 0) {
+            m_timeOrigin = m_accessUnitTime;
+        }
+        auto timestamp = m_accessUnitTime - m_timeOrigin;
+
+        if (m_clusterTime < 0 || m_accessUnitIsKey || timestamp - m_clusterTime > kMaxClusterDuration) {
+            startCluster(timestamp);
+        }
+        auto relative = static_cast<int16_t>(timestamp - m_clusterTime);
+
+        QByteArray block;
+        writeId(block, 0xA3);
+        writeSize(block, 4 + m_accessUnit.size());
+        block.append(static_cast<char>(0x81));
+        block.append(static_cast<char>(relative >> 8));
+        block.append(static_cast<char>(relative));
+        block.append(static_cast<char>(m_accessUnitIsKey ? 0x80 : 0x00));
+        block.append(m_accessUnit);
+        m_file.write(block);
+    }
+
+    m_accessUnit.clear();
+    m_accessUnitHasSlice = false;
+    m_accessUnitIsKey = false;
+}
+
+
+void VideoRecorder::writeHeader() {
+    int width = 0;
+    int height = 0;
+    if (!parseSPS(m_sps, width, height)) {
+        qDebug() << "VideoRecorder: could not parse SPS";
+    }
+
+    QByteArray out;
+
+    QByteArray ebml;
+    writeUInt(ebml, 0x4286, 1); // EBMLVersion
+    writeUInt(ebml, 0x42F7, 1); // EBMLReadVersion
+    writeUInt(ebml, 0x42F2, 4); // EBMLMaxIDLength
+    writeUInt(ebml, 0x42F3, 8); // EBMLMaxSizeLength
+    writeBinary(ebml, 0x4282, "matroska"); // DocType
+    writeUInt(ebml, 0x4287, 4); // DocTypeVersion
+    writeUInt(ebml, 0x4285, 2); // DocTypeReadVersion
+    writeBinary(out, 0x1A45DFA3, ebml);
+
+    // Segment, size unknown so it never has to be patched
+    writeId(out, 0x18538067);
+    writeUnknownSize(out);
+
+    QByteArray info;
+    writeUInt(info, 0x2AD7B1, 1000000); // TimecodeScale, 1ms
+    writeBinary(info, 0x4D80, "QOpenHD"); // MuxingApp
+    writeBinary(info, 0x5741, "QOpenHD"); // WritingApp
+    writeBinary(out, 0x1549A966, info);
+
+    // AVCDecoderConfigurationRecord
+    QByteArray avcC;
+    avcC.append(static_cast<char>(1));
+    avcC.append(m_sps.size() > 3 ? m_sps.mid(1, 3) : QByteArray(3, 0));
+    avcC.append(static_cast<char>(0xFF)); // 4 byte NAL lengths
+    avcC.append(static_cast<char>(0xE1)); // 1 SPS
+    avcC.append(static_cast<char>(m_sps.size() >> 8));
+    avcC.append(static_cast<char>(m_sps.size()));
+    avcC.append(m_sps);
+    avcC.append(static_cast<char>(1)); // 1 PPS
+    avcC.append(static_cast<char>(m_pps.size() >> 8));
+    avcC.append(static_cast<char>(m_pps.size()));
+    avcC.append(m_pps);
+
+    QByteArray video;
+    writeUInt(video, 0xB0, width); // PixelWidth
+    writeUInt(video, 0xBA, height); // PixelHeight
+
+    QByteArray track;
+    writeUInt(track, 0xD7, 1); // TrackNumber
+    writeUInt(track, 0x73C5, 1); // TrackUID
+    writeUInt(track, 0x83, 1); // TrackType, video
+    writeUInt(track, 0x9C, 0); // FlagLacing
+    writeBinary(track, 0x86, "V_MPEG4/ISO/AVC"); // CodecID
+    writeBinary(track, 0x63A2, avcC); // CodecPrivate
+    writeBinary(track, 0xE0, video);
+
+    QByteArray tracks;
+    writeBinary(tracks, 0xAE, track);
+    writeBinary(out, 0x1654AE6B, tracks);
+
+    m_file.write(out);
+    m_headerWritten = true;
+}
+
+
+/*
+ * Clusters are also written with an unknown size, players find the end of one by the
+ * start of the next. Flushing here means at most one cluster is lost in a crash.
+ */
+void VideoRecorder::startCluster(qint64 timestamp) {
+    m_file.flush();
+
+    QByteArray cluster;
+    writeId(cluster, 0x1F43B675);
+    writeUnknownSize(cluster);
+    writeUInt(cluster, 0xE7, timestamp); // Timecode
+    m_file.write(cluster);
+
+    m_clusterTime = timestamp;
+}
+
+
+/*
+ * Pulls the coded size out of the SPS, the muxer needs it for the track header and we
+ * don't want to depend on the decoder having reported it.
+ */
+bool VideoRecorder::parseSPS(const QByteArray &sps, int &width, int &height) {
+    // strip emulation prevention bytes and the NAL header
+    QByteArray rbsp;
+    int zeros = 0;
+    for (int i = 1; i < sps.size(); i++) {
+        auto b = static_cast<uint8_t>(sps[i]);
+        if (zeros >= 2 && b == 3) {
+            zeros = 0;
+            continue;
+        }
+        rbsp.append(static_cast<char>(b));
+        zeros = (b == 0) ? zeros + 1 : 0;
+    }
+
+    SPSReader r { rbsp };
+
+    auto profile_idc = r.readBits(8);
+    r.readBits(8); // constraint flags
+    r.readBits(8); // level_idc
+    r.readUE(); // seq_parameter_set_id
+
+    uint32_t chroma_format_idc = 1;
+    if (profile_idc == 100 || profile_idc == 110 || profile_idc == 122 || profile_idc == 244 ||
+        profile_idc == 44 || profile_idc == 83 || profile_idc == 86 || profile_idc == 118 ||
+        profile_idc == 128 || profile_idc == 138 || profile_idc == 139 || profile_idc == 134 ||
+        profile_idc == 135) {
+        chroma_format_idc = r.readUE();
+        if (chroma_format_idc == 3) {
+            r.readBit(); // separate_colour_plane_flag
+        }
+        r.readUE(); // bit_depth_luma_minus8
+        r.readUE(); // bit_depth_chroma_minus8
+        r.readBit(); // qpprime_y_zero_transform_bypass_flag
+        if (r.readBit()) {
+            // seq_scaling_matrix_present_flag, skip the lists
+            int lists = chroma_format_idc != 3 ? 8 : 12;
+            for (int i = 0; i < lists; i++) {
+                if (!r.readBit()) {
+                    continue;
+                }
+                int size = i < 6 ? 16 : 64;
+                int last = 8;
+                int next = 8;
+                for (int j = 0; j < size && !r.overflow; j++) {
+                    if (next != 0) {
+                        next = (last + r.readSE() + 256) % 256;
+                    }
+                    last = next == 0 ? last : next;
+                }
+            }
+        }
+    }
+
+    r.readUE(); // log2_max_frame_num_minus4
+    auto pic_order_cnt_type = r.readUE();
+    if (pic_order_cnt_type == 0) {
+        r.readUE(); // log2_max_pic_order_cnt_lsb_minus4
+    } else if (pic_order_cnt_type == 1) {
+        r.readBit(); // delta_pic_order_always_zero_flag
+        r.readSE(); // offset_for_non_ref_pic
+        r.readSE(); // offset_for_top_to_bottom_field
+        auto cycle = r.readUE();
+        for (uint32_t i = 0; i < cycle && !r.overflow; i++) {
+            r.readSE();
+        }
+    }
+
+    r.readUE(); // max_num_ref_frames
+    r.readBit(); // gaps_in_frame_num_value_allowed_flag
+
+    auto pic_width_in_mbs = r.readUE() + 1;
+    auto pic_height_in_map_units = r.readUE() + 1;
+    auto frame_mbs_only_flag = r.readBit();
+    if (!frame_mbs_only_flag) {
+        r.readBit(); // mb_adaptive_frame_field_flag
+    }
+    r.readBit(); // direct_8x8_inference_flag
+
+    int crop_left = 0;
+    int crop_right = 0;
+    int crop_top = 0;
+    int crop_bottom = 0;
+    if (r.readBit()) {
+        crop_left = r.readUE();
+        crop_right = r.readUE();
+        crop_top = r.readUE();
+        crop_bottom = r.readUE();
+    }
+
+    if (r.overflow) {
+        return false;
+    }
+
+    int sub_width_c = chroma_format_idc == 3 ? 1 : 2;
+    int sub_height_c = chroma_format_idc == 1 ? 2 : 1;
+    int crop_unit_x = chroma_format_idc == 0 ? 1 : sub_width_c;
+    int crop_unit_y = (chroma_format_idc == 0 ? 1 : sub_height_c) * (2 - frame_mbs_only_flag);
+
+    width = pic_width_in_mbs * 16 - (crop_left + crop_right) * crop_unit_x;
+    height = (2 - frame_mbs_only_flag) * pic_height_in_map_units * 16 - (crop_top + crop_bottom) * crop_unit_y;
+
+    return width > 0 && height > 0;
+}
@@ -0,0 +1,68 @@
+#include "wifibroadcaststatus.h"
+
+#include <cstring>
+
+#include "telemetrydecoder.h"
+
+
+constexpr uint32_t kMaxAdapters = 6;
+
+
+/*
+ * The ground side sends wifibroadcast_rx_status_forward_t as it is laid out in memory
+ * there, packed and little endian. It is read field by field so a short, long or
+ * corrupted datagram can't leave the struct half filled or be read past its end.
+ */
+bool decodeRxStatus(const uint8_t *data, int length, wifibroadcast_rx_status_forward_t &telemetry) {
+    static_assert(sizeof(wifibroadcast_rx_status_forward_t) == kRxStatusSize, "wifibroadcast_rx_status_forward_t layout changed");
+
+    if (length != kRxStatusSize) {
+        return false;
+    }
+
+    TelemetryReader reader(data, length);
+
+    auto readFloat = [&reader] {
+        auto bits = reader.u32();
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    };
+
+    telemetry.damaged_block_cnt = reader.u32();
+    telemetry.lost_packet_cnt = reader.u32();
+    telemetry.skipped_packet_cnt = reader.u32();
+    telemetry.injection_fail_cnt = reader.u32();
+    telemetry.received_packet_cnt = reader.u32();
+    telemetry.kbitrate = reader.u32();
+    telemetry.kbitrate_measured = reader.u32();
+    telemetry.kbitrate_set = reader.u32();
+    telemetry.lost_packet_cnt_telemetry_up = reader.u32();
+    telemetry.lost_packet_cnt_telemetry_down = reader.u32();
+    telemetry.lost_packet_cnt_msp_up = reader.u32();
+    telemetry.lost_packet_cnt_msp_down = reader.u32();
+    telemetry.lost_packet_cnt_rc = reader.u32();
+    telemetry.current_signal_joystick_uplink = reader.i8();
+    telemetry.current_signal_telemetry_uplink = reader.i8();
+    telemetry.joystick_connected = reader.i8();
+    telemetry.HomeLat = readFloat();
+    telemetry.HomeLon = readFloat();
+    telemetry.cpuload_gnd = reader.u8();
+    telemetry.temp_gnd = reader.u8();
+    telemetry.cpuload_air = reader.u8();
+    telemetry.temp_air = reader.u8();
+    telemetry.wifi_adapter_cnt = reader.u32();
+    for (auto &adapter : telemetry.adapter) {
+        adapter.received_packet_cnt = reader.u32();
+        adapter.current_signal_dbm = reader.i8();
+        adapter.type = reader.i8();
+        adapter.signal_good = reader.i8();
+    }
+
+    // the count indexes adapter[] below, never trust it
+    if (telemetry.wifi_adapter_cnt > kMaxAdapters) {
+        telemetry.wifi_adapter_cnt = kMaxAdapters;
+    }
+
+    return reader.ok();
+}
@@ -0,0 +1,25 @@
+# Headless checks for ADSBVehicleModel, nothing from QtQuick or the GUI is linked.
+#
+#   qmake && make && ./adsb_model
+#
+# Exits 1 when a check fails.
+
+BASEDIR = $$PWD/../..
+
+TEMPLATE = app
+TARGET = adsb_model
+
+QT = core positioning
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$BASEDIR/inc
+
+SOURCES += \
+    main.cpp \
+    $$BASEDIR/src/ADSBVehicle.cpp \
+    $$BASEDIR/src/ADSBVehicleModel.cpp
+
+HEADERS += \
+    $$BASEDIR/inc/ADSBVehicle.h \
+    $$BASEDIR/inc/ADSBVehicleModel.h
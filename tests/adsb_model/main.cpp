@@ -0,0 +1,102 @@
+#include <QCoreApplication>
+#include <QThread>
+
+#include <cstdio>
+
+#include "ADSBVehicleModel.h"
+
+/*
+ * Headless checks for ADSBVehicleModel: what it tells the views has to match what it
+ * holds, or the QML views of it break.
+ */
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    std::printf("%s: %s\n", ok ? "ok" : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+
+static ADSBVehicle::VehicleInfo_t contact(uint32_t icao, const char *callsign, double lat, double lon) {
+    ADSBVehicle::VehicleInfo_t info {};
+    info.icaoAddress = icao;
+    info.callsign = QString::fromLatin1(callsign);
+    info.location = QGeoCoordinate(lat, lon);
+    info.availableFlags = ADSBVehicle::CallsignAvailable | ADSBVehicle::LocationAvailable;
+    return info;
+}
+
+
+// rows the model announced through rowsInserted, against rowCount()
+static void appendRepeated() {
+    ADSBVehicleModel model;
+    int announced = 0;
+    QObject::connect(&model, &QAbstractItemModel::rowsInserted, [&](const QModelIndex &, int first, int last) {
+        announced += last - first + 1;
+    });
+
+    // the same new contact twice in one list, as two MAVLink messages in one batch are
+    ADSBVehicle::VehicleList vehicles;
+    vehicles.append(contact(0x400001, "FIRST", 47.0, 8.0));
+    vehicles.append(contact(0x400002, "OTHER", 47.1, 8.1));
+    vehicles.append(contact(0x400001, "SECOND", 47.2, 8.2));
+    model.append(vehicles);
+
+    check(announced == 2, "a contact listed twice is announced as one row");
+    check(model.rowCount() == announced, "rowCount() matches the rows announced");
+    check(model.callsign(0x400001) == "SECOND", "the last copy of a repeated contact wins");
+
+    // one known, one new listed twice
+    vehicles.clear();
+    vehicles.append(contact(0x400002, "OTHER", 47.1, 8.1));
+    vehicles.append(contact(0x400003, "THIRD", 47.3, 8.3));
+    vehicles.append(contact(0x400003, "THIRD", 47.4, 8.4));
+    model.append(vehicles);
+
+    check(announced == 3, "a known contact isn't announced again");
+    check(model.rowCount() == announced, "rowCount() still matches the rows announced");
+}
+
+
+// a contact glides along its heading until the report is too old, then goes back to it
+static void extrapolateCap() {
+    ADSBVehicleModel model;
+
+    // just under the 15s cap, 900 km/h north
+    auto info = contact(0x400001, "GLIDER", 47.0, 8.0);
+    info.velocity = 900.0;
+    info.heading = 0.0;
+    info.lastContact = 14;
+    info.availableFlags |= ADSBVehicle::VelocityAvailable | ADSBVehicle::HeadingAvailable | ADSBVehicle::LastContactAvailable;
+    ADSBVehicle::VehicleList vehicles;
+    vehicles.append(info);
+    model.append(vehicles);
+
+    auto shown = [&]() {
+        return model.data(model.index(0), ADSBVehicleModel::LatRole).toDouble();
+    };
+
+    model.extrapolate(QGeoRectangle());
+    check(shown() > 47.0, "a recent report is extrapolated along its heading");
+
+    QThread::msleep(1100);
+    model.extrapolate(QGeoRectangle());
+    check(shown() == 47.0, "past the cap the contact is shown where it was reported");
+}
+
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    appendRepeated();
+    extrapolateCap();
+
+    if (failures > 0) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtNetwork>
+
+#include <cstdio>
+
+#include "rcpacket.h"
+#include "rcreceiverstub.h"
+
+/*
+ * Headless checks for the OpenHD RC transport: RCPacket round trips and CRC, and the
+ * receiver stub going into failsafe when the sender stops and out of it again, also for
+ * a sender that restarted its sequence numbers.
+ */
+
+// out of the way of the real RC port, in case something is listening there
+constexpr quint16 kTestPort = RCPacket::kPort + 100;
+
+// the sender's rate, 50Hz like the default rc_rate
+constexpr int kPeriod = 20;
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+    std::printf("%s: %s\n", ok ? "ok" : "FAIL", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+
+static void roundTrip() {
+    uint8_t buffer[RCPacket::kMaxSize];
+
+    bool all = true;
+    for (int count = 1; count <= RCPacket::kMaxChannels; count++) {
+        RCPacket::Packet packet;
+        packet.count = static_cast<uint8_t>(count);
+        packet.sequence = static_cast<uint16_t>(65530 + count);
+        packet.time = 0xfedcba98u + count;
+        for (int c = 0; c < count; c++) {
+            // both ends of the 11 bits and something in between
+            packet.channels[c] = c == 0 ? 0 : c == 1 ? 2047 : static_cast<uint16_t>(988 + c * 61);
+        }
+
+        auto length = RCPacket::encode(packet, buffer);
+        RCPacket::Packet decoded;
+        auto ok = length == static_cast<size_t>(RCPacket::kHeaderSize + (count * 11 + 7) / 8 + RCPacket::kCrcSize)
+               && RCPacket::decode(buffer, length, decoded)
+               && decoded.type == RCPacket::kChannels && decoded.count == count
+               && decoded.sequence == packet.sequence && decoded.time == packet.time;
+        for (int c = 0; ok && c < count; c++) {
+            ok = decoded.channels[c] == packet.channels[c];
+        }
+        if (!ok) {
+            std::printf("round trip of %d channels differs\n", count);
+            all = false;
+        }
+    }
+    check(all, "1 to 18 channels round trip through encode() and decode()");
+
+    RCPacket::Packet packet;
+    packet.count = RCPacket::kMaxChannels;
+    auto length = RCPacket::encode(packet, buffer);
+
+    RCPacket::Packet decoded;
+    buffer[RCPacket::kHeaderSize] ^= 0x10;
+    check(!RCPacket::decode(buffer, length, decoded), "a corrupted packet fails the CRC");
+    buffer[RCPacket::kHeaderSize] ^= 0x10;
+    check(!RCPacket::decode(buffer, length - 1, decoded), "a truncated packet is rejected");
+    check(RCPacket::decode(buffer, length, decoded), "the restored packet decodes again");
+}
+
+
+class Sender {
+public:
+    Sender() {
+        m_socket.bind(QHostAddress::LocalHost, 0);
+        m_packet.count = RCPacket::kMaxChannels;
+        std::fill(m_packet.channels, m_packet.channels + RCPacket::kMaxChannels, 1500);
+    }
+
+    void restart(uint16_t sequence) {
+        m_packet.sequence = sequence;
+    }
+
+    void send() {
+        uint8_t buffer[RCPacket::kMaxSize];
+        auto length = RCPacket::encode(m_packet, buffer);
+        m_socket.writeDatagram((char*)buffer, static_cast<qint64>(length), QHostAddress::LocalHost, kTestPort);
+        m_packet.sequence++;
+
+        // the echoes only need taking out of the way, and counting
+        while (m_socket.hasPendingDatagrams()) {
+            auto size = m_socket.readDatagram((char*)buffer, sizeof(buffer));
+            RCPacket::Packet echo;
+            if (size > 0 && RCPacket::decode(buffer, static_cast<size_t>(size), echo) && echo.type == RCPacket::kEcho) {
+                m_echoes++;
+            }
+        }
+    }
+
+    int echoes() const {
+        return m_echoes;
+    }
+
+private:
+    QUdpSocket m_socket;
+    RCPacket::Packet m_packet;
+    int m_echoes = 0;
+};
+
+
+// runs the stub's event loop for ms, sending every kPeriod when there is a sender
+static void run(int ms, Sender *sender) {
+    QElapsedTimer clock;
+    clock.start();
+    qint64 next = 0;
+    while (clock.elapsed() < ms) {
+        if (sender != nullptr && clock.elapsed() >= next) {
+            sender->send();
+            next += kPeriod;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        QThread::msleep(1);
+    }
+}
+
+
+static int throttle(const RCReceiverStub &stub) {
+    auto channels = stub.channels();
+    return channels.size() > 2 ? channels[2].toInt() : -1;
+}
+
+
+static void failsafe() {
+    RCReceiverStub stub;
+    if (!stub.start(kTestPort)) {
+        check(false, "the stub listens on the test port");
+        return;
+    }
+    check(stub.failsafe(), "the stub starts in failsafe");
+
+    Sender sender;
+    sender.restart(1000);
+    run(300, &sender);
+    check(!stub.failsafe(), "packets end failsafe");
+    check(throttle(stub) == 1500, "the throttle follows the sender");
+    check(sender.echoes() > 0, "packets are echoed");
+
+    // an app restart starts counting at 0 again
+    auto packets = stub.property("packets").toInt();
+    sender.restart(0);
+    run(200, &sender);
+    check(stub.property("packets").toInt() > packets + 5, "a restarted sender is followed");
+    check(stub.property("outOfOrder").toInt() == 0, "a restarted sender isn't out of order");
+    check(!stub.failsafe(), "a restarted sender doesn't trip failsafe");
+
+    // kFailsafeTimeout is 500ms, the check runs every 50
+    run(450, nullptr);
+    check(!stub.failsafe(), "no failsafe before 500ms without a packet");
+    run(200, nullptr);
+    check(stub.failsafe(), "failsafe after 500ms without a packet");
+    check(throttle(stub) == 1000, "failsafe puts the throttle to 1000");
+
+    // the sender comes back from somewhere else in its count
+    sender.restart(40000);
+    run(200, &sender);
+    check(!stub.failsafe(), "the first packets after failsafe end it");
+    check(throttle(stub) == 1500, "the throttle follows the sender again");
+
+    stub.stop();
+}
+
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    roundTrip();
+    failsafe();
+
+    if (failures > 0) {
+        std::printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    return 0;
+}
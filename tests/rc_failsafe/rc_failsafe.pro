@@ -0,0 +1,26 @@
+# Headless checks for the OpenHD RC packet and the receiver stub's failsafe, nothing from
+# QtQuick or the GUI is linked.
+#
+#   qmake && make && ./rc_failsafe
+#
+# Exits 1 when a check fails. The stub listens on 127.0.0.1, port kTestPort in main.cpp.
+
+BASEDIR = $$PWD/../..
+
+TEMPLATE = app
+TARGET = rc_failsafe
+
+QT = core network
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$BASEDIR/inc
+
+SOURCES += \
+    main.cpp \
+    $$BASEDIR/src/rcpacket.cpp \
+    $$BASEDIR/src/rcreceiverstub.cpp
+
+HEADERS += \
+    $$BASEDIR/inc/rcpacket.h \
+    $$BASEDIR/inc/rcreceiverstub.h
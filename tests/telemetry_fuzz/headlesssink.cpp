@@ -0,0 +1,124 @@
+#include "telemetrysink.h"
+
+/*
+ * TelemetrySink without the OpenHD singleton behind it, so the decoders can run without
+ * QtQuick. Values are kept rather than dropped so the compiler can't throw away the
+ * decoding that produced them, and the derived values still go through OpenHDUtil the
+ * way the real sink does.
+ */
+
+static volatile double s_last_value = 0;
+static volatile int s_last_percent = 0;
+
+
+TelemetrySink::TelemetrySink() {}
+
+
+int TelemetrySink::battery_cells() {
+    return m_battery_cells;
+}
+
+
+void TelemetrySink::set_battery_voltage(double voltage) {
+    s_last_value = voltage;
+    s_last_percent = m_util.lipo_battery_voltage_to_percent(battery_cells(), voltage);
+    m_util.battery_gauge_glyph_from_percentage(s_last_percent);
+}
+
+
+void TelemetrySink::set_battery_current(double ampere) {
+    s_last_value = ampere;
+}
+
+
+void TelemetrySink::set_flight_mah(double mah) {
+    s_last_value = mah;
+}
+
+
+void TelemetrySink::set_lat(double lat) {
+    s_last_value = lat;
+}
+
+
+void TelemetrySink::set_lon(double lon) {
+    s_last_value = lon;
+}
+
+
+void TelemetrySink::set_alt_rel(double alt_rel) {
+    s_last_value = alt_rel;
+}
+
+
+void TelemetrySink::set_alt_msl(double alt_msl) {
+    s_last_value = alt_msl;
+}
+
+
+void TelemetrySink::set_satellites_visible(int satellites) {
+    s_last_value = satellites;
+}
+
+
+void TelemetrySink::set_gps_hdop(double hdop) {
+    s_last_value = hdop;
+}
+
+
+void TelemetrySink::set_speed(double speed) {
+    s_last_value = speed;
+}
+
+
+void TelemetrySink::set_airspeed(double airspeed) {
+    s_last_value = airspeed;
+}
+
+
+void TelemetrySink::set_hdg(double hdg) {
+    s_last_value = hdg;
+}
+
+
+void TelemetrySink::set_pitch(double pitch) {
+    s_last_value = pitch;
+}
+
+
+void TelemetrySink::set_roll(double roll) {
+    s_last_value = roll;
+}
+
+
+void TelemetrySink::set_vx(double vx) {
+    s_last_value = vx;
+}
+
+
+void TelemetrySink::set_vy(double vy) {
+    s_last_value = vy;
+}
+
+
+void TelemetrySink::set_vz(double vz) {
+    s_last_value = vz;
+}
+
+
+void TelemetrySink::set_rc_rssi(int rssi) {
+    s_last_value = rssi;
+}
+
+
+void TelemetrySink::set_armed(bool armed) {
+    s_last_value = armed;
+}
+
+
+void TelemetrySink::set_flight_mode(const QString &flight_mode) {
+    s_last_value = flight_mode.size();
+}
+
+
+void TelemetrySink::update_home() {}
@@ -0,0 +1,249 @@
+#include <QByteArray>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+
+#include <cstdio>
+#include <vector>
+
+#include "mavlinkbase.h"
+#include "telemetryprotocols.h"
+#include "telemetrysink.h"
+#include "wifibroadcaststatus.h"
+
+/*
+ * Headless harness for the telemetry parsers: the framers from telemetryprotocols.h, the
+ * OpenHD rx status and MavlinkBase::processData(), without QtQuick or the rest of the app.
+ *
+ * The first byte of every input picks the parser, see Target, the rest is handed to it
+ * as one datagram. make_corpus.py writes the checked in corpus in that format.
+ *
+ * Built normally this runs the corpus files or directories given on the command line
+ * and reports bytes/s and frames/s per parser. With CONFIG+=fuzzer libFuzzer drives
+ * LLVMFuzzerTestOneInput() instead, under AddressSanitizer.
+ */
+
+enum Target {
+    TargetFrSky,
+    TargetSmartPort,
+    TargetLTM,
+    TargetVector,
+    TargetMSP,
+    TargetRxStatus,
+    TargetMavlink,
+    TargetCount
+};
+
+static const char *kTargetNames[TargetCount] = { "FrSky", "SmartPort", "LTM", "Vector", "MSP", "RxStatus", "MAVLink" };
+
+// each corpus is run at least this long (ms) for the numbers to settle
+constexpr qint64 kMinRunTime = 500;
+
+
+/*
+ * Takes every message, the corpus isn't from one particular sysid/compid. COMMAND_ACK is
+ * handled by the base class and not counted.
+ */
+class HeadlessMavlink : public MavlinkBase {
+public:
+    HeadlessMavlink() {
+        m_restrict_sysid = false;
+        m_restrict_compid = false;
+        connect(this, &MavlinkBase::processMavlinkMessage, [this](mavlink_message_t) {
+            m_messages++;
+        });
+    }
+
+    void parse(const uint8_t *data, int length) {
+        auto before = m_rx_status.parse_error;
+        processData(QByteArray::fromRawData(reinterpret_cast<const char*>(data), length));
+        m_errors += static_cast<uint8_t>(m_rx_status.parse_error - before);
+    }
+
+    void reset() {
+        m_rx_message = {};
+        m_rx_status = {};
+    }
+
+    uint64_t messages() const {
+        return m_messages;
+    }
+
+    uint64_t errors() const {
+        return m_errors;
+    }
+
+private:
+    uint64_t m_messages = 0;
+    uint64_t m_errors = 0;
+};
+
+
+struct Parsers {
+    FrSkyDecoder frsky;
+    SmartPortDecoder smartport;
+    LTMDecoder ltm;
+    VectorDecoder vector;
+    MSPDecoder msp;
+
+    uint64_t rx_status = 0;
+    uint64_t rx_status_errors = 0;
+
+    TelemetryDecoder *decoder(int target) {
+        switch (target) {
+            case TargetFrSky: return &frsky;
+            case TargetSmartPort: return &smartport;
+            case TargetLTM: return &ltm;
+            case TargetVector: return &vector;
+            case TargetMSP: return &msp;
+            default: return nullptr;
+        }
+    }
+};
+
+
+static void feed(Parsers &parsers, HeadlessMavlink &mavlink, TelemetrySink &sink, int target, const uint8_t *data, int length) {
+    if (target == TargetRxStatus) {
+        wifibroadcast_rx_status_forward_t status;
+        if (decodeRxStatus(data, length, status)) {
+            parsers.rx_status++;
+        } else {
+            parsers.rx_status_errors++;
+        }
+    } else if (target == TargetMavlink) {
+        mavlink.parse(data, length);
+    } else {
+        parsers.decoder(target)->parse(data, length, sink);
+    }
+}
+
+
+#if defined(TELEMETRY_FUZZER)
+
+/*
+ * Fresh framer state per input so a crash reproduces from its input alone. The sink and
+ * the MavlinkBase are QObjects and only built once, the latter's parser is reset instead.
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static TelemetrySink sink;
+    static HeadlessMavlink mavlink;
+
+    if (size < 1) {
+        return 0;
+    }
+
+    Parsers parsers;
+    mavlink.reset();
+    feed(parsers, mavlink, sink, data[0] % TargetCount, data + 1, static_cast<int>(size - 1));
+    return 0;
+}
+
+#else
+
+static uint64_t frames(Parsers &parsers, HeadlessMavlink &mavlink, int target) {
+    if (target == TargetRxStatus) {
+        return parsers.rx_status;
+    }
+    if (target == TargetMavlink) {
+        return mavlink.messages();
+    }
+    return parsers.decoder(target)->frames();
+}
+
+
+static uint64_t errors(Parsers &parsers, HeadlessMavlink &mavlink, int target) {
+    if (target == TargetRxStatus) {
+        return parsers.rx_status_errors;
+    }
+    if (target == TargetMavlink) {
+        return mavlink.errors();
+    }
+    return parsers.decoder(target)->errors();
+}
+
+
+static void addInput(const QString &path, std::vector<QByteArray> &inputs) {
+    QFileInfo info(path);
+    if (info.isDir()) {
+        for (const auto &entry : QDir(path).entryInfoList(QDir::Files, QDir::Name)) {
+            addInput(entry.filePath(), inputs);
+        }
+        return;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        fprintf(stderr, "can't read %s\n", qPrintable(path));
+        return;
+    }
+    auto data = file.readAll();
+    if (data.size() > 1) {
+        inputs.push_back(data);
+    }
+}
+
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <corpus file or directory>...\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<QByteArray> inputs[TargetCount];
+    for (int i = 1; i < argc; i++) {
+        std::vector<QByteArray> found;
+        addInput(QString::fromLocal8Bit(argv[i]), found);
+        for (const auto &input : found) {
+            inputs[static_cast<uint8_t>(input[0]) % TargetCount].push_back(input);
+        }
+    }
+
+    TelemetrySink sink;
+    HeadlessMavlink mavlink;
+    Parsers parsers;
+
+    printf("%-10s %8s %12s %10s %12s %12s\n", "parser", "inputs", "frames", "errors", "MB/s", "frames/s");
+
+    int result = 0;
+
+    for (int target = 0; target < TargetCount; target++) {
+        if (inputs[target].empty()) {
+            continue;
+        }
+
+        auto frames_before = frames(parsers, mavlink, target);
+        auto errors_before = errors(parsers, mavlink, target);
+        uint64_t bytes = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        qint64 elapsed = 0;
+        do {
+            for (const auto &input : inputs[target]) {
+                auto data = reinterpret_cast<const uint8_t*>(input.constData());
+                feed(parsers, mavlink, sink, target, data + 1, input.size() - 1);
+                bytes += input.size() - 1;
+            }
+            elapsed = timer.nsecsElapsed();
+        } while (elapsed < kMinRunTime * 1000000);
+
+        auto decoded = frames(parsers, mavlink, target) - frames_before;
+        auto failed = errors(parsers, mavlink, target) - errors_before;
+        auto seconds = elapsed / 1e9;
+
+        printf("%-10s %8zu %12llu %10llu %12.1f %12.0f\n", kTargetNames[target], inputs[target].size(),
+               static_cast<unsigned long long>(decoded), static_cast<unsigned long long>(failed),
+               bytes / seconds / 1e6, decoded / seconds);
+
+        // the corpus is made of valid frames, a parser that finds none of them is broken
+        if (decoded == 0) {
+            fprintf(stderr, "%s decoded nothing from its corpus\n", kTargetNames[target]);
+            result = 1;
+        }
+    }
+
+    return result;
+}
+
+#endif
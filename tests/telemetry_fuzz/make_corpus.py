@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+#
+# Writes the seed corpus for telemetry_fuzz. Every file starts with one byte picking the
+# parser, see Target in main.cpp, followed by the stream as it would arrive on the wire.
+# The files are checked in, run this again after changing a protocol.
+
+import os
+import struct
+
+FRSKY, SMARTPORT, LTM, VECTOR, MSP, RXSTATUS, MAVLINK = range(7)
+
+OUT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "corpus")
+
+
+def write(name, target, data):
+    with open(os.path.join(OUT, name), "wb") as f:
+        f.write(bytes([target]) + data)
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def crc_x25(data, crc=0xFFFF):
+    for b in data:
+        tmp = b ^ (crc & 0xFF)
+        tmp = (tmp ^ (tmp << 4)) & 0xFF
+        crc = ((crc >> 8) ^ (tmp << 8) ^ (tmp << 3) ^ (tmp >> 4)) & 0xFFFF
+    return crc
+
+
+def xor(data):
+    x = 0
+    for b in data:
+        x ^= b
+    return x
+
+
+# FrSky hub: 0x5E id lo hi, 0x5E/0x5D in the data stuffed as 0x5D b^0x60
+def frsky(id, value):
+    out = bytearray([0x5E])
+    for b in struct.pack("<BH", id, value):
+        if b in (0x5E, 0x5D):
+            out += bytes([0x5D, b ^ 0x60])
+        else:
+            out.append(b)
+    return bytes(out)
+
+
+# SmartPort: poll 0x7E, then 0x10 id value crc, 0x7E/0x7D stuffed as 0x7D b^0x20
+def smartport(id, value):
+    frame = struct.pack("<BHI", 0x10, id, value & 0xFFFFFFFF)
+    crc = 0
+    for b in frame:
+        crc += b
+        crc += crc >> 8
+        crc &= 0xFF
+    frame += bytes([0xFF - crc])
+    out = bytearray([0x7E, 0x98])
+    for b in frame:
+        if b in (0x7E, 0x7D):
+            out += bytes([0x7D, b ^ 0x20])
+        else:
+            out.append(b)
+    return bytes(out)
+
+
+def ltm(kind, payload):
+    return b"$T" + kind + payload + bytes([xor(payload)])
+
+
+def msp(command, payload):
+    body = bytes([len(payload), command]) + payload
+    return b"$M>" + body + bytes([xor(body)])
+
+
+def vector():
+    body = struct.pack(">IIiHhHhhhhhhHHHHHhHHBBiiIHHiBBB24x",
+                       0xB01EDEAD, 123456, 12345, 120, 50, 3000,
+                       -150, 220, 1800, 10, -5, 3,
+                       1620, 1200, 500, 500, 123, 250, 1234, 90, 80, 95,
+                       473977420, 85455620, 1234, 452, 180, 54321, 12, 9, 2)
+    assert len(body) == 95, len(body)
+    return body + struct.pack("<H", crc16_ccitt(body))
+
+
+def rxstatus(adapters):
+    status = struct.pack("<13I3b2f4BI",
+                         2, 15, 0, 1, 123456, 6200, 8000, 7000,
+                         3, 4, 0, 0, 2,
+                         -58, -60, 1,
+                         47.39, 8.54,
+                         35, 55, 42, 61,
+                         len(adapters))
+    for i in range(6):
+        count, dbm = adapters[i] if i < len(adapters) else (0, 0)
+        status += struct.pack("<Ibbb", count, dbm, 0, 1)
+    assert len(status) == 113, len(status)
+    return status
+
+
+# MAVLink v1 and v2, crc extras from the common dialect
+HEARTBEAT = (0, 50)
+SYS_STATUS = (1, 124)
+ATTITUDE = (30, 39)
+GLOBAL_POSITION_INT = (33, 104)
+COMMAND_ACK = (77, 143)
+
+
+def mavlink1(message, payload, seq, sysid=1, compid=1):
+    msgid, extra = message
+    header = struct.pack("<BBBBB", len(payload), seq, sysid, compid, msgid)
+    crc = crc_x25(header + payload + bytes([extra]))
+    return b"\xFE" + header + payload + struct.pack("<H", crc)
+
+
+def mavlink2(message, payload, seq, sysid=1, compid=1):
+    msgid, extra = message
+    payload = payload.rstrip(b"\x00") or b"\x00"
+    header = struct.pack("<BBBBBB", len(payload), 0, 0, seq, sysid, compid) + struct.pack("<I", msgid)[:3]
+    crc = crc_x25(header + payload + bytes([extra]))
+    return b"\xFD" + header + payload + struct.pack("<H", crc)
+
+
+def mavlink_stream(pack):
+    heartbeat = struct.pack("<IBBBBB", 3, 2, 3, 0x81, 4, 3)
+    sys_status = struct.pack("<IIIHHhHHHHHHb", 0, 0, 0, 250, 16200, 1250, 0, 0, 0, 0, 0, 0, 87)
+    attitude = struct.pack("<Iffffff", 1000, 0.1, -0.05, 1.5, 0.0, 0.0, 0.0)
+    position = struct.pack("<IiiiihhhH", 1000, 473977420, 85455620, 452000, 12000, 150, -20, 5, 9000)
+    ack = struct.pack("<HB", 11202, 0)
+    out = b""
+    seq = 0
+    for _ in range(4):
+        for message, payload in ((HEARTBEAT, heartbeat), (SYS_STATUS, sys_status), (ATTITUDE, attitude),
+                                 (GLOBAL_POSITION_INT, position), (COMMAND_ACK, ack)):
+            out += pack(message, payload, seq & 0xFF)
+            seq += 1
+    return out
+
+
+def main():
+    os.makedirs(OUT, exist_ok=True)
+
+    write("frsky", FRSKY,
+          frsky(0x39, 126) + frsky(0x10, 0x5E5D) + frsky(0x12, 8) + frsky(0x1A, 5455) + frsky(0x22, ord("E")) +
+          frsky(0x13, 47) + frsky(0x1B, 3977) + frsky(0x23, ord("N")) + frsky(0x11, 12) + frsky(0x14, 90))
+
+    write("smartport", SMARTPORT,
+          smartport(0x0210, 1620) + smartport(0x0800, 28438452) + smartport(0x0800, 0x80000000 | 5127337) +
+          smartport(0x0100, 4520) + smartport(0x0830, 1234) + smartport(0x0840, 9000) + smartport(0x7E7D, 0x7E7D7E7D))
+
+    write("ltm", LTM,
+          ltm(b"G", struct.pack("<iiBiB", 473977420, 85455620, 12, 45200, (9 << 2) | 3)) +
+          ltm(b"A", struct.pack("<hhh", -5, 10, -170)) +
+          ltm(b"S", struct.pack("<HHBBB", 16200, 1250, 87, 14, (2 << 2) | 1)) +
+          ltm(b"O", struct.pack("<iiiBB", 473977000, 85455000, 0, 1, 3)) +
+          ltm(b"X", struct.pack("<HBBBB", 120, 0, 0, 0, 0)) +
+          ltm(b"N", struct.pack("<BBBBBB", 0, 0, 0, 0, 0, 0)))
+
+    write("vector", VECTOR, vector() + vector())
+
+    write("msp", MSP,
+          msp(106, struct.pack("<BBiiHHH", 1, 9, 473977420, 85455620, 452, 1200, 900)) +
+          msp(108, struct.pack("<hhh", -50, 100, 180)) +
+          msp(109, struct.pack("<ih", 4520, 15)) +
+          msp(110, struct.pack("<BHHh", 162, 1250, 870, 125)) +
+          msp(106, b"\x01"))
+
+    write("rxstatus", RXSTATUS, rxstatus([(12345, -58), (12001, -61)]))
+    write("rxstatus-adapters", RXSTATUS, rxstatus([(100 * i, -50 - i) for i in range(6)]))
+
+    write("mavlink1", MAVLINK, mavlink_stream(mavlink1))
+    write("mavlink2", MAVLINK, mavlink_stream(mavlink2))
+
+    # a frame cut short and one with a bad crc, with good frames after them
+    good = mavlink_stream(mavlink2)
+    bad = bytearray(good[:40])
+    bad[20] ^= 0xFF
+    write("mavlink-damaged", MAVLINK, good[:17] + bytes(bad) + good)
+
+
+if __name__ == "__main__":
+    main()
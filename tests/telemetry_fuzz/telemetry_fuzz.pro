@@ -0,0 +1,53 @@
+# Headless harness for the telemetry parsers, nothing from QtQuick or the GUI is linked.
+#
+# Benchmark, runs the corpus through every parser and reports bytes/s and frames/s:
+#
+#   qmake && make && ./telemetry_fuzz corpus
+#
+# Add CONFIG+=asan to run the same under AddressSanitizer. libFuzzer, the first byte of
+# each input picks the parser:
+#
+#   qmake CONFIG+=fuzzer QMAKE_CXX=clang++ QMAKE_LINK=clang++ && make
+#   ./telemetry_fuzz -max_len=4096 corpus
+#
+# make_corpus.py rewrites corpus/ after a protocol change.
+
+BASEDIR = $$PWD/../..
+
+TEMPLATE = app
+TARGET = telemetry_fuzz
+
+QT = core network concurrent
+CONFIG += console c++17
+CONFIG -= app_bundle
+
+# trace.cpp needs the QML side, the macros compile to nothing here
+DEFINES += QOPENHD_NO_TRACE
+
+INCLUDEPATH += $$BASEDIR/inc
+INCLUDEPATH += $$BASEDIR/lib/mavlink_generated/include/mavlink/v2.0
+
+SOURCES += \
+    main.cpp \
+    headlesssink.cpp \
+    $$BASEDIR/src/mavlinkbase.cpp \
+    $$BASEDIR/src/telemetryprotocols.cpp \
+    $$BASEDIR/src/util.cpp \
+    $$BASEDIR/src/wifibroadcaststatus.cpp
+
+HEADERS += \
+    $$BASEDIR/inc/mavlinkbase.h \
+    $$BASEDIR/inc/telemetrydecoder.h \
+    $$BASEDIR/inc/telemetryprotocols.h \
+    $$BASEDIR/inc/telemetrysink.h \
+    $$BASEDIR/inc/util.h \
+    $$BASEDIR/inc/wifibroadcaststatus.h
+
+fuzzer {
+    DEFINES += TELEMETRY_FUZZER
+    QMAKE_CXXFLAGS += -g -fno-omit-frame-pointer -fsanitize=fuzzer,address
+    QMAKE_LFLAGS += -fsanitize=fuzzer,address
+} else:asan {
+    QMAKE_CXXFLAGS += -g -fno-omit-frame-pointer -fsanitize=address
+    QMAKE_LFLAGS += -fsanitize=address
+}